@@ -0,0 +1,286 @@
+/**
+  * @file BenchCommon.h
+  * @brief Файл BenchCommon.h содержит общие для программ измерения
+  *        производительности средства: гистограмму задержек, отсчет времени,
+  *        разбор параметров командной строки и формирование результатов в
+  *        формате JSON.
+  */
+
+#ifndef BENCHCOMMON_H
+#define BENCHCOMMON_H
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef SPO_BENCH_VERSION
+# define SPO_BENCH_VERSION "unknown"
+#endif
+
+namespace                         spo   {
+namespace                         bench {
+
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Метод NowNs возвращает показания монотонных часов в наносекундах.
+ */
+inline std::uint64_t NowNs ()
+{
+  return static_cast< std::uint64_t >(
+        std::chrono::duration_cast< std::chrono::nanoseconds >(
+          std::chrono::steady_clock::now().time_since_epoch() ).count() );
+}
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс LatencyHistogram реализует лог-линейную гистограмму значений
+ *        задержки (в наносекундах).
+ *
+ * Диапазон каждой степени двойки делится на @a SUB_BUCKETS равных интервалов,
+ * поэтому относительная погрешность процентилей не превышает 1/SUB_BUCKETS
+ * (~3%) при постоянном объеме памяти и O(1) на запись.
+ */
+class                             LatencyHistogram
+{
+public:
+  static const std::size_t        SUB_BITS          = 5;
+  static const std::size_t        SUB_BUCKETS       = std::size_t( 1 ) << SUB_BITS;
+  static const std::size_t        MAJOR_BUCKETS     = 64 - SUB_BITS;
+
+  /**
+   * @brief Метод Record добавляет значение в гистограмму.
+   * @param value значение задержки, нс.
+   */
+  void Record ( std::uint64_t value )
+  {
+    ++ m_Counts[ Index( value ) ];
+    ++ m_Count;
+    m_Sum += value;
+    m_Min = std::min( m_Min, value );
+    m_Max = std::max( m_Max, value );
+  }
+
+  /**
+   * @brief Метод RecordCorrected добавляет значение с поправкой на
+   *        согласованный пропуск (coordinated omission).
+   *
+   * Источник нагрузки с замкнутым циклом не отправляет запросы, пока ожидает
+   * ответа, поэтому задержка @a value, превышающая ожидаемый интервал между
+   * запросами, скрывает запросы, которые должны были быть отправлены за это
+   * время. Для них записываются значения value - interval, value - 2*interval
+   * и т.д. (как recordValueWithExpectedInterval в HdrHistogram).
+   *
+   * @param value     значение задержки, нс;
+   * @param intervalNs ожидаемый интервал между запросами, нс (0 - без поправки).
+   */
+  void RecordCorrected ( std::uint64_t value, std::uint64_t intervalNs )
+  {
+    Record( value );
+    if( ( intervalNs == 0 ) or ( value <= intervalNs ) )
+      return;
+
+    for( auto missing( value - intervalNs ); missing >= intervalNs; missing -= intervalNs )
+      Record( missing );
+  }
+
+  /**
+   * @brief Метод Merge добавляет к гистограмме значения другой гистограммы.
+   */
+  void Merge ( const LatencyHistogram & other )
+  {
+    for( std::size_t idx( 0 ); idx < m_Counts.size(); ++idx )
+      m_Counts[ idx ] += other.m_Counts[ idx ];
+    m_Count += other.m_Count;
+    m_Sum   += other.m_Sum;
+    m_Min    = std::min( m_Min, other.m_Min );
+    m_Max    = std::max( m_Max, other.m_Max );
+  }
+
+  void Clear ()
+  {
+    * this = LatencyHistogram();
+  }
+
+  std::uint64_t Count () const { return m_Count; }
+  std::uint64_t Min   () const { return m_Count > 0 ? m_Min : 0; }
+  std::uint64_t Max   () const { return m_Max; }
+  double        Mean  () const
+    { return m_Count > 0 ? double( m_Sum ) / double( m_Count ) : 0.0; }
+
+  /**
+   * @brief Метод Percentile возвращает значение процентиля.
+   * @param p процентиль в диапазоне [0, 100].
+   * @return верхняя граница интервала, содержащего процентиль, но не более
+   *         максимального записанного значения.
+   */
+  std::uint64_t Percentile ( double p ) const
+  {
+    if( m_Count == 0 )
+      return 0;
+
+    auto rank( static_cast< std::uint64_t >( double( m_Count ) * p / 100.0 + 0.5 ) );
+    rank = std::max< std::uint64_t >( 1, std::min( rank, m_Count ) );
+
+    std::uint64_t seen( 0 );
+    for( std::size_t idx( 0 ); idx < m_Counts.size(); ++idx )
+    {
+      seen += m_Counts[ idx ];
+      if( seen >= rank )
+        return std::min( UpperBound( idx ), m_Max );
+    }
+    return m_Max;
+  }
+
+private:
+  static std::size_t Index ( std::uint64_t value )
+  {
+    if( value < SUB_BUCKETS )
+      return static_cast< std::size_t >( value );
+
+    std::size_t msb( 63 - static_cast< std::size_t >( __builtin_clzll( value ) ) );
+    std::size_t shift( msb - SUB_BITS );
+    return ( shift + 1 ) * SUB_BUCKETS
+        + static_cast< std::size_t >( ( value >> shift ) & ( SUB_BUCKETS - 1 ) );
+  }
+
+  static std::uint64_t UpperBound ( std::size_t idx )
+  {
+    if( idx < SUB_BUCKETS )
+      return idx;
+
+    std::size_t shift( idx / SUB_BUCKETS - 1 );
+    std::uint64_t sub( idx % SUB_BUCKETS );
+    return ( ( ( std::uint64_t( SUB_BUCKETS ) | sub ) + 1 ) << shift ) - 1;
+  }
+
+  std::array< std::uint64_t, ( MAJOR_BUCKETS + 1 ) * SUB_BUCKETS > m_Counts {{}};
+  std::uint64_t                   m_Count             { 0 };
+  std::uint64_t                   m_Sum               { 0 };
+  std::uint64_t                   m_Min               { UINT64_MAX };
+  std::uint64_t                   m_Max               { 0 };
+};
+
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Метод JsonString экранирует строку для вывода в JSON.
+ */
+inline std::string JsonString ( const std::string & str )
+{
+  std::string retval( "\"" );
+  for( auto c : str )
+  {
+    if( ( c == '"' ) or ( c == '\\' ) )
+      retval += '\\';
+    retval += ( static_cast< unsigned char >( c ) < 0x20 ) ? ' ' : c;
+  }
+  return retval + "\"";
+}
+
+/**
+ * @brief Метод HistogramJson возвращает JSON-объект с характеристиками
+ *        гистограммы задержек (значения в наносекундах).
+ */
+inline std::string HistogramJson ( const LatencyHistogram & h )
+{
+  std::ostringstream os;
+  os << "{\"count\":" << h.Count()
+     << ",\"min\":"   << h.Min()
+     << ",\"mean\":"  << static_cast< std::uint64_t >( h.Mean() )
+     << ",\"p50\":"   << h.Percentile( 50.0 )
+     << ",\"p90\":"   << h.Percentile( 90.0 )
+     << ",\"p99\":"   << h.Percentile( 99.0 )
+     << ",\"p999\":"  << h.Percentile( 99.9 )
+     << ",\"max\":"   << h.Max()
+     << "}";
+  return os.str();
+}
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс Arguments реализует разбор параметров командной строки вида
+ *        @a --name @a value.
+ */
+class                             Arguments
+{
+public:
+  /**/                            Arguments           ( int argc, char * argv[] )
+  {
+    for( int idx( 1 ); idx < argc; ++idx )
+      m_Args.push_back( argv[ idx ] );
+  }
+
+  bool Has ( const std::string & name ) const
+  {
+    return std::find( m_Args.cbegin(), m_Args.cend(), name ) != m_Args.cend();
+  }
+
+  std::string Value ( const std::string & name, const std::string & defValue ) const
+  {
+    auto iter( std::find( m_Args.cbegin(), m_Args.cend(), name ) );
+    return
+        ( iter != m_Args.cend() ) and ( iter + 1 != m_Args.cend() )
+        ? *( iter + 1 )
+        : defValue;
+  }
+
+  std::int64_t Int ( const std::string & name, std::int64_t defValue ) const
+  {
+    auto str( Value( name, std::string() ) );
+    return str.empty() ? defValue : std::strtoll( str.c_str(), nullptr, 0 );
+  }
+
+  /**
+   * @brief Метод List возвращает список значений, перечисленных через запятую.
+   */
+  std::vector< std::string > List ( const std::string & name, const std::string & defValue ) const
+  {
+    std::vector< std::string > retval;
+    std::stringstream ss( Value( name, defValue ) );
+    std::string item;
+    while( std::getline( ss, item, ',' ) )
+      if( not item.empty() )
+        retval.push_back( item );
+    return retval;
+  }
+
+  /**
+   * @brief Метод Sizes возвращает список размеров, перечисленных через запятую.
+   *        Допускаются суффиксы K и M (1024 и 1048576).
+   */
+  std::vector< std::size_t > Sizes ( const std::string & name, const std::string & defValue ) const
+  {
+    std::vector< std::size_t > retval;
+    for( auto & item : List( name, defValue ) )
+      retval.push_back( ParseSize( item ) );
+    return retval;
+  }
+
+  static std::size_t ParseSize ( const std::string & str )
+  {
+    char * end( nullptr );
+    std::size_t retval( std::strtoull( str.c_str(), & end, 10 ) );
+    if( ( nullptr != end ) and ( ( *end == 'K' ) or ( *end == 'k' ) ) )
+      retval <<= 10;
+    else if( ( nullptr != end ) and ( ( *end == 'M' ) or ( *end == 'm' ) ) )
+      retval <<= 20;
+    return retval;
+  }
+
+private:
+  std::vector< std::string >      m_Args;
+};
+
+//------------------------------------------------------------------------------
+
+}// namespace                     bench
+}// namespace                     spo
+
+#endif // BENCHCOMMON_H
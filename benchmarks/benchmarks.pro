@@ -0,0 +1,13 @@
+TEMPLATE = subdirs
+
+bench_tools.subdir = $$PWD/tools
+
+bench_tools.CONFIG = recursive
+
+SUBDIRS += \
+    bench_tools \
+
+OTHER_FILES += $$PWD/BenchCommon.h
+
+QMAKE_EXTRA_TARGETS += \
+    $$PWD/../tools \
@@ -0,0 +1,38 @@
+include($$PWD/../tools/core/core_config.pri)
+include($$PWD/../tools/core/admin/admin.pri)
+include($$PWD/../tools/asio/asio.pri)
+
+TARGET = $${APP_NAME}$${FILE_SUFFIX}
+
+CONFIG += console
+CONFIG -= app_bundle
+
+INCLUDEPATH += $$PWD
+
+SOURCES += *.cpp
+HEADERS += $$PWD/BenchCommon.h
+
+DEFINES += SPO_BENCH_VERSION=\\\"$${VERSION}\\\"
+
+target.path=$${OUTPUT_BINARY_BENCH_PATH}
+
+INSTALLS += target
+
+LIBS += -L$$OUTPUT_LIBRARY_PATH -l$${CORE_LIB_NAME}$${FILE_SUFFIX}
+LIBS += -L$$OUTPUT_LIBRARY_PATH -l$${ASIO_LIB_NAME}$${FILE_SUFFIX}
+
+LIBS += \
+    -L/usr/include/boost \
+    -lboost_coroutine \
+    -lboost_context \
+    -lboost_thread \
+    -lboost_date_time \
+    -lboost_system \
+
+QMAKE_EXTRA_TARGETS += \
+    $$PWD/../tools \
+    $$PWD/../tools/core \
+    $$PWD/../tools/asio \
+
+QMAKE_DISTCLEAN += \
+    $${target.path}/$${TARGET}*
@@ -0,0 +1,3 @@
+APP_NAME = load_gen
+
+include($$PWD/../../../benchmarks_body.pri)
@@ -0,0 +1,645 @@
+/**
+  * @file main.cpp
+  * @brief Программа load_gen формирует сетевую нагрузку на серверы
+  *        @a spo::asio::AsioTCPServer и @a spo::asio::AsioUDPServer средствами
+  *        клиента @a spo::asio::AsioClient.
+  *
+  * Сессии библиотеки однократны, поэтому каждый обмен (запрос) выполняется
+  * отдельным подключением клиента: одновременно обслуживаемые обмены образуют
+  * одновременные соединения (до @a max_connections - 1 на процесс).
+  *
+  * Режимы формирования нагрузки:
+  * @value closed замкнутый цикл: @a --connections одновременных обменов, каждый
+  *               следующий обмен соединения начинается после завершения
+  *               предыдущего (не чаще @a --rate / @a --connections в секунду);
+  * @value open   разомкнутый цикл: обмены начинаются в расчетные моменты
+  *               времени с частотой @a --rate (равномерно или по закону
+  *               Пуассона) независимо от завершения предыдущих; не более
+  *               @a --connections обменов одновременно, остальные учитываются
+  *               как пропущенные (dropped).
+  *
+  * Размер сообщения выбирается для каждого обмена по закону @a --size-dist:
+  * @value fixed:N               постоянный размер;
+  * @value uniform:MIN:MAX       равномерное распределение;
+  * @value exp:MEAN              экспоненциальное распределение;
+  * @value lognormal:MEDIAN:SIGMA логнормальное распределение;
+  * @value choice:S1/S2/...      равновероятный выбор из списка.
+  *
+  * Задержки записываются в две гистограммы:
+  * @value service_ns время обмена от начала подключения до ответа (или до
+  *                   закрытия соединения для режимов, завершающихся передачей);
+  * @value latency_ns задержка с поправкой на согласованный пропуск: в
+  *                   разомкнутом цикле отсчитывается от расчетного момента
+  *                   начала обмена, в замкнутом цикле с заданной частотой
+  *                   дополняется значениями пропущенных запросов
+  *                   (@a LatencyHistogram::RecordCorrected).
+  *
+  * Отчет выводится в стандартный поток вывода в формате JSON, диагностика
+  * библиотеки подавляется.
+  *
+  * @par Пример запуска:
+  * @code
+  *  load_gen --proto tcp --host 127.0.0.1 --port 24000 --mode HalfDuplexOut \
+  *           --loop open --rate 20000 --arrival poisson --connections 2000 \
+  *           --size-dist lognormal:512:1.0 --duration-ms 10000 > load.json
+  * @endcode
+  */
+
+#include "BenchCommon.h"
+#include "asio/AsioClient.h"
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+namespace {
+
+using byte_t                    = char;
+using document_t                = spo::core::docs::BytesDocument< byte_t >;
+
+const std::size_t                 UDP_PAYLOAD_MAX   = 65507;
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Структура Settings содержит параметры нагрузки.
+ */
+struct                            Settings
+{
+  std::string                     m_Proto           { "tcp" };
+  std::string                     m_Host            { "127.0.0.1" };
+  std::string                     m_Port            { "24000" };
+  std::string                     m_Mode            { "HalfDuplexOut" };
+  std::string                     m_Loop            { "closed" };
+  std::string                     m_Arrival         { "fixed" };
+  std::string                     m_SizeDist        { "fixed:64" };
+  int                             m_Connections     { 64 };
+  double                          m_Rate            { 0.0 };
+  std::int64_t                    m_DurationMs      { 10000 };
+  std::int64_t                    m_WarmupMs        { 1000 };
+  std::int64_t                    m_TimeoutMs       { 5000 };
+  std::size_t                     m_ResponseBuffer  { 65536 };
+  std::uint64_t                   m_Seed            { 1 };
+
+  bool IsOpenLoop () const { return m_Loop == "open"; }
+  bool IsTcp      () const { return m_Proto == "tcp"; }
+};
+
+spo::asio::TransferType ModeType ( const std::string & mode )
+{
+  if( mode == "SimplexIn"    ) return spo::asio::TransferType::SimplexIn;
+  if( mode == "SimplexOut"   ) return spo::asio::TransferType::SimplexOut;
+  if( mode == "HalfDuplexIn" ) return spo::asio::TransferType::HalfDuplexIn;
+  return spo::asio::TransferType::HalfDuplexOut;
+}
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс SizeDistribution реализует выбор размера сообщения по
+ *        заданному закону распределения.
+ */
+class                             SizeDistribution
+{
+public:
+  /**
+   * @brief Метод Parse разбирает описание закона распределения.
+   * @param spec    описание вида "тип:параметр[:параметр]";
+   * @param maxSize максимальный размер сообщения.
+   * @return признак корректного описания.
+   */
+  bool Parse ( const std::string & spec, std::size_t maxSize )
+  {
+    m_Spec    = spec;
+    m_MaxSize = maxSize;
+
+    std::vector< std::string > items;
+    std::stringstream ss( spec );
+    std::string item;
+    while( std::getline( ss, item, ':' ) )
+      items.push_back( item );
+    if( items.size() < 2 )
+      return false;
+
+    m_Kind = items[ 0 ];
+    if( m_Kind == "choice" )
+    {
+      std::stringstream cs( items[ 1 ] );
+      while( std::getline( cs, item, '/' ) )
+        if( not item.empty() )
+          m_Choices.push_back( spo::bench::Arguments::ParseSize( item ) );
+      return not m_Choices.empty();
+    }
+
+    m_A = double( spo::bench::Arguments::ParseSize( items[ 1 ] ) );
+    if( m_Kind == "fixed" or m_Kind == "exp" )
+      return m_A > 0;
+    if( items.size() < 3 )
+      return false;
+    if( m_Kind == "uniform" )
+    {
+      m_B = double( spo::bench::Arguments::ParseSize( items[ 2 ] ) );
+      return ( m_A > 0 ) and ( m_B >= m_A );
+    }
+    if( m_Kind == "lognormal" )
+    {
+      m_B = std::strtod( items[ 2 ].c_str(), nullptr );
+      return ( m_A > 0 ) and ( m_B >= 0 );
+    }
+    return false;
+  }
+
+  std::size_t Next ( std::mt19937_64 & gen ) const
+  {
+    double value( m_A );
+    if( m_Kind == "uniform" )
+      value = std::uniform_real_distribution< double >( m_A, m_B + 1.0 )( gen );
+    else if( m_Kind == "exp" )
+      value = std::exponential_distribution< double >( 1.0 / m_A )( gen );
+    else if( m_Kind == "lognormal" )
+      value = std::lognormal_distribution< double >( std::log( m_A ), m_B )( gen );
+    else if( m_Kind == "choice" )
+      value = double( m_Choices[ std::uniform_int_distribution< std::size_t >(
+                                   0, m_Choices.size() - 1 )( gen ) ] );
+
+    return std::max< std::size_t >( 1, std::min( m_MaxSize, static_cast< std::size_t >( value ) ) );
+  }
+
+  const std::string & Spec    () const { return m_Spec; }
+  std::size_t         MaxSize () const { return m_MaxSize; }
+
+private:
+  std::string                     m_Spec;
+  std::string                     m_Kind;
+  double                          m_A               { 0.0 };
+  double                          m_B               { 0.0 };
+  std::vector< std::size_t >      m_Choices;
+  std::size_t                     m_MaxSize         { 1 };
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс LoadGenerator формирует нагрузку клиентом
+ *        @a spo::asio::AsioClient и собирает результаты измерения.
+ */
+template< typename                ProtocolT_ >
+class                             LoadGenerator
+{
+public:
+  using client_t                = spo::asio::AsioClient< ProtocolT_, byte_t >;
+  using session_shr_t           = typename client_t::session_shr_t;
+
+  /**
+   * @brief Структура Exchange содержит состояние одного обмена.
+   */
+  struct                          Exchange
+  {
+    std::uint64_t                 m_Intended        { 0 };
+    std::uint64_t                 m_Started         { 0 };
+    std::size_t                   m_Size            { 0 };
+    int                           m_Slot            { -1 };
+    std::atomic_bool              m_Sent            { false };
+    std::atomic_bool              m_Done            { false };
+    std::atomic< std::uint64_t >  m_Received        { 0 };
+  };
+  using exchange_shr_t          = std::shared_ptr< Exchange >;
+
+  /**/                            LoadGenerator       ( const Settings & settings, const SizeDistribution & sizes )
+    : m_Settings                  ( settings )
+    , m_Sizes                     ( sizes )
+    , m_Client                    ( ModeType( settings.m_Mode ), settings.m_Host, settings.m_Port, false )
+    , m_Random                    ( settings.m_Seed )
+    , m_Payload                   ( sizes.MaxSize(), 'x' )
+  {
+    // начальное подключение клиента при запуске сервиса не используется:
+    // обмены запускаются генератором
+    spo::asio::AsioService::Instance().ClearCallbacks();
+
+    m_Client.SetSocketsLimit( INT_MAX );
+    m_Client.SetSocketDeadline( settings.m_TimeoutMs );
+    m_Client.SetBufferSize( settings.m_ResponseBuffer );
+    m_Connections = std::max( 1, std::min( settings.m_Connections, m_Client.SocketsLimit() ) );
+
+    if( settings.m_Rate > 0 )
+      m_IntervalNs = static_cast< std::uint64_t >(
+                       1e9 * ( settings.IsOpenLoop() ? 1.0 : double( m_Connections ) ) / settings.m_Rate );
+
+    auto mode( ModeType( settings.m_Mode ) );
+    m_EndsWithSend = ( mode == spo::asio::TransferType::SimplexOut )
+                     or ( mode == spo::asio::TransferType::HalfDuplexIn );
+  }
+
+  /**
+   * @brief Метод Run выполняет нагрузку и возвращает JSON-объект результата.
+   */
+  std::string Run ()
+  {
+    if( not spo::asio::AsioService::Instance().Start() )
+      return "{\"error\":\"service start failed\"}";
+
+    m_Running     = true;
+    m_Start       = spo::bench::NowNs();
+    m_MeasureFrom = m_Start + static_cast< std::uint64_t >( m_Settings.m_WarmupMs ) * 1000000;
+    m_MeasureTo   = m_MeasureFrom + static_cast< std::uint64_t >( m_Settings.m_DurationMs ) * 1000000;
+
+    if( m_Settings.IsOpenLoop() )
+      boost::asio::spawn(
+            spo::asio::io_strand_t( ServiceRef() ),
+            boost::bind( & LoadGenerator::OpenLoop, this, _1 ) );
+    else
+      for( int slot( 0 ); slot < m_Connections; ++slot )
+      { // начальные обмены соединений распределяются по интервалу
+        auto ex( MakeExchange( slot, m_Start + m_IntervalNs * std::uint64_t( slot ) / std::uint64_t( m_Connections ) ) );
+        Schedule( ex );
+      }
+
+    SleepUntil( m_MeasureTo );
+    m_Running = false;
+
+    // ожидание завершения начатых обменов
+    auto drain_to( spo::bench::NowNs() + static_cast< std::uint64_t >( m_Settings.m_TimeoutMs + 1000 ) * 1000000 );
+    while( ( m_InFlight > 0 ) and ( spo::bench::NowNs() < drain_to ) )
+      std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    spo::asio::AsioService::Instance().Stop();
+
+    return Report();
+  }
+
+private:
+  Settings                        m_Settings;
+  SizeDistribution                m_Sizes;
+  client_t                        m_Client;
+  std::mt19937_64                 m_Random;
+  std::mutex                      m_RandomMutex;
+  const std::string               m_Payload;
+  int                             m_Connections     { 1 };
+  std::uint64_t                   m_IntervalNs      { 0 };
+  bool                            m_EndsWithSend    { false };
+
+  std::atomic_bool                m_Running         { false };
+  std::uint64_t                   m_Start           { 0 };
+  std::uint64_t                   m_MeasureFrom     { 0 };
+  std::uint64_t                   m_MeasureTo       { 0 };
+  std::atomic_int                 m_InFlight        { 0 };
+
+  std::atomic< std::uint64_t >    m_Issued          { 0 };
+  std::atomic< std::uint64_t >    m_Completed       { 0 };
+  std::atomic< std::uint64_t >    m_ConnectErrors   { 0 };
+  std::atomic< std::uint64_t >    m_Failed          { 0 };
+  std::atomic< std::uint64_t >    m_Dropped         { 0 };
+  std::atomic< std::uint64_t >    m_BytesSent       { 0 };
+  std::atomic< std::uint64_t >    m_BytesReceived   { 0 };
+  std::mutex                      m_Mutex;
+  spo::bench::LatencyHistogram    m_Service;
+  spo::bench::LatencyHistogram    m_Latency;
+
+  static spo::asio::io_service_t & ServiceRef ()
+  {
+    return spo::asio::AsioService::Instance().ServiceRef();
+  }
+
+  static std::chrono::steady_clock::time_point TimePoint ( std::uint64_t ns )
+  {
+    return std::chrono::steady_clock::time_point( std::chrono::nanoseconds( ns ) );
+  }
+
+  static void SleepUntil ( std::uint64_t ns )
+  {
+    std::this_thread::sleep_until( TimePoint( ns ) );
+  }
+
+  bool IsMeasured ( std::uint64_t intended ) const
+  {
+    return ( intended >= m_MeasureFrom ) and ( intended < m_MeasureTo );
+  }
+
+  exchange_shr_t MakeExchange ( int slot, std::uint64_t intended )
+  {
+    auto retval( std::make_shared< Exchange >() );
+    retval->m_Slot      = slot;
+    retval->m_Intended  = intended;
+    std::lock_guard< std::mutex > l( m_RandomMutex );
+    retval->m_Size      = m_Sizes.Next( m_Random );
+    return retval;
+  }
+
+  /**
+   * @brief Метод OpenLoop запускает обмены в расчетные моменты времени
+   *        (сопрограмма сервиса). Опоздавшие моменты времени обрабатываются
+   *        сразу, без сдвига расписания.
+   */
+  void OpenLoop ( boost::asio::yield_context yield )
+  {
+    std::exponential_distribution< double > poisson( 1.0 );
+    spo::asio::asio_steady_timer_t timer( ServiceRef() );
+    auto next( m_Start );
+
+    while( m_Running )
+    {
+      spo::asio::error_t ec;
+      timer.expires_at( TimePoint( next ) );
+      timer.async_wait( yield[ ec ] );
+
+      auto now( spo::bench::NowNs() );
+      while( m_Running and ( next <= now ) and ( next < m_MeasureTo ) )
+      {
+        if( m_InFlight >= m_Connections )
+        {
+          if( IsMeasured( next ) )
+            ++ m_Dropped;
+        }
+        else
+          Issue( MakeExchange( -1, next ) );
+
+        if( m_Settings.m_Arrival == "poisson" )
+        {
+          std::lock_guard< std::mutex > l( m_RandomMutex );
+          next += static_cast< std::uint64_t >( double( m_IntervalNs ) * poisson( m_Random ) ) + 1;
+        }
+        else
+          next += m_IntervalNs;
+      }
+    }
+  }
+
+  /**
+   * @brief Метод Schedule запускает обмен замкнутого цикла в расчетный момент
+   *        времени (не ранее текущего).
+   */
+  void Schedule ( exchange_shr_t ex )
+  {
+    auto now( spo::bench::NowNs() );
+    if( ex->m_Intended <= now )
+    {
+      ex->m_Intended = now;
+      Issue( ex );
+      return;
+    }
+
+    auto timer( std::make_shared< spo::asio::asio_steady_timer_t >( ServiceRef() ) );
+    timer->expires_at( TimePoint( ex->m_Intended ) );
+    timer->async_wait( [ this, ex, timer ]( const spo::asio::error_t & )
+                       {
+                         if( m_Running )
+                           Issue( ex );
+                       } );
+  }
+
+  void Issue ( exchange_shr_t ex )
+  {
+    ++ m_InFlight;
+    if( IsMeasured( ex->m_Intended ) )
+      ++ m_Issued;
+    ex->m_Started = spo::bench::NowNs();
+
+    if( not m_Client.TryConnect(
+          [ this, ex ]( session_shr_t session, const spo::asio::error_t & )
+          {
+            OnConnect( ex, session );
+          } ) )
+      Finish( ex );
+  }
+
+  /**
+   * @brief Метод OnConnect назначает сессии обмена обработчики каналов.
+   */
+  void OnConnect ( exchange_shr_t ex, session_shr_t session )
+  {
+    if( not session )
+    {
+      if( IsMeasured( ex->m_Intended ) )
+        ++ m_ConnectErrors;
+      Finish( ex );
+      return;
+    }
+
+    session->SetBufferSize( std::max( ex->m_Size, m_Settings.m_ResponseBuffer ) );
+    session->SetAction( 1,
+                        [ this, ex ]( document_t & data )
+                        {
+                          data.Add( m_Payload.data(), ex->m_Size );
+                          ex->m_Sent = true;
+                          return not data.IsEmpty();
+                        } );
+    session->SetAction( 0,
+                        [ this, ex ]( document_t & data )
+                        {
+                          ex->m_Received += data.Size();
+                          if( not m_EndsWithSend )
+                            Complete( ex );
+                          return true;
+                        } );
+    session->SetAfterStop(
+          [ this, ex ]( void * )
+          {
+            m_Client.DecSocketsCount();
+            Finish( ex );
+          } );
+  }
+
+  /**
+   * @brief Метод Complete регистрирует успешно завершенный обмен.
+   */
+  void Complete ( exchange_shr_t ex )
+  {
+    if( ex->m_Done.exchange( true ) )
+      return;
+
+    auto end( spo::bench::NowNs() );
+    if( not IsMeasured( ex->m_Intended ) )
+      return;
+
+    ++ m_Completed;
+    m_BytesSent     += ex->m_Sent ? ex->m_Size : 0;
+    m_BytesReceived += ex->m_Received;
+
+    auto service( end - ex->m_Started );
+    std::lock_guard< std::mutex > l( m_Mutex );
+    m_Service.Record( service );
+    if( m_Settings.IsOpenLoop() )
+      m_Latency.Record( end - ex->m_Intended );
+    else
+      m_Latency.RecordCorrected( service, m_IntervalNs );
+  }
+
+  /**
+   * @brief Метод Finish завершает обмен (сессия остановлена или подключение
+   *        не выполнено) и в замкнутом цикле запускает следующий обмен.
+   */
+  void Finish ( exchange_shr_t ex )
+  {
+    if( m_EndsWithSend and ex->m_Sent )
+      Complete( ex );
+    if( ( not ex->m_Done ) and IsMeasured( ex->m_Intended ) )
+      ++ m_Failed;
+
+    if( ( ex->m_Slot >= 0 ) and m_Running )
+    { // следующий обмен соединения: не ранее интервала от начала предыдущего
+      auto next( MakeExchange( ex->m_Slot, ex->m_Started + m_IntervalNs ) );
+      Schedule( next );
+    }
+    -- m_InFlight;
+  }
+
+  std::string Report ()
+  {
+    auto elapsed_s( double( m_MeasureTo - m_MeasureFrom ) / 1e9 );
+    const char * correction(
+          m_Settings.IsOpenLoop() ? "intended_start"
+                                  : ( m_IntervalNs > 0 ? "expected_interval" : "none" ) );
+
+    std::ostringstream os;
+    std::lock_guard< std::mutex > l( m_Mutex );
+    os << "{\"benchmark\":\"load_gen\",\"version\":\"" << SPO_BENCH_VERSION << "\""
+       << ",\"backend\":"           << spo::bench::JsonString( spo::asio::AsioService::BackendName() )
+       << ",\"proto\":"             << spo::bench::JsonString( m_Settings.m_Proto )
+       << ",\"host\":"              << spo::bench::JsonString( m_Settings.m_Host )
+       << ",\"port\":"              << spo::bench::JsonString( m_Settings.m_Port )
+       << ",\"mode\":"              << spo::bench::JsonString( m_Settings.m_Mode )
+       << ",\"loop\":"              << spo::bench::JsonString( m_Settings.m_Loop )
+       << ",\"arrival\":"           << spo::bench::JsonString( m_Settings.m_Arrival )
+       << ",\"rate\":"              << m_Settings.m_Rate
+       << ",\"connections\":"       << m_Connections
+       << ",\"size_dist\":"         << spo::bench::JsonString( m_Sizes.Spec() )
+       << ",\"duration_s\":"        << elapsed_s
+       << ",\"issued\":"            << m_Issued
+       << ",\"completed\":"         << m_Completed
+       << ",\"connect_errors\":"    << m_ConnectErrors
+       << ",\"failed\":"            << m_Failed
+       << ",\"dropped\":"           << m_Dropped
+       << ",\"bytes_sent\":"        << m_BytesSent
+       << ",\"bytes_received\":"    << m_BytesReceived
+       << ",\"exchanges_per_sec\":" << double( m_Completed ) / elapsed_s
+       << ",\"mb_per_sec\":"        << double( m_BytesSent + m_BytesReceived ) / elapsed_s / 1e6
+       << ",\"co_correction\":\""   << correction << "\""
+       << ",\"service_ns\":"        << spo::bench::HistogramJson( m_Service )
+       << ",\"latency_ns\":"        << spo::bench::HistogramJson( m_Latency )
+       << "}";
+    return os.str();
+  }
+};
+
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Метод RaiseFileLimit увеличивает ограничение количества открытых
+ *        файлов процесса до максимально допустимого.
+ */
+void RaiseFileLimit ()
+{
+  rlimit rl;
+  if( ( ::getrlimit( RLIMIT_NOFILE, & rl ) == 0 ) and ( rl.rlim_cur < rl.rlim_max ) )
+  {
+    rl.rlim_cur = rl.rlim_max;
+    UNUSED( ::setrlimit( RLIMIT_NOFILE, & rl ) );
+  }
+}
+
+template< typename                ProtocolT_ >
+std::string Generate ( const Settings & settings, const SizeDistribution & sizes )
+{
+  LoadGenerator< ProtocolT_ > generator( settings, sizes );
+  return generator.Run();
+}
+
+void Usage ()
+{
+  std::cerr <<
+    "usage: load_gen [options]\n"
+    "  --proto        tcp | udp                    (default: tcp)\n"
+    "  --host         server host                  (default: 127.0.0.1)\n"
+    "  --port         server port or service       (default: 24000)\n"
+    "  --mode         client mode: SimplexOut, HalfDuplexOut, SimplexIn,\n"
+    "                 HalfDuplexIn                 (default: HalfDuplexOut)\n"
+    "  --loop         closed | open                (default: closed)\n"
+    "  --connections  closed: concurrent exchanges, open: in-flight limit\n"
+    "                                              (default: 64)\n"
+    "  --rate         exchanges/s, required for open loop\n"
+    "                 (closed loop: 0 = unthrottled, default: 0)\n"
+    "  --arrival      fixed | poisson (open loop)  (default: fixed)\n"
+    "  --size-dist    fixed:N | uniform:MIN:MAX | exp:MEAN |\n"
+    "                 lognormal:MEDIAN:SIGMA | choice:S1/S2/...\n"
+    "                 K/M suffixes allowed         (default: fixed:64)\n"
+    "  --max-size     message size limit           (default: 16M, udp: 65507)\n"
+    "  --response-buffer  receive buffer size      (default: 64K)\n"
+    "  --duration-ms  measurement time             (default: 10000)\n"
+    "  --warmup-ms    warm-up time                 (default: 1000)\n"
+    "  --timeout-ms   exchange timeout             (default: 5000)\n"
+    "  --seed         random seed                  (default: 1)\n";
+}
+
+}
+
+int main( int argc, char * argv[] )
+{
+  spo::bench::Arguments args( argc, argv );
+  if( args.Has( "--help" ) or args.Has( "-h" ) )
+  {
+    Usage();
+    return 0;
+  }
+
+  Settings settings;
+  settings.m_Proto          = args.Value( "--proto", settings.m_Proto );
+  settings.m_Host           = args.Value( "--host", settings.m_Host );
+  settings.m_Port           = args.Value( "--port", settings.m_Port );
+  settings.m_Mode           = args.Value( "--mode", settings.m_Mode );
+  settings.m_Loop           = args.Value( "--loop", settings.m_Loop );
+  settings.m_Arrival        = args.Value( "--arrival", settings.m_Arrival );
+  settings.m_SizeDist       = args.Value( "--size-dist", settings.m_SizeDist );
+  settings.m_Connections    = static_cast< int >( args.Int( "--connections", settings.m_Connections ) );
+  settings.m_Rate           = std::strtod( args.Value( "--rate", "0" ).c_str(), nullptr );
+  settings.m_DurationMs     = args.Int( "--duration-ms", settings.m_DurationMs );
+  settings.m_WarmupMs       = args.Int( "--warmup-ms", settings.m_WarmupMs );
+  settings.m_TimeoutMs      = args.Int( "--timeout-ms", settings.m_TimeoutMs );
+  settings.m_ResponseBuffer = spo::bench::Arguments::ParseSize( args.Value( "--response-buffer", "64K" ) );
+  settings.m_Seed           = static_cast< std::uint64_t >( args.Int( "--seed", 1 ) );
+
+  auto max_size( spo::bench::Arguments::ParseSize(
+                   args.Value( "--max-size", settings.IsTcp() ? "16M" : "65507" ) ) );
+  if( not settings.IsTcp() )
+    max_size = std::min( max_size, UDP_PAYLOAD_MAX );
+
+  std::string error;
+  SizeDistribution sizes;
+  if( ( settings.m_Proto != "tcp" ) and ( settings.m_Proto != "udp" ) )
+    error = "unknown protocol";
+  else if( not sizes.Parse( settings.m_SizeDist, max_size ) )
+    error = "invalid size distribution";
+  else if( settings.IsOpenLoop() and ( settings.m_Rate <= 0 ) )
+    error = "open loop requires --rate";
+  else if( ( not settings.IsTcp() )
+           and ( ( settings.m_Mode == "SimplexIn" ) or ( settings.m_Mode == "HalfDuplexIn" ) ) )
+    error = "udp server cannot send first";
+
+  if( not error.empty() )
+  {
+    std::cerr << "load_gen: " << error << "\n";
+    Usage();
+    return 1;
+  }
+
+  RaiseFileLimit();
+
+  // библиотека выводит диагностику в stdout: отчет выводится в исходный поток
+  std::fflush( stdout );
+  int report_fd( ::dup( STDOUT_FILENO ) );
+  int null_fd  ( ::open( "/dev/null", O_WRONLY ) );
+  if( null_fd >= 0 )
+    ::dup2( null_fd, STDOUT_FILENO );
+
+  auto report( settings.IsTcp()
+               ? Generate< boost::asio::ip::tcp >( settings, sizes )
+               : Generate< boost::asio::ip::udp >( settings, sizes ) );
+  report += "\n";
+
+  std::flush( std::cout );
+  UNUSED( ::write( report_fd >= 0 ? report_fd : STDERR_FILENO, report.data(), report.size() ) );
+
+  // завершение без разрушения статического сервиса: поток сервиса отсоединен
+  ::_exit( 0 );
+}
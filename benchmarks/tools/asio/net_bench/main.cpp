@@ -0,0 +1,765 @@
+/**
+  * @file main.cpp
+  * @brief Программа net_bench измеряет пропускную способность (сообщений/с,
+  *        МБ/с) и процентили задержек серверов Boost.Asio через петлевой
+  *        интерфейс для протоколов TCP и UDP во всех режимах
+  *        @a spo::asio::TransferType и для дуплексного сервера
+  *        @a spo::asio::AsioServerDuplex.
+  *
+  * Каждый сценарий (протокол, режим, размер сообщения, число соединений)
+  * выполняется в отдельном дочернем процессе: сервис @a spo::asio::AsioService
+  * является единственным на процесс и не предназначен для повторного запуска.
+  * Результат сценария передается родительскому процессу через канал (pipe),
+  * итоговый отчет выводится в стандартный поток вывода в формате JSON.
+  *
+  * Клиентская нагрузка формируется блокирующими сокетами POSIX в отдельных
+  * потоках. Каждое сообщение начинается с 16 шестнадцатеричных цифр отметки
+  * времени (нс, steady_clock), поэтому задержка вычисляется стороной,
+  * завершающей обмен:
+  * @value one_way задержка доставки сообщения (SimplexIn, SimplexOut, Duplex);
+  * @value rtt     время полного обмена запрос-ответ (HalfDuplexIn, HalfDuplexOut).
+  *
+  * Сессии библиотеки однократны: одно соединение (TCP) или одна датаграмма
+  * (UDP) обслуживается одним обменом, поэтому сообщений/с для TCP включает
+  * установление и закрытие соединения.
+  *
+  * Протокол unix (потоковые локальные сокеты, @a spo::asio::AsioLocalServer )
+  * измеряется в режимах Simplex и HalfDuplex для сравнения с TCP через
+  * петлевой интерфейс.
+  *
+  * Во всех режимах выводится прирост резидентной памяти процесса за время
+  * сценария на соединение (rss_bytes_per_connection): значение включает
+  * потоки соединений и сравнимо только между сценариями с одинаковым числом
+  * соединений (например, --coroutines stackful,stackless).
+  *
+  * Режим Idle (только TCP) измеряет память сессий: открывается заданное число
+  * соединений без передачи данных, и после создания всех сессий сервера
+  * вычисляется прирост резидентной памяти процесса на соединение. Измерения
+  * выполняются для сопрограмм сессий обоих видов (--coroutines), сопрограммы
+  * C++20 доступны в сборке с CONFIG+=asio_stackless.
+  *
+  * @par Пример запуска:
+  * @code
+  *  net_bench --proto tcp --mode SimplexIn,HalfDuplexIn --payloads 64,4K \
+  *            --connections 1,16 --duration-ms 2000 > net_bench.json
+  * @endcode
+  */
+
+#include "BenchCommon.h"
+#include "asio/AsioServerDuplex.h"
+#include "asio/AsioLocalServer.h"
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+namespace {
+
+using byte_t                    = char;
+using document_t                = spo::core::docs::BytesDocument< byte_t >;
+
+const std::size_t                 STAMP_SIZE        = 16;
+const std::size_t                 UDP_PAYLOAD_MAX   = 65507;
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Структура Scenario определяет параметры одного измерения.
+ */
+struct                            Scenario
+{
+  std::string                     m_Proto;
+  std::string                     m_Mode;
+  std::size_t                     m_Payload         { 64 };
+  int                             m_Connections     { 1 };
+  std::int64_t                    m_DurationMs      { 2000 };
+  std::int64_t                    m_WarmupMs        { 200 };
+  std::int64_t                    m_UdpIntervalUs   { 100 };
+  spo::asio::port_t               m_Port            { 24000 };
+  spo::asio::cpu_list_t           m_IoCpus;
+  std::string                     m_Coroutines      { "stackful" };
+  std::size_t                     m_StackSize       { 0 };
+
+  bool IsTcp    () const { return m_Proto == "tcp"; }
+  bool IsLocal  () const { return m_Proto == "unix"; }
+  bool IsStream () const { return IsTcp() or IsLocal(); }
+  std::string LocalPath () const { return "/tmp/net_bench." + std::to_string( m_Port ) + ".sock"; }
+  bool IsDuplex () const { return m_Mode == "Duplex"; }
+  bool IsIdle   () const { return m_Mode == "Idle"; }
+  bool IsStackless () const { return m_Coroutines == "stackless"; }
+};
+
+/**
+ * @brief Структура BenchState содержит счетчики и гистограмму сценария,
+ *        выполняемого в текущем процессе.
+ */
+struct                            BenchState
+{
+  std::atomic_bool                m_Measuring       { false };
+  std::atomic_bool                m_Stopped         { false };
+  std::atomic< std::uint64_t >    m_Messages        { 0 };
+  std::atomic< std::uint64_t >    m_Bytes           { 0 };
+  std::atomic< std::uint64_t >    m_Sent            { 0 };
+  std::atomic< std::uint64_t >    m_Errors          { 0 };
+  std::size_t                     m_Payload         { 64 };
+  std::mutex                      m_Mutex;
+  spo::bench::LatencyHistogram    m_Latency;
+
+  /**
+   * @brief Метод Deliver регистрирует завершенный обмен сообщением.
+   * @param bytes     количество доставленных байт;
+   * @param latencyNs задержка обмена, нс.
+   */
+  void Deliver ( std::uint64_t bytes, std::uint64_t latencyNs )
+  {
+    if( not m_Measuring )
+      return;
+
+    ++ m_Messages;
+    m_Bytes += bytes;
+    std::lock_guard< std::mutex > l( m_Mutex );
+    m_Latency.Record( latencyNs );
+  }
+
+  void Error ()
+  {
+    if( m_Measuring )
+      ++ m_Errors;
+  }
+
+  void Sent ()
+  {
+    if( m_Measuring )
+      ++ m_Sent;
+  }
+};
+
+BenchState                        g_State;
+
+//------------------------------------------------------------------------------
+
+std::string MakePayload ( std::size_t size )
+{
+  char stamp[ STAMP_SIZE + 1 ];
+  std::snprintf( stamp, sizeof( stamp ), "%016llx",
+                 static_cast< unsigned long long >( spo::bench::NowNs() ) );
+  std::string retval( stamp, STAMP_SIZE );
+  retval.resize( std::max( size, STAMP_SIZE ), 'x' );
+  return retval;
+}
+
+bool ParseStamp ( const byte_t * data, std::size_t size, std::uint64_t & stamp )
+{
+  if( size < STAMP_SIZE )
+    return false;
+
+  char str[ STAMP_SIZE + 1 ];
+  std::memcpy( str, data, STAMP_SIZE );
+  str[ STAMP_SIZE ] = '\0';
+  char * end( nullptr );
+  stamp = std::strtoull( str, & end, 16 );
+  return end == str + STAMP_SIZE;
+}
+
+std::uint64_t Elapsed ( std::uint64_t stamp )
+{
+  auto now( spo::bench::NowNs() );
+  return now > stamp ? now - stamp : 0;
+}
+
+//------------------------------------------------------------------------------
+// обработчики каналов сервера
+
+/**
+ * @brief Метод ReceiveStamped завершает обмен на стороне сервера: задержка
+ *        вычисляется по отметке времени в начале сообщения (отметка клиента
+ *        для SimplexIn или собственная отметка сервера, возвращенная клиентом,
+ *        для HalfDuplexOut).
+ */
+bool ReceiveStamped ( document_t & data )
+{
+  std::uint64_t stamp( 0 );
+  if( ParseStamp( data.ContentRef().data(), data.Size(), stamp ) )
+    g_State.Deliver( data.Size(), Elapsed( stamp ) );
+  else
+    g_State.Error();
+  return true;
+}
+
+bool ReceiveRequest ( document_t & data )
+{
+  return not data.IsEmpty();
+}
+
+bool SendStamped ( document_t & data )
+{
+  return data.FromByteArray( MakePayload( g_State.m_Payload ) );
+}
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс PeerSocket реализует блокирующий клиентский сокет нагрузки с
+ *        ограничением времени ожидания приема и передачи.
+ */
+class                             PeerSocket
+{
+public:
+  /**/                            PeerSocket          ( int type, spo::asio::port_t port, int timeoutMs )
+    : m_Fd                        ( ::socket( AF_INET, type, 0 ) )
+  {
+    if( m_Fd < 0 )
+      return;
+
+    SetTimeouts( timeoutMs );
+    sockaddr_in addr;
+    std::memset( & addr, 0, sizeof( addr ) );
+    addr.sin_family       = AF_INET;
+    addr.sin_port         = htons( port );
+    addr.sin_addr.s_addr  = htonl( INADDR_LOOPBACK );
+    m_Connected = ::connect( m_Fd, reinterpret_cast< sockaddr * >( & addr ), sizeof( addr ) ) == 0;
+  }
+  /**/                            PeerSocket          ( const std::string & path, int timeoutMs )
+    : m_Fd                        ( ::socket( AF_UNIX, SOCK_STREAM, 0 ) )
+  {
+    if( m_Fd < 0 )
+      return;
+
+    SetTimeouts( timeoutMs );
+    sockaddr_un addr;
+    std::memset( & addr, 0, sizeof( addr ) );
+    addr.sun_family = AF_UNIX;
+    std::strncpy( addr.sun_path, path.c_str(), sizeof( addr.sun_path ) - 1 );
+    m_Connected = ::connect( m_Fd, reinterpret_cast< sockaddr * >( & addr ), sizeof( addr ) ) == 0;
+  }
+  /**/                          ~ PeerSocket          ()
+  {
+    if( m_Fd >= 0 )
+      ::close( m_Fd );
+  }
+
+  bool IsConnected () const { return m_Connected; }
+
+  bool SendAll ( const std::string & data )
+  {
+    std::size_t sent( 0 );
+    while( sent < data.size() )
+    {
+      auto n( ::send( m_Fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL ) );
+      if( n <= 0 )
+        return false;
+      sent += static_cast< std::size_t >( n );
+    }
+    return true;
+  }
+
+  /**
+   * @brief Метод Receive принимает данные до достижения размера @a limit,
+   *        закрытия соединения сервером или истечения времени ожидания.
+   *        Для датаграммного сокета принимается одна датаграмма.
+   */
+  std::size_t Receive ( std::string & into, std::size_t limit, bool datagram = false )
+  {
+    into.clear();
+    std::vector< char > buf( std::max< std::size_t >( limit, 1 ) );
+    while( into.size() < limit )
+    {
+      auto n( ::recv( m_Fd, buf.data(), buf.size(), 0 ) );
+      if( n <= 0 )
+        break;
+      into.append( buf.data(), static_cast< std::size_t >( n ) );
+      if( datagram )
+        break;
+    }
+    return into.size();
+  }
+
+  void ShutdownSend ()
+  {
+    ::shutdown( m_Fd, SHUT_WR );
+  }
+
+private:
+  int                             m_Fd              { -1 };
+  bool                            m_Connected       { false };
+
+  void SetTimeouts ( int timeoutMs )
+  {
+    timeval tv;
+    tv.tv_sec   = timeoutMs / 1000;
+    tv.tv_usec  = ( timeoutMs % 1000 ) * 1000;
+    ::setsockopt( m_Fd, SOL_SOCKET, SO_RCVTIMEO, & tv, sizeof( tv ) );
+    ::setsockopt( m_Fd, SOL_SOCKET, SO_SNDTIMEO, & tv, sizeof( tv ) );
+  }
+};
+
+//------------------------------------------------------------------------------
+// клиентская нагрузка
+
+const int                         PEER_TIMEOUT_MS   = 1000;
+
+void TcpPeer ( const Scenario & sc, int idx )
+{
+  std::string payload, reply;
+  auto mode( sc.m_Mode );
+  auto port( sc.m_Port );
+  if( sc.IsDuplex() )
+  { // половина соединений передает на порт приема сервера, половина
+    // принимает с порта передачи
+    mode = ( idx % 2 == 0 ) ? "SimplexIn" : "SimplexOut";
+    port = static_cast< spo::asio::port_t >( sc.m_Port + ( idx % 2 ) );
+  }
+
+  while( not g_State.m_Stopped )
+  {
+    std::unique_ptr< PeerSocket > s_ptr(
+          sc.IsLocal()
+          ? new PeerSocket( sc.LocalPath(), PEER_TIMEOUT_MS )
+          : new PeerSocket( SOCK_STREAM, port, PEER_TIMEOUT_MS ) );
+    auto & s( * s_ptr );
+    if( not s.IsConnected() )
+    {
+      g_State.Error();
+      std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+      continue;
+    }
+
+    if( mode == "SimplexIn" )
+    {
+      if( s.SendAll( MakePayload( sc.m_Payload ) ) )
+        g_State.Sent();
+      else
+        g_State.Error();
+      s.ShutdownSend();
+      s.Receive( reply, 1 ); // ожидание закрытия соединения сервером
+    }
+    else if( mode == "SimplexOut" )
+    {
+      std::uint64_t stamp( 0 );
+      if( s.Receive( reply, sc.m_Payload ) > 0 and ParseStamp( reply.data(), reply.size(), stamp ) )
+        g_State.Deliver( reply.size(), Elapsed( stamp ) );
+      else
+        g_State.Error();
+    }
+    else if( mode == "HalfDuplexIn" )
+    {
+      auto t0( spo::bench::NowNs() );
+      if( s.SendAll( MakePayload( sc.m_Payload ) ) and ( s.Receive( reply, sc.m_Payload ) > 0 ) )
+        g_State.Deliver( reply.size(), Elapsed( t0 ) );
+      else
+        g_State.Error();
+    }
+    else if( mode == "HalfDuplexOut" )
+    { // возврат серверу его же сообщения с отметкой времени
+      if( ( s.Receive( reply, sc.m_Payload ) > 0 ) and s.SendAll( reply ) )
+      {
+        g_State.Sent();
+        s.ShutdownSend();
+        s.Receive( reply, 1 );
+      }
+      else
+        g_State.Error();
+    }
+  }
+}
+
+/**
+ * @brief Метод UdpPeer формирует датаграммную нагрузку. Сервер UDP принимает
+ *        следующую датаграмму только после завершения сессии и повторной
+ *        привязки порта, поэтому отправка выполняется с интервалом
+ *        @a Scenario::m_UdpIntervalUs, а потери учитываются как ошибки.
+ */
+void UdpPeer ( const Scenario & sc )
+{
+  PeerSocket s( SOCK_DGRAM, sc.m_Port, 50 );
+  std::string reply;
+  while( not g_State.m_Stopped )
+  {
+    auto t0( spo::bench::NowNs() );
+    if( not s.SendAll( MakePayload( sc.m_Payload ) ) )
+      g_State.Error();
+    else
+    {
+      g_State.Sent();
+      if( sc.m_Mode == "HalfDuplexIn" )
+      {
+        if( s.Receive( reply, sc.m_Payload, true ) > 0 )
+          g_State.Deliver( reply.size(), Elapsed( t0 ) );
+        else
+          g_State.Error();
+      }
+    }
+    std::this_thread::sleep_for( std::chrono::microseconds( sc.m_UdpIntervalUs ) );
+  }
+}
+
+//------------------------------------------------------------------------------
+// сценарии
+
+spo::asio::TransferType ModeType ( const std::string & mode )
+{
+  if( mode == "SimplexOut"    ) return spo::asio::TransferType::SimplexOut;
+  if( mode == "HalfDuplexIn"  ) return spo::asio::TransferType::HalfDuplexIn;
+  if( mode == "HalfDuplexOut" ) return spo::asio::TransferType::HalfDuplexOut;
+  return spo::asio::TransferType::SimplexIn;
+}
+
+const char * LatencyKind ( const std::string & mode )
+{
+  return mode.compare( 0, 10, "HalfDuplex" ) == 0 ? "rtt" : "one_way";
+}
+
+/**
+ * @brief Метод SkipReason возвращает причину, по которой сценарий не может
+ *        быть выполнен, или пустую строку.
+ */
+std::string SkipReason ( const Scenario & sc )
+{
+  if( sc.IsStackless() and ( not spo::asio::AsioService::IsStacklessAvailable() ) )
+    return "built without stackless coroutines (CONFIG+=asio_stackless)";
+  if( sc.IsIdle() and ( not sc.IsTcp() ) )
+    return "idle connections are measured for tcp only";
+  if( sc.IsDuplex() and sc.IsLocal() )
+    return "duplex server is measured for tcp only";
+  if( not sc.IsStream() )
+  {
+    if( ( sc.m_Mode != "SimplexIn" ) and ( sc.m_Mode != "HalfDuplexIn" ) )
+      return "udp server has no peer address before the first datagram";
+    if( sc.m_Payload > UDP_PAYLOAD_MAX )
+      return "payload exceeds udp datagram size";
+  }
+  return std::string();
+}
+
+template< typename                ServerT_ >
+void SetupServer ( ServerT_ & server, const Scenario & sc )
+{
+  server.SetBufferSize( std::max( sc.m_Payload, STAMP_SIZE ) );
+  server.SetSocketDeadline( PEER_TIMEOUT_MS );
+  server.SetBufferAction( spo::asio::DataType::Input,
+                          sc.m_Mode == "HalfDuplexIn" ? ReceiveRequest : ReceiveStamped );
+  server.SetBufferAction( spo::asio::DataType::Output, SendStamped );
+}
+
+/**
+ * @brief Метод ResidentBytes возвращает объем резидентной памяти процесса.
+ */
+std::int64_t ResidentBytes ()
+{
+  std::ifstream is( "/proc/self/statm" );
+  std::int64_t size( 0 ), resident( 0 );
+  is >> size >> resident;
+  return resident * ::sysconf( _SC_PAGESIZE );
+}
+
+/**
+ * @brief Метод Measure запускает клиентскую нагрузку на запущенный сервер и
+ *        формирует JSON-объект результата.
+ */
+std::string Measure ( const Scenario & sc )
+{
+  // ожидание готовности сервиса к приему подключений
+  std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+
+  // прирост резидентной памяти включает потоки соединений (одинаковые для
+  // обоих видов сопрограмм) и сессии сервера
+  auto rss0( ResidentBytes() );
+  std::vector< std::thread > peers;
+  for( int idx( 0 ); idx < sc.m_Connections; ++idx )
+  {
+    peers.emplace_back( [ &sc, idx ]()
+    {
+      if( sc.IsStream() )
+        TcpPeer( sc, idx );
+      else
+        UdpPeer( sc );
+    } );
+  }
+
+  std::this_thread::sleep_for( std::chrono::milliseconds( sc.m_WarmupMs ) );
+  auto t0( spo::bench::NowNs() );
+  g_State.m_Measuring = true;
+  std::this_thread::sleep_for( std::chrono::milliseconds( sc.m_DurationMs ) );
+  g_State.m_Measuring = false;
+  auto elapsed_s( double( spo::bench::NowNs() - t0 ) / 1e9 );
+  auto rss_delta( ResidentBytes() - rss0 );
+
+  g_State.m_Stopped = true;
+  for( auto & peer : peers )
+    peer.join();
+
+  std::ostringstream os;
+  std::lock_guard< std::mutex > l( g_State.m_Mutex );
+  os << "{\"proto\":"         << spo::bench::JsonString( sc.m_Proto )
+     << ",\"mode\":"          << spo::bench::JsonString( sc.m_Mode )
+     << ",\"payload\":"       << sc.m_Payload
+     << ",\"connections\":"   << sc.m_Connections
+     << ",\"coroutines\":"    << spo::bench::JsonString( sc.m_Coroutines )
+     << ",\"duration_s\":"    << elapsed_s
+     << ",\"messages\":"      << g_State.m_Messages
+     << ",\"bytes\":"         << g_State.m_Bytes
+     << ",\"sent\":"          << g_State.m_Sent
+     << ",\"errors\":"        << g_State.m_Errors
+     << ",\"msgs_per_sec\":"  << double( g_State.m_Messages ) / elapsed_s
+     << ",\"mb_per_sec\":"    << double( g_State.m_Bytes ) / elapsed_s / 1e6
+     << ",\"latency_kind\":\"" << LatencyKind( sc.m_Mode ) << "\""
+     << ",\"latency_ns\":"    << spo::bench::HistogramJson( g_State.m_Latency )
+     << ",\"rss_delta_bytes\":" << rss_delta
+     << ",\"rss_bytes_per_connection\":" << double( rss_delta ) / double( sc.m_Connections )
+     << "}";
+  return os.str();
+}
+
+/**
+ * @brief Метод MeasureIdle открывает @a Scenario::m_Connections соединений
+ *        без передачи данных и возвращает прирост резидентной памяти процесса
+ *        на ожидающую сессию сервера.
+ */
+std::string MeasureIdle ( const Scenario & sc )
+{
+  std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+
+  auto rss0( ResidentBytes() );
+  std::vector< std::unique_ptr< PeerSocket > > peers;
+  for( int idx( 0 ); idx < sc.m_Connections; ++idx )
+  {
+    std::unique_ptr< PeerSocket > peer( new PeerSocket( SOCK_STREAM, sc.m_Port, PEER_TIMEOUT_MS ) );
+    if( not peer->IsConnected() )
+      ++ g_State.m_Errors;
+    peers.push_back( std::move( peer ) );
+  }
+
+  // ожидание создания сессий всех соединений
+  auto deadline( std::chrono::steady_clock::now() + std::chrono::milliseconds( sc.m_DurationMs ) );
+  while( ( spo::asio::AsioService::Instance().SessionsCount() < std::size_t( sc.m_Connections ) )
+         and ( std::chrono::steady_clock::now() < deadline ) )
+    std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+
+  auto sessions( spo::asio::AsioService::Instance().SessionsCount() );
+  auto delta( ResidentBytes() - rss0 );
+
+  std::ostringstream os;
+  os << "{\"proto\":"         << spo::bench::JsonString( sc.m_Proto )
+     << ",\"mode\":"          << spo::bench::JsonString( sc.m_Mode )
+     << ",\"connections\":"   << sc.m_Connections
+     << ",\"coroutines\":"    << spo::bench::JsonString( sc.m_Coroutines )
+     << ",\"stack_size\":"    << sc.m_StackSize
+     << ",\"sessions\":"      << sessions
+     << ",\"errors\":"        << g_State.m_Errors
+     << ",\"rss_delta_bytes\":" << delta
+     << ",\"rss_bytes_per_session\":" << ( sessions > 0 ? double( delta ) / double( sessions ) : 0.0 )
+     << "}";
+  return os.str();
+}
+
+/**
+ * @brief Метод RunScenario выполняет сценарий в текущем (дочернем) процессе.
+ */
+std::string RunScenario ( const Scenario & sc )
+{
+  g_State.m_Payload = sc.m_Payload;
+
+  // потоки ввода/вывода сессий на заданных процессорах
+  spo::asio::thread_placements_t placements;
+  for( auto cpu : sc.m_IoCpus )
+  {
+    spo::asio::ThreadPlacement placement;
+    placement.m_Cpu = cpu;
+    placements.push_back( placement );
+  }
+  UNUSED( spo::asio::AsioService::Instance().SetIoThreads( placements ) );
+  spo::asio::AsioService::Instance().SetIncomingCpuMatching( not placements.empty() );
+
+  UNUSED( spo::asio::AsioService::Instance().SetSessionCoroutines(
+            sc.IsStackless()
+            ? spo::asio::CoroutineKind::Stackless
+            : spo::asio::CoroutineKind::Stackful ) );
+  spo::asio::AsioService::Instance().SetCoroutineStackSize( sc.m_StackSize );
+
+  if( sc.IsIdle() )
+  { // сессии ожидают данные до окончания измерения
+    spo::asio::AsioTCPServer< byte_t > server( spo::asio::TransferType::SimplexIn, sc.m_Port );
+    SetupServer( server, sc );
+    server.SetSocketDeadline( sc.m_DurationMs + 10 * PEER_TIMEOUT_MS );
+    server.SetSocketsLimit( sc.m_Connections + 1 );
+    UNUSED( server.Start() );
+    return MeasureIdle( sc );
+  }
+
+  if( sc.IsDuplex() )
+  {
+    spo::asio::AsioServerDuplex< spo::asio::AsioTCPServer< byte_t >, byte_t >
+        server( sc.m_Port, static_cast< spo::asio::port_t >( sc.m_Port + 1 ) );
+    for( auto type : { spo::asio::DataType::Input, spo::asio::DataType::Output } )
+      server.SetSocketDeadline( type, PEER_TIMEOUT_MS );
+    server.SetBufferAction( spo::asio::DataType::Input, ReceiveStamped );
+    server.SetBufferAction( spo::asio::DataType::Output, SendStamped );
+    UNUSED( server.Start() );
+    return Measure( sc );
+  }
+
+  if( sc.IsLocal() )
+  {
+    spo::asio::AsioLocalServer< byte_t > server( ModeType( sc.m_Mode ), sc.LocalPath() );
+    SetupServer( server, sc );
+    UNUSED( server.Start() );
+    auto retval( Measure( sc ) );
+    ::unlink( sc.LocalPath().c_str() );
+    return retval;
+  }
+
+  if( sc.IsTcp() )
+  {
+    spo::asio::AsioTCPServer< byte_t > server( ModeType( sc.m_Mode ), sc.m_Port );
+    SetupServer( server, sc );
+    UNUSED( server.Start() );
+    return Measure( sc );
+  }
+
+  spo::asio::AsioUDPServer< byte_t > server( ModeType( sc.m_Mode ), sc.m_Port );
+  SetupServer( server, sc );
+  UNUSED( server.Start() );
+  return Measure( sc );
+}
+
+/**
+ * @brief Метод ForkScenario выполняет сценарий в дочернем процессе и
+ *        возвращает его JSON-результат.
+ */
+std::string ForkScenario ( const Scenario & sc )
+{
+  int fds[ 2 ];
+  if( ::pipe( fds ) != 0 )
+    return "{\"error\":\"pipe\"}";
+
+  auto pid( ::fork() );
+  if( pid == 0 )
+  { // библиотека выводит диагностику в stdout: вывод отчета не засоряется
+    ::close( fds[ 0 ] );
+    int null_fd( ::open( "/dev/null", O_WRONLY ) );
+    if( null_fd >= 0 )
+      ::dup2( null_fd, STDOUT_FILENO );
+
+    auto result( RunScenario( sc ) );
+    UNUSED( ::write( fds[ 1 ], result.data(), result.size() ) );
+    ::close( fds[ 1 ] );
+    ::_exit( 0 );
+  }
+
+  ::close( fds[ 1 ] );
+  std::string retval;
+  if( pid > 0 )
+  {
+    char buf[ 4096 ];
+    ssize_t n( 0 );
+    while( ( n = ::read( fds[ 0 ], buf, sizeof( buf ) ) ) > 0 )
+      retval.append( buf, static_cast< std::size_t >( n ) );
+    int status( 0 );
+    ::waitpid( pid, & status, 0 );
+  }
+  ::close( fds[ 0 ] );
+
+  if( retval.empty() )
+  {
+    retval = "{\"proto\":" + spo::bench::JsonString( sc.m_Proto )
+           + ",\"mode\":" + spo::bench::JsonString( sc.m_Mode )
+           + ",\"payload\":" + std::to_string( sc.m_Payload )
+           + ",\"connections\":" + std::to_string( sc.m_Connections )
+           + ",\"coroutines\":" + spo::bench::JsonString( sc.m_Coroutines )
+           + ",\"error\":\"scenario process failed\"}";
+  }
+  return retval;
+}
+
+void Usage ()
+{
+  std::cerr <<
+    "usage: net_bench [options]\n"
+    "  --proto        tcp,udp,unix                 (default: tcp,udp)\n"
+    "  --mode         SimplexIn,SimplexOut,HalfDuplexIn,HalfDuplexOut,Duplex,\n"
+    "                 Idle (tcp: session memory of idle connections)\n"
+    "  --payloads     sizes, K/M suffixes allowed  (default: 64,1K,16K)\n"
+    "  --connections  concurrent peers             (default: 1,16)\n"
+    "  --duration-ms  measurement per scenario     (default: 2000)\n"
+    "  --warmup-ms    warm-up per scenario         (default: 200)\n"
+    "  --udp-interval-us  udp send pacing          (default: 100)\n"
+    "  --port         first server port            (default: 24000)\n"
+    "  --io-cpus      CPUs of session I/O threads, sessions are matched by\n"
+    "                 SO_INCOMING_CPU             (default: service thread)\n"
+    "  --coroutines   stackful,stackless           (default: stackful)\n"
+    "  --stack-size   stackful coroutine stack, K/M suffixes allowed\n"
+    "                                              (default: boost default)\n";
+}
+
+}
+
+int main( int argc, char * argv[] )
+{
+  spo::bench::Arguments args( argc, argv );
+  if( args.Has( "--help" ) or args.Has( "-h" ) )
+  {
+    Usage();
+    return 0;
+  }
+
+  auto protos       ( args.List ( "--proto", "tcp,udp" ) );
+  auto modes        ( args.List ( "--mode", "SimplexIn,SimplexOut,HalfDuplexIn,HalfDuplexOut,Duplex" ) );
+  auto payloads     ( args.Sizes( "--payloads", "64,1K,16K" ) );
+  auto connections  ( args.List ( "--connections", "1,16" ) );
+  auto port         ( args.Int  ( "--port", 24000 ) );
+  auto io_cpus      ( spo::asio::AsioPlacement::ParseCpuList( args.Value( "--io-cpus", std::string() ) ) );
+  auto coroutines   ( args.List ( "--coroutines", "stackful" ) );
+  auto stack_sizes  ( args.Sizes( "--stack-size", "0" ) );
+
+  std::cout << "{\"benchmark\":\"net_bench\",\"version\":\"" << SPO_BENCH_VERSION
+            << "\",\"backend\":\"" << spo::asio::AsioService::BackendName()
+            << "\",\"io_cpus\":" << spo::bench::JsonString( args.Value( "--io-cpus", std::string() ) )
+            << ",\"results\":[";
+  std::size_t count( 0 );
+  for( auto & proto : protos )
+    for( auto & mode : modes )
+      for( auto payload : payloads )
+        for( auto & conn : connections )
+          for( auto & coro : coroutines )
+          {
+            Scenario sc;
+            sc.m_Proto          = proto;
+            sc.m_Mode           = mode;
+            sc.m_Payload        = payload;
+            sc.m_Connections    = std::max( 1, std::atoi( conn.c_str() ) );
+            sc.m_DurationMs     = args.Int( "--duration-ms", 2000 );
+            sc.m_WarmupMs       = args.Int( "--warmup-ms", 200 );
+            sc.m_UdpIntervalUs  = args.Int( "--udp-interval-us", 100 );
+            sc.m_IoCpus         = io_cpus;
+            sc.m_Coroutines     = coro;
+            sc.m_StackSize      = stack_sizes.empty() ? 0 : stack_sizes.front();
+            // отдельные порты для каждого сценария: соединения предыдущего
+            // сценария могут оставаться в состоянии TIME_WAIT. Порты следует
+            // выбирать вне диапазона ip_local_port_range, иначе привязка может
+            // конфликтовать с эфемерными портами клиентов
+            sc.m_Port           = static_cast< spo::asio::port_t >( port + 2 * count );
+            if( sc.IsDuplex() )
+              sc.m_Connections  = std::max( 2, sc.m_Connections );
+
+            auto reason( SkipReason( sc ) );
+            std::cout << ( count++ > 0 ? ",\n" : "\n" );
+            if( reason.empty() )
+              std::cout << ForkScenario( sc );
+            else
+              std::cout << "{\"proto\":" << spo::bench::JsonString( sc.m_Proto )
+                        << ",\"mode\":" << spo::bench::JsonString( sc.m_Mode )
+                        << ",\"payload\":" << sc.m_Payload
+                        << ",\"connections\":" << sc.m_Connections
+                        << ",\"coroutines\":" << spo::bench::JsonString( sc.m_Coroutines )
+                        << ",\"skipped\":" << spo::bench::JsonString( reason ) << "}";
+            std::flush( std::cout );
+          }
+  std::cout << "\n]}" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,3 @@
+APP_NAME = docs_bench
+
+include($$PWD/../../../benchmarks_body.pri)
@@ -0,0 +1,362 @@
+/**
+  * @file main.cpp
+  * @brief Программа docs_bench измеряет время операций над документами,
+  *        выполняемых для каждого принятого сообщения:
+  *        @a BytesDocument::Add / @a FromStream / @a ToStream,
+  *        @a DocumentPkg::GetPackage / @a HasHeader,
+  *        @a DocumentFrame::ToByteArray / @a GetPackage (кадры с префиксом
+  *        длины и CRC-32, без экранирования),
+  *        @a ByteStuffing::Stuff / @a Unstuff,
+  *        @a StrToHex / @a StrFromHex и @a StrReplace.
+  *
+  * Каждая операция измеряется для размеров сообщений от 16 Б до 16 МБ и двух
+  * видов данных:
+  * @value text   печатные символы ASCII с переводом строки каждые 64 байта
+  *               (без байтов-маркеров пакета);
+  * @value binary псевдослучайные байты (фиксированное начальное значение),
+  *               содержащие маркеры 0xAA и 0xBB.
+  *
+  * Время каждой операции отсчитывается отдельно, подготовка входных данных в
+  * измерение не входит. Операция повторяется не менее @a --min-time-ms
+  * миллисекунд. Если оценка времени одной операции для следующего размера
+  * (экстраполяция по двум предыдущим размерам, от линейной до квадратичной)
+  * превышает @a --max-op-ms, размер пропускается с указанием оценки.
+  *
+  * @par Пример запуска:
+  * @code
+  *  docs_bench --sizes 16,1K,64K,1M --data binary --filter ByteStuffing > docs.json
+  * @endcode
+  */
+
+#include "BenchCommon.h"
+#include "core/documents/DocumentFrame.h"
+#include "core/documents/DocumentPkg.h"
+#include "core/utils/CoreUtils.h"
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <random>
+
+namespace {
+
+using byte_t                    = char;
+using document_t                = spo::core::docs::BytesDocument< byte_t >;
+using package_t                 = spo::core::docs::DocumentPkg< byte_t >;
+using frame_t                   = spo::core::docs::DocumentFrame< byte_t >;
+
+/**
+ * @brief Тип bench_fnc_t определяет измеряемую операцию: функтор получает
+ *        входные данные и возвращает время выполнения операции, нс.
+ */
+using bench_fnc_t               = std::function< std::uint64_t( const std::string & ) >;
+
+struct                            BenchCase
+{
+  std::string                     m_Name;
+  bench_fnc_t                     m_Fnc;
+};
+
+//------------------------------------------------------------------------------
+
+std::string MakeData ( const std::string & kind, std::size_t size )
+{
+  std::string retval( size, '\0' );
+  if( kind == "binary" )
+  {
+    std::mt19937 gen( 20180101 );
+    for( auto & c : retval )
+      c = static_cast< char >( gen() & 0xFF );
+  }
+  else
+  {
+    static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789 ";
+    for( std::size_t idx( 0 ); idx < size; ++idx )
+      retval[ idx ] = ( idx % 64 == 63 ) ? '\n' : alphabet[ idx % ( sizeof( alphabet ) - 1 ) ];
+  }
+  return retval;
+}
+
+std::vector< byte_t > ToVector ( const std::string & data )
+{
+  return std::vector< byte_t >( data.cbegin(), data.cend() );
+}
+
+/**
+ * @brief Метод Stuffed возвращает данные после байт-стаффинга пакета
+ *        @a DocumentPkg (в таком виде данные передаются по сети).
+ */
+std::string Stuffed ( const std::string & data )
+{
+  auto v( ToVector( data ) );
+  package_t pkg;
+  pkg.Add( v, v.size() );
+  return pkg.ToByteArray();
+}
+
+/**
+ * @brief Метод Timed выполняет операцию и возвращает время ее выполнения, нс.
+ */
+template< typename                FncT_ >
+std::uint64_t Timed ( FncT_ fnc )
+{
+  auto t0( spo::bench::NowNs() );
+  fnc();
+  return spo::bench::NowNs() - t0;
+}
+
+/**
+ * @brief Метод Sink исключает удаление результата операции оптимизатором.
+ */
+template< typename                T_ >
+void Sink ( const T_ & value )
+{
+  asm volatile( "" : : "r"( & value ) : "memory" );
+}
+
+//------------------------------------------------------------------------------
+
+std::vector< BenchCase > MakeCases ()
+{
+  using namespace spo::core;
+
+  return
+  {
+    {
+      "BytesDocument::Add",
+      []( const std::string & data )
+      {
+        auto v( ToVector( data ) );
+        document_t doc;
+        return Timed( [ & ]() { doc.Add( v, v.size() ); } );
+      }
+    },
+    {
+      "BytesDocument::FromStream",
+      []( const std::string & data )
+      {
+        boost::asio::streambuf buffer;
+        std::ostream os( & buffer );
+        os.write( data.data(), static_cast< std::streamsize >( data.size() ) );
+        document_t doc;
+        return Timed( [ & ]() { doc.FromStream( buffer ); } );
+      }
+    },
+    {
+      "BytesDocument::ToStream",
+      []( const std::string & data )
+      {
+        document_t doc;
+        doc.FromByteArray( data );
+        boost::asio::streambuf buffer;
+        return Timed( [ & ]() { doc.ToStream( buffer, doc.Size() ); } );
+      }
+    },
+    {
+      "DocumentPkg::GetPackage",
+      []( const std::string & data )
+      { // два пакета подряд: извлекается первый, заголовок второго
+        // ограничивает его окончание
+        package_t pkg;
+        auto v( ToVector( pkg.GetHeader() + Stuffed( data ) + pkg.GetHeader() ) );
+        pkg.Add( v, v.size() );
+        return Timed( [ & ]() { Sink( pkg.GetPackage() ); } );
+      }
+    },
+    {
+      "DocumentPkg::HasHeader",
+      []( const std::string & data )
+      { // заголовок в конце данных: худший случай поиска
+        // (константная ссылка выбирает вариант с индексом, а не шаблонный
+        // вариант с итератором)
+        package_t pkg;
+        auto v( ToVector( Stuffed( data ) + pkg.GetHeader() ) );
+        pkg.Add( v, v.size() );
+        const package_t & pkg_ref( pkg );
+        return Timed( [ & ]() { Sink( pkg_ref.HasHeader( 0 ) ); } );
+      }
+    },
+    {
+      "DocumentFrame::ToByteArray",
+      []( const std::string & data )
+      {
+        auto v( ToVector( data ) );
+        frame_t frame( docs::FrameLength::Varint, true );
+        frame.Add( v, v.size() );
+        std::string result;
+        return Timed( [ & ]() { result = frame.ToByteArray(); } );
+      }
+    },
+    {
+      "DocumentFrame::GetPackage",
+      []( const std::string & data )
+      { // два кадра подряд: извлекается первый (аналог DocumentPkg::GetPackage)
+        auto v( ToVector( data ) );
+        frame_t frame( docs::FrameLength::Varint, true );
+        frame.Add( v, v.size() );
+        auto w( ToVector( frame.ToByteArray() + frame.ToByteArray() ) );
+        frame.ClearContent();
+        frame.Add( w, w.size() );
+        return Timed( [ & ]() { Sink( frame.GetPackage() ); } );
+      }
+    },
+    {
+      "ByteStuffing::Stuff",
+      []( const std::string & data )
+      {
+        admin::ByteStuffing stuffing( { std::string( 1, char( 0xAA ) ),
+                                        std::string( 1, char( 0xBB ) ) + std::string( 1, char( 0x00 ) ) } );
+        std::string result;
+        return Timed( [ & ]() { result = stuffing.Stuff( data ); } );
+      }
+    },
+    {
+      "ByteStuffing::Unstuff",
+      []( const std::string & data )
+      {
+        admin::ByteStuffing stuffing( { std::string( 1, char( 0xAA ) ),
+                                        std::string( 1, char( 0xBB ) ) + std::string( 1, char( 0x00 ) ) } );
+        auto stuffed( stuffing.Stuff( data ) );
+        std::string result;
+        return Timed( [ & ]() { result = stuffing.Unstuff( stuffed ); } );
+      }
+    },
+    {
+      "StrToHex",
+      []( const std::string & data )
+      {
+        std::string result;
+        return Timed( [ & ]() { result = utils::StrToHex( data ); } );
+      }
+    },
+    {
+      "StrFromHex",
+      []( const std::string & data )
+      {
+        auto hex( utils::StrToHex( data ) );
+        std::string result;
+        return Timed( [ & ]() { result = utils::StrFromHex( hex ); } );
+      }
+    },
+    {
+      "StrReplace",
+      []( const std::string & data )
+      { // замена с изменением длины: "\n" -> "\r\n" (text), 0xAA -> 0xBB 0x00 (binary)
+        std::string from( data.find( '\n' ) != std::string::npos ? "\n" : std::string( 1, char( 0xAA ) ) );
+        std::string to  ( from == "\n" ? "\r\n" : std::string( 1, char( 0xBB ) ) + std::string( 1, char( 0x00 ) ) );
+        std::string result;
+        return Timed( [ & ]() { result = utils::StrReplace( data, from, to ); } );
+      }
+    },
+  };
+}
+
+//------------------------------------------------------------------------------
+
+struct                            CaseResult
+{
+  std::uint64_t                   m_Iterations      { 0 };
+  std::uint64_t                   m_TotalNs         { 0 };
+  spo::bench::LatencyHistogram    m_Latency;
+};
+
+CaseResult RunCase ( const BenchCase & bc, const std::string & data, std::int64_t minTimeMs )
+{
+  CaseResult retval;
+  auto min_ns( static_cast< std::uint64_t >( minTimeMs ) * 1000000 );
+  auto started( spo::bench::NowNs() );
+  do
+  {
+    auto ns( bc.m_Fnc( data ) );
+    retval.m_Latency.Record( ns );
+    retval.m_TotalNs += ns;
+    ++ retval.m_Iterations;
+  }
+  while( ( spo::bench::NowNs() - started < min_ns ) and ( retval.m_Iterations < 1000000 ) );
+  return retval;
+}
+
+void Usage ()
+{
+  std::cerr <<
+    "usage: docs_bench [options]\n"
+    "  --sizes        sizes, K/M suffixes allowed  (default: 16,256,4K,64K,1M,16M)\n"
+    "  --data         text,binary                  (default: text,binary)\n"
+    "  --filter       run cases whose name contains the substring\n"
+    "  --min-time-ms  measurement time per case    (default: 200)\n"
+    "  --max-op-ms    skip sizes estimated slower  (default: 2000)\n";
+}
+
+}
+
+int main( int argc, char * argv[] )
+{
+  spo::bench::Arguments args( argc, argv );
+  if( args.Has( "--help" ) or args.Has( "-h" ) )
+  {
+    Usage();
+    return 0;
+  }
+
+  auto sizes      ( args.Sizes( "--sizes", "16,256,4K,64K,1M,16M" ) );
+  auto kinds      ( args.List ( "--data", "text,binary" ) );
+  auto filter     ( args.Value( "--filter", std::string() ) );
+  auto min_time   ( args.Int  ( "--min-time-ms", 200 ) );
+  auto max_op_ns  ( static_cast< double >( args.Int( "--max-op-ms", 2000 ) ) * 1e6 );
+  std::sort( sizes.begin(), sizes.end() );
+
+  std::cout << "{\"benchmark\":\"docs_bench\",\"version\":\"" << SPO_BENCH_VERSION
+            << "\",\"results\":[";
+  std::size_t count( 0 );
+  for( auto & bc : MakeCases() )
+  {
+    if( ( not filter.empty() ) and ( bc.m_Name.find( filter ) == std::string::npos ) )
+      continue;
+
+    for( auto & kind : kinds )
+    {
+      double      last_ns   ( 0 ), prev_ns  ( 0 );
+      std::size_t last_size ( 0 ), prev_size( 0 );
+      for( auto size : sizes )
+      {
+        std::cout << ( count++ > 0 ? ",\n" : "\n" )
+                  << "{\"name\":" << spo::bench::JsonString( bc.m_Name )
+                  << ",\"data\":" << spo::bench::JsonString( kind )
+                  << ",\"size\":" << size;
+
+        // показатель роста времени по двум предыдущим размерам, в пределах
+        // от линейного до квадратичного
+        double growth( 2.0 );
+        if( ( prev_size > 0 ) and ( prev_ns > 0 ) and ( last_ns > 0 ) )
+          growth = std::max( 1.0, std::min( 2.0, std::log( last_ns / prev_ns )
+                                                 / std::log( double( last_size ) / double( prev_size ) ) ) );
+        double estimate( last_size > 0
+                         ? last_ns * std::pow( double( size ) / double( last_size ), growth )
+                         : 0.0 );
+        if( estimate > max_op_ns )
+        {
+          std::cout << ",\"skipped\":\"estimated time per operation exceeds --max-op-ms\""
+                    << ",\"estimated_ns_per_op\":" << static_cast< std::uint64_t >( estimate ) << "}";
+          continue;
+        }
+
+        auto data  ( MakeData( kind, size ) );
+        auto result( RunCase( bc, data, min_time ) );
+        auto ns_op ( double( result.m_TotalNs ) / double( result.m_Iterations ) );
+        prev_ns   = last_ns;
+        prev_size = last_size;
+        last_ns   = ns_op;
+        last_size = size;
+
+        std::cout << ",\"iterations\":" << result.m_Iterations
+                  << ",\"ns_per_op\":" << static_cast< std::uint64_t >( ns_op )
+                  << ",\"mb_per_sec\":" << ( ns_op > 0 ? double( size ) * 1e3 / ns_op : 0.0 )
+                  << ",\"latency_ns\":" << spo::bench::HistogramJson( result.m_Latency )
+                  << "}";
+        std::flush( std::cout );
+      }
+    }
+  }
+  std::cout << "\n]}" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,14 @@
+TEMPLATE = subdirs
+
+bench_core.subdir = $$PWD/core
+bench_asio.subdir = $$PWD/asio
+
+SUBDIRS += \
+    bench_core \
+    bench_asio \
+
+bench_core.CONFIG = recursive
+bench_asio.CONFIG = recursive
+
+QMAKE_EXTRA_TARGETS += \
+    $$PWD/../../tools \
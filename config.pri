@@ -3,11 +3,13 @@ ADMIN_PATH = $$PWD/build/usr/local/export
 
 OUTPUT_LIBRARY_PATH     = $${ADMIN_PATH}/lib
 OUTPUT_BINARY_EXMPL_PATH= $${ADMIN_PATH}/examples
+OUTPUT_BINARY_BENCH_PATH= $${ADMIN_PATH}/benchmarks
 OUTPUT_INCLUDE_PATH     = $${ADMIN_PATH}/include
 OUTPUT_CONFIG_PATH      = $${ADMIN_PATH}/conf
 
 system('mkdir -p $$OUTPUT_LIBRARY_PATH')
 system('mkdir -p $$OUTPUT_BINARY_EXMPL_PATH')
+system('mkdir -p $$OUTPUT_BINARY_BENCH_PATH')
 system('mkdir -p $$OUTPUT_INCLUDE_PATH')
 system('mkdir -p $$OUTPUT_CONFIG_PATH')
 
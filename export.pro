@@ -2,15 +2,19 @@ TEMPLATE = subdirs
 
 lib_tools.subdir      = $$PWD/tools
 examples.subdir       = $$PWD/examples
+benchmarks.subdir     = $$PWD/benchmarks
 
 SUBDIRS += \
     lib_tools \
     examples \
+    benchmarks \
 
 lib_tools.CONFIG      = recursive
 examples.CONFIG       = recursive
+benchmarks.CONFIG     = recursive
 
 examples.depends      = lib_tools
+benchmarks.depends    = lib_tools
 
 RESOURCES += \
     $${lib_tools.subdir}/ui/widgets/images.qrc
@@ -24,22 +24,36 @@ namespace                         asio  {
  *        подключения клиентов к конечной точке.
  *
  * Параметры шаблона:
- * @value ProtocolT_ тип протокола обмена информации по IP-адресу сервера.
  * @value ByteT_ тип единицы информации для каналов обмена данными.
+ * @value ProtocolT_ потоковый протокол подключений: TCP или потоковые
+ *        локальные сокеты ( @a local_stream_t ).
  *
  * Методы класса используют технологию Boost.Coroutine реализации алгоритмов на
  * основе сопрограмм.
  *
  */
-template< typename                ByteT_ >
+template
+<
+    typename                      ByteT_,
+    typename                      ProtocolT_  = spo::asio::tcp_t,
+    typename                    = typename std::enable_if
+    <
+      std::is_same< ProtocolT_, boost::asio::ip::tcp >::value
+      or
+      std::is_same< ProtocolT_, spo::asio::local_stream_t >::value
+    >::type
+>
 class SPO_CORE_EXPORT             AsioAcceptor :
-public                            std::enable_shared_from_this< spo::asio::AsioAcceptor< ByteT_ > >
+public                            std::enable_shared_from_this< spo::asio::AsioAcceptor< ByteT_, ProtocolT_ > >
 {
 public:
-  using self_t                  = spo::asio::AsioAcceptor< ByteT_ >;
+  using self_t                  = spo::asio::AsioAcceptor< ByteT_, ProtocolT_ >;
   using service_t               = spo::asio::AsioService;
-  using shared_t                = std::enable_shared_from_this< spo::asio::AsioAcceptor< ByteT_ > >;
-  using session_t               = spo::asio::AsioSocketSession< spo::asio::tcp_t, ByteT_ >;
+  using shared_t                = std::enable_shared_from_this< self_t >;
+  using protocol_t              = ProtocolT_;
+  using socket_t                = typename ProtocolT_::socket;
+  using server_t                = spo::asio::AsioServer< ProtocolT_, ByteT_ >;
+  using session_t               = spo::asio::AsioSocketSession< ProtocolT_, ByteT_ >;
 
   /**
    * @brief  Конструктор AsioAcceptor формирует экземпляр класса для
@@ -52,9 +66,9 @@ public:
   /**/                            AsioAcceptor
   (
       spo::asio::TransferType       type,
-      const spo::asio::AsioServer< spo::asio::tcp_t, ByteT_ > & serverRef
+      const server_t              & serverRef
   )
-    : m_ServerRef   ( const_cast< spo::asio::AsioServer< spo::asio::tcp_t, ByteT_ > & >( serverRef ) )
+    : m_ServerRef   ( const_cast< server_t & >( serverRef ) )
     , m_Acceptor    ( self_t::service_t::Instance().ServiceRef() )
   {
     self_t::service_t::Instance().AddBeforeStartCallback
@@ -87,7 +101,7 @@ public:
    */
   io_service_t                  & ServiceRef          ()
   {
-    return std::ref( m_Acceptor.get_io_service() );
+    return ServiceOf( m_Acceptor );
   }
 
   /**
@@ -137,16 +151,20 @@ public:
       }
     }
     if( not IsOpen() )
+    {
       m_ServerRef.SetSocketsCount( 0 );
+      spo::asio::error_t ec;
+      UnlinkLocalEndpoint( m_ServerRef.Endpoint(), ec );
+    }
   }
 
 private:
-  spo::asio::AsioServer< spo::asio::tcp_t, ByteT_ > & m_ServerRef;
+  server_t                      & m_ServerRef;
   /**
    * @brief Атрибут m_Acceptor содержит элемент обслуживания запроса от клиента
    *        на подключение к серверу.
    */
-  typename tcp_t::acceptor        m_Acceptor;
+  typename ProtocolT_::acceptor   m_Acceptor;
 
   /**
    * @brief Метод TryOpen производит попытки активизации обслуживания подключения
@@ -178,7 +196,9 @@ private:
                   if( success )
                   {
                     this->SetOptions();
-                    this->m_Acceptor.bind( this->m_ServerRef.Endpoint(), ec );
+                    // файл локального сокета предыдущего запуска сервера
+                    if( UnlinkLocalEndpoint( this->m_ServerRef.Endpoint(), ec ) )
+                      this->m_Acceptor.bind( this->m_ServerRef.Endpoint(), ec );
                     success = not spo::asio::AsioService::Instance().IsError( ec );
                     if( success )
                     {
@@ -263,6 +283,14 @@ protected:
     acceptor_t::enable_connection_aborted o_aborted(true);
     m_Acceptor.set_option(o_reuse, ec);
     m_Acceptor.set_option(o_aborted, ec);
+
+    // опции профиля наследуются сокетами принятых подключений (профиль
+    // содержит опции TCP и к локальным сокетам не применяется)
+    auto profile( m_ServerRef.SocketProfilePtr() );
+    if( profile
+        and std::is_same< ProtocolT_, tcp_t >::value
+        and ( not profile->ApplyListener( m_Acceptor, ec ) ) )
+      DUMP_BOOST_ERROR( ec );
   }
 
   /**
@@ -281,37 +309,106 @@ protected:
         return;
       }
       spo::asio::error_t ec;
-      tcp_t::socket socket( ServiceRef() );
+      socket_t socket( ServiceRef() );
+      SPO_ASIO_TRACE( Yield, this, "accept", 0 );
       m_Acceptor.async_accept( socket, yield[ ec ] );
+      SPO_ASIO_TRACE( Resume, this, "accept", 0 );
 
       if( not spo::asio::AsioService::Instance().IsError( ec ) )
-      { // подключение прошло успешно. Создание ощедоступного указателя на
-        // экземпляр сессии работы с сокетом
+      { // подключение прошло успешно. Выбор потока ввода/вывода сессии
         m_ServerRef.IncSocketsCount();
-        auto session_ptr( std::move( MakeSocketSession< boost::asio::ip::tcp, ByteT_ >(
-                                      m_ServerRef.ActionsRef(),
-                                      type,
-                                      std::move( socket ),
-                                      m_ServerRef.SocketDeadline() ) ) );
-        if( session_ptr )
+        auto & service( AsioService::Instance().SessionServiceRef(
+                          AsioService::Instance().IsIncomingCpuMatching()
+                          ? AsioPlacement::IncomingCpu( socket.native_handle() )
+                          : -1 ) );
+
+        if( & service == & ServiceRef() )
         {
-          session_ptr->SetAfterStop(
-                []( void * ptr )
-                {
-                  auto s_ptr( reinterpret_cast< spo::asio::AsioServer< spo::asio::tcp_t, ByteT_ > * >(ptr) );
-                  if( nullptr != s_ptr )
-                  {
-                    s_ptr->DecSocketsCount();
-                  }
-                }, & m_ServerRef );
-          AsioService::Instance().ServiceRef().post(
-            boost::bind(
-              & spo::asio::AsioSocketSession< boost::asio::ip::tcp, ByteT_ >::Start,
-              session_ptr ) );
+          StartSession( type, std::make_shared< socket_t >( std::move( socket ) ) );
+          continue;
+        }
+
+        // перенос сокета в сервис потока ввода/вывода: сессия создается в
+        // этом потоке, буферы сессии размещаются в памяти его узла NUMA
+        auto socket_ptr( std::make_shared< socket_t >( service ) );
+        auto handle( socket.release( ec ) );
+        if( IsNoErr( ec ) )
+          socket_ptr->assign( m_ServerRef.Protocol(), handle, ec );
+        if( not IsNoErr( ec ) )
+        {
+          DUMP_BOOST_ERROR( ec );
+          m_ServerRef.DecSocketsCount();
+          continue;
         }
+        service.post( boost::bind( & self_t::StartSession,
+                                   this->shared_from_this(),
+                                   type,
+                                   socket_ptr ) );
       }
     }
   }
+
+  /**
+   * @brief Метод StartSession создает и запускает сессию работы с сокетом
+   *        принятого подключения. Выполняется в потоке сервиса сокета.
+   * @param type тип (режим) работы сервера
+   * @param socketPtr сокет принятого подключения
+   */
+  void StartSession ( TransferType type, std::shared_ptr< socket_t > socketPtr )
+  {
+    // создание ощедоступного указателя на экземпляр сессии работы с сокетом
+    auto session_ptr( std::move( MakeSocketSession< ProtocolT_, ByteT_ >(
+                                  m_ServerRef.ActionsRef(),
+                                  type,
+                                  std::move( * socketPtr ),
+                                  m_ServerRef.SocketDeadline() ) ) );
+    if( session_ptr )
+    {
+      session_ptr->SetBufferSize( m_ServerRef.BufferSize() );
+      session_ptr->SetSocketProfile( m_ServerRef.SocketProfilePtr() );
+      session_ptr->SetBatchPolicy( m_ServerRef.BatchPolicyPtr() );
+      session_ptr->SetInboundLimit( m_ServerRef.InboundHigh(), m_ServerRef.InboundLow() );
+      auto sizing( m_ServerRef.ReceiveSizingPtr() );
+      if( sizing )
+        session_ptr->SetReceiveSizing( * sizing );
+      m_ServerRef.AddChannelsTo( * session_ptr );
+      m_ServerRef.OffloadTo( * session_ptr );
+      if( m_ServerRef.FileTransferFactory() )
+        session_ptr->SetFileTransfer( m_ServerRef.FileTransferFactory()() );
+#if defined( SPO_ASIO_TLS )
+      auto tls( m_ServerRef.TlsContextPtr() );
+      if( tls )
+        session_ptr->SetTls( tls );
+#endif
+      const session_t * session_raw( session_ptr.get() );
+      session_ptr->SetAfterStop(
+            [ session_raw ]( void * ptr )
+            {
+              auto s_ptr( reinterpret_cast< server_t * >(ptr) );
+              if( nullptr != s_ptr )
+              {
+                // остановленный подписчик удаляется из реестра тем
+                s_ptr->TopicsRef().Release( session_raw );
+                s_ptr->DecSocketsCount();
+              }
+            }, & m_ServerRef );
+
+      // отклоненное подключение закрывается без запуска сессии
+      auto & filter( m_ServerRef.AcceptFilter() );
+      if( filter and ( not filter( session_ptr ) ) )
+      {
+        session_ptr->Stop();
+        return;
+      }
+
+      // подписчик тем принимает сообщения рассылки вместо обмена
+      session_ptr->ServiceRef().post(
+        boost::bind( m_ServerRef.Subscribe( session_ptr )
+                     ? & session_t::StartPush
+                     : & session_t::Start,
+                     session_ptr ) );
+    }
+  }
 };
 
 }// namespace                     asio
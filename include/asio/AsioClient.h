@@ -24,6 +24,10 @@ template
       std::is_same< ProtocolT_, boost::asio::ip::udp >::value
       or
       std::is_same< ProtocolT_, boost::asio::ip::icmp >::value
+      or
+      std::is_same< ProtocolT_, spo::asio::local_stream_t >::value
+      or
+      std::is_same< ProtocolT_, spo::asio::local_datagram_t >::value
     >::type
 >
 class SPO_CORE_EXPORT             AsioClient :
@@ -36,9 +40,23 @@ public:
   using resolver_t              = spo::asio::AsioResolver< ProtocolT_, ByteT_ >;
   using session_t               = spo::asio::AsioSocketSession< ProtocolT_, ByteT_ >;
   using session_shr_t           = std::shared_ptr< typename self_t::session_t >;
+  /**
+   * @brief Тип connect_callback_t определяет обработчик результата попытки
+   *        подключения: созданная сессия (до ее запуска) и код ошибки. При
+   *        ошибке подключения указатель на сессию пуст.
+   */
+  using connect_callback_t      = spo::simple_fnc_t< void, session_shr_t, const error_t & >;
 
 private:
   std::atomic_bool              m_KeepAlive { false };
+  connect_callback_t            m_AfterConnect;
+  /**
+   * @brief Атрибуты m_ReconnectMinMs и m_ReconnectMaxMs содержат начальный и
+   *        наибольший интервал повторного подключения после неудачной
+   *        попытки в режиме @a IsKeepAlive, мс.
+   */
+  std::atomic< std::int64_t >   m_ReconnectMinMs { 100 };
+  std::atomic< std::int64_t >   m_ReconnectMaxMs { 10000 };
 
 public:
   /**
@@ -109,81 +127,235 @@ public:
     }
   }
 
+  /**
+   * @brief Метод SetReconnectBackoff задает интервалы повторного подключения
+   *        в режиме @a IsKeepAlive: после каждой неудачной попытки интервал
+   *        удваивается от @a minMs до @a maxMs, успешное подключение
+   *        возвращает его к начальному.
+   * @param minMs начальный интервал, мс (не менее 1);
+   * @param maxMs наибольший интервал, мс.
+   */
+  void SetReconnectBackoff ( std::int64_t minMs, std::int64_t maxMs )
+  {
+    m_ReconnectMinMs.store( std::max< std::int64_t >( minMs, 1 ) );
+    m_ReconnectMaxMs.store( std::max< std::int64_t >( maxMs, m_ReconnectMinMs ) );
+  }
+
+  /**
+   * @brief Метод SetAfterConnect назначает обработчик результата подключений,
+   *        выполняемых методом @a TryConnect без параметров (в т.ч. при запуске
+   *        сервиса).
+   *
+   * Обработчик вызывается до запуска сессии: в нем допускается назначение
+   * сессии собственных обработчиков каналов и завершения работы.
+   */
+  void SetAfterConnect ( const connect_callback_t & afterConnect )
+  {
+    m_AfterConnect = afterConnect;
+  }
+
   /**
    * @brief Метод TryConnect производит попытки подключения к серверу
-   * @param type
+   * @return Признак запуска попытки подключения:
+   * @value true  сопрограмма подключения запущена;
+   * @value false превышено допустимое количество сокетов, сервер не найден,
+   *              выполняется плавное завершение работы сервиса или произошла
+   *              ошибка запуска.
+   */
+  bool TryConnect ()
+  {
+    return TryConnect( m_AfterConnect );
+  }
+
+  /**
+   * @brief Метод TryConnect производит попытку подключения к серверу с
+   *        обработчиком результата данного подключения.
+   * @param afterConnect обработчик результата подключения (вызывается в потоке
+   *        сервиса, если метод вернул true).
+   * @return Признак запуска попытки подключения.
    */
-  void TryConnect ()
+  bool TryConnect ( const connect_callback_t & afterConnect )
   {
+    if( AsioService::Instance().IsDraining() )
+      return false;
+
     if( not base_class_t::SocketsValid() )
     {
       AsioService::Instance().SetState( AsioState::ErrSocketCount );
-      return;
+      return false;
     }
 
-    if( resolver_t::IsValid( true ) )
+    // повторное разрешение имени выполняется только при отсутствии конечных
+    // точек: многократные подключения не обращаются к службе имен
+    bool retval( resolver_t::IsValid( not resolver_t::IsValid() ) );
+    if( retval )
     {
       try
       {
         boost::asio::spawn(
               io_strand_t( self_t::ServiceRef() ),
-              boost::bind( & self_t::Connect, this, _1 ) );
+              boost::bind( & self_t::Connect, this, _1, afterConnect ) );
       }
       catch ( const std::exception & e)
       {
+        retval = false;
         DUMP_EXCEPTION( e );
       }
     }
+    return retval;
   }
 
 protected:
   /**
    * @brief Метод Connect реализует функционал подключения к серверу.
-   * @param type тип (режим) работы сервера
+   *
+   * Результат каждого подключения передается обработчику @a afterConnect.
+   * В режиме поддержки подключения ( @a IsKeepAlive ) подключения повторяются,
+   * пока сервис активен и не выполняет плавное завершение работы; повтор
+   * после неудачной попытки выполняется через интервал
+   * @a SetReconnectBackoff.
+   *
    * @param yield контекст передачи управления очередной сопрограмме
+   * @param afterConnect обработчик результата подключения
    */
-  void Connect( boost::asio::yield_context yield )
+  void Connect( boost::asio::yield_context yield, connect_callback_t afterConnect )
   {
+    std::int64_t backoff_ms( 0 );
+    do
+    {
+      error_t ec;
+      auto session_ptr( ConnectSession( yield, ec ) );
+      try
+      {
+        if( session_ptr )
+        {
+          // сессия создана успешно, запуск транзакции работы с данными
+          session_ptr->SetBufferSize( base_class_t::BufferSize() );
+          session_ptr->SetAfterStop( base_class_t::SessionAfterStop(),
+                                     base_class_t::SessionAfterStopParam() );
+          if( afterConnect )
+            afterConnect( session_ptr, ec );
+
+          self_t::ServiceRef().post(boost::bind( & session_t::Start, session_ptr ) );
+        }
+        else if( afterConnect )
+          afterConnect( session_shr_t(), ec );
+      }
+      catch( std::exception & e )
+      {
+        DUMP_EXCEPTION( e );
+      }
+
+      if( session_ptr or ( not IsKeepAlive() ) )
+      {
+        backoff_ms = 0;
+        continue;
+      }
+      // сервер недоступен: повтор через удвоенный интервал
+      backoff_ms = backoff_ms > 0
+                   ? std::min( backoff_ms * 2, m_ReconnectMaxMs.load() )
+                   : m_ReconnectMinMs.load();
+      asio_steady_timer_t timer( self_t::ServiceRef() );
+      timer.expires_from_now( std::chrono::milliseconds( backoff_ms ) );
+      error_t timer_ec;
+      SPO_ASIO_TRACE( Yield, this, "reconnect", 0 );
+      timer.async_wait( yield[ timer_ec ] );
+      SPO_ASIO_TRACE( Resume, this, "reconnect", 0 );
+    }
+    while( IsKeepAlive()
+           and spo::asio::AsioService::Instance().IsActive()
+           and ( not spo::asio::AsioService::Instance().IsDraining() ) );
+  }
+
+  /**
+   * @brief Метод ConnectSession выполняет подключение к серверу и создает
+   *        сессию работы с сокетом.
+   *
+   * Конечные точки сервера перебираются до первого успешного подключения.
+   *
+   * @param yield контекст передачи управления очередной сопрограмме
+   * @param ec    код ошибки подключения
+   * @return сессия подключенного сокета или пустой указатель при ошибке.
+   */
+  session_shr_t ConnectSession( boost::asio::yield_context yield, error_t & ec )
+  {
+    session_shr_t retval;
+    ec = boost::asio::error::host_not_found;
     try
     {
-      boost::system::error_code ec;
       typename ProtocolT_::socket socket( resolver_t::ServiceRef() );
       base_class_t::IncSocketsCount();
+      auto profile( base_class_t::SocketProfilePtr() );
 
-      while( IsKeepAlive() )
       for( auto ep : self_t::Endpoints() )
       {
+        if( profile )
+        { // опции профиля назначаются до подключения: размер окна приема
+          // определяется при установлении соединения
+          error_t profile_ec;
+          socket.open( ep.protocol(), profile_ec );
+          if( IsNoErr( profile_ec )
+              and ( not profile->template ApplySocket< ProtocolT_ >( socket, profile_ec ) ) )
+            DUMP_BOOST_ERROR( profile_ec );
+        }
+        SPO_ASIO_TRACE( Yield, this, "connect", 0 );
         socket.async_connect( ep, yield[ ec ] );
+        SPO_ASIO_TRACE( Resume, this, "connect", 0 );
 
-        if( spo::asio::AsioService::Instance().IsError( ec ) )
-        {
-          AsioService::Instance().SetState( AsioState::ErrConnection );
-          base_class_t::DecSocketsCount();
-          break;
+        if( not IsNoErr( ec ) )
+        { // следующая конечная точка: сокет неудачной попытки закрывается
+          error_t ignored_ec;
+          socket.close( ignored_ec );
+          continue;
         }
         // создание сессии работы с сокетом
-        auto session_ptr( std::move( MakeSocketSession< ProtocolT_, ByteT_ >(
-                                      self_t::ActionsRef(),
-                                      base_class_t::TransferType(),
-                                      std::move( socket ),
-                                      ep,
-                                      self_t::SocketDeadline() ) ) );
-        if( session_ptr )
+        retval = MakeSocketSession< ProtocolT_, ByteT_ >(
+                   self_t::ActionsRef(),
+                   base_class_t::TransferType(),
+                   std::move( socket ),
+                   ep,
+                   self_t::SocketDeadline() );
+        if( retval )
         {
-          // сессия создана успешно, запуск транзакции работы с данными
-          session_ptr->SetAfterStop( base_class_t::SessionAfterStop(),
-                                     base_class_t::SessionAfterStopParam() );
-
-          self_t::ServiceRef().post(boost::bind( & session_t::Start, session_ptr ) );
-          break;
+          retval->SetSocketProfile( profile );
+          retval->SetBatchPolicy( base_class_t::BatchPolicyPtr() );
+          retval->SetInboundLimit( base_class_t::InboundHigh(), base_class_t::InboundLow() );
+          auto sizing( base_class_t::ReceiveSizingPtr() );
+          if( sizing )
+            retval->SetReceiveSizing( * sizing );
+          base_class_t::AddChannelsTo( * retval );
+          base_class_t::OffloadTo( * retval );
+          if( base_class_t::FileTransferFactory() )
+            retval->SetFileTransfer( base_class_t::FileTransferFactory()() );
+#if defined( SPO_ASIO_TLS )
+          // повторное подключение к серверу возобновляет сессию TLS
+          auto tls( base_class_t::TlsContextPtr() );
+          if( tls )
+            retval->SetTls( tls, resolver_t::HosName() + ":" + resolver_t::RemouteService() );
+#endif
+        }
+        else
+        {
+          ec = boost::system::errc::make_error_code( boost::system::errc::owner_dead );
+          spo::asio::AsioService::Instance().SetError( boost::system::errc::owner_dead );
         }
-        spo::asio::AsioService::Instance().SetError( boost::system::errc::owner_dead );
+        break;
       }
     }
     catch( std::exception & e )
     {
+      retval.reset();
+      ec = boost::system::errc::make_error_code( boost::system::errc::owner_dead );
       DUMP_EXCEPTION( e );
     }
+
+    if( not retval )
+    {
+      if( spo::asio::AsioService::Instance().IsError( ec ) )
+        AsioService::Instance().SetState( AsioState::ErrConnection );
+      base_class_t::DecSocketsCount();
+    }
+    return retval;
   }
 };
 
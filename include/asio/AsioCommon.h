@@ -20,6 +20,34 @@
 #include <boost/asio/steady_timer.hpp>
 #include <boost/asio/deadline_timer.hpp>
 
+/*
+ * Реактор io_uring (qmake CONFIG+=asio_io_uring, см. tools/asio/asio.pri)
+ * поддерживается Boost.Asio начиная с версии 1.78. BOOST_ASIO_HAS_IO_URING и
+ * BOOST_ASIO_DISABLE_EPOLL должны быть определены до включения заголовков
+ * Boost.Asio во всех единицах трансляции, поэтому задаются только в DEFINES.
+ */
+#if defined( SPO_ASIO_IO_URING )
+# if BOOST_VERSION < 107800
+#   error "SPO_ASIO_IO_URING requires Boost.Asio 1.78 or later"
+# endif
+# if not defined( BOOST_ASIO_HAS_IO_URING_AS_DEFAULT )
+#   error "SPO_ASIO_IO_URING requires BOOST_ASIO_HAS_IO_URING and BOOST_ASIO_DISABLE_EPOLL"
+# endif
+#endif
+
+/*
+ * Сопрограммы C++20 (qmake CONFIG+=asio_stackless) для обмена данными сессий
+ * дополняют сопрограммы Boost.Coroutine (см. spo::asio::CoroutineKind).
+ */
+#if defined( SPO_ASIO_STACKLESS )
+# if not defined( BOOST_ASIO_HAS_CO_AWAIT )
+#   error "SPO_ASIO_STACKLESS requires C++20 coroutines (BOOST_ASIO_HAS_CO_AWAIT)"
+# endif
+# include <boost/asio/co_spawn.hpp>
+# include <boost/asio/detached.hpp>
+# include <boost/asio/redirect_error.hpp>
+# include <boost/asio/use_awaitable.hpp>
+#endif
 
 #ifdef QT_DEBUG
 # include <QDebug>
@@ -42,6 +70,17 @@ enum class                        TransferType
   FullDuplex        , ///< двусторонний ассинхронный (одновременный) обмен данными
 };
 
+/**
+ * @brief Класс-перечисление CoroutineKind определяет вид сопрограмм обмена
+ *        данными сессий.
+ */
+enum class                        CoroutineKind
+{
+  Stackful      = 0 , ///< сопрограммы Boost.Coroutine со своим стеком (boost::asio::spawn)
+  Stackless         , ///< сопрограммы C++20 без стека (boost::asio::co_spawn),
+                      ///< только в сборке с SPO_ASIO_STACKLESS
+};
+
 /**
  * @brief Перечисление DataType определяет направление петока передачи данных.
  */
@@ -80,6 +119,11 @@ const std::size_t                 ASIO_DEADLINE_STEPS_DEFAULT ( 1 );
  * @brief Константа ASIO_DEADLINE_DEFAULT
  */
 const boost::int64_t              ASIO_DEADLINE_DEFAULT  ( 1000 );
+/**
+ * @brief Константа ASIO_DRAIN_POLL_MS содержит период (мс) проверки завершения
+ *        сессий при плавном завершении работы сервиса.
+ */
+const boost::int64_t              ASIO_DRAIN_POLL_MS     ( 10 );
 /**
  * @brief Константа ASIO_DEADLINE_MILLISEC_TYPE
  */
@@ -115,6 +159,28 @@ using asio_poolkey_t            = std::size_t;
  * @brief Тип
  */
 using io_service_t              = boost::asio::io_service;
+
+/**
+ * @brief Метод ServiceOf возвращает ссылку на сервис ввода/вывода, к которому
+ *        привязан объект Boost.Asio (сокет, таймер, акцептор, резолвер).
+ *
+ * Метод get_io_service() удален из Boost.Asio 1.70, а исполнитель по умолчанию
+ * с версии 1.74 не имеет метода context(), поэтому сервис извлекается
+ * способом, доступным в используемой версии библиотеки.
+ */
+template< typename                IoObjectT_ >
+io_service_t & ServiceOf ( IoObjectT_ & object )
+{
+#if BOOST_VERSION < 107000
+  return object.get_io_service();
+#elif ( BOOST_VERSION < 107400 ) or defined( BOOST_ASIO_USE_TS_EXECUTOR_AS_DEFAULT )
+  return static_cast< io_service_t & >( object.get_executor().context() );
+#else
+  return static_cast< io_service_t & >(
+        boost::asio::query( object.get_executor(), boost::asio::execution::context ) );
+#endif
+}
+
 /**
  * @brief Тип
  */
@@ -127,6 +193,16 @@ using tcp_t                     = boost::asio::ip::tcp;
  * @brief Тип
  */
 using udp_t                     = boost::asio::ip::udp;
+/**
+ * @brief Тип local_stream_t определяет протокол потоковых локальных сокетов
+ *        (сокеты домена Unix, SOCK_STREAM).
+ */
+using local_stream_t            = boost::asio::local::stream_protocol;
+/**
+ * @brief Тип local_datagram_t определяет протокол датаграммных локальных
+ *        сокетов (сокеты домена Unix, SOCK_DGRAM).
+ */
+using local_datagram_t          = boost::asio::local::datagram_protocol;
 /**
  * @brief Тип
  */
@@ -349,6 +425,12 @@ void DUMP_ASIO_ERROR( const error_t & error_code )
   * Это займет некоторое время, чтобы привыкнуть, но, как только вы поймете это,
   * вы сможете изолировать выходные данные, в которых содержится проблема и находить
   * фактическую часть кода, которая должна быть исправлена.
+  *
+  * Для поиска задержек конкретного запроса удобнее трассировка
+  * @a spo::asio::AsioTrace (файл asio/AsioTrace.h): события запуска, передачи
+  * управления и возобновления сопрограмм сессий, выполнения обработчиков и
+  * завершения операций ввода/вывода выгружаются в формате Chrome trace-event
+  * JSON для просмотра в Perfetto.
   */
 
 #endif // ASIO_COMMON_H
@@ -0,0 +1,134 @@
+/**
+  * @file AsioComputePool.h
+  * @brief Файл AsioComputePool.h содержит объявление класса
+  *        @a spo::asio::AsioComputePool пула потоков вычислений, в котором
+  *        выполняются действия каналов сессий с признаком
+  *        @a IOChannel::IsOffload.
+  *
+  * Действие канала, выполняемое в потоке сервиса, задерживает обмен всех
+  * сессий этого потока. Действие, переданное в пул, выполняется вне
+  * реактора: сопрограмма сессии ожидает его завершения, не занимая поток
+  * сервиса, поэтому длительная обработка увеличивает задержку только своей
+  * сессии. Порядок действий сессии сохраняется: следующее действие
+  * передается в пул после завершения предыдущего.
+  *
+  * Каждый поток пула имеет собственную очередь задач; освободившийся поток
+  * забирает задачи из очередей других потоков.
+  */
+
+#ifndef ASIOCOMPUTEPOOL_H
+#define ASIOCOMPUTEPOOL_H
+
+#include "asio/AsioCommon.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace                         spo   {
+namespace                         asio  {
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Структура ComputeMetrics содержит счетчики пула вычислений.
+ */
+struct                            ComputeMetrics
+{
+  std::atomic< std::uint64_t >    m_Submitted       { 0 }; ///< передано задач
+  std::atomic< std::uint64_t >    m_Executed        { 0 }; ///< выполнено задач
+  std::atomic< std::uint64_t >    m_Stolen          { 0 }; ///< задач, взятых из чужой очереди
+  std::atomic< std::size_t >      m_Queued          { 0 }; ///< задач, ожидающих выполнения
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс AsioComputePool определяет общий для сессий процесса пул
+ *        потоков вычислений.
+ *
+ * Пока пул не запущен, действия каналов выполняются в потоке сервиса.
+ *
+ * @par Пример использования:
+ * @code language="cpp"
+ *  spo::asio::AsioComputePool::Instance().Start( 4 );
+ *  server.SetOffload( spo::asio::DataType::Input );
+ *  ...
+ *  spo::asio::AsioComputePool::Instance().Stop();
+ * @endcode
+ */
+class SPO_CORE_EXPORT             AsioComputePool
+{
+public:
+  /**
+   * @brief Тип task_t определяет задачу пула.
+   */
+  using task_t                  = spo::simple_fnc_t< void >;
+
+  /**/                            AsioComputePool     ( const AsioComputePool & ) = delete;
+  /**/                            AsioComputePool     ( AsioComputePool && ) = delete;
+  AsioComputePool &               operator=           ( const AsioComputePool & ) = delete;
+  AsioComputePool &               operator=           ( AsioComputePool && ) = delete;
+
+  static
+  spo::asio::AsioComputePool &    Instance            ();
+
+  /**
+   * @brief Метод Start запускает потоки пула.
+   * @param threads количество потоков (0 - по количеству ядер процессора).
+   * @return false, если пул уже запущен.
+   */
+  bool                            Start               ( std::size_t threads = 0 );
+  /**
+   * @brief Метод Stop завершает потоки пула после выполнения переданных
+   *        задач. Не вызывается из задачи пула.
+   */
+  void                            Stop                ();
+
+  bool                            IsRunning           () const BOOST_NOEXCEPT
+    { return m_Running.load(); }
+  std::size_t                     Threads             () const BOOST_NOEXCEPT
+    { return m_Threads.load(); }
+  const ComputeMetrics          & MetricsRef          () const BOOST_NOEXCEPT
+    { return m_Metrics; }
+
+  /**
+   * @brief Метод Submit передает задачу пулу. Задача, переданная из потока
+   *        пула, помещается в очередь этого потока.
+   * @return false, если пул не запущен (задача не выполняется).
+   */
+  bool                            Submit              ( const task_t & task );
+
+private:
+  /**
+   * @brief Структура Worker содержит очередь задач и поток пула.
+   */
+  struct                          Worker
+  {
+    std::mutex                    m_Mutex;
+    std::deque< task_t >          m_Tasks;
+    std::thread                   m_Thread;
+  };
+
+  /**/                            AsioComputePool     () = default;
+  /**/                           ~AsioComputePool     ();
+
+  void                            Run                 ( std::size_t index );
+  bool                            Take                ( std::size_t index, task_t & task );
+
+  std::vector< std::unique_ptr< Worker > >
+                                  m_Workers;
+  std::atomic_bool                m_Running           { false };
+  std::atomic< std::size_t >      m_Threads           { 0 };
+  std::atomic< std::size_t >      m_Next              { 0 };
+  ComputeMetrics                  m_Metrics;
+  std::mutex                      m_Mutex;
+  std::condition_variable         m_Ready;
+};
+
+//------------------------------------------------------------------------------
+}// namespace                   asio
+}// namespace                   spo
+
+#endif // ASIOCOMPUTEPOOL_H
@@ -0,0 +1,158 @@
+/**
+  * @file AsioFileTransfer.h
+  * @brief Файл AsioFileTransfer.h содержит объявление класса
+  *        @a spo::asio::AsioFileTransfer передачи файла через потоковый сокет
+  *        сессии без копирования данных в память процесса.
+  *
+  * Передача файла выполняется системным вызовом sendfile (файл - сокет),
+  * прием - системным вызовом splice (сокет - канал pipe - файл). Если ядро
+  * не поддерживает вызов для данного файла или сокета, данные переносятся
+  * через буфер постоянного размера @a AsioFileTransfer::CHUNK_SIZE.
+  * Объем используемой памяти не зависит от размера файла.
+  *
+  * Передача файла назначается сессии TCP или потокового локального сокета
+  * методом @a AsioSocketSession::SetFileTransfer (серверу или клиенту -
+  * методом @a ClientServerBase::SetFileTransferFactory ) и заменяет
+  * обработчик канала передачи или приема сессии.
+  */
+
+#ifndef ASIOFILETRANSFER_H
+#define ASIOFILETRANSFER_H
+
+#include "asio/AsioCommon.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace                         spo   {
+namespace                         asio  {
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс-перечисление FileDirection определяет направление передачи
+ *        файла.
+ */
+enum class                        FileDirection
+{
+  Send          = 0 , ///< файл передается в сокет (вместо канала Output)
+  Receive           , ///< данные сокета записываются в файл (вместо канала Input)
+};
+
+/**
+ * @brief Тип file_progress_t определяет обработчик хода передачи файла:
+ *        количество переданных байт и размер файла (0 - размер неизвестен,
+ *        прием до закрытия подключения другой стороной).
+ */
+using file_progress_t           = spo::simple_fnc_t< void, std::uint64_t, std::uint64_t >;
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс AsioFileTransfer содержит файл и состояние его передачи через
+ *        сокет одной сессии.
+ *
+ * @par Пример использования:
+ * @code language="cpp"
+ *  server.SetFileTransferFactory(
+ *        []()
+ *        {
+ *          auto transfer( std::make_shared< spo::asio::AsioFileTransfer >() );
+ *          spo::asio::error_t ec;
+ *          transfer->OpenSend( "/var/lib/app/update.pkg", ec );
+ *          transfer->SetProgress( []( std::uint64_t done, std::uint64_t total ) { ... } );
+ *          return transfer;
+ *        } );
+ * @endcode
+ */
+class SPO_CORE_EXPORT             AsioFileTransfer
+{
+public:
+  /**
+   * @brief Константа CHUNK_SIZE ограничивает объем данных одного системного
+   *        вызова (и размер буфера переноса без sendfile/splice), байт.
+   */
+  static const std::size_t        CHUNK_SIZE        = 1 << 20;
+
+  /**/                            AsioFileTransfer  () = default;
+  ~ AsioFileTransfer ();
+
+  AsioFileTransfer ( const AsioFileTransfer & ) = delete;
+  AsioFileTransfer & operator = ( const AsioFileTransfer & ) = delete;
+
+  /**
+   * @brief Метод OpenSend открывает файл для передачи.
+   * @param path   путь файла;
+   * @param ec     код ошибки;
+   * @param offset смещение начала передачи (продолжение прерванной передачи).
+   * @return Признак открытия файла.
+   */
+  bool OpenSend ( const std::string & path, error_t & ec, std::uint64_t offset = 0 );
+
+  /**
+   * @brief Метод OpenReceive создает (перезаписывает) файл для приема.
+   * @param path  путь файла;
+   * @param ec    код ошибки;
+   * @param total ожидаемый размер (0 - прием до закрытия подключения).
+   * @return Признак открытия файла.
+   */
+  bool OpenReceive ( const std::string & path, error_t & ec, std::uint64_t total = 0 );
+
+  bool                            IsOpen            () const { return m_File >= 0; }
+  FileDirection                   Direction         () const { return m_Direction; }
+  std::uint64_t                   Done              () const { return m_Done; }
+  std::uint64_t                   Total             () const { return m_Total; }
+  bool                            IsComplete        () const { return m_Complete; }
+
+  void SetProgress ( const file_progress_t & progress ) { m_Progress = progress; }
+
+  /**
+   * @brief Метод Transfer выполняет очередной шаг передачи через сокет
+   *        @a socketHandle в неблокирующем режиме.
+   * @param socketHandle дескриптор сокета;
+   * @param ec           код ошибки: @a boost::asio::error::would_block -
+   *                     ожидание готовности сокета.
+   * @return количество перенесенных байт.
+   */
+  std::size_t Transfer ( int socketHandle, error_t & ec );
+
+  void Close ();
+
+private:
+  std::size_t Send ( int socketHandle, error_t & ec );
+  std::size_t Receive ( int socketHandle, error_t & ec );
+  void Advance ( std::size_t size );
+
+  int                             m_File            { -1 };
+  int                             m_Pipe[ 2 ]       { -1, -1 };
+  FileDirection                   m_Direction       { FileDirection::Send };
+  std::atomic< std::uint64_t >    m_Done            { 0 };
+  std::uint64_t                   m_Offset          { 0 };
+  std::uint64_t                   m_Total           { 0 };
+  std::atomic_bool                m_Complete        { false };
+  /**
+   * @brief Атрибут m_ZeroCopy содержит признак поддержки sendfile/splice
+   *        для файла и сокета (сбрасывается при первом отказе ядра).
+   */
+  bool                            m_ZeroCopy        { true };
+  /**
+   * @brief Атрибут m_Buffer содержит буфер переноса данных без
+   *        sendfile/splice (выделяется при первом использовании).
+   */
+  std::vector< char >             m_Buffer;
+  file_progress_t                 m_Progress;
+};
+
+using file_transfer_ptr_t       = std::shared_ptr< AsioFileTransfer >;
+
+/**
+ * @brief Тип file_transfer_factory_t определяет фабрику передач файлов для
+ *        сессий сервера или клиента (пустой указатель - обмен обработчиками
+ *        каналов).
+ */
+using file_transfer_factory_t   = spo::simple_fnc_t< file_transfer_ptr_t >;
+
+//------------------------------------------------------------------------------
+}// namespace                   asio
+}// namespace                   spo
+
+#endif // ASIOFILETRANSFER_H
@@ -0,0 +1,317 @@
+/**
+  * @file AsioLinkServer.h
+  * @brief Файл AsioLinkServer.h содержит шаблоны классов
+  *        @a spo::asio::AsioLinkServer и @a spo::asio::AsioLinkClient -
+  *        общие части серверов и клиентов, обслуживающих подключение одним
+  *        каналом, существующим до закрытия подключения
+  *        ( @a spo::asio::AsioMuxLink, @a spo::asio::AsioShmLink ).
+  *
+  * Сервер принимает подключения, создает канал подключения, проверяет его
+  * фильтром подключений и только после этого подготавливает канал к обмену
+  * ( @a AsioLinkServer::OpenLink ), учитывает в количестве сокетов и
+  * запускает. Производные классы определяют создание и подготовку канала.
+  *
+  * Канал должен предоставлять методы SetAfterStop, Start и Stop.
+  */
+
+#ifndef ASIOLINKSERVER_H
+#define ASIOLINKSERVER_H
+
+#include "asio/AsioLocal.h"
+#include "asio/ClientServerBase.h"
+
+namespace                         spo   {
+namespace                         asio  {
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Функция StartCountedLink учитывает канал в количестве сокетов
+ *        сервера (клиента) @a owner до завершения канала и запускает канал.
+ */
+template< typename OwnerT_, typename LinkT_ >
+void StartCountedLink ( OwnerT_ & owner, const std::shared_ptr< LinkT_ > & link )
+{
+  owner.IncSocketsCount();
+  link->SetAfterStop(
+        []( void * ptr )
+        {
+          if( nullptr != ptr )
+            reinterpret_cast< OwnerT_ * >( ptr )->DecSocketsCount();
+        },
+        & owner );
+  link->Start();
+}
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс AsioLinkServer определяет прием подключений, каждое из
+ *        которых обслуживается каналом @a LinkT_.
+ *
+ * Параметры шаблона:
+ * @value ProtocolT_ потоковый протокол (TCP или локальный сокет);
+ * @value LinkT_     тип канала подключения;
+ * @value ByteT_     тип единицы информации для каналов обмена данными.
+ */
+template< typename ProtocolT_, typename LinkT_, typename ByteT_ = unsigned char >
+class SPO_CORE_EXPORT             AsioLinkServer :
+public                            spo::asio::ClientServerBase< ProtocolT_, ByteT_ >
+{
+public:
+  using self_t                  = spo::asio::AsioLinkServer< ProtocolT_, LinkT_, ByteT_ >;
+  using base_class_t            = spo::asio::ClientServerBase< ProtocolT_, ByteT_ >;
+  using link_t                  = LinkT_;
+  using link_shr_t              = std::shared_ptr< link_t >;
+  using socket_t                = typename ProtocolT_::socket;
+  using endpoint_type           = typename ProtocolT_::endpoint;
+  /**
+   * @brief Тип accept_filter_t определяет фильтр подключений: канал, для
+   *        которого фильтр вернул false, закрывается до подготовки к обмену
+   *        ( @a OpenLink ).
+   */
+  using accept_filter_t         = spo::simple_fnc_t< bool, link_shr_t >;
+
+  /**
+   * @brief Конструктор AsioLinkServer
+   * @param type             тип (режим) обмена данными;
+   * @param endpoint         адрес приема подключений;
+   * @param serviceTimeoutMs время ожидания сервиса.
+   */
+  explicit AsioLinkServer
+  (
+      spo::asio::TransferType         type,
+      const endpoint_type           & endpoint,
+      std::int64_t                    serviceTimeoutMs  = 10000
+  )
+    : base_class_t    ( type, serviceTimeoutMs )
+    , m_Endpoint      ( endpoint )
+    , m_Acceptor      ( AsioService::Instance().ServiceRef() )
+  {
+    AsioService::Instance().AddBeforeStartCallback
+        ( {
+            []( void * ptr )
+            {
+              if( nullptr != ptr )
+                reinterpret_cast< self_t * >( ptr )->StartAcceptor();
+            },
+            this
+          } );
+    AsioService::Instance().AddBeforeStopCallback
+        ( {
+            []( void * ptr )
+            {
+              if( nullptr != ptr )
+                reinterpret_cast< self_t * >( ptr )->StopAcceptor();
+            },
+            this
+          } );
+  }
+
+  virtual ~ AsioLinkServer () = default;
+
+  const endpoint_type           & Endpoint          () const { return m_Endpoint; }
+  bool                            IsOpen            () const { return m_Acceptor.is_open(); }
+
+  /**
+   * @brief Метод SetAcceptFilter назначает фильтр подключений.
+   */
+  void SetAcceptFilter ( const accept_filter_t & filter )
+  {
+    m_AcceptFilter = filter;
+  }
+
+  /**
+   * @brief Метод StartAcceptor открывает сокет подключений и запускает прием
+   *        клиентов.
+   */
+  void StartAcceptor ()
+  {
+    error_t ec;
+    if( UnlinkLocalEndpoint( m_Endpoint, ec ) )
+      m_Acceptor.open( m_Endpoint.protocol(), ec );
+    if( IsNoErr( ec ) )
+      m_Acceptor.set_option( boost::asio::socket_base::reuse_address( true ), ec );
+    if( IsNoErr( ec ) )
+      m_Acceptor.bind( m_Endpoint, ec );
+    if( IsNoErr( ec ) )
+      m_Acceptor.listen( base_class_t::SocketsLimit(), ec );
+    if( not IsNoErr( ec ) )
+    {
+      DUMP_BOOST_ERROR( ec );
+      m_Acceptor.close( ec );
+      return;
+    }
+
+    try
+    {
+      boost::asio::spawn(
+            io_strand_t( AsioService::Instance().ServiceRef() ),
+            boost::bind( & self_t::AcceptorAction, this, _1 ) );
+    }
+    catch ( const std::exception & e )
+    {
+      DUMP_EXCEPTION( e );
+    }
+  }
+
+  /**
+   * @brief Метод StopAcceptor прекращает прием клиентов. Подключенные
+   *        каналы завершаются сервисом ( @a AsioService::Drain или останов).
+   */
+  void StopAcceptor ()
+  {
+    error_t ec;
+    m_Acceptor.cancel( ec );
+    m_Acceptor.close( ec );
+    UnlinkLocalEndpoint( m_Endpoint, ec );
+  }
+
+protected:
+  /**
+   * @brief Метод MakeLink создает канал принятого подключения (до проверки
+   *        фильтром подключений).
+   */
+  virtual link_shr_t MakeLink ( socket_t && socket ) = 0;
+
+  /**
+   * @brief Метод OpenLink подготавливает к обмену канал, прошедший фильтр
+   *        подключений.
+   * @return false - канал закрывается.
+   */
+  virtual bool OpenLink ( const link_shr_t & link, error_t & ec )
+  {
+    UNUSED( link );
+    ec = error_t();
+    return true;
+  }
+
+private:
+  endpoint_type                   m_Endpoint;
+  typename ProtocolT_::acceptor   m_Acceptor;
+  accept_filter_t                 m_AcceptFilter;
+
+  /**
+   * @brief Метод AcceptorAction принимает подключения клиентов и создает
+   *        каналы.
+   * @param yield контекст передачи управления очередной сопрограмме
+   */
+  void AcceptorAction ( boost::asio::yield_context yield )
+  {
+    while( IsOpen() )
+    {
+      error_t ec;
+      socket_t socket( AsioService::Instance().ServiceRef() );
+      m_Acceptor.async_accept( socket, yield[ ec ] );
+      if( not IsNoErr( ec ) )
+      {
+        if( ec == boost::asio::error::operation_aborted )
+          return;
+        continue;
+      }
+
+      if( ( not base_class_t::SocketsValid() ) or AsioService::Instance().IsDraining() )
+        continue;
+
+      auto link( MakeLink( std::move( socket ) ) );
+      if( not link )
+        continue;
+      if( m_AcceptFilter and ( not m_AcceptFilter( link ) ) )
+      {
+        link->Stop();
+        continue;
+      }
+      if( not OpenLink( link, ec ) )
+      {
+        DUMP_BOOST_ERROR( ec );
+        link->Stop();
+        continue;
+      }
+
+      StartCountedLink( * this, link );
+    }
+  }
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс AsioLinkClient определяет подключение к серверу
+ *        @a AsioLinkServer.
+ *
+ * Параметры шаблона:
+ * @value ProtocolT_ потоковый протокол (TCP или локальный сокет);
+ * @value LinkT_     тип канала подключения;
+ * @value ByteT_     тип единицы информации для каналов обмена данными.
+ */
+template< typename ProtocolT_, typename LinkT_, typename ByteT_ = unsigned char >
+class SPO_CORE_EXPORT             AsioLinkClient :
+public                            spo::asio::ClientServerBase< ProtocolT_, ByteT_ >
+{
+public:
+  using self_t                  = spo::asio::AsioLinkClient< ProtocolT_, LinkT_, ByteT_ >;
+  using base_class_t            = spo::asio::ClientServerBase< ProtocolT_, ByteT_ >;
+  using link_t                  = LinkT_;
+  using link_shr_t              = std::shared_ptr< link_t >;
+  using socket_t                = typename ProtocolT_::socket;
+  using endpoint_type           = typename ProtocolT_::endpoint;
+
+  explicit AsioLinkClient
+  (
+      spo::asio::TransferType         type,
+      const endpoint_type           & endpoint,
+      std::int64_t                    serviceTimeoutMs  = 10000
+  )
+    : base_class_t    ( type, serviceTimeoutMs )
+    , m_Endpoint      ( endpoint )
+  {}
+
+  virtual ~ AsioLinkClient () = default;
+
+  const endpoint_type           & Endpoint          () const { return m_Endpoint; }
+
+  /**
+   * @brief Метод Connect подключается к серверу и запускает канал в сервисе
+   *        @a AsioService (обмен начинается после запуска сервиса).
+   * @param ec код ошибки подключения.
+   * @return канал или пустой указатель при ошибке.
+   */
+  link_shr_t Connect ( error_t & ec )
+  {
+    ec = error_t();
+    if( AsioService::Instance().IsDraining() )
+    {
+      ec = boost::asio::error::operation_aborted;
+      return link_shr_t();
+    }
+    if( not base_class_t::SocketsValid() )
+    {
+      AsioService::Instance().SetState( AsioState::ErrSocketCount );
+      ec = boost::asio::error::no_buffer_space;
+      return link_shr_t();
+    }
+
+    socket_t socket( AsioService::Instance().ServiceRef() );
+    socket.connect( m_Endpoint, ec );
+    if( not IsNoErr( ec ) )
+      return link_shr_t();
+
+    auto retval( MakeLink( std::move( socket ), ec ) );
+    if( retval )
+      StartCountedLink( * this, retval );
+    return retval;
+  }
+
+protected:
+  /**
+   * @brief Метод MakeLink создает канал подключения к серверу.
+   * @return канал или пустой указатель при ошибке ( @a ec ).
+   */
+  virtual link_shr_t MakeLink ( socket_t && socket, error_t & ec ) = 0;
+
+private:
+  endpoint_type                   m_Endpoint;
+};
+
+//------------------------------------------------------------------------------
+}// namespace                   asio
+}// namespace                   spo
+
+#endif // ASIOLINKSERVER_H
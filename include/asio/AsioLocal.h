@@ -0,0 +1,130 @@
+/**
+  * @file AsioLocal.h
+  * @brief Файл AsioLocal.h содержит средства работы с локальными сокетами
+  *        (сокетами домена Unix): учетные данные процесса другой стороны
+  *        @a spo::asio::PeerCredentials и освобождение пути сокета перед
+  *        привязкой.
+  *
+  * Локальные сокеты обслуживают обмен между процессами одного узла без стека
+  * TCP/IP. Серверы локальных сокетов - @a spo::asio::AsioLocalServer и
+  * @a spo::asio::AsioLocalDatagramServer (файл asio/AsioLocalServer.h),
+  * клиент - @a spo::asio::AsioClient с протоколом @a local_stream_t или
+  * @a local_datagram_t и путем сокета вместо имени хоста.
+  *
+  * Путь, начинающийся с символа '\0', задает сокет абстрактного пространства
+  * имен Linux (без файла в файловой системе).
+  */
+
+#ifndef ASIOLOCAL_H
+#define ASIOLOCAL_H
+
+#include "asio/AsioCommon.h"
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace                         spo   {
+namespace                         asio  {
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Структура PeerCredentials содержит учетные данные процесса другой
+ *        стороны локального сокета на момент подключения.
+ */
+struct                            PeerCredentials
+{
+  pid_t                           m_Pid             { -1 };
+  uid_t                           m_Uid             { uid_t( -1 ) };
+  gid_t                           m_Gid             { gid_t( -1 ) };
+};
+
+/**
+ * @brief Метод ReadPeerCredentials получает учетные данные процесса другой
+ *        стороны подключенного сокета @a nativeHandle (SO_PEERCRED).
+ * @param nativeHandle дескриптор сокета;
+ * @param credentials  учетные данные;
+ * @param ec           код ошибки.
+ * @return Признак получения учетных данных.
+ */
+inline
+bool ReadPeerCredentials ( int nativeHandle, PeerCredentials & credentials, error_t & ec )
+{
+  ec = error_t();
+#if defined( SO_PEERCRED )
+  ucred cred;
+  socklen_t len( sizeof( cred ) );
+  if( ::getsockopt( nativeHandle, SOL_SOCKET, SO_PEERCRED, & cred, & len ) != 0 )
+    ec = error_t( errno, boost::system::system_category() );
+  else
+  {
+    credentials.m_Pid = cred.pid;
+    credentials.m_Uid = cred.uid;
+    credentials.m_Gid = cred.gid;
+  }
+#else
+  UNUSED( nativeHandle );
+  UNUSED( credentials );
+  ec = boost::asio::error::operation_not_supported;
+#endif
+  return IsNoErr( ec );
+}
+
+/**
+ * @brief Метод UnlinkLocalEndpoint удаляет файл локального сокета, оставшийся
+ *        от предыдущего запуска сервера, перед привязкой. Для конечных точек
+ *        IP и абстрактных локальных сокетов ничего не выполняет.
+ *
+ * Файл удаляется, только если подключение к нему отклонено (ECONNREFUSED):
+ * сокет, который обслуживает работающий сервер, не освобождается.
+ *
+ * @param endpoint конечная точка;
+ * @param ec       код ошибки: @a boost::asio::error::address_in_use, если
+ *        путь обслуживается другим процессом.
+ * @return Признак допустимости привязки.
+ */
+template< typename                EndpointT_ >
+bool UnlinkLocalEndpoint ( const EndpointT_ & endpoint, error_t & ec )
+{
+  UNUSED( endpoint );
+  ec = error_t();
+  return true;
+}
+
+template< typename                ProtocolT_ >
+bool UnlinkLocalEndpoint ( const boost::asio::local::basic_endpoint< ProtocolT_ > & endpoint, error_t & ec )
+{
+  ec = error_t();
+  auto path( endpoint.path() );
+  if( path.empty() or ( path[ 0 ] == '\0' ) )
+    return true;
+
+  // пробное подключение не ожидает освобождения очереди подключений сервера
+  const int fd( ::socket( AF_UNIX, endpoint.protocol().type() | SOCK_NONBLOCK | SOCK_CLOEXEC, 0 ) );
+  if( fd < 0 )
+  {
+    ec = error_t( errno, boost::system::system_category() );
+    return false;
+  }
+  const int rc( ::connect( fd, endpoint.data(), static_cast< socklen_t >( endpoint.size() ) ) );
+  const int error( rc == 0 ? 0 : errno );
+  ::close( fd );
+
+  if( error == ECONNREFUSED )
+  { // файл остался от завершенного процесса
+    ::unlink( path.c_str() );
+    return true;
+  }
+  if( ( error == 0 ) or ( error == EAGAIN ) )
+  { // путь обслуживается работающим сервером
+    ec = boost::asio::error::address_in_use;
+    return false;
+  }
+  // файл отсутствует или недоступен: ошибку сообщает привязка
+  return true;
+}
+
+//------------------------------------------------------------------------------
+}// namespace                   asio
+}// namespace                   spo
+
+#endif // ASIOLOCAL_H
@@ -0,0 +1,54 @@
+/**
+  * @file AsioLocalServer.h
+  * @brief Файл AsioLocalServer.h содержит объявления серверов локальных
+  *        сокетов (сокетов домена Unix) для обмена между процессами одного
+  *        узла без стека TCP/IP.
+  *
+  * Серверы реализуются серверами TCP и UDP с протоколами локальных сокетов и
+  * создаются по пути сокета:
+  * @code language="cpp"
+  *  spo::asio::AsioLocalServer< char > server( spo::asio::TransferType::HalfDuplexIn,
+  *                                             std::string( "/run/app/app.sock" ) );
+  *  server.SetAcceptFilter(
+  *        []( spo::asio::AsioLocalServer< char >::session_shr_t session )
+  *        {
+  *          spo::asio::PeerCredentials cred;
+  *          spo::asio::error_t ec;
+  *          return session->ReadPeerCredentials( cred, ec ) and ( cred.m_Uid == ::getuid() );
+  *        } );
+  * @endcode
+  *
+  * Файл сокета, оставшийся от предыдущего запуска, удаляется перед привязкой.
+  * Сервер датаграмм отвечает (HalfDuplexIn) только клиентам, сокет которых
+  * привязан к пути.
+  */
+
+#ifndef ASIOLOCALSERVER_H
+#define ASIOLOCALSERVER_H
+
+#include "asio/AsioTCPServer.h"
+#include "asio/AsioUDPServer.h"
+
+namespace                         spo   {
+namespace                         asio  {
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Тип AsioLocalServer определяет сервер потоковых локальных сокетов.
+ */
+template< typename                ByteT_ >
+using AsioLocalServer           = spo::asio::AsioTCPServer< ByteT_, spo::asio::local_stream_t >;
+
+/**
+ * @brief Тип AsioLocalDatagramServer определяет сервер датаграммных локальных
+ *        сокетов.
+ */
+template< typename                ByteT_ >
+using AsioLocalDatagramServer   = spo::asio::AsioUDPServer< ByteT_, spo::asio::local_datagram_t >;
+
+//------------------------------------------------------------------------------
+
+}// namespace                     asio
+}// namespace                     spo
+
+#endif // ASIOLOCALSERVER_H
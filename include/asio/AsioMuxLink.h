@@ -0,0 +1,860 @@
+/**
+  * @file AsioMuxLink.h
+  * @brief Файл AsioMuxLink.h содержит объявление шаблонного класса
+  *        @a spo::asio::AsioMuxLink канала обмена документами несколькими
+  *        независимыми логическими потоками через одно подключение потокового
+  *        сокета (TCP или локального сокета).
+  *
+  * Документы потоков передаются кадрами @a spo::asio::MuxFrame с номером
+  * потока. Документ, превышающий @a AsioMuxLink::CHUNK_SIZE, передается
+  * несколькими кадрами; кадры разных потоков чередуются. Каждый поток имеет
+  * окно передачи (управление потоком): отправитель передает не более
+  * @a AsioMuxLink::WINDOW_SIZE байт без подтверждения получателя, получатель
+  * возвращает окно кадром @a MuxFrame::Window после приема данных. Поток,
+  * прием которого приостановлен ( @a AsioMuxLink::PauseStream ), не
+  * возвращает окно и не задерживает обмен других потоков.
+  *
+  * Как и канал разделяемой памяти ( @a spo::asio::AsioShmLink ), канал
+  * существует до закрытия подключения любой из сторон.
+  */
+
+#ifndef ASIOMUXLINK_H
+#define ASIOMUXLINK_H
+
+#include "asio/AsioService.h"
+#include "asio/IOChannel.h"
+#include "core/documents/FrameHeader.h"
+#include <array>
+#include <deque>
+#include <map>
+
+namespace                         spo   {
+namespace                         asio  {
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Структура MuxFrame содержит заголовок кадра канала с логическими
+ *        потоками.
+ *
+ * Формат кадра:
+ * @code
+ *   [тип: 1 байт][признаки: 1 байт][номер потока: 4 байта][длина: 4 байта][данные]
+ * @endcode
+ * Номер потока и длина передаются в сетевом порядке. Кадр
+ * @a MuxFrame::Window не содержит данных: поле длины содержит объем
+ * возвращаемого окна.
+ */
+struct                            MuxFrame
+{
+  static const std::size_t        HEADER_SIZE       = 10;
+  static const std::uint8_t       FLAG_LAST         = 0x01;
+
+  /**
+   * @brief Перечисление Type определяет тип кадра.
+   */
+  enum                            Type : std::uint8_t
+  {
+    Data                        = 0,  ///< часть документа потока
+    Window                      = 1,  ///< возврат окна передачи потока
+    Close                       = 2,  ///< завершение передачи потока
+  };
+
+  using header_t                = std::array< unsigned char, HEADER_SIZE >;
+
+  std::uint8_t                    m_Type            { Data };
+  std::uint8_t                    m_Flags           { 0 };
+  std::uint32_t                   m_Stream          { 0 };
+  std::uint32_t                   m_Length          { 0 };
+
+  bool IsLast () const { return ( m_Flags & FLAG_LAST ) != 0; }
+
+  header_t Write () const
+  {
+    header_t retval;
+    spo::core::docs::FrameHeaderWriter( retval.data() )
+        .Byte( m_Type ).Byte( m_Flags ).Fixed32( m_Stream ).Fixed32( m_Length );
+    return retval;
+  }
+
+  void Read ( const unsigned char * data )
+  {
+    spo::core::docs::FrameHeaderReader in( data );
+    m_Type    = in.Byte();
+    m_Flags   = in.Byte();
+    m_Stream  = in.Fixed32();
+    m_Length  = in.Fixed32();
+  }
+};
+
+/**
+ * @brief Структура MuxMetrics содержит счетчики канала с логическими
+ *        потоками.
+ */
+struct                            MuxMetrics
+{
+  std::atomic< std::uint64_t >    m_Received        { 0 }; ///< принятые документы
+  std::atomic< std::uint64_t >    m_Sent            { 0 }; ///< переданные документы
+  std::atomic< std::uint64_t >    m_Frames          { 0 }; ///< переданные кадры
+  std::atomic< std::uint64_t >    m_Writes          { 0 }; ///< записи в сокет
+  std::atomic< std::uint64_t >    m_Streams         { 0 }; ///< открытые потоки (обеими сторонами)
+  std::atomic< std::uint64_t >    m_Blocked         { 0 }; ///< ожидания окна передачи потоками
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс AsioMuxLink определяет канал обмена документами логическими
+ *        потоками через одно подключение.
+ *
+ * Параметры шаблона:
+ * @value ProtocolT_ потоковый протокол сокета подключения;
+ * @value ByteT_     тип единицы информации документов.
+ *
+ * Потоки открываются любой стороной ( @a OpenStream ): номера потоков
+ * стороны, выполнившей подключение, нечетные, другой стороны - четные.
+ * Документы потока, открытого другой стороной, передаются обработчику,
+ * назначенному @a SetStreamOpened, или обработчику канала приема. В режиме
+ * HalfDuplexIn после обработки принятого документа выполняется обработчик
+ * канала передачи, и сформированный документ передается тем же потоком.
+ *
+ * Состояние канала изменяется в последовательности ( @a io_strand_t )
+ * канала; открытые методы допускают вызов из любого потока.
+ *
+ * @par Пример использования:
+ * @code language="cpp"
+ *  auto link( client.Connect( ec ) );
+ *  auto control( link->OpenStream( on_control ) );
+ *  auto bulk( link->OpenStream( on_bulk ) );
+ *  link->Send( bulk, large_document );
+ *  link->Send( control, command ); // не ожидает передачи large_document
+ * @endcode
+ */
+template< typename ProtocolT_, typename ByteT_ = unsigned char >
+class SPO_CORE_EXPORT             AsioMuxLink :
+public                            std::enable_shared_from_this< spo::asio::AsioMuxLink< ProtocolT_, ByteT_ > >
+{
+public:
+  using self_t                  = spo::asio::AsioMuxLink< ProtocolT_, ByteT_ >;
+  using socket_t                = typename ProtocolT_::socket;
+  using channel_t               = spo::asio::IOChannel< ByteT_ >;
+  using buffer_t                = typename channel_t::buffer_t;
+  using action_t                = io_channel_action_t< ByteT_ >;
+  using content_t               = spo::socket_byffer_t< ByteT_ >;
+  using content_ptr_t           = std::shared_ptr< const content_t >;
+  /**
+   * @brief Тип stream_opened_t определяет обработчик открытия потока другой
+   *        стороной: возвращает обработчик документов потока (пустой -
+   *        обработчик канала приема).
+   */
+  using stream_opened_t         = spo::simple_fnc_t< action_t, std::uint32_t >;
+
+  /**
+   * @brief Константа WINDOW_SIZE содержит окно передачи потока, байт
+   *        (одинаково для обеих сторон).
+   */
+  static const std::uint32_t      WINDOW_SIZE       = 256 * 1024;
+  /**
+   * @brief Константа CHUNK_SIZE ограничивает размер данных кадра, байт.
+   */
+  static const std::uint32_t      CHUNK_SIZE        = 16 * 1024;
+  /**
+   * @brief Константа WRITE_SIZE ограничивает объем данных одной записи в
+   *        сокет, байт.
+   */
+  static const std::size_t        WRITE_SIZE        = 64 * 1024;
+  /**
+   * @brief Константа DOCUMENT_SIZE_MAX ограничивает размер принимаемого
+   *        документа, байт (превышение - нарушение формата, канал
+   *        закрывается).
+   */
+  static const std::size_t        DOCUMENT_SIZE_MAX = 64 * 1024 * 1024;
+  /**
+   * @brief Константа STREAMS_MAX ограничивает количество потоков канала,
+   *        открытых другой стороной (каждый поток может удерживать окно
+   *        принятых данных).
+   */
+  static const std::size_t        STREAMS_MAX       = 256;
+  /**
+   * @brief Константа READY_MAX ограничивает количество принятых документов
+   *        потока, ожидающих обработчика (документы без данных не
+   *        расходуют окно передачи).
+   */
+  static const std::size_t        READY_MAX         = 1024;
+
+  /**
+   * @brief Конструктор AsioMuxLink
+   * @param type      тип (режим) обмена данными;
+   * @param socket    подключенный сокет;
+   * @param initiator признак стороны, выполнившей подключение;
+   * @param actions   обработчики каналов приема и передачи.
+   */
+  /**/                            AsioMuxLink
+  (
+      spo::asio::TransferType                 type,
+      socket_t                             && socket,
+      bool                                    initiator,
+      const buffer_actions_map< ByteT_ >    & actions
+  )
+    : m_Type        ( type )
+    , m_Socket      ( std::move( socket ) )
+    , m_Strand      ( ServiceOf( m_Socket ) )
+    , m_NextStream  ( initiator ? 1 : 2 )
+  {
+    assert( actions.size() == spo::asio::DataType::DataSize );
+    for( auto & action : actions )
+      m_Channels.emplace_back( action.second );
+    m_ReadBuffer.resize( WRITE_SIZE );
+  }
+
+  ~ AsioMuxLink ()
+  {
+    AsioService::Instance().UnregisterSession( this );
+  }
+
+  io_service_t                  & ServiceRef        () { return ServiceOf( m_Socket ); }
+  socket_t                      & SocketRef         () { return m_Socket; }
+  const MuxMetrics              & MetricsRef        () const { return m_Metrics; }
+  spo::asio::TransferType         TransferType      () const { return m_Type; }
+  bool                            IsOpen            () const { return m_Open; }
+
+  /**
+   * @brief Метод SetStreamOpened назначает обработчик открытия потоков
+   *        другой стороной. Назначается до вызова @a Start.
+   */
+  void SetStreamOpened ( const stream_opened_t & opened )
+  {
+    m_StreamOpened = opened;
+  }
+
+  /**
+   * @brief Метод SetAfterStop назначает обработчик завершения канала
+   *        (вызывается однократно).
+   */
+  void SetAfterStop ( const spo::asio::io_service_callback_t & f, void * stopParamPtr = nullptr )
+  {
+    m_AfterStop     = f;
+    m_StopParamPtr  = stopParamPtr;
+  }
+
+  /**
+   * @brief Метод Start запускает прием кадров.
+   */
+  void Start ()
+  {
+    auto self( this->shared_from_this() );
+    std::weak_ptr< self_t > weak_self( self );
+    // состояние канала проверяется в его последовательности
+    AsioService::Instance().RegisterSession(
+          this,
+          [ weak_self ]( bool force )
+          {
+            auto link_ptr( weak_self.lock() );
+            if( link_ptr )
+              link_ptr->m_Strand.post(
+                    [ weak_self, force ]()
+                    {
+                      auto link_ptr( weak_self.lock() );
+                      if( link_ptr and ( force or link_ptr->IsIdle() ) )
+                        link_ptr->Stop();
+                    } );
+          } );
+
+    m_Open = true;
+    m_Strand.post( [ self ]() { self->Read(); } );
+  }
+
+  /**
+   * @brief Метод Stop закрывает подключение.
+   */
+  void Stop ()
+  {
+    error_t ec;
+    AsioService::Instance().UnregisterSession( this );
+    m_Open = false;
+    if( m_Socket.is_open() )
+    {
+      m_Socket.shutdown( boost::asio::socket_base::shutdown_both, ec );
+      m_Socket.close( ec );
+    }
+    if( m_AfterStop and ( not m_Stopped.exchange( true ) ) )
+      m_AfterStop( m_StopParamPtr );
+  }
+
+  /**
+   * @brief Метод IsIdle сообщает об отсутствии документов в обработке:
+   *        частично принятых и ожидающих передачи.
+   */
+  bool IsIdle ()
+  {
+    return m_Idle;
+  }
+
+  /**
+   * @brief Метод OpenStream открывает поток.
+   * @param action обработчик документов потока (пустой - обработчик канала
+   *               приема).
+   * @return номер потока или 0, если канал закрыт.
+   */
+  std::uint32_t OpenStream ( const action_t & action = action_t() )
+  {
+    if( not IsOpen() )
+      return 0;
+    const std::uint32_t stream( m_NextStream.fetch_add( 2 ) );
+    auto self( this->shared_from_this() );
+    m_Strand.dispatch( [ self, stream, action ]() { self->StreamRef( stream ).m_Action = action; } );
+    return stream;
+  }
+
+  /**
+   * @brief Метод SetStreamAction назначает обработчик документов потока.
+   */
+  void SetStreamAction ( std::uint32_t stream, const action_t & action )
+  {
+    auto self( this->shared_from_this() );
+    m_Strand.dispatch( [ self, stream, action ]() { self->StreamRef( stream ).m_Action = action; } );
+  }
+
+  /**
+   * @brief Метод Send передает копию документа @a document потоком
+   *        @a stream.
+   * @return false, если канал закрыт или номер потока равен 0.
+   */
+  bool Send ( std::uint32_t stream, const buffer_t & document )
+  {
+    if( ( not IsOpen() ) or ( stream == 0 ) )
+      return false;
+    auto self( this->shared_from_this() );
+    content_ptr_t content( std::make_shared< content_t >( const_cast< buffer_t & >( document ).ContentRef() ) );
+    m_Strand.dispatch(
+          [ self, stream, content ]()
+          {
+            self->StreamRef( stream ).m_Outbound.push_back( Item { content, 0, false } );
+            self->Flush();
+          } );
+    return true;
+  }
+
+  /**
+   * @brief Метод CloseStream завершает передачу потоком после передачи
+   *        документов его очереди. Поток удаляется после завершения
+   *        передачи обеими сторонами.
+   */
+  void CloseStream ( std::uint32_t stream )
+  {
+    auto self( this->shared_from_this() );
+    m_Strand.dispatch(
+          [ self, stream ]()
+          {
+            self->StreamRef( stream ).m_Outbound.push_back( Item { content_ptr_t(), 0, true } );
+            self->Flush();
+          } );
+  }
+
+  /**
+   * @brief Метод PauseStream приостанавливает передачу принятых документов
+   *        потока обработчику: окно передачи не возвращается, другая
+   *        сторона прекращает передачу потоком после исчерпания окна.
+   */
+  void PauseStream ( std::uint32_t stream )
+  {
+    auto self( this->shared_from_this() );
+    m_Strand.dispatch( [ self, stream ]() { self->StreamRef( stream ).m_Paused = true; } );
+  }
+
+  /**
+   * @brief Метод ResumeStream передает обработчику документы, принятые во
+   *        время паузы, и возвращает окно передачи.
+   */
+  void ResumeStream ( std::uint32_t stream )
+  {
+    auto self( this->shared_from_this() );
+    m_Strand.dispatch(
+          [ self, stream ]()
+          {
+            auto found( self->m_Streams.find( stream ) );
+            if( found == self->m_Streams.end() )
+              return;
+            found->second.m_Paused = false;
+            self->Deliver( stream );
+          } );
+  }
+
+private:
+  /**
+   * @brief Структура Item содержит документ очереди передачи потока или
+   *        признак завершения передачи.
+   */
+  struct                          Item
+  {
+    content_ptr_t                 m_Content;
+    std::size_t                   m_Offset;
+    bool                          m_Close;
+  };
+
+  /**
+   * @brief Структура Stream содержит состояние логического потока.
+   */
+  struct                          Stream
+  {
+    action_t                      m_Action;
+    std::deque< Item >            m_Outbound;
+    std::int64_t                  m_Window          { WINDOW_SIZE };
+    /**
+     * @brief Атрибут m_Inbound содержит принимаемый документ.
+     */
+    content_t                     m_Inbound;
+    /**
+     * @brief Атрибут m_Ready содержит документы, принятые во время паузы
+     *        (не более @a READY_MAX ).
+     */
+    std::deque< content_t >       m_Ready;
+    /**
+     * @brief Атрибут m_Unacked содержит объем принятых данных, окно для
+     *        которых не возвращено (не более @a WINDOW_SIZE ).
+     */
+    std::uint32_t                 m_Unacked         { 0 };
+    bool                          m_Paused          { false };
+    /**
+     * @brief Атрибут m_Announced содержит признак вызова обработчика
+     *        открытия потока другой стороной.
+     */
+    bool                          m_Announced       { false };
+    bool                          m_LocalClosed     { false };
+    bool                          m_RemoteClosed    { false };
+    bool                          m_Blocked         { false };
+  };
+
+  /**
+   * @brief Структура Piece содержит кадр текущей записи.
+   */
+  struct                          Piece
+  {
+    MuxFrame::header_t            m_Header;
+    content_ptr_t                 m_Content;
+    std::size_t                   m_Offset;
+    std::size_t                   m_Size;
+    bool                          m_Last;
+  };
+
+  spo::asio::TransferType         m_Type;
+  socket_t                        m_Socket;
+  io_strand_t                     m_Strand;
+  std::vector< channel_t >        m_Channels;
+  std::map< std::uint32_t, Stream > m_Streams;
+  /**
+   * @brief Атрибут m_Control содержит кадры возврата окна, ожидающие
+   *        записи (передаются перед кадрами данных).
+   */
+  std::deque< MuxFrame >          m_Control;
+  std::vector< Piece >            m_Batch;
+  /**
+   * @brief Атрибут m_Cursor содержит номер потока, с которого начинается
+   *        выбор кадров следующей записи (поочередная передача потоков).
+   */
+  std::uint32_t                   m_Cursor          { 0 };
+  std::vector< ByteT_ >           m_ReadBuffer;
+  MuxFrame::header_t              m_Header;
+  std::size_t                     m_HeaderFill      { 0 };
+  MuxFrame                        m_Frame;
+  std::size_t                     m_Left            { 0 };
+  std::atomic< std::uint32_t >    m_NextStream;
+  MuxMetrics                      m_Metrics;
+  stream_opened_t                 m_StreamOpened;
+  std::atomic_bool                m_Open            { false };
+  std::atomic_bool                m_Stopped         { false };
+  std::atomic_bool                m_Idle            { true };
+  bool                            m_Writing         { false };
+  io_service_callback_t           m_AfterStop;
+  void                          * m_StopParamPtr    = nullptr;
+
+  /**
+   * @brief Метод StreamRef возвращает поток @a stream, создавая его при
+   *        первом обращении.
+   */
+  Stream & StreamRef ( std::uint32_t stream )
+  {
+    auto found( m_Streams.find( stream ) );
+    if( found == m_Streams.end() )
+    {
+      ++ m_Metrics.m_Streams;
+      found = m_Streams.emplace( stream, Stream() ).first;
+    }
+    return found->second;
+  }
+
+  /**
+   * @brief Метод InboundRef возвращает поток, которому другая сторона
+   *        передает кадр данных: поток этой стороны должен быть открыт, поток
+   *        другой стороны открывается первым кадром в пределах
+   *        @a STREAMS_MAX потоков.
+   * @return nullptr - номер потока недопустим.
+   */
+  Stream * InboundRef ( std::uint32_t id )
+  {
+    auto found( m_Streams.find( id ) );
+    if( found != m_Streams.end() )
+      return found->second.m_RemoteClosed ? nullptr : & found->second;
+
+    std::size_t remote( 0 );
+    for( auto & stream : m_Streams )
+      if( IsRemote( stream.first ) )
+        ++ remote;
+    if( ( id == 0 ) or ( not IsRemote( id ) ) or ( remote >= STREAMS_MAX ) )
+      return nullptr;
+    return & StreamRef( id );
+  }
+
+  /**
+   * @brief Метод IsRemote сообщает, что поток открыт другой стороной.
+   */
+  bool IsRemote ( std::uint32_t stream ) const
+  {
+    return ( stream & 1 ) != ( m_NextStream & 1 );
+  }
+
+  void UpdateIdle ()
+  {
+    // кадры текущей записи передаются до завершения async_write
+    bool idle( m_Control.empty() and ( m_HeaderFill == 0 ) and ( not m_Writing ) and m_Batch.empty() );
+    for( auto & stream : m_Streams )
+      idle = idle
+          and stream.second.m_Outbound.empty()
+          and stream.second.m_Inbound.empty()
+          and stream.second.m_Ready.empty();
+    m_Idle = idle;
+  }
+
+  /**
+   * @brief Метод Read принимает данные подключения.
+   */
+  void Read ()
+  {
+    if( not IsOpen() )
+      return;
+    auto self( this->shared_from_this() );
+    m_Socket.async_read_some(
+          boost::asio::buffer( m_ReadBuffer ),
+          m_Strand.wrap(
+            [ self ]( const error_t & ec, std::size_t t )
+            {
+              if( ( not IsNoErr( ec ) ) or ( t == 0 ) )
+              { // подключение закрыто другой стороной
+                self->Stop();
+                return;
+              }
+              if( self->Parse( reinterpret_cast< const unsigned char * >( self->m_ReadBuffer.data() ), t ) )
+                self->Read();
+              else
+              {
+                DUMP_CRITICAL( "AsioMuxLink: malformed frame" );
+                self->Stop();
+              }
+            } ) );
+  }
+
+  /**
+   * @brief Метод Parse разбирает принятые данные.
+   * @return false при нарушении формата.
+   */
+  bool Parse ( const unsigned char * ptr, std::size_t bytes )
+  {
+    while( bytes > 0 )
+    {
+      if( m_HeaderFill < MuxFrame::HEADER_SIZE )
+      {
+        const std::size_t t( std::min( bytes, MuxFrame::HEADER_SIZE - m_HeaderFill ) );
+        std::copy( ptr, ptr + t, m_Header.begin() + m_HeaderFill );
+        m_HeaderFill += t;
+        ptr += t;
+        bytes -= t;
+        if( m_HeaderFill < MuxFrame::HEADER_SIZE )
+          break;
+        m_Frame.Read( m_Header.data() );
+        if( m_Frame.m_Type != MuxFrame::Data )
+        {
+          m_HeaderFill = 0;
+          if( not Control( m_Frame ) )
+            return false;
+          continue;
+        }
+        // другая сторона передает не более окна, возвращенного ей
+        auto stream( InboundRef( m_Frame.m_Stream ) );
+        if( ( nullptr == stream )
+            or ( stream->m_Unacked + std::uint64_t( m_Frame.m_Length ) > WINDOW_SIZE )
+            or ( stream->m_Inbound.size() * sizeof( ByteT_ ) + m_Frame.m_Length > DOCUMENT_SIZE_MAX )
+            or ( m_Frame.m_Length % sizeof( ByteT_ ) != 0 )
+            or ( m_Frame.IsLast() and ( stream->m_Ready.size() >= READY_MAX ) ) )
+          return false;
+        m_Left = m_Frame.m_Length;
+      }
+
+      const std::size_t t( std::min( bytes, m_Left ) );
+      auto & stream( m_Streams.at( m_Frame.m_Stream ) );
+      auto first( reinterpret_cast< const ByteT_ * >( ptr ) );
+      stream.m_Inbound.insert( stream.m_Inbound.end(), first, first + t / sizeof( ByteT_ ) );
+      stream.m_Unacked += static_cast< std::uint32_t >( t );
+      ptr += t;
+      bytes -= t;
+      m_Left -= t;
+      if( m_Left == 0 )
+      {
+        m_HeaderFill = 0;
+        if( m_Frame.IsLast() )
+        {
+          stream.m_Ready.emplace_back();
+          stream.m_Ready.back().swap( stream.m_Inbound );
+        }
+        Deliver( m_Frame.m_Stream );
+      }
+    }
+    UpdateIdle();
+    return true;
+  }
+
+  /**
+   * @brief Метод Control обрабатывает кадры возврата окна и завершения
+   *        потока.
+   * @return false при нарушении формата (неизвестный тип кадра, возврат
+   *         окна сверх переданных данных).
+   */
+  bool Control ( const MuxFrame & frame )
+  {
+    if( ( frame.m_Type != MuxFrame::Window ) and ( frame.m_Type != MuxFrame::Close ) )
+      return false;
+    auto found( m_Streams.find( frame.m_Stream ) );
+    if( found == m_Streams.end() )
+      return true;
+
+    auto & stream( found->second );
+    if( frame.m_Type == MuxFrame::Window )
+    {
+      if( stream.m_Window + frame.m_Length > std::int64_t( WINDOW_SIZE ) )
+        return false;
+      stream.m_Window += frame.m_Length;
+      if( stream.m_Blocked )
+      {
+        stream.m_Blocked = false;
+        Flush();
+      }
+    }
+    else
+    {
+      stream.m_RemoteClosed = true;
+      Release( frame.m_Stream );
+    }
+    return true;
+  }
+
+  /**
+   * @brief Метод Deliver передает обработчику принятые документы потока и
+   *        возвращает окно передачи (если прием потока не приостановлен).
+   */
+  void Deliver ( std::uint32_t id )
+  {
+    auto & stream( StreamRef( id ) );
+    if( stream.m_Paused )
+      return;
+
+    if( ( not stream.m_Announced ) and IsRemote( id ) and ( not stream.m_Ready.empty() ) )
+    { // первый документ потока другой стороны: назначение обработчика
+      stream.m_Announced = true;
+      if( m_StreamOpened and ( not stream.m_Action ) )
+        stream.m_Action = m_StreamOpened( id );
+    }
+
+    while( ( not stream.m_Ready.empty() ) and ( not stream.m_Paused ) and IsOpen() )
+    {
+      auto & input( m_Channels.at( DataType::Input ) );
+      buffer_t document;
+      document.ContentRef().swap( stream.m_Ready.front() );
+      stream.m_Ready.pop_front();
+      ++ m_Metrics.m_Received;
+      if( stream.m_Action )
+        stream.m_Action( document );
+      else if( input.ActionExists() )
+        input.m_Action( document );
+
+      if( m_Type == spo::asio::TransferType::HalfDuplexIn )
+        Respond( id );
+    }
+
+    // окно возвращается после передачи документов обработчику или при
+    // приеме половины окна частью документа
+    if( ( not stream.m_Paused )
+        and ( stream.m_Unacked > 0 )
+        and ( stream.m_Inbound.empty() or ( stream.m_Unacked >= WINDOW_SIZE / 2 ) ) )
+    {
+      MuxFrame frame;
+      frame.m_Type    = MuxFrame::Window;
+      frame.m_Stream  = id;
+      frame.m_Length  = stream.m_Unacked;
+      stream.m_Unacked = 0;
+      m_Control.push_back( frame );
+      Flush();
+    }
+    Release( id );
+  }
+
+  /**
+   * @brief Метод Respond выполняет обработчик канала передачи и передает
+   *        сформированный документ потоком @a id.
+   */
+  void Respond ( std::uint32_t id )
+  {
+    auto & output( m_Channels.at( DataType::Output ) );
+    output.Clear();
+    if( output.Execute() and ( not output.BufferRef().IsEmpty() ) )
+    {
+      auto content( std::make_shared< content_t >() );
+      content->swap( output.BufferRef().ContentRef() );
+      StreamRef( id ).m_Outbound.push_back( Item { content, 0, false } );
+      Flush();
+    }
+  }
+
+  /**
+   * @brief Метод Release удаляет поток, передача которого завершена обеими
+   *        сторонами.
+   */
+  void Release ( std::uint32_t id )
+  {
+    auto found( m_Streams.find( id ) );
+    if( ( found != m_Streams.end() )
+        and found->second.m_LocalClosed
+        and found->second.m_RemoteClosed
+        and found->second.m_Ready.empty() )
+      m_Streams.erase( found );
+  }
+
+  /**
+   * @brief Метод Select выбирает кадры записи: кадры возврата окна, затем
+   *        по одному кадру потоков, имеющих окно передачи, поочередно.
+   */
+  void Select ()
+  {
+    std::size_t bytes( 0 );
+    for( ; ( not m_Control.empty() ) and ( bytes < WRITE_SIZE ); m_Control.pop_front() )
+    {
+      m_Batch.push_back( Piece { m_Control.front().Write(), content_ptr_t(), 0, 0, false } );
+      bytes += MuxFrame::HEADER_SIZE;
+    }
+
+    bool progress( true );
+    while( progress and ( bytes < WRITE_SIZE ) )
+    {
+      progress = false;
+      auto found( m_Streams.upper_bound( m_Cursor ) );
+      for( std::size_t count( 0 ); ( count < m_Streams.size() ) and ( bytes < WRITE_SIZE ); ++count, ++found )
+      {
+        if( found == m_Streams.end() )
+          found = m_Streams.begin();
+        auto & stream( found->second );
+        if( stream.m_Outbound.empty() or stream.m_LocalClosed )
+          continue;
+
+        auto & item( stream.m_Outbound.front() );
+        MuxFrame frame;
+        frame.m_Stream = found->first;
+        if( item.m_Close )
+        {
+          frame.m_Type = MuxFrame::Close;
+          m_Batch.push_back( Piece { frame.Write(), content_ptr_t(), 0, 0, false } );
+          stream.m_Outbound.pop_front();
+          stream.m_LocalClosed = true;
+        }
+        else
+        {
+          const std::size_t left( ( item.m_Content->size() - item.m_Offset ) * sizeof( ByteT_ ) );
+          std::size_t size( std::min< std::size_t >( left, CHUNK_SIZE ) );
+          size = std::min< std::size_t >( size, static_cast< std::size_t >( std::max< std::int64_t >( stream.m_Window, 0 ) ) );
+          size -= size % sizeof( ByteT_ );
+          if( ( size == 0 ) and ( left > 0 ) )
+          { // окно исчерпано: поток ожидает возврата окна
+            if( not stream.m_Blocked )
+              ++ m_Metrics.m_Blocked;
+            stream.m_Blocked = true;
+            continue;
+          }
+          const bool last( size == left );
+          frame.m_Flags   = last ? MuxFrame::FLAG_LAST : 0;
+          frame.m_Length  = static_cast< std::uint32_t >( size );
+          m_Batch.push_back( Piece { frame.Write(), item.m_Content, item.m_Offset, size, last } );
+          stream.m_Window -= static_cast< std::int64_t >( size );
+          item.m_Offset += size / sizeof( ByteT_ );
+          if( last )
+            stream.m_Outbound.pop_front();
+          bytes += MuxFrame::HEADER_SIZE + size;
+        }
+        m_Cursor = found->first;
+        progress = true;
+      }
+    }
+  }
+
+  /**
+   * @brief Метод Flush записывает выбранные кадры в сокет (одна запись
+   *        одновременно).
+   */
+  void Flush ()
+  {
+    if( m_Writing or ( not IsOpen() ) )
+      return;
+
+    Select();
+    UpdateIdle();
+    if( m_Batch.empty() )
+      return;
+
+    std::vector< boost::asio::const_buffer > buffers;
+    buffers.reserve( m_Batch.size() * 2 );
+    for( auto & piece : m_Batch )
+    {
+      buffers.push_back( boost::asio::buffer( piece.m_Header ) );
+      if( piece.m_Size > 0 )
+        buffers.push_back( boost::asio::buffer( piece.m_Content->data() + piece.m_Offset, piece.m_Size ) );
+    }
+
+    auto self( this->shared_from_this() );
+    m_Writing = true;
+    boost::asio::async_write(
+          m_Socket,
+          buffers,
+          m_Strand.wrap(
+            [ self ]( const error_t & ec, std::size_t )
+            {
+              self->Written( ec );
+            } ) );
+  }
+
+  void Written ( const error_t & ec )
+  {
+    m_Writing = false;
+    for( auto & piece : m_Batch )
+      if( piece.m_Last )
+        ++ m_Metrics.m_Sent;
+    m_Metrics.m_Frames += m_Batch.size();
+    m_Batch.clear();
+    if( not IsNoErr( ec ) )
+    {
+      Stop();
+      return;
+    }
+    ++ m_Metrics.m_Writes;
+
+    for( auto found( m_Streams.begin() ); found != m_Streams.end(); )
+    {
+      auto id( found->first );
+      ++ found;
+      Release( id );
+    }
+    Flush();
+  }
+};
+
+template< typename ProtocolT_, typename ByteT_ >
+using mux_link_ptr_t            = std::shared_ptr< spo::asio::AsioMuxLink< ProtocolT_, ByteT_ > >;
+
+//------------------------------------------------------------------------------
+}// namespace                   asio
+}// namespace                   spo
+
+#endif // ASIOMUXLINK_H
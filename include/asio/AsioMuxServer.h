@@ -0,0 +1,148 @@
+/**
+  * @file AsioMuxServer.h
+  * @brief Файл AsioMuxServer.h содержит объявления сервера
+  *        @a spo::asio::AsioMuxServer и клиента @a spo::asio::AsioMuxClient
+  *        обмена документами логическими потоками через одно подключение
+  *        ( @a spo::asio::AsioMuxLink ).
+  *
+  * Вместо нескольких подключений к серверу (например, к серверам приема и
+  * передачи @a AsioServerDuplex ) клиент открывает потоки одного
+  * подключения: потоки не требуют дескрипторов и установления подключения,
+  * а передача одного потока не задерживает другие.
+  * @code language="cpp"
+  *  spo::asio::AsioMuxServer< spo::asio::tcp_t, char > server(
+  *        spo::asio::TransferType::HalfDuplexIn,
+  *        spo::asio::tcp_t::endpoint( boost::asio::ip::tcp::v4(), 33445 ) );
+  *  server.SetBufferAction( spo::asio::DataType::Input, on_request );
+  *  server.SetBufferAction( spo::asio::DataType::Output, make_reply );
+  * @endcode
+  */
+
+#ifndef ASIOMUXSERVER_H
+#define ASIOMUXSERVER_H
+
+#include "asio/AsioLinkServer.h"
+#include "asio/AsioMuxLink.h"
+
+namespace                         spo   {
+namespace                         asio  {
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс AsioMuxServer определяет сервер обмена документами
+ *        логическими потоками.
+ *
+ * Параметры шаблона:
+ * @value ProtocolT_ потоковый протокол (TCP или локальный сокет);
+ * @value ByteT_     тип единицы информации для каналов обмена данными.
+ */
+template< typename ProtocolT_, typename ByteT_ = unsigned char >
+class SPO_CORE_EXPORT             AsioMuxServer :
+public                            spo::asio::AsioLinkServer< ProtocolT_, spo::asio::AsioMuxLink< ProtocolT_, ByteT_ >, ByteT_ >
+{
+public:
+  using self_t                  = spo::asio::AsioMuxServer< ProtocolT_, ByteT_ >;
+  using link_t                  = spo::asio::AsioMuxLink< ProtocolT_, ByteT_ >;
+  using base_class_t            = spo::asio::AsioLinkServer< ProtocolT_, link_t, ByteT_ >;
+  using link_shr_t              = typename base_class_t::link_shr_t;
+  using socket_t                = typename base_class_t::socket_t;
+  using endpoint_type           = typename base_class_t::endpoint_type;
+  using accept_filter_t         = typename base_class_t::accept_filter_t;
+
+  /**
+   * @brief Конструктор AsioMuxServer
+   * @param type             тип (режим) обмена данными потоков;
+   * @param endpoint         адрес приема подключений;
+   * @param serviceTimeoutMs время ожидания сервиса.
+   */
+  explicit AsioMuxServer
+  (
+      spo::asio::TransferType         type,
+      const endpoint_type           & endpoint,
+      std::int64_t                    serviceTimeoutMs  = 10000
+  )
+    : base_class_t    ( type, endpoint, serviceTimeoutMs )
+  {}
+
+  /**
+   * @brief Метод SetStreamOpened назначает обработчик открытия потоков
+   *        клиентами ( @a AsioMuxLink::SetStreamOpened ) каналам, создаваемым
+   *        после вызова метода.
+   */
+  void SetStreamOpened ( const typename link_t::stream_opened_t & opened )
+  {
+    m_StreamOpened = opened;
+  }
+
+protected:
+  link_shr_t MakeLink ( socket_t && socket ) override
+  {
+    error_t ec;
+    SetSocketOptions< ProtocolT_ >( socket );
+    auto profile( base_class_t::SocketProfilePtr() );
+    if( profile and ( not profile->template ApplyConnected< ProtocolT_ >( socket, ec ) ) )
+      DUMP_BOOST_ERROR( ec );
+
+    auto link( std::make_shared< link_t >( base_class_t::TransferType(),
+                                           std::move( socket ),
+                                           false,
+                                           base_class_t::ActionsRef() ) );
+    link->SetStreamOpened( m_StreamOpened );
+    return link;
+  }
+
+private:
+  typename link_t::stream_opened_t m_StreamOpened;
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс AsioMuxClient определяет клиента обмена документами
+ *        логическими потоками с сервером @a AsioMuxServer.
+ *
+ * Параметры шаблона:
+ * @value ProtocolT_ потоковый протокол (TCP или локальный сокет);
+ * @value ByteT_     тип единицы информации для каналов обмена данными.
+ */
+template< typename ProtocolT_, typename ByteT_ = unsigned char >
+class SPO_CORE_EXPORT             AsioMuxClient :
+public                            spo::asio::AsioLinkClient< ProtocolT_, spo::asio::AsioMuxLink< ProtocolT_, ByteT_ >, ByteT_ >
+{
+public:
+  using self_t                  = spo::asio::AsioMuxClient< ProtocolT_, ByteT_ >;
+  using link_t                  = spo::asio::AsioMuxLink< ProtocolT_, ByteT_ >;
+  using base_class_t            = spo::asio::AsioLinkClient< ProtocolT_, link_t, ByteT_ >;
+  using link_shr_t              = typename base_class_t::link_shr_t;
+  using socket_t                = typename base_class_t::socket_t;
+  using endpoint_type           = typename base_class_t::endpoint_type;
+
+  explicit AsioMuxClient
+  (
+      spo::asio::TransferType         type,
+      const endpoint_type           & endpoint,
+      std::int64_t                    serviceTimeoutMs  = 10000
+  )
+    : base_class_t    ( type, endpoint, serviceTimeoutMs )
+  {}
+
+protected:
+  link_shr_t MakeLink ( socket_t && socket, error_t & ec ) override
+  {
+    SetSocketOptions< ProtocolT_ >( socket );
+    auto profile( base_class_t::SocketProfilePtr() );
+    if( profile and ( not profile->template ApplyConnected< ProtocolT_ >( socket, ec ) ) )
+      DUMP_BOOST_ERROR( ec );
+    ec = error_t();
+
+    return std::make_shared< link_t >( base_class_t::TransferType(),
+                                       std::move( socket ),
+                                       true,
+                                       base_class_t::ActionsRef() );
+  }
+};
+
+//------------------------------------------------------------------------------
+}// namespace                   asio
+}// namespace                   spo
+
+#endif // ASIOMUXSERVER_H
@@ -0,0 +1,114 @@
+/**
+  * @file AsioPlacement.h
+  * @brief Файл AsioPlacement.h содержит объявление структуры
+  *        @a spo::asio::ThreadPlacement размещения потока ввода/вывода на
+  *        процессоре или узле NUMA и класса @a spo::asio::AsioPlacement
+  *        средств привязки потоков к процессорам и памяти узлов NUMA.
+  *
+  * Топология процессоров и узлов NUMA определяется по файлам
+  * /sys/devices/system/node, привязка памяти выполняется системным вызовом
+  * set_mempolicy (без зависимости от libnuma).
+  */
+
+#ifndef ASIOPLACEMENT_H
+#define ASIOPLACEMENT_H
+
+#include "asio/AsioCommon.h"
+#include <string>
+#include <vector>
+
+namespace                         spo   {
+namespace                         asio  {
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Тип cpu_list_t определяет список номеров процессоров.
+ */
+using cpu_list_t                = std::vector< int >;
+
+/**
+ * @brief Структура ThreadPlacement определяет размещение потока ввода/вывода
+ *        сервиса.
+ *
+ * @value m_Cpu      поток выполняется только на процессоре @a m_Cpu;
+ * @value m_NumaNode поток выполняется на процессорах узла @a m_NumaNode (если
+ *                   процессор не задан) и получает память этого узла.
+ *
+ * Если узел не задан, используется узел процессора @a m_Cpu.
+ */
+struct                            ThreadPlacement
+{
+  int                             m_Cpu             { -1 }; ///< номер процессора (-1 - не задан)
+  int                             m_NumaNode        { -1 }; ///< номер узла NUMA (-1 - не задан)
+};
+
+/**
+ * @brief Тип thread_placements_t определяет размещение потоков ввода/вывода
+ *        сервиса (по элементу на поток).
+ */
+using thread_placements_t       = std::vector< ThreadPlacement >;
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс AsioPlacement содержит методы определения топологии NUMA и
+ *        привязки потоков к процессорам и памяти узлов NUMA.
+ */
+class SPO_CORE_EXPORT             AsioPlacement
+{
+public:
+  /**
+   * @brief Метод ParseCpuList разбирает список процессоров в формате ядра
+   *        Linux ("0-3,8,10-11").
+   */
+  static cpu_list_t               ParseCpuList        ( const std::string & str );
+
+  /**
+   * @brief Метод NodeCpus возвращает список процессоров узла NUMA.
+   * @return список процессоров (пустой, если узел не найден).
+   */
+  static cpu_list_t               NodeCpus            ( int node );
+
+  /**
+   * @brief Метод CpuNode возвращает номер узла NUMA процессора.
+   * @return номер узла или -1, если узел не определен.
+   */
+  static int                      CpuNode             ( int cpu );
+
+  /**
+   * @brief Метод Cpus возвращает список процессоров размещения потока.
+   * @return список процессоров (пустой - размещение не ограничено).
+   */
+  static cpu_list_t               Cpus                ( const ThreadPlacement & placement );
+
+  /**
+   * @brief Метод Node возвращает узел NUMA размещения потока.
+   * @return номер узла или -1, если узел не задан и не определен.
+   */
+  static int                      Node                ( const ThreadPlacement & placement );
+
+  /**
+   * @brief Метод PinCurrentThread привязывает текущий поток к процессорам
+   *        размещения и назначает потоку предпочтительное выделение памяти на
+   *        узле NUMA размещения: память, выделяемая потоком (буферы сессий),
+   *        размещается на том же узле.
+   * @param placement размещение потока;
+   * @param ec        код первой ошибки привязки.
+   * @return Признак успешной привязки.
+   */
+  static bool                     PinCurrentThread    ( const ThreadPlacement & placement, error_t & ec );
+
+  /**
+   * @brief Метод IncomingCpu возвращает номер процессора, обработавшего
+   *        входящие пакеты соединения (SO_INCOMING_CPU).
+   * @param nativeHandle дескриптор сокета.
+   * @return номер процессора или -1, если номер не определен.
+   */
+  static int                      IncomingCpu         ( int nativeHandle );
+};
+
+//------------------------------------------------------------------------------
+
+}// namespace                     asio
+}// namespace                     spo
+
+#endif // ASIOPLACEMENT_H
@@ -27,6 +27,10 @@ template
       std::is_same< ProtocolT_, boost::asio::ip::udp >::value
       or
       std::is_same< ProtocolT_, boost::asio::ip::icmp >::value
+      or
+      std::is_same< ProtocolT_, spo::asio::local_stream_t >::value
+      or
+      std::is_same< ProtocolT_, spo::asio::local_datagram_t >::value
     >::type
 >
 class SPO_CORE_EXPORT             AsioResolver :
@@ -138,7 +142,7 @@ public:
    */
   io_service_t & ServiceRef ()
   {
-    return m_Resolver.get_io_service();
+    return ServiceOf( m_Resolver );
   }
 
   /**
@@ -201,6 +205,93 @@ private:
     mutable typename self_t::endpoints_t m_Endpoints;
 };
 
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс AsioLocalResolver формирует конечную точку подключения к
+ *        серверу локального сокета: имя хоста задает путь сокета, служба
+ *        имен не используется.
+ *
+ * Параметры шаблона:
+ * @value ProtocolT_ протокол локальных сокетов ( @a local_stream_t или
+ *                   @a local_datagram_t ).
+ * @value ByteT_ тип единицы информации для каналов обмена данными.
+ */
+template
+<
+    typename                      ProtocolT_,
+    typename                      ByteT_
+>
+class SPO_CORE_EXPORT             AsioLocalResolver
+{
+public:
+  using protocol_t              = ProtocolT_;
+  using endpoint_t              = typename protocol_t::endpoint;
+  using endpoints_t             = std::vector< endpoint_t >;
+  using session_t               = spo::asio::AsioSocketSession< ProtocolT_, ByteT_ >;
+
+  /**
+   * @brief Конструктор AsioLocalResolver
+   * @param path             путь локального сокета сервера;
+   * @param remoute_service  не используется (совместимость с @a AsioResolver );
+   * @param serviceTimeoutMs время ожидания активации сервиса.
+   */
+  explicit AsioLocalResolver
+  (
+      const std::string   & path,
+      const std::string   & remoute_service,
+      const std::int64_t    serviceTimeoutMs
+  )
+    : m_ServiceRef( spo::asio::AsioService::Instance( serviceTimeoutMs ).ServiceRef() )
+    , m_Path      ( path )
+    , m_Service   ( remoute_service )
+    , m_Endpoints { endpoint_t( path ) }
+  {}
+
+  std::string                     HosName       () const { return m_Path; }
+  std::string                     RemouteService() const { return m_Service; }
+  io_service_t                  & ServiceRef    ()       { return m_ServiceRef; }
+
+  bool IsValid ( bool rescan = false )
+  {
+    UNUSED( rescan );
+    return not m_Path.empty();
+  }
+
+  void Scan () BOOST_NOEXCEPT
+  {}
+
+  endpoints_t Endpoints ( bool rescan = false )
+  {
+    UNUSED( rescan );
+    return m_Endpoints;
+  }
+
+private:
+  io_service_t                  & m_ServiceRef;
+  std::string                     m_Path;
+  std::string                     m_Service;
+  endpoints_t                     m_Endpoints;
+};
+
+/**
+ * @brief Специализации AsioResolver для локальных сокетов.
+ */
+template< typename                ByteT_ >
+class SPO_CORE_EXPORT             AsioResolver< spo::asio::local_stream_t, ByteT_ > :
+public                            spo::asio::AsioLocalResolver< spo::asio::local_stream_t, ByteT_ >
+{
+public:
+  using spo::asio::AsioLocalResolver< spo::asio::local_stream_t, ByteT_ >::AsioLocalResolver;
+};
+
+template< typename                ByteT_ >
+class SPO_CORE_EXPORT             AsioResolver< spo::asio::local_datagram_t, ByteT_ > :
+public                            spo::asio::AsioLocalResolver< spo::asio::local_datagram_t, ByteT_ >
+{
+public:
+  using spo::asio::AsioLocalResolver< spo::asio::local_datagram_t, ByteT_ >::AsioLocalResolver;
+};
+
 //------------------------------------------------------------------------------
 
 }// namespace                     asio
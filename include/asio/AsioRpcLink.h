@@ -0,0 +1,505 @@
+/**
+  * @file AsioRpcLink.h
+  * @brief Файл AsioRpcLink.h содержит объявление шаблона класса
+  *        @a spo::asio::AsioRpcLink обмена запросами и ответами с
+  *        идентификаторами через одно подключение сессии потокового сокета.
+  *
+  * Сессия обмена @a TransferType::HalfDuplexOut передает один запрос и
+  * принимает один ответ. Канал @a AsioRpcLink передает запросы, не ожидая
+  * ответов на предыдущие (конвейер запросов): ответ сопоставляется с
+  * запросом по идентификатору кадра и может поступить в любом порядке.
+  *
+  * Формат кадра:
+  * @code
+  *   [тип: 1 байт][идентификатор запроса: 4 байта][длина данных: 4 байта][данные]
+  * @endcode
+  * Идентификатор и длина передаются в сетевом порядке.
+  *
+  * Канал назначается сессии до ее запуска: клиентом
+  * ( @a AsioClient::SetAfterConnect ) или сервером
+  * ( @a AsioServer::SetAcceptFilter ).
+  * @code language="cpp"
+  *  server.SetAcceptFilter(
+  *        [ & ]( session_shr_t session )
+  *        {
+  *          return bool( rpc_t::Attach( session, on_request ) );
+  *        } );
+  *  client.SetAfterConnect(
+  *        [ & ]( session_shr_t session, const spo::asio::error_t & )
+  *        {
+  *          if( session )
+  *            link = rpc_t::Attach( session );
+  *        } );
+  *  ...
+  *  auto reply( link->Call( request ) ); // std::future
+  * @endcode
+  */
+
+#ifndef ASIORPCLINK_H
+#define ASIORPCLINK_H
+
+#include "asio/AsioSocketSession.h"
+#include "core/documents/FrameHeader.h"
+#include <future>
+#include <map>
+#include <mutex>
+
+namespace                         spo   {
+namespace                         asio  {
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Структура RpcFrame содержит заголовок кадра канала запросов.
+ */
+struct                            RpcFrame
+{
+  static const std::size_t        HEADER_SIZE       = 9;
+
+  /**
+   * @brief Перечисление Type определяет тип кадра.
+   */
+  enum                            Type : std::uint8_t
+  {
+    Request                     = 0,  ///< запрос
+    Response                    = 1,  ///< ответ на запрос
+    Fault                       = 2,  ///< запрос не обработан
+  };
+
+  using header_t                = std::array< unsigned char, HEADER_SIZE >;
+
+  std::uint8_t                    m_Type            { Request };
+  std::uint32_t                   m_Id              { 0 };
+  std::uint32_t                   m_Length          { 0 };
+
+  header_t Write () const
+  {
+    header_t retval;
+    spo::core::docs::FrameHeaderWriter( retval.data() ).Byte( m_Type ).Fixed32( m_Id ).Fixed32( m_Length );
+    return retval;
+  }
+
+  void Read ( const unsigned char * data )
+  {
+    spo::core::docs::FrameHeaderReader in( data );
+    m_Type    = in.Byte();
+    m_Id      = in.Fixed32();
+    m_Length  = in.Fixed32();
+  }
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Структура RpcMetrics содержит счетчики канала запросов.
+ */
+struct                            RpcMetrics
+{
+  std::atomic< std::uint64_t >    m_Calls           { 0 }; ///< передано запросов
+  std::atomic< std::uint64_t >    m_Replies         { 0 }; ///< получено ответов
+  std::atomic< std::uint64_t >    m_Failed          { 0 }; ///< запросов без ответа (отказ, закрытие)
+  std::atomic< std::uint64_t >    m_Served          { 0 }; ///< обработано запросов другой стороны
+  std::atomic< std::size_t >      m_MaxOutstanding  { 0 }; ///< наибольшее число ожидающих запросов
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс AsioRpcLink определяет канал запросов и ответов сессии.
+ *
+ * Параметры шаблона:
+ * @value ProtocolT_ потоковый протокол сессии;
+ * @value ByteT_     тип единицы информации документов (размером в байт).
+ *
+ * Канал симметричен: каждая сторона передает запросы ( @a Call ) и
+ * обрабатывает запросы другой стороны (обработчиком @a handler_t или
+ * отложенным ответом @a Respond ). Методы @a Call и @a Respond допускают
+ * вызов из любого потока; кадры передаются очередью исходящих сообщений
+ * сессии ( @a AsioSocketSession::Post ). Обработчики ответов вызываются в
+ * потоке сервиса сессии; при закрытии подключения ожидающие запросы
+ * завершаются ошибкой @a boost::asio::error::connection_aborted.
+ */
+template< typename ProtocolT_, typename ByteT_ = unsigned char >
+class SPO_CORE_EXPORT             AsioRpcLink :
+public                            std::enable_shared_from_this< spo::asio::AsioRpcLink< ProtocolT_, ByteT_ > >
+{
+  static_assert( sizeof( ByteT_ ) == 1, "AsioRpcLink: ByteT_ must be byte-sized" );
+
+public:
+  using self_t                  = spo::asio::AsioRpcLink< ProtocolT_, ByteT_ >;
+  using self_shr_t              = std::shared_ptr< self_t >;
+  using session_t               = spo::asio::AsioSocketSession< ProtocolT_, ByteT_ >;
+  using session_shr_t           = std::shared_ptr< session_t >;
+  using document_t              = spo::core::docs::BytesDocument< ByteT_ >;
+  using content_t               = typename session_t::batcher_t::content_t;
+  using content_ptr_t           = typename session_t::batcher_t::content_ptr_t;
+  /**
+   * @brief Тип reply_t определяет обработчик ответа на запрос: код ошибки
+   *        и документ ответа.
+   */
+  using reply_t                 = spo::simple_fnc_t< void, const error_t &, document_t & >;
+  /**
+   * @brief Тип handler_t определяет обработчик запроса другой стороны:
+   *        документ запроса и формируемый документ ответа; false - запрос
+   *        отклоняется.
+   */
+  using handler_t               = spo::simple_fnc_t< bool, document_t &, document_t & >;
+  /**
+   * @brief Тип deferred_t определяет обработчик запроса с отложенным
+   *        ответом: идентификатор и документ запроса. Ответ передается
+   *        методом @a Respond.
+   */
+  using deferred_t              = spo::simple_fnc_t< void, std::uint32_t, document_t & >;
+
+  /**
+   * @brief Константа DOCUMENT_SIZE_MAX ограничивает размер принимаемого
+   *        документа, байт.
+   */
+  static const std::size_t        DOCUMENT_SIZE_MAX = 64 * 1024 * 1024;
+
+  /**/                            AsioRpcLink
+  (
+      const session_shr_t       & session,
+      const handler_t           & handler
+  )
+    : m_Session ( session )
+    , m_Handler ( handler )
+  {}
+
+  /**
+   * @brief Метод Attach создает канал запросов сессии @a session.
+   *        Вызывается до запуска сессии; канал существует, пока существует
+   *        сессия.
+   * @param session сессия потокового сокета;
+   * @param handler обработчик запросов другой стороны.
+   * @return канал или пустой указатель, если протокол сессии датаграммный
+   *         или сессия использует TLS.
+   */
+  static self_shr_t Attach ( const session_shr_t & session, const handler_t & handler = handler_t() )
+  {
+    if( not session )
+      return self_shr_t();
+
+    auto retval( std::make_shared< self_t >( session, handler ) );
+    if( not session->SetStreamReceive(
+          [ retval ]( const unsigned char * data, std::size_t size )
+          {
+            return retval->Feed( data, size );
+          } ) )
+      return self_shr_t();
+    return retval;
+  }
+
+  const RpcMetrics              & MetricsRef        () const { return m_Metrics; }
+
+  /**
+   * @brief Метод SetDeferred назначает обработчик запросов с отложенным
+   *        ответом (используется вместо обработчика @a handler_t ).
+   *        Назначается до запуска сессии.
+   */
+  void SetDeferred ( const deferred_t & deferred )
+  {
+    m_Deferred = deferred;
+  }
+
+  /**
+   * @brief Метод IsOpen сообщает, что подключение канала открыто.
+   */
+  bool IsOpen () const
+  {
+    auto session( m_Session.lock() );
+    return ( not m_Closed ) and session and session->IsOpen();
+  }
+
+  /**
+   * @brief Метод Outstanding возвращает количество запросов, ожидающих
+   *        ответа.
+   */
+  std::size_t Outstanding () const
+  {
+    std::lock_guard< std::mutex > l( m_Mutex );
+    return m_Outstanding.size();
+  }
+
+  /**
+   * @brief Метод Call передает запрос, не ожидая ответов на предыдущие
+   *        запросы.
+   * @param request документ запроса;
+   * @param reply   обработчик ответа.
+   * @return false, если подключение закрыто (обработчик не вызывается).
+   */
+  bool Call ( const document_t & request, const reply_t & reply )
+  {
+    std::uint32_t id;
+    {
+      std::lock_guard< std::mutex > l( m_Mutex );
+      if( m_Closed )
+        return false;
+      id = ++ m_LastId;
+      m_Outstanding[ id ] = reply;
+      if( m_Outstanding.size() > m_Metrics.m_MaxOutstanding )
+        m_Metrics.m_MaxOutstanding = m_Outstanding.size();
+    }
+
+    if( not Send( RpcFrame::Request, id, request ) )
+    {
+      std::lock_guard< std::mutex > l( m_Mutex );
+      m_Outstanding.erase( id );
+      return false;
+    }
+    ++ m_Metrics.m_Calls;
+    return true;
+  }
+
+  /**
+   * @brief Метод Call передает запрос и возвращает ответ через
+   *        @a std::future (ошибка передается исключением
+   *        @a boost::system::system_error ).
+   */
+  std::future< document_t > Call ( const document_t & request )
+  {
+    auto promise( std::make_shared< std::promise< document_t > >() );
+    auto retval( promise->get_future() );
+    auto reply(
+          [ promise ]( const error_t & ec, document_t & document )
+          {
+            if( IsNoErr( ec ) )
+              promise->set_value( document );
+            else
+              promise->set_exception( std::make_exception_ptr( boost::system::system_error( ec ) ) );
+          } );
+    if( not Call( request, reply ) )
+    {
+      document_t empty;
+      reply( boost::asio::error::not_connected, empty );
+    }
+    return retval;
+  }
+
+  /**
+   * @brief Метод Respond передает ответ на запрос @a id, полученный
+   *        обработчиком @a deferred_t.
+   * @param id      идентификатор запроса;
+   * @param reply   документ ответа;
+   * @param success false - запрос отклонен.
+   */
+  bool Respond ( std::uint32_t id, const document_t & reply, bool success = true )
+  {
+    Unhold( id );
+    return Send( success ? RpcFrame::Response : RpcFrame::Fault, id, reply );
+  }
+
+  /**
+   * @brief Метод Close закрывает подключение канала.
+   */
+  void Close ()
+  {
+    auto session( m_Session.lock() );
+    if( session )
+      session->ServiceRef().post( boost::bind( & session_t::Stop, session ) );
+  }
+
+private:
+  using outstanding_t           = std::map< std::uint32_t, reply_t >;
+
+  std::weak_ptr< session_t >      m_Session;
+  handler_t                       m_Handler;
+  deferred_t                      m_Deferred;
+  RpcMetrics                      m_Metrics;
+  /**
+   * @brief Атрибут m_Outstanding содержит обработчики ответов на переданные
+   *        запросы по их идентификаторам.
+   */
+  outstanding_t                   m_Outstanding;
+  /**
+   * @brief Атрибут m_Held содержит размеры запросов с отложенным ответом,
+   *        учитываемых в объеме принятых данных сессии
+   *        ( @a AsioSocketSession::HoldInbound ) до ответа.
+   */
+  std::map< std::uint32_t, std::size_t > m_Held;
+  std::uint32_t                   m_LastId          { 0 };
+  std::atomic_bool                m_Closed          { false };
+  mutable std::mutex              m_Mutex;
+
+  // состояние разбора принятых кадров (поток сервиса сессии)
+  RpcFrame::header_t              m_Header;
+  std::size_t                     m_HeaderFill      { 0 };
+  RpcFrame                        m_Frame;
+  content_t                       m_Payload;
+
+  /**
+   * @brief Метод Send передает кадр типа @a type с данными документа.
+   */
+  bool Send ( RpcFrame::Type type, std::uint32_t id, const document_t & document )
+  {
+    auto session( m_Session.lock() );
+    if( not session )
+      return false;
+
+    const auto & payload( const_cast< document_t & >( document ).ContentRef() );
+    RpcFrame frame;
+    frame.m_Type    = type;
+    frame.m_Id      = id;
+    frame.m_Length  = static_cast< std::uint32_t >( payload.size() );
+    const auto header( frame.Write() );
+
+    auto content( std::make_shared< content_t >() );
+    content->reserve( RpcFrame::HEADER_SIZE + payload.size() );
+    content->insert( content->end(), header.begin(), header.end() );
+    content->insert( content->end(), payload.begin(), payload.end() );
+    return session->Post( content_ptr_t( std::move( content ) ) );
+  }
+
+  /**
+   * @brief Метод Feed разбирает принятые данные сессии
+   *        ( @a AsioSocketSession::stream_receive_t ).
+   * @return false при нарушении формата потока.
+   */
+  bool Feed ( const unsigned char * data, std::size_t size )
+  {
+    if( size == 0 )
+    {
+      Abort();
+      return false;
+    }
+
+    while( size > 0 )
+    {
+      if( m_HeaderFill < RpcFrame::HEADER_SIZE )
+      { // заголовок кадра может быть разделен между частями данных
+        const std::size_t t( std::min( size, RpcFrame::HEADER_SIZE - m_HeaderFill ) );
+        std::copy( data, data + t, m_Header.begin() + m_HeaderFill );
+        m_HeaderFill += t;
+        data += t;
+        size -= t;
+        if( m_HeaderFill < RpcFrame::HEADER_SIZE )
+          break;
+        m_Frame.Read( m_Header.data() );
+        if( ( m_Frame.m_Length > DOCUMENT_SIZE_MAX ) or ( m_Frame.m_Type > RpcFrame::Fault ) )
+        {
+          DUMP_CRITICAL( "AsioRpcLink: invalid frame" );
+          return false;
+        }
+        m_Payload.clear();
+        m_Payload.reserve( m_Frame.m_Length );
+      }
+
+      const std::size_t t( std::min< std::size_t >( size, m_Frame.m_Length - m_Payload.size() ) );
+      m_Payload.insert( m_Payload.end(), data, data + t );
+      data += t;
+      size -= t;
+      if( m_Payload.size() == m_Frame.m_Length )
+      {
+        m_HeaderFill = 0;
+        Dispatch();
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief Метод Dispatch передает принятый кадр обработчику запроса или
+   *        ответа.
+   */
+  void Dispatch ()
+  {
+    document_t document;
+    document.ContentRef().swap( m_Payload );
+
+    if( m_Frame.m_Type == RpcFrame::Request )
+    {
+      ++ m_Metrics.m_Served;
+      if( m_Deferred )
+      { // запрос учитывается до ответа: при отставании обработки чтение
+        // сессии приостанавливается
+        Hold( m_Frame.m_Id, document.ContentRef().size() );
+        m_Deferred( m_Frame.m_Id, document );
+        return;
+      }
+      document_t reply;
+      const bool success( m_Handler and m_Handler( document, reply ) );
+      Respond( m_Frame.m_Id, reply, success );
+      return;
+    }
+
+    reply_t reply;
+    {
+      std::lock_guard< std::mutex > l( m_Mutex );
+      auto it( m_Outstanding.find( m_Frame.m_Id ) );
+      if( it == m_Outstanding.end() )
+        return; // ответ на неизвестный запрос не обрабатывается
+      reply = std::move( it->second );
+      m_Outstanding.erase( it );
+    }
+
+    if( m_Frame.m_Type == RpcFrame::Response )
+      ++ m_Metrics.m_Replies;
+    else
+      ++ m_Metrics.m_Failed;
+    if( reply )
+      reply( m_Frame.m_Type == RpcFrame::Response
+             ? error_t()
+             : error_t( boost::asio::error::operation_not_supported ),
+             document );
+  }
+
+  void Hold ( std::uint32_t id, std::size_t size )
+  {
+    auto session( m_Session.lock() );
+    if( not session )
+      return;
+    {
+      std::lock_guard< std::mutex > l( m_Mutex );
+      m_Held[ id ] += size;
+    }
+    session->HoldInbound( size );
+  }
+
+  void Unhold ( std::uint32_t id )
+  {
+    std::size_t size( 0 );
+    {
+      std::lock_guard< std::mutex > l( m_Mutex );
+      auto it( m_Held.find( id ) );
+      if( it == m_Held.end() )
+        return;
+      size = it->second;
+      m_Held.erase( it );
+    }
+    auto session( m_Session.lock() );
+    if( session )
+      session->ReleaseInbound( size );
+  }
+
+  /**
+   * @brief Метод Abort завершает ожидающие запросы при закрытии
+   *        подключения.
+   */
+  void Abort ()
+  {
+    outstanding_t outstanding;
+    std::map< std::uint32_t, std::size_t > held;
+    {
+      std::lock_guard< std::mutex > l( m_Mutex );
+      m_Closed = true;
+      outstanding.swap( m_Outstanding );
+      held.swap( m_Held );
+    }
+
+    auto session( m_Session.lock() );
+    if( session )
+      for( auto & item : held )
+        session->ReleaseInbound( item.second );
+
+    m_Metrics.m_Failed += outstanding.size();
+    for( auto & item : outstanding )
+      if( item.second )
+      {
+        document_t empty;
+        item.second( boost::asio::error::connection_aborted, empty );
+      }
+  }
+};
+
+//------------------------------------------------------------------------------
+}// namespace                   asio
+}// namespace                   spo
+
+#endif // ASIORPCLINK_H
@@ -0,0 +1,508 @@
+/**
+  * @file AsioSendBatcher.h
+  * @brief Файл AsioSendBatcher.h содержит объявление шаблонного класса
+  *        @a spo::asio::AsioSendBatcher очереди исходящих сообщений сессии
+  *        с объединением сообщений в одну запись в сокет.
+  *
+  * Сокеты TCP сессий работают с опцией TCP_NODELAY: каждая передача малого
+  * сообщения формирует отдельный сегмент. Очередь удерживает сообщения не
+  * дольше бюджета задержки @a BatchPolicy::m_BudgetUs или до накопления
+  * @a BatchPolicy::m_MaxBytes и передает их одной записью с массивом буферов
+  * (writev). Сообщения, поступившие во время записи, передаются сразу после
+  * ее завершения (аналог алгоритма Нейгла с ограниченной задержкой).
+  *
+  * Сообщения дополнительных каналов сессии передаются в порядке приоритета
+  * каналов ( @a spo::asio::ChannelPriority ).
+  */
+
+#ifndef ASIOSENDBATCHER_H
+#define ASIOSENDBATCHER_H
+
+#include "asio/AsioCommon.h"
+#include "asio/ChannelFrame.h"
+#include <array>
+#include <deque>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <vector>
+
+namespace                         spo   {
+namespace                         asio  {
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Структура BatchPolicy содержит параметры объединения исходящих
+ *        сообщений сессии.
+ */
+struct                            BatchPolicy
+{
+  /**
+   * @brief Атрибут m_BudgetUs содержит максимальное время удержания
+   *        сообщения в очереди, мкс (0 - передача без удержания).
+   */
+  std::int64_t                    m_BudgetUs        { 200 };
+  /**
+   * @brief Атрибут m_MaxBytes содержит объем сообщений очереди, при
+   *        достижении которого очередь передается без ожидания, байт.
+   */
+  std::size_t                     m_MaxBytes        { 16384 };
+  /**
+   * @brief Атрибут m_MaxMessages ограничивает количество сообщений одной
+   *        записи (количество буферов writev).
+   */
+  std::size_t                     m_MaxMessages     { 256 };
+  /**
+   * @brief Атрибут m_Cork включает опцию TCP_CORK на время передачи очереди:
+   *        опция удерживается между последовательными записями (например,
+   *        кадрами большого сообщения канала), ядро формирует из них полные
+   *        сегменты; остаток передается при опустошении очереди или после
+   *        записи сообщения канала управления (только TCP).
+   */
+  bool                            m_Cork            { false };
+  /**
+   * @brief Атрибут m_ChunkSize ограничивает размер кадра сообщения канала
+   *        ( @a ChannelFrame ), байт: между кадрами большого сообщения
+   *        передаются сообщения каналов более высокого приоритета.
+   */
+  std::size_t                     m_ChunkSize       { 65536 };
+};
+
+using batch_policy_ptr_t        = std::shared_ptr< const BatchPolicy >;
+
+/**
+ * @brief Структура BatchMetrics содержит счетчики очереди исходящих
+ *        сообщений.
+ */
+struct                            BatchMetrics
+{
+  std::atomic< std::uint64_t >    m_Messages        { 0 }; ///< переданные сообщения
+  std::atomic< std::uint64_t >    m_Writes          { 0 }; ///< записи в сокет
+  std::atomic< std::uint64_t >    m_Bytes           { 0 }; ///< переданные байты
+  std::atomic< std::uint64_t >    m_SizeFlushes     { 0 }; ///< записи по объему или количеству сообщений очереди
+  std::atomic< std::uint64_t >    m_BudgetFlushes   { 0 }; ///< записи по истечении бюджета задержки
+  std::atomic< std::uint64_t >    m_Dropped         { 0 }; ///< сообщения, сброшенные при ошибке записи
+  std::atomic< std::uint64_t >    m_Chunks          { 0 }; ///< неполные кадры сообщений каналов
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Шаблонная функция SetCork включает или выключает опцию TCP_CORK
+ *        сокета. Для протоколов, отличных от TCP, ничего не выполняет.
+ */
+template< typename Prot_ >
+void SetCork ( typename Prot_::socket & socket, bool cork )
+{
+  UNUSED( socket );
+  UNUSED( cork );
+}
+
+template<>
+inline void SetCork< boost::asio::ip::tcp >( boost::asio::ip::tcp::socket & socket, bool cork )
+{
+#if defined( TCP_CORK )
+  int value( cork ? 1 : 0 );
+  ::setsockopt( socket.native_handle(), IPPROTO_TCP, TCP_CORK, & value, sizeof( value ) );
+#else
+  UNUSED( socket );
+  UNUSED( cork );
+#endif
+}
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс AsioSendBatcher определяет очередь исходящих сообщений
+ *        потокового сокета сессии.
+ *
+ * Параметры шаблона:
+ * @value ProtocolT_ потоковый протокол сокета;
+ * @value ByteT_     тип единицы информации сообщений.
+ *
+ * Сообщения размещаются в очередях приоритетов @a ChannelPriority. Запись
+ * формируется из очередей в порядке убывания приоритета. Сообщения каналов
+ * ( @a ChannelFrame ) передаются кадрами не более
+ * @a BatchPolicy::m_ChunkSize: очередь, содержащая частично переданное
+ * сообщение, продолжает передачу следующей записью, поэтому сообщение
+ * канала управления ожидает не более одной записи.
+ *
+ * Сообщения передаются в очередь методом @a Post из любого потока; прочие
+ * действия очереди выполняются в потоке сервиса сокета. Обработчики записи
+ * и таймера удерживают владельца сокета (сессию), переданного методу
+ * @a Post, до их завершения.
+ */
+template< typename ProtocolT_, typename ByteT_ >
+class SPO_CORE_EXPORT             AsioSendBatcher :
+public                            std::enable_shared_from_this< spo::asio::AsioSendBatcher< ProtocolT_, ByteT_ > >
+{
+public:
+  using self_t                  = spo::asio::AsioSendBatcher< ProtocolT_, ByteT_ >;
+  using socket_t                = typename ProtocolT_::socket;
+  using content_t               = spo::socket_byffer_t< ByteT_ >;
+  using content_ptr_t           = std::shared_ptr< const content_t >;
+  using owner_t                 = std::shared_ptr< void >;
+  /**
+   * @brief Тип written_t определяет обработчик завершения записи сообщения
+   *        (код завершения, размер сообщения в байтах).
+   */
+  using written_t               = spo::simple_fnc_t< void, const error_t &, std::size_t >;
+
+  /**
+   * @brief Константа UNFRAMED обозначает сообщение без кадра канала
+   *        (передается одной частью).
+   */
+  static const int                UNFRAMED          = -1;
+
+  /**/                            AsioSendBatcher
+  (
+      socket_t                  & socket,
+      const BatchPolicy         & policy
+  )
+    : m_Socket  ( socket )
+    , m_Policy  ( policy )
+    , m_Timer   ( ServiceOf( socket ) )
+  {}
+
+  const BatchMetrics            & MetricsRef        () const { return m_Metrics; }
+  const BatchPolicy             & PolicyRef         () const { return m_Policy; }
+
+  /**
+   * @brief Метод IsEmpty сообщает об отсутствии сообщений, ожидающих
+   *        передачи или передаваемых.
+   */
+  bool IsEmpty () const
+  {
+    return m_Pending == 0;
+  }
+
+  /**
+   * @brief Метод PendingMessages возвращает количество сообщений, переданных
+   *        методу @a Post и еще не записанных в сокет.
+   */
+  std::size_t PendingMessages () const
+  {
+    return m_Pending;
+  }
+
+  /**
+   * @brief Метод PendingBytes возвращает объем данных сообщений, еще не
+   *        записанных в сокет, байт.
+   */
+  std::size_t PendingBytes () const
+  {
+    return m_PendingBytes;
+  }
+
+  /**
+   * @brief Метод SetErrorHandler назначает обработчик ошибки записи
+   *        (вызывается в потоке сервиса сокета после сброса очереди).
+   */
+  void SetErrorHandler ( const spo::simple_fnc_t< void > & handler )
+  {
+    m_OnError = handler;
+  }
+
+  /**
+   * @brief Метод Post передает сообщение в очередь из любого потока.
+   *        Данные сообщения не копируются: одни и те же данные могут
+   *        находиться в очередях нескольких сокетов.
+   * @param owner    владелец сокета;
+   * @param content  данные сообщения;
+   * @param priority приоритет сообщения;
+   * @param channel  номер канала кадров сообщения или @a UNFRAMED;
+   * @param written  обработчик завершения записи сообщения (вызывается в
+   *                 потоке сервиса сокета, в т.ч. при сбросе очереди).
+   *                 Сообщение с обработчиком передается без удержания.
+   */
+  void Post
+  (
+      const owner_t             & owner,
+      const content_ptr_t       & content,
+      ChannelPriority             priority  = ChannelPriority::Interactive,
+      int                         channel   = UNFRAMED,
+      const written_t           & written   = written_t()
+  )
+  {
+    if( ( not content ) or ( content->empty() and ( channel == UNFRAMED ) ) )
+    {
+      if( written )
+        written( error_t(), 0 );
+      return;
+    }
+
+    ++ m_Pending;
+    m_PendingBytes += content->size() * sizeof( ByteT_ );
+    auto self( this->shared_from_this() );
+    ServiceOf( m_Socket ).post(
+          [ self, owner, content, priority, channel, written ]()
+          {
+            self->Enqueue( owner, content, priority, channel, written );
+          } );
+  }
+
+  /**
+   * @brief Метод Cancel сбрасывает очередь (при останове сессии).
+   */
+  void Cancel ()
+  {
+    error_t ec;
+    m_Timer.cancel( ec );
+    m_Metrics.m_Dropped += m_Queued;
+    m_Pending -= m_Queued;
+    m_PendingBytes -= m_QueuedBytes;
+    std::vector< written_t > dropped;
+    for( auto & queue : m_Queues )
+    {
+      for( auto & item : queue )
+        if( item.m_Written )
+          dropped.push_back( item.m_Written );
+      queue.clear();
+    }
+    m_Queued      = 0;
+    m_QueuedBytes = 0;
+    for( auto & written : dropped )
+      written( boost::asio::error::operation_aborted, 0 );
+  }
+
+private:
+  /**
+   * @brief Структура Item содержит сообщение очереди и объем его переданной
+   *        части.
+   */
+  struct                          Item
+  {
+    content_ptr_t                 m_Content;
+    std::size_t                   m_Offset;
+    int                           m_Channel;
+    written_t                     m_Written;
+  };
+
+  /**
+   * @brief Структура Piece содержит часть сообщения текущей записи.
+   */
+  struct                          Piece
+  {
+    content_ptr_t                 m_Content;
+    std::size_t                   m_Offset;
+    std::size_t                   m_Size;
+    ChannelFrame::header_t        m_Header;
+    bool                          m_Framed;
+    bool                          m_Last;
+    written_t                     m_Written;
+  };
+
+  socket_t                      & m_Socket;
+  BatchPolicy                     m_Policy;
+  asio_steady_timer_t             m_Timer;
+  BatchMetrics                    m_Metrics;
+  /**
+   * @brief Атрибут m_Queues содержит сообщения, ожидающие записи, по
+   *        приоритетам.
+   */
+  std::array< std::deque< Item >, static_cast< std::size_t >( ChannelPriority::Count ) > m_Queues;
+  /**
+   * @brief Атрибут m_Batch содержит части сообщений текущей записи.
+   */
+  std::vector< Piece >            m_Batch;
+  std::size_t                     m_QueuedBytes     { 0 };
+  std::size_t                     m_Queued          { 0 };
+  std::atomic< std::size_t >      m_Pending         { 0 };
+  std::atomic< std::size_t >      m_PendingBytes    { 0 };
+  spo::simple_fnc_t< void >       m_OnError;
+  bool                            m_Writing         { false };
+  bool                            m_TimerArmed      { false };
+  bool                            m_Corked          { false };
+  bool                            m_Urgent          { false };  ///< запись содержит сообщение канала управления
+
+  /**
+   * @brief Метод Enqueue добавляет сообщение в очередь приоритета (в потоке
+   *        сервиса сокета) и, если бюджет задержки исчерпан, передает
+   *        очередь.
+   */
+  void Enqueue
+  (
+      const owner_t             & owner,
+      const content_ptr_t       & content,
+      ChannelPriority             priority,
+      int                         channel,
+      const written_t           & written
+  )
+  {
+    m_QueuedBytes += content->size() * sizeof( ByteT_ );
+    m_Queues[ static_cast< std::size_t >( priority ) ].push_back( Item { content, 0, channel, written } );
+    ++ m_Queued;
+    if( m_Writing )
+      return; // очередь передается после завершения текущей записи
+
+    const bool by_size( ( m_QueuedBytes >= m_Policy.m_MaxBytes )
+                        or ( m_Queued >= m_Policy.m_MaxMessages ) );
+    if( by_size
+        or ( m_Policy.m_BudgetUs <= 0 )
+        or ( priority == ChannelPriority::Control )
+        or written )
+    {
+      if( by_size )
+        ++ m_Metrics.m_SizeFlushes;
+      Flush( owner );
+    }
+    else if( not m_TimerArmed )
+      ArmTimer( owner );
+  }
+
+  void ArmTimer ( const owner_t & owner )
+  {
+    auto self( this->shared_from_this() );
+    m_TimerArmed = true;
+    m_Timer.expires_from_now( std::chrono::microseconds( m_Policy.m_BudgetUs ) );
+    m_Timer.async_wait(
+          [ self, owner ]( const error_t & ec )
+          {
+            self->m_TimerArmed = false;
+            if( IsNoErr( ec ) and ( not self->m_Writing ) and ( self->m_Queued > 0 ) )
+            {
+              ++ self->m_Metrics.m_BudgetFlushes;
+              self->Flush( owner );
+            }
+          } );
+  }
+
+  /**
+   * @brief Метод Select переносит в @a m_Batch части сообщений очередей в
+   *        порядке убывания приоритета (не более
+   *        @a BatchPolicy::m_MaxMessages частей и, кроме первой части,
+   *        @a BatchPolicy::m_MaxBytes байт).
+   */
+  void Select ()
+  {
+    const std::size_t chunk( std::max< std::size_t >( m_Policy.m_ChunkSize / sizeof( ByteT_ ), 1 ) );
+    const std::size_t limit( std::max< std::size_t >( m_Policy.m_MaxMessages, 1 ) );
+    std::size_t bytes( 0 );
+    for( auto & queue : m_Queues )
+      while( not queue.empty() )
+      {
+        if( ( m_Batch.size() >= limit )
+            or ( ( not m_Batch.empty() ) and ( bytes >= m_Policy.m_MaxBytes ) ) )
+          return;
+
+        auto & item( queue.front() );
+        const bool framed( item.m_Channel != UNFRAMED );
+        const std::size_t left( item.m_Content->size() - item.m_Offset );
+        const std::size_t size( framed ? std::min( left, chunk ) : left );
+        const bool last( size == left );
+
+        Piece piece { item.m_Content, item.m_Offset, size, ChannelFrame::header_t(), framed, last,
+                      last ? item.m_Written : written_t() };
+        if( framed )
+        {
+          ChannelFrame frame;
+          frame.m_Channel = static_cast< std::uint8_t >( item.m_Channel );
+          frame.m_Flags   = last ? ChannelFrame::FLAG_LAST : 0;
+          frame.m_Length  = static_cast< std::uint32_t >( size * sizeof( ByteT_ ) );
+          piece.m_Header  = frame.Write();
+        }
+        m_Batch.push_back( piece );
+        bytes += size * sizeof( ByteT_ );
+        m_QueuedBytes -= size * sizeof( ByteT_ );
+
+        if( not last )
+        { // остаток передается следующей записью: очереди более высокого
+          // приоритета проверяются перед ней
+          item.m_Offset += size;
+          ++ m_Metrics.m_Chunks;
+          return;
+        }
+        queue.pop_front();
+        -- m_Queued;
+      }
+  }
+
+  /**
+   * @brief Метод Flush передает части сообщений очереди одной записью.
+   */
+  void Flush ( const owner_t & owner )
+  {
+    error_t ec;
+    if( m_TimerArmed )
+      m_Timer.cancel( ec );
+
+    m_Urgent = not m_Queues[ static_cast< std::size_t >( ChannelPriority::Control ) ].empty();
+    Select();
+    std::vector< boost::asio::const_buffer > buffers;
+    buffers.reserve( m_Batch.size() * 2 );
+    for( auto & piece : m_Batch )
+    {
+      if( piece.m_Framed )
+        buffers.push_back( boost::asio::buffer( piece.m_Header ) );
+      if( piece.m_Size > 0 )
+        buffers.push_back( boost::asio::buffer( piece.m_Content->data() + piece.m_Offset,
+                                                piece.m_Size * sizeof( ByteT_ ) ) );
+    }
+
+    if( m_Policy.m_Cork and ( not m_Corked ) )
+    {
+      SetCork< ProtocolT_ >( m_Socket, true );
+      m_Corked = true;
+    }
+
+    auto self( this->shared_from_this() );
+    m_Writing = true;
+    boost::asio::async_write(
+          m_Socket,
+          buffers,
+          [ self, owner ]( const error_t & ec, std::size_t t )
+          {
+            self->Written( owner, ec, t );
+          } );
+  }
+
+  void Written ( const owner_t & owner, const error_t & ec, std::size_t t )
+  {
+    m_Writing = false;
+
+    std::size_t completed( 0 );
+    std::size_t bytes( 0 );
+    std::vector< std::pair< written_t, std::size_t > > done;
+    for( auto & piece : m_Batch )
+    {
+      bytes += piece.m_Size * sizeof( ByteT_ );
+      if( piece.m_Last )
+        ++ completed;
+      if( piece.m_Written )
+        done.emplace_back( piece.m_Written, piece.m_Content->size() * sizeof( ByteT_ ) );
+    }
+    m_Batch.clear();
+    for( auto & written : done )
+      written.first( ec, IsNoErr( ec ) ? written.second : 0 );
+
+    m_Pending -= completed;
+    m_PendingBytes -= bytes;
+    if( not IsNoErr( ec ) )
+    { // сокет закрыт или недоступен: сообщения очереди не передаются
+      m_Corked = false;
+      m_Metrics.m_Dropped += completed;
+      Cancel();
+      if( m_OnError )
+        m_OnError();
+      return;
+    }
+
+    ++ m_Metrics.m_Writes;
+    m_Metrics.m_Messages += completed;
+    m_Metrics.m_Bytes += t;
+
+    if( m_Corked and ( m_Urgent or ( m_Queued == 0 ) ) )
+    { // очередь передана или записано сообщение канала управления:
+      // неполный сегмент отправляется
+      SetCork< ProtocolT_ >( m_Socket, false );
+      m_Corked = false;
+    }
+
+    // сообщения, накопленные во время записи, ожидали ее завершения
+    if( m_Queued > 0 )
+      Flush( owner );
+  }
+};
+
+//------------------------------------------------------------------------------
+}// namespace                   asio
+}// namespace                   spo
+
+#endif // ASIOSENDBATCHER_H
@@ -3,6 +3,7 @@
 
 #include "asio/ClientServerBase.h"
 #include "asio/AsioSocketSession.h"
+#include "asio/AsioTopicHub.h"
 
 namespace                         spo   {
 namespace                         asio  {
@@ -20,6 +21,10 @@ template
       std::is_same< ProtocolT_, boost::asio::ip::udp >::value
       or
       std::is_same< ProtocolT_, boost::asio::ip::icmp >::value
+      or
+      std::is_same< ProtocolT_, spo::asio::local_stream_t >::value
+      or
+      std::is_same< ProtocolT_, spo::asio::local_datagram_t >::value
     >::type
 >
 class SPO_CORE_EXPORT             AsioServer :
@@ -29,9 +34,25 @@ public:
   using self_t                  = spo::asio::AsioServer< ProtocolT_, ByteT_ >;
   using base_class_t            = spo::asio::ClientServerBase< ProtocolT_, ByteT_ >;
   using protocol_t              = ProtocolT_;
+  using endpoint_type           = typename ProtocolT_::endpoint;
+  using session_shr_t           = std::shared_ptr< spo::asio::AsioSocketSession< ProtocolT_, ByteT_ > >;
+  /**
+   * @brief Тип accept_filter_t определяет обработчик проверки принятого
+   *        подключения до запуска его сессии: false - подключение закрывается.
+   */
+  using accept_filter_t         = spo::simple_fnc_t< bool, session_shr_t >;
+  using topic_hub_t             = spo::asio::AsioTopicHub< ProtocolT_, ByteT_ >;
+  /**
+   * @brief Тип subscribe_t определяет обработчик выбора тем, на которые
+   *        подписывается принятое подключение.
+   */
+  using subscribe_t             = spo::simple_fnc_t< std::vector< std::string >, session_shr_t >;
 
 private:
-  endpoint_t< ProtocolT_ >        m_Endpoint;
+  endpoint_type                   m_Endpoint;
+  accept_filter_t                 m_AcceptFilter;
+  topic_hub_t                     m_Topics;
+  subscribe_t                     m_Subscribe;
 
 public:
   /**
@@ -59,6 +80,93 @@ public:
                   : AsioState::ErrPortCount );
   }
 
+  /**
+   * @brief Конструктор AsioServer формирует экземпляр класса для
+   *        прослушивания подключений на конечной точке @a endpoint (например,
+   *        по пути локального сокета).
+   * @param type             тип (режим) работы сервера;
+   * @param endpoint         конечная точка сервера;
+   * @param serviceTimeoutMs время ожидания активации сервиса.
+   */
+  /**/                            AsioServer
+  (
+      const spo::asio::TransferType   type,
+      const endpoint_type           & endpoint,
+      const std::int64_t            & serviceTimeoutMs = 10000
+  )
+    : base_class_t  ( type, serviceTimeoutMs )
+    , m_Endpoint    ( endpoint )
+  {
+    spo::asio::AsioService::Instance().SetState( AsioState::Ok );
+  }
+
+  /**
+   * @brief Метод SetAcceptFilter назначает обработчик проверки принятых
+   *        подключений (например, по учетным данным процесса клиента
+   *        локального сокета, @a AsioSocketSession::ReadPeerCredentials ).
+   *        Назначается до запуска сервера.
+   */
+  void SetAcceptFilter ( const accept_filter_t & filter )
+  {
+    m_AcceptFilter = filter;
+  }
+
+  /**
+   * @brief Метод AcceptFilter возвращает обработчик проверки принятых
+   *        подключений.
+   */
+  const accept_filter_t & AcceptFilter () const
+  {
+    return m_AcceptFilter;
+  }
+
+  /**
+   * @brief Метод SetSubscribe назначает обработчик выбора тем принятых
+   *        подключений ( @a AsioTopicHub ). Назначается до запуска сервера.
+   */
+  void SetSubscribe ( const subscribe_t & subscribe )
+  {
+    m_Subscribe = subscribe;
+  }
+
+  /**
+   * @brief Метод Subscribe подписывает сессию принятого подключения на темы,
+   *        выбранные обработчиком @a SetSubscribe.
+   * @return true, если сессия подписана хотя бы на одну тему (сессия
+   *         запускается методом @a AsioSocketSession::StartPush ).
+   */
+  bool Subscribe ( const session_shr_t & session )
+  {
+    bool retval( false );
+    if( m_Subscribe )
+      for( auto & topic : m_Subscribe( session ) )
+        retval = m_Topics.Subscribe( topic, session ) or retval;
+    return retval;
+  }
+
+  /**
+   * @brief Метод TopicsRef возвращает ссылку на реестр подписчиков тем.
+   */
+  topic_hub_t & TopicsRef ()
+  {
+    return m_Topics;
+  }
+
+  /**
+   * @brief Метод Publish передает сообщение подписчикам темы @a topic.
+   * @return количество подписчиков, получивших сообщение в очередь.
+   * @see spo::asio::AsioTopicHub::Publish
+   */
+  std::size_t Publish ( const std::string & topic, const typename topic_hub_t::buffer_t & buffer )
+  {
+    return m_Topics.Publish( topic, buffer );
+  }
+
+  std::size_t Publish ( const std::string & topic, const spo::core::docs::BytesDocument< ByteT_ > & document )
+  {
+    return m_Topics.Publish( topic, document );
+  }
+
   /**
    * @brief Метод Protocol возвращает тип (версию) подключения:
    * @return Значение типа (версии) подключения
@@ -117,6 +225,20 @@ public:
         self_t::service_t::Instance().Stop();
   }
 
+  /**
+   * @brief Метод Drain выполняет плавное завершение работы сервера: прием
+   *        подключений прекращается, начатые обмены завершаются в пределах
+   *        времени ожидания, после чего сервис останавливается.
+   * @param deadlineMs время ожидания завершения обменов, мс.
+   * @return количество принудительно остановленных сессий.
+   *
+   * @see spo::asio::AsioService::Drain
+   */
+  std::size_t Drain ( std::int64_t deadlineMs ) BOOST_NOEXCEPT
+  {
+    return self_t::service_t::Instance().Drain( deadlineMs );
+  }
+
   /**
    * @brief Метод TemporaryStart временно запускает сервер на обслуживание
    *        подключений сетевых  клинтов.
@@ -332,6 +332,17 @@ public:
     return retval;
   }
 
+  /**
+   * @brief Метод Drain выполняет плавное завершение работы серверов приема и
+   *        передачи (общий сервис @a spo::asio::AsioService ).
+   * @param deadlineMs время ожидания завершения обменов, мс.
+   * @return количество принудительно остановленных сессий.
+   */
+  std::size_t Drain ( std::int64_t deadlineMs ) BOOST_NOEXCEPT
+  {
+    return AsioService::Instance().Drain( deadlineMs );
+  }
+
   /**
    * @brief Метод TemporaryStart временно запускает сервер на обслуживание
    *        подключений сетевых  клинтов.
@@ -2,6 +2,9 @@
 #define ASIOSERVICE_H
 
 #include "asio/AsioError.h"
+#include "asio/AsioPlacement.h"
+#include "asio/AsioStallWatch.h"
+#include <mutex>
 
 namespace                         spo   {
 namespace                         asio  {
@@ -17,6 +20,14 @@ using io_service_callback_t     = spo::simple_fnc_t< void, void* >;
  */
 using io_service_callbacks_t    = std::vector< std::pair< io_service_callback_t, void* > >;
 
+/**
+ * @brief Тип io_session_drain_t определяет функтор останова сессии,
+ *        зарегистрированной в сервисе, при плавном завершении работы:
+ * @value true  останов выполняется принудительно;
+ * @value false останавливается только сессия, не начавшая обмен данными.
+ */
+using io_session_drain_t        = spo::simple_fnc_t< void, bool >;
+
 /**
  * @brief The IoServiceActionType enum
  */
@@ -65,7 +76,7 @@ public:
   /**/                            AsioService         ( AsioService &&                  ) = delete;
   /**/                            AsioService         ( const spo::asio::io_service_t & ) = delete;
   /**/                            AsioService         ( spo::asio::io_service_t &&      ) = delete;
-  virtual                       ~ AsioService         ()  {}
+  virtual                       ~ AsioService         ()  { JoinIoThreads(); }
 
   virtual AsioService &           operator=           ( const AsioService&              ) = delete;
   virtual AsioService &           operator=           ( AsioService &&                  ) = delete;
@@ -166,6 +177,151 @@ public:
   void                            Poll                ();
   void                            Stop                () BOOST_NOEXCEPT;
 
+  /**
+   * @brief Метод Drain выполняет плавное завершение работы сервиса.
+   *
+   * Выполняются обработчики @a BeforeStop (акцепторы прекращают прием
+   * подключений), сессии, не начавшие обмен данными, закрываются. Сессиям,
+   * выполняющим обмен, предоставляется время до истечения @a deadlineMs для его
+   * завершения, оставшиеся сессии останавливаются принудительно, после чего
+   * останавливается сервис.
+   *
+   * Метод ожидает завершения сессий, обработчики которых выполняются потоками
+   * сервиса. При вызове из потока сервиса (обработчика или сопрограммы)
+   * завершение выполняется отдельным потоком, метод возвращает 0 без
+   * ожидания.
+   *
+   * @param deadlineMs время ожидания завершения обменов, мс.
+   * @return количество принудительно остановленных сессий.
+   */
+  std::size_t                     Drain               ( const std::int64_t & deadlineMs ) BOOST_NOEXCEPT;
+
+  /**
+   * @brief Метод IsDraining сообщает о выполнении плавного завершения работы
+   *        сервиса (метод @a Drain): новые подключения и повторные запуски
+   *        приема не выполняются.
+   */
+  bool                            IsDraining          () const BOOST_NOEXCEPT
+    { return m_Draining; }
+
+  /**
+   * @brief Методы RegisterSession, UnregisterSession и SessionsCount ведут
+   *        реестр запущенных сессий для плавного завершения работы ( @a Drain ).
+   */
+  void                            RegisterSession     ( const void * key, const io_session_drain_t & drain );
+  void                            UnregisterSession   ( const void * key ) BOOST_NOEXCEPT;
+  std::size_t                     SessionsCount       () const;
+
+  /**
+   * @brief Метод SetIoThreads задает потоки ввода/вывода сессий.
+   *
+   * Каждый поток обслуживает собственный сервис Boost.Asio, выполняется на
+   * процессорах своего размещения и выделяет память на узле NUMA размещения.
+   * Сессии принятых TCP-подключений создаются и обслуживаются потоками
+   * ввода/вывода ( @a SessionServiceRef ), прием подключений, клиенты и
+   * UDP-серверы обслуживаются основным сервисом @a ServiceRef.
+   * Пустой список (по умолчанию) - все сессии обслуживаются основным сервисом.
+   * Потоки предыдущего запуска сервиса ожидаются до замены списка.
+   *
+   * @param placements размещение потоков (по элементу на поток).
+   * @return false, если сервис активен (потоки не изменяются).
+   */
+  bool                            SetIoThreads        ( const thread_placements_t & placements );
+
+  std::size_t                     IoThreadsCount      () const BOOST_NOEXCEPT
+    { return m_IoThreads.size(); }
+
+  /**
+   * @brief Метод SetIncomingCpuMatching включает выбор потока ввода/вывода
+   *        сессии по процессору, обработавшему входящие пакеты подключения
+   *        (SO_INCOMING_CPU, очередь приема сетевого адаптера): поток на этом
+   *        процессоре, затем поток на его узле NUMA, затем по очереди.
+   */
+  void                            SetIncomingCpuMatching ( bool match ) BOOST_NOEXCEPT
+    { m_IncomingCpuMatching = match; }
+
+  bool                            IsIncomingCpuMatching  () const BOOST_NOEXCEPT
+    { return m_IncomingCpuMatching; }
+
+  /**
+   * @brief Метод SessionServiceRef выбирает сервис потока ввода/вывода для
+   *        новой сессии.
+   * @param incomingCpu процессор входящих пакетов подключения (-1 - не задан).
+   * @return сервис потока ввода/вывода или основной сервис, если потоки
+   *         ввода/вывода не заданы.
+   */
+  io_service_t                  & SessionServiceRef   ( int incomingCpu = -1 ) BOOST_NOEXCEPT;
+
+  /**
+   * @brief Метод SetStallWatch назначает наблюдение за длительностью
+   *        обработчиков основного потока сервиса и потоков ввода/вывода:
+   *        обработчик или действие канала сессии, выполняемое дольше порога
+   *        @a StallPolicy::m_ThresholdMs, учитывается и сообщается
+   *        ( @a AsioStallWatch::SetReport ).
+   */
+  void                            SetStallWatch       ( const StallPolicy & policy )
+    { AsioStallWatch::Instance().SetPolicy( policy ); }
+
+  const StallMetrics            & StallMetricsRef     () const BOOST_NOEXCEPT
+    { return AsioStallWatch::Instance().MetricsRef(); }
+
+  /**
+   * @brief Метод IsStacklessAvailable сообщает о сборке с поддержкой сопрограмм
+   *        C++20 для обмена данными сессий (qmake CONFIG+=asio_stackless).
+   */
+  static
+  bool                            IsStacklessAvailable () BOOST_NOEXCEPT
+  {
+#if defined( SPO_ASIO_STACKLESS )
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  /**
+   * @brief Метод SetSessionCoroutines задает вид сопрограмм обмена данными
+   *        сессий, запускаемых после вызова метода.
+   * @param kind вид сопрограмм.
+   * @return false, если вид сопрограмм недоступен в данной сборке.
+   */
+  bool                            SetSessionCoroutines ( CoroutineKind kind ) BOOST_NOEXCEPT
+  {
+    if( ( kind == CoroutineKind::Stackless ) and ( not IsStacklessAvailable() ) )
+      return false;
+    m_SessionCoroutines = kind;
+    return true;
+  }
+
+  CoroutineKind                   SessionCoroutines   () const BOOST_NOEXCEPT
+    { return m_SessionCoroutines; }
+
+  /**
+   * @brief Метод SetCoroutineStackSize задает размер стека сопрограмм
+   *        Boost.Coroutine сессий (0 - размер по умолчанию, не менее
+   *        минимального размера стека системы).
+   * @param size размер стека, байт.
+   */
+  void                            SetCoroutineStackSize ( std::size_t size ) BOOST_NOEXCEPT
+    { m_CoroutineStackSize = size; }
+
+  std::size_t                     CoroutineStackSize  () const BOOST_NOEXCEPT
+    { return m_CoroutineStackSize; }
+
+  /**
+   * @brief Метод CoroutineAttributes возвращает атрибуты стека сопрограмм
+   *        Boost.Coroutine сессий для @a boost::asio::spawn.
+   */
+  boost::coroutines::attributes   CoroutineAttributes () const
+  {
+    std::size_t size( m_CoroutineStackSize );
+    return
+        size == 0
+        ? boost::coroutines::attributes()
+        : boost::coroutines::attributes(
+            std::max( size, boost::coroutines::stack_traits::minimum_size() ) );
+  }
+
   error_t                         ErrorCode           () const
     { return m_Error.Code(); }
 
@@ -177,6 +333,32 @@ public:
     return std::ref( m_Service );
   }
 
+  /**
+   * @brief Метод BackendName возвращает наименование механизма ожидания
+   *        событий ввода/вывода, выбранного Boost.Asio при сборке
+   *        ( @a io_uring при сборке с CONFIG+=asio_io_uring ).
+   *
+   * Наименование отражает только выбор реактора Boost.Asio: отдельного
+   * пути обмена через io_uring сессии не имеют.
+   */
+  static
+  const char                    * BackendName         () BOOST_NOEXCEPT
+  {
+#if defined( BOOST_ASIO_HAS_IO_URING_AS_DEFAULT )
+    return "io_uring";
+#elif defined( BOOST_ASIO_HAS_IOCP )
+    return "iocp";
+#elif defined( BOOST_ASIO_HAS_EPOLL )
+    return "epoll";
+#elif defined( BOOST_ASIO_HAS_KQUEUE )
+    return "kqueue";
+#elif defined( BOOST_ASIO_HAS_DEV_POLL )
+    return "dev_poll";
+#else
+    return "select";
+#endif
+  }
+
   /**
    * @brief Защищенный метод SetState назначает текущее состояние серверу
    * @param state значение назначаемого состояния
@@ -215,11 +397,52 @@ private:
    * @brief Атрибут m_State
    */
   AsioState                       m_State             { AsioState::Unknown };
+  /**
+   * @brief Атрибут m_Draining содержит признак плавного завершения работы.
+   */
+  std::atomic_bool                m_Draining          { false };
+  /**
+   * @brief Атрибут m_Sessions содержит функторы останова запущенных сессий
+   *        (ключ - адрес сессии).
+   */
+  std::map< const void *, io_session_drain_t > m_Sessions;
+  mutable std::mutex              m_SessionsMutex;
+
+  /**
+   * @brief Структура IoThread содержит сервис, размещение и поток
+   *        ввода/вывода сессий.
+   */
+  struct                          IoThread
+  {
+    ThreadPlacement               m_Placement;
+    cpu_list_t                    m_Cpus;
+    int                           m_Node            { -1 };
+    io_service_t                  m_Service;
+    asio_workptr_t                m_WorkPtr;
+    threadptr_t                   m_Thread;
+  };
+  /**
+   * @brief Атрибут m_IoThreads содержит потоки ввода/вывода сессий.
+   */
+  std::vector< std::unique_ptr< IoThread > > m_IoThreads;
+  std::atomic< std::size_t >      m_NextIoThread      { 0 };
+  std::atomic_bool                m_IncomingCpuMatching { false };
+  /**
+   * @brief Атрибуты m_SessionCoroutines и m_CoroutineStackSize содержат вид
+   *        сопрограмм сессий и размер стека сопрограмм Boost.Coroutine.
+   */
+  std::atomic< CoroutineKind >    m_SessionCoroutines { CoroutineKind::Stackful };
+  std::atomic< std::size_t >      m_CoroutineStackSize { 0 };
 
   void                            RunServiceCallbacks ( const io_service_callbacks_map_t::key_type & key ) BOOST_NOEXCEPT;
+  void                            DrainSessions       ( bool force ) BOOST_NOEXCEPT;
+  void                            StopService         () BOOST_NOEXCEPT;
   void                            SetDefaultErrorCallbacks () BOOST_NOEXCEPT;
   void                            RunService          () BOOST_NOEXCEPT;
   void                            RunThreadService    () BOOST_NOEXCEPT;
+  void                            RunIoThread         ( IoThread * ioThread ) BOOST_NOEXCEPT;
+  void                            JoinIoThreads       () BOOST_NOEXCEPT;
+  bool                            IsServiceThread     () BOOST_NOEXCEPT;
 };
 
 //------------------------------------------------------------------------------
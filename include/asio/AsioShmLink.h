@@ -0,0 +1,436 @@
+/**
+  * @file AsioShmLink.h
+  * @brief Файл AsioShmLink.h содержит объявление шаблонного класса
+  *        @a spo::asio::AsioShmLink канала обмена документами
+  *        @a spo::core::docs::BytesDocument через кольца разделяемой памяти
+  *        ( @a spo::asio::ShmRegion ) с процессом того же узла.
+  *
+  * Канал обслуживается сервисом @a spo::asio::AsioService и использует те же
+  * обработчики каналов @a spo::asio::IOChannel, что и сессии сокетов:
+  * @value Input  - обработка каждого принятого документа;
+  * @value Output - формирование документа передачи (ответ в режиме
+  *                 HalfDuplexIn или передача по вызову @a Transmit).
+  *
+  * В отличие от сессии сокета, канал не завершается после обмена: он
+  * существует до закрытия управляющего локального сокета любой из сторон.
+  */
+
+#ifndef ASIOSHMLINK_H
+#define ASIOSHMLINK_H
+
+#include "asio/AsioLocal.h"
+#include "asio/AsioService.h"
+#include "asio/IOChannel.h"
+#include "asio/ShmRing.h"
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <deque>
+
+namespace                         spo   {
+namespace                         asio  {
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Структура ShmMetrics содержит счетчики канала разделяемой памяти.
+ */
+struct                            ShmMetrics
+{
+  std::atomic< std::uint64_t >    m_Received        { 0 }; ///< принятые документы
+  std::atomic< std::uint64_t >    m_Sent            { 0 }; ///< переданные документы
+  std::atomic< std::uint64_t >    m_Wakeups         { 0 }; ///< пробуждения другой стороны (eventfd)
+  std::atomic< std::uint64_t >    m_Deferred        { 0 }; ///< документы, ожидавшие места в кольце
+  std::atomic< std::uint64_t >    m_Dropped         { 0 }; ///< документы больше MaxMessage
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс AsioShmLink определяет канал обмена документами с процессом
+ *        того же узла через кольца разделяемой памяти.
+ *
+ * Параметры шаблона:
+ * @value ByteT_ тип единицы информации буфера обмена данными.
+ *
+ * Операции с кольцами выполняются в последовательности ( @a io_strand_t )
+ * канала: у каждого кольца один писатель и один читатель. Документы, не
+ * поместившиеся в кольцо передачи, ожидают освобождения места в очереди
+ * канала; другая сторона пробуждает канал после извлечения сообщений.
+ */
+template< typename                ByteT_            = unsigned char >
+class SPO_CORE_EXPORT             AsioShmLink :
+public                            std::enable_shared_from_this< spo::asio::AsioShmLink< ByteT_ > >
+{
+public:
+  using self_t                  = spo::asio::AsioShmLink< ByteT_ >;
+  using socket_t                = spo::asio::local_stream_t::socket;
+  using channel_t               = spo::asio::IOChannel< ByteT_ >;
+  using buffer_t                = typename channel_t::buffer_t;
+  using content_t               = spo::socket_byffer_t< ByteT_ >;
+
+  /**
+   * @brief Константа DRAIN_BATCH ограничивает количество документов,
+   *        обрабатываемых за один вызов обработчика приема (остальные
+   *        обрабатываются после обработчиков других сессий сервиса).
+   */
+  static const std::size_t        DRAIN_BATCH       = 64;
+
+  /**
+   * @brief Конструктор AsioShmLink создает канал без области разделяемой
+   *        памяти: сервер создает и передает область методом @a Open после
+   *        проверки подключения, клиент назначает полученную область
+   *        методом @a Attach.
+   * @param type    тип (режим) обмена данными;
+   * @param control управляющий локальный сокет (закрытие - завершение канала);
+   * @param actions обработчики каналов приема и передачи.
+   */
+  /**/                            AsioShmLink
+  (
+      spo::asio::TransferType                 type,
+      socket_t                             && control,
+      const buffer_actions_map< ByteT_ >    & actions
+  )
+    : m_Type        ( type )
+    , m_Control     ( std::move( control ) )
+    , m_Strand      ( ServiceOf( m_Control ) )
+    , m_RxEvent     ( ServiceOf( m_Control ) )
+  {
+    for( auto & action : actions )
+      m_Channels.emplace_back( action.second );
+  }
+
+
+  ~ AsioShmLink ()
+  {
+    AsioService::Instance().UnregisterSession( this );
+  }
+
+  io_service_t                  & ServiceRef        () { return ServiceOf( m_Control ); }
+  const ShmMetrics              & MetricsRef        () const { return m_Metrics; }
+  spo::asio::TransferType         TransferType      () const { return m_Type; }
+  bool                            IsOpen            () const { return m_Open; }
+
+  /**
+   * @brief Метод ChannelRef возвращает канал приема или передачи данных.
+   */
+  channel_t & ChannelRef ( const spo::asio::DataType & key )
+  {
+    return std::ref( m_Channels.at( key == spo::asio::DataType::Input ? 0 : 1 ) );
+  }
+
+  /**
+   * @brief Метод MaxMessage возвращает максимальный размер документа, байт.
+   */
+  std::size_t MaxMessage ()
+  {
+    return m_Region ? m_Region->TxRef().MaxMessage() : 0;
+  }
+
+  /**
+   * @brief Метод Attach назначает каналу область разделяемой памяти,
+   *        полученную от другой стороны ( @a ShmRegion::Receive , сторона
+   *        клиента, до @a Start).
+   * @param region область разделяемой памяти канала;
+   * @param ec     код ошибки.
+   */
+  bool Attach ( shm_region_ptr_t region, error_t & ec )
+  {
+    return AttachRegion( std::move( region ), ec );
+  }
+
+  /**
+   * @brief Метод Open создает область разделяемой памяти канала и передает
+   *        ее другой стороне по управляющему сокету (вызывается сервером
+   *        после проверки подключения, до @a Start).
+   * @param capacity размер кольца каждого направления, байт;
+   * @param ec       код ошибки.
+   */
+  bool Open ( std::size_t capacity, error_t & ec )
+  {
+    shm_region_ptr_t region( new ShmRegion );
+    return region->Create( capacity, ec )
+        and region->Send( m_Control.native_handle(), ec )
+        and AttachRegion( std::move( region ), ec );
+  }
+
+  /**
+   * @brief Метод ReadPeerCredentials получает учетные данные процесса другой
+   *        стороны канала.
+   */
+  bool ReadPeerCredentials ( PeerCredentials & credentials, error_t & ec )
+  {
+    return spo::asio::ReadPeerCredentials( m_Control.native_handle(), credentials, ec );
+  }
+
+  /**
+   * @brief Метод SetAfterStop назначает обработчик завершения канала
+   *        (вызывается однократно).
+   */
+  void SetAfterStop ( const spo::asio::io_service_callback_t & f, void * stopParamPtr = nullptr )
+  {
+    m_AfterStop     = f;
+    m_StopParamPtr  = stopParamPtr;
+  }
+
+  /**
+   * @brief Метод Start запускает прием документов и контроль подключения
+   *        другой стороны.
+   */
+  void Start ()
+  {
+    auto self( this->shared_from_this() );
+    std::weak_ptr< self_t > weak_self( self );
+    // очередь ожидания изменяется только в последовательности канала
+    AsioService::Instance().RegisterSession(
+          this,
+          [ weak_self ]( bool force )
+          {
+            auto link_ptr( weak_self.lock() );
+            if( link_ptr )
+              link_ptr->m_Strand.post(
+                    [ weak_self, force ]()
+                    {
+                      auto link_ptr( weak_self.lock() );
+                      if( link_ptr and ( force or link_ptr->IsIdle() ) )
+                        link_ptr->Stop();
+                    } );
+          } );
+
+    m_Open = true;
+    // после подключения другая сторона не передает данные по управляющему
+    // сокету: завершение чтения означает закрытие канала
+    m_Control.async_read_some(
+          boost::asio::buffer( & m_ControlByte, sizeof( m_ControlByte ) ),
+          m_Strand.wrap( [ self ]( const error_t &, std::size_t ) { self->Stop(); } ) );
+    m_Strand.post( [ self ]() { self->Receive(); } );
+  }
+
+  /**
+   * @brief Метод Stop завершает работу канала.
+   */
+  void Stop ()
+  {
+    error_t ec;
+    AsioService::Instance().UnregisterSession( this );
+    m_Open = false;
+    m_RxEvent.cancel( ec );
+    m_RxEvent.close( ec );
+    if( m_Control.is_open() )
+    {
+      m_Control.shutdown( boost::asio::socket_base::shutdown_both, ec );
+      m_Control.close( ec );
+    }
+    if( m_AfterStop and ( not m_Stopped.exchange( true ) ) )
+      m_AfterStop( m_StopParamPtr );
+  }
+
+  /**
+   * @brief Метод IsIdle сообщает об отсутствии документов в обработке:
+   *        принятых и ожидающих места в кольце передачи (вызывается в
+   *        последовательности канала).
+   */
+  bool IsIdle ()
+  {
+    return m_Pending.empty() and ( ( not m_Region ) or m_Region->RxRef().IsEmpty() );
+  }
+
+  /**
+   * @brief Метод Transmit выполняет обработчик канала передачи и передает
+   *        сформированный документ другой стороне (режимы SimplexOut и
+   *        HalfDuplexOut; ответ принимается обработчиком канала приема).
+   * @return false, если канал закрыт.
+   */
+  bool Transmit ()
+  {
+    if( not IsOpen() )
+      return false;
+    auto self( this->shared_from_this() );
+    m_Strand.post( [ self ]() { self->Respond(); } );
+    return true;
+  }
+
+  /**
+   * @brief Метод Send передает другой стороне копию документа @a document.
+   * @return false, если канал закрыт.
+   */
+  bool Send ( const buffer_t & document )
+  {
+    if( not IsOpen() )
+      return false;
+    auto self( this->shared_from_this() );
+    auto content( std::make_shared< content_t >( const_cast< buffer_t & >( document ).ContentRef() ) );
+    m_Strand.post( [ self, content ]() { self->Push( * content ); } );
+    return true;
+  }
+
+private:
+  spo::asio::TransferType         m_Type;
+  socket_t                        m_Control;
+  shm_region_ptr_t                m_Region;
+  io_strand_t                     m_Strand;
+  boost::asio::posix::stream_descriptor m_RxEvent;
+  std::vector< channel_t >        m_Channels;
+  /**
+   * @brief Атрибут m_Pending содержит документы, ожидающие места в кольце
+   *        передачи (в порядке передачи).
+   */
+  std::deque< content_t >         m_Pending;
+  ShmMetrics                      m_Metrics;
+  std::atomic_bool                m_Open            { false };
+  std::atomic_bool                m_Stopped         { false };
+  std::uint64_t                   m_EventValue      { 0 };
+  char                            m_ControlByte     { 0 };
+  io_service_callback_t           m_AfterStop;
+  void                          * m_StopParamPtr    = nullptr;
+
+  /**
+   * @brief Метод AttachRegion назначает каналу область разделяемой памяти.
+   */
+  bool AttachRegion ( shm_region_ptr_t region, error_t & ec )
+  {
+    // дескриптор пробуждения принадлежит области: объект ожидания получает копию
+    ec = error_t();
+    m_Region = std::move( region );
+    m_RxEvent.assign( ::dup( m_Region->RxEventHandle() ), ec );
+    return IsNoErr( ec );
+  }
+
+  /**
+   * @brief Метод Receive передает документы очереди ожидания, обрабатывает
+   *        принятые документы и, если кольцо приема пусто, ожидает
+   *        пробуждения от другой стороны.
+   */
+  void Receive ()
+  {
+    if( ( not IsOpen() ) or ( not m_Region ) )
+      return;
+
+    Flush();
+    auto self( this->shared_from_this() );
+    auto & rx( m_Region->RxRef() );
+    auto & input( m_Channels.at( 0 ) );
+    std::size_t count( 0 );
+    for( ; count < DRAIN_BATCH; ++count )
+    {
+      std::size_t size( 0 );
+      auto data( static_cast< const ByteT_ * >( rx.Front( size ) ) );
+      if( nullptr == data )
+        break;
+
+      input.BufferRef().ContentRef().assign( data, data + size / sizeof( ByteT_ ) );
+      rx.Pop();
+      ++ m_Metrics.m_Received;
+      input.Execute();
+      if( m_Type == spo::asio::TransferType::HalfDuplexIn )
+        Respond();
+    }
+
+    // другая сторона записала в кольцо недопустимые значения
+    if( rx.IsCorrupted() )
+    {
+      Stop();
+      return;
+    }
+
+    if( ( count > 0 ) and rx.ReleaseWriter() )
+    {
+      ++ m_Metrics.m_Wakeups;
+      m_Region->Wake();
+    }
+
+    if( ( count < DRAIN_BATCH ) and rx.PrepareWait() )
+      m_RxEvent.async_read_some(
+            boost::asio::buffer( & m_EventValue, sizeof( m_EventValue ) ),
+            m_Strand.wrap(
+              [ self ]( const error_t & ec, std::size_t )
+              {
+                if( IsNoErr( ec ) or ( ec == boost::asio::error::would_block ) )
+                  self->Receive();
+              } ) );
+    else
+      m_Strand.post( [ self ]() { self->Receive(); } );
+  }
+
+  /**
+   * @brief Метод Respond выполняет обработчик канала передачи и передает
+   *        сформированный документ.
+   */
+  void Respond ()
+  {
+    auto & output( m_Channels.at( 1 ) );
+    output.Clear();
+    if( output.Execute() and ( not output.BufferRef().IsEmpty() ) )
+      Push( output.BufferRef().ContentRef() );
+  }
+
+  /**
+   * @brief Метод Push записывает документ в кольцо передачи или, при
+   *        отсутствии места, в очередь ожидания.
+   */
+  void Push ( const content_t & content )
+  {
+    if( ( not IsOpen() ) or ( not m_Region ) )
+      return;
+
+    const std::size_t size( content.size() * sizeof( ByteT_ ) );
+    if( size > m_Region->TxRef().MaxMessage() )
+    {
+      ++ m_Metrics.m_Dropped;
+      DUMP_CRITICAL( "AsioShmLink: document exceeds ring message size" );
+      return;
+    }
+
+    if( m_Pending.empty() and TryPush( content ) )
+      return;
+
+    ++ m_Metrics.m_Deferred;
+    m_Pending.push_back( content );
+    if( ( m_Pending.size() == 1 ) and ( not m_Region->TxRef().PrepareWaitSpace( size ) ) )
+    { // место освободилось после неудачной записи
+      auto self( this->shared_from_this() );
+      m_Strand.post( [ self ]() { self->Flush(); } );
+    }
+  }
+
+  bool TryPush ( const content_t & content )
+  {
+    bool wake( false );
+    if( not m_Region->TxRef().TryPush( content.data(), content.size() * sizeof( ByteT_ ), wake ) )
+    {
+      if( m_Region->TxRef().IsCorrupted() )
+        Stop();
+      return false;
+    }
+
+    ++ m_Metrics.m_Sent;
+    if( wake )
+    {
+      ++ m_Metrics.m_Wakeups;
+      m_Region->Wake();
+    }
+    return true;
+  }
+
+  /**
+   * @brief Метод Flush записывает документы очереди ожидания в кольцо
+   *        передачи, пока есть место.
+   */
+  void Flush ()
+  {
+    while( ( not m_Pending.empty() ) and TryPush( m_Pending.front() ) )
+      m_Pending.pop_front();
+    if( IsOpen()
+        and ( not m_Pending.empty() )
+        and ( not m_Region->TxRef().PrepareWaitSpace( m_Pending.front().size() * sizeof( ByteT_ ) ) ) )
+    {
+      auto self( this->shared_from_this() );
+      m_Strand.post( [ self ]() { self->Flush(); } );
+    }
+  }
+};
+
+template< typename                ByteT_ >
+using shm_link_ptr_t            = std::shared_ptr< spo::asio::AsioShmLink< ByteT_ > >;
+
+//------------------------------------------------------------------------------
+}// namespace                   asio
+}// namespace                   spo
+
+#endif // ASIOSHMLINK_H
@@ -0,0 +1,177 @@
+/**
+  * @file AsioShmServer.h
+  * @brief Файл AsioShmServer.h содержит объявления сервера
+  *        @a spo::asio::AsioShmServer и клиента @a spo::asio::AsioShmClient
+  *        обмена документами через разделяемую память с процессами того же
+  *        узла.
+  *
+  * Подключение выполняется по локальному сокету: сервер создает область
+  * разделяемой памяти ( @a spo::asio::ShmRegion ), передает клиенту ее
+  * дескрипторы и далее обменивается с ним документами через кольца области
+  * ( @a spo::asio::AsioShmLink ). Локальный сокет остается открытым и служит
+  * признаком подключения другой стороны.
+  *
+  * Обработчики каналов назначаются так же, как серверам сокетов
+  * ( @a ClientServerBase::SetBufferAction ): один и тот же набор обработчиков
+  * может обслуживать сетевых клиентов и клиентов разделяемой памяти.
+  * @code language="cpp"
+  *  spo::asio::AsioTCPServer< char > tcp( spo::asio::TransferType::HalfDuplexIn, 33444 );
+  *  spo::asio::AsioShmServer< char > shm( spo::asio::TransferType::HalfDuplexIn,
+  *                                        "/run/app/app.shm" );
+  *  tcp.SetBufferAction( spo::asio::DataType::Input, on_request );
+  *  shm.SetBufferAction( spo::asio::DataType::Input, on_request );
+  *  tcp.SetBufferAction( spo::asio::DataType::Output, make_reply );
+  *  shm.SetBufferAction( spo::asio::DataType::Output, make_reply );
+  * @endcode
+  */
+
+#ifndef ASIOSHMSERVER_H
+#define ASIOSHMSERVER_H
+
+#include "asio/AsioLinkServer.h"
+#include "asio/AsioShmLink.h"
+
+namespace                         spo   {
+namespace                         asio  {
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс AsioShmServer определяет сервер обмена документами через
+ *        разделяемую память.
+ *
+ * Параметры шаблона:
+ * @value ByteT_ тип единицы информации для каналов обмена данными.
+ *
+ * Область разделяемой памяти создается и передается только клиенту,
+ * прошедшему фильтр подключений ( @a SetAcceptFilter , например, по учетным
+ * данным процесса клиента @a AsioShmLink::ReadPeerCredentials ).
+ */
+template< typename                ByteT_            = unsigned char >
+class SPO_CORE_EXPORT             AsioShmServer :
+public                            spo::asio::AsioLinkServer< spo::asio::local_stream_t, spo::asio::AsioShmLink< ByteT_ >, ByteT_ >
+{
+public:
+  using self_t                  = spo::asio::AsioShmServer< ByteT_ >;
+  using link_t                  = spo::asio::AsioShmLink< ByteT_ >;
+  using base_class_t            = spo::asio::AsioLinkServer< spo::asio::local_stream_t, link_t, ByteT_ >;
+  using link_shr_t              = typename base_class_t::link_shr_t;
+  using socket_t                = typename base_class_t::socket_t;
+  using endpoint_type           = typename base_class_t::endpoint_type;
+  using accept_filter_t         = typename base_class_t::accept_filter_t;
+
+  /**
+   * @brief Константа RING_CAPACITY содержит размер кольца каждого
+   *        направления по умолчанию, байт.
+   */
+  static const std::size_t        RING_CAPACITY     = 1 << 20;
+
+  /**
+   * @brief Конструктор AsioShmServer
+   * @param type             тип (режим) обмена данными;
+   * @param path             путь локального сокета подключения;
+   * @param ringCapacity     размер кольца каждого направления, байт;
+   * @param serviceTimeoutMs время ожидания сервиса.
+   */
+  explicit AsioShmServer
+  (
+      spo::asio::TransferType         type,
+      const std::string             & path,
+      std::size_t                     ringCapacity      = RING_CAPACITY,
+      std::int64_t                    serviceTimeoutMs  = 10000
+  )
+    : base_class_t    ( type, endpoint_type( path ), serviceTimeoutMs )
+    , m_RingCapacity  ( ringCapacity )
+  {}
+
+  std::size_t                     RingCapacity      () const { return m_RingCapacity; }
+
+protected:
+  link_shr_t MakeLink ( socket_t && socket ) override
+  {
+    auto link( std::make_shared< link_t >( base_class_t::TransferType(),
+                                           std::move( socket ),
+                                           base_class_t::ActionsRef() ) );
+    for( auto & channel : { spo::asio::DataType::Input, spo::asio::DataType::Output } )
+      link->ChannelRef( channel ).SetBufferSize( base_class_t::BufferSize() );
+    return link;
+  }
+
+  bool OpenLink ( const link_shr_t & link, error_t & ec ) override
+  {
+    return link->Open( m_RingCapacity, ec );
+  }
+
+private:
+  std::size_t                     m_RingCapacity;
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс AsioShmClient определяет клиента обмена документами через
+ *        разделяемую память с сервером @a AsioShmServer.
+ *
+ * Параметры шаблона:
+ * @value ByteT_ тип единицы информации для каналов обмена данными.
+ *
+ * @par Пример использования:
+ * @code language="cpp"
+ *  spo::asio::AsioShmClient< char > client( spo::asio::TransferType::HalfDuplexOut,
+ *                                           "/run/app/app.shm" );
+ *  client.SetBufferAction( spo::asio::DataType::Output, make_request );
+ *  client.SetBufferAction( spo::asio::DataType::Input, on_reply );
+ *  spo::asio::error_t ec;
+ *  auto link( client.Connect( ec ) );
+ *  if( link )
+ *    link->Transmit();
+ * @endcode
+ */
+template< typename                ByteT_            = unsigned char >
+class SPO_CORE_EXPORT             AsioShmClient :
+public                            spo::asio::AsioLinkClient< spo::asio::local_stream_t, spo::asio::AsioShmLink< ByteT_ >, ByteT_ >
+{
+public:
+  using self_t                  = spo::asio::AsioShmClient< ByteT_ >;
+  using link_t                  = spo::asio::AsioShmLink< ByteT_ >;
+  using base_class_t            = spo::asio::AsioLinkClient< spo::asio::local_stream_t, link_t, ByteT_ >;
+  using link_shr_t              = typename base_class_t::link_shr_t;
+  using socket_t                = typename base_class_t::socket_t;
+  using endpoint_type           = typename base_class_t::endpoint_type;
+
+  explicit AsioShmClient
+  (
+      spo::asio::TransferType         type,
+      const std::string             & path,
+      std::int64_t                    serviceTimeoutMs  = 10000
+  )
+    : base_class_t    ( type, endpoint_type( path ), serviceTimeoutMs )
+  {}
+
+protected:
+  /**
+   * @brief Метод MakeLink получает от сервера область разделяемой памяти и
+   *        создает канал.
+   */
+  link_shr_t MakeLink ( socket_t && socket, error_t & ec ) override
+  {
+    shm_region_ptr_t region( new ShmRegion );
+    if( not region->Receive( socket.native_handle(),
+                             static_cast< int >( base_class_t::TimeoutMs() ),
+                             ec ) )
+      return link_shr_t();
+
+    auto retval( std::make_shared< link_t >( base_class_t::TransferType(),
+                                             std::move( socket ),
+                                             base_class_t::ActionsRef() ) );
+    if( not retval->Attach( std::move( region ), ec ) )
+      return link_shr_t();
+    for( auto & channel : { spo::asio::DataType::Input, spo::asio::DataType::Output } )
+      retval->ChannelRef( channel ).SetBufferSize( base_class_t::BufferSize() );
+    return retval;
+  }
+};
+
+//------------------------------------------------------------------------------
+}// namespace                   asio
+}// namespace                   spo
+
+#endif // ASIOSHMSERVER_H
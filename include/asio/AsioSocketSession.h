@@ -4,6 +4,15 @@
 #include "asio/AsioService.h"
 #include "asio/AsioError.h"
 #include "asio/IOChannel.h"
+#include "asio/AsioTrace.h"
+#include "asio/SocketProfile.h"
+#include "asio/AsioTls.h"
+#include "asio/AsioLocal.h"
+#include "asio/AsioFileTransfer.h"
+#include "asio/AsioSendBatcher.h"
+#include "asio/InboundBudget.h"
+#include "asio/AsioComputePool.h"
+#include <limits>
 
 namespace                         spo   {
 namespace                         asio  {
@@ -28,6 +37,10 @@ template
       std::is_same< Prot_, boost::asio::ip::tcp >::value
       or
       std::is_same< Prot_, boost::asio::ip::udp >::value
+      or
+      std::is_same< Prot_, spo::asio::local_stream_t >::value
+      or
+      std::is_same< Prot_, spo::asio::local_datagram_t >::value
 //      or
 //      std::is_same< Prot_, boost::asio::ip::icmp >::value
     >::type
@@ -55,6 +68,30 @@ bool SetSocketOptions< boost::asio::ip::tcp >
   return retval;
 }
 
+/**
+ * @brief Специализации SetSocketOptions для локальных сокетов: опции
+ *        протоколов IP к ним не применяются.
+ */
+template<>
+inline bool SetSocketOptions< spo::asio::local_stream_t >
+( spo::asio::local_stream_t::socket & socket )
+{
+  bool retval( socket.is_open() );
+  if( retval )
+    socket.non_blocking( true );
+  return retval;
+}
+
+template<>
+inline bool SetSocketOptions< spo::asio::local_datagram_t >
+( spo::asio::local_datagram_t::socket & socket )
+{
+  bool retval( socket.is_open() );
+  if( retval )
+    socket.non_blocking( true );
+  return retval;
+}
+
 template<>
 bool SetSocketOptions< boost::asio::ip::udp >( boost::asio::ip::udp::socket & socket )
 {
@@ -73,6 +110,35 @@ bool SetSocketOptions< boost::asio::ip::udp >( boost::asio::ip::udp::socket & so
   return retval;
 }
 
+#if defined( SPO_ASIO_TLS )
+//------------------------------------------------------------------------------
+/**
+ * @brief Тип tls_stream_t определяет поток TLS поверх сокета TCP сессии.
+ */
+using tls_stream_t              = boost::asio::ssl::stream< boost::asio::ip::tcp::socket & >;
+
+/**
+ * @brief Шаблонная структура tls_stream_factory создает поток TLS для сокета
+ *        протокола: TLS поддерживается только для TCP.
+ */
+template< typename Prot_ >
+struct tls_stream_factory
+{
+  std::unique_ptr< tls_stream_t > operator() ( typename Prot_::socket &, AsioTls & ) const
+  {
+    return std::unique_ptr< tls_stream_t >();
+  }
+};
+
+template<>
+struct tls_stream_factory< boost::asio::ip::tcp >
+{
+  std::unique_ptr< tls_stream_t > operator() ( boost::asio::ip::tcp::socket & socket, AsioTls & tls ) const
+  {
+    return std::unique_ptr< tls_stream_t >( new tls_stream_t( socket, tls.ContextRef() ) );
+  }
+};
+#endif
 
 //------------------------------------------------------------------------------
 /**
@@ -90,6 +156,10 @@ template
       std::is_same< Prot_, boost::asio::ip::tcp >::value
       or
       std::is_same< Prot_, boost::asio::ip::udp >::value
+      or
+      std::is_same< Prot_, spo::asio::local_stream_t >::value
+      or
+      std::is_same< Prot_, spo::asio::local_datagram_t >::value
 //      or
 //      std::is_same< Prot_, boost::asio::ip::icmp >::value
     >::type
@@ -124,6 +194,10 @@ struct async_reader< SocketSession, boost::asio::ip::tcp >
       boost::asio::yield_context                    yield
   ) const
   {
+#if defined( SPO_ASIO_TLS )
+    if( session.IsTls() )
+      return session.TlsStreamPtr()->async_read_some( bufs, yield[ ec ] );
+#endif
     return session.SocketRef().async_read_some( bufs, yield[ ec ] );
   }
 };
@@ -147,6 +221,46 @@ struct async_reader< SocketSession, boost::asio::ip::udp >
   }
 };
 
+/**
+ * @brief Шаблонная структура async_reader определяет реализацию
+ *        опрератора operator() для получения данных из потокового локального
+ *        сокета.
+ */
+template < typename SocketSession >
+struct async_reader< SocketSession, spo::asio::local_stream_t >
+{
+  std::size_t operator()
+  (
+      SocketSession                               & session,
+      boost::asio::streambuf::mutable_buffers_type& bufs,
+      boost::system::error_code                   & ec,
+      boost::asio::yield_context                    yield
+  ) const
+  {
+    return session.SocketRef().async_read_some( bufs, yield[ ec ] );
+  }
+};
+
+/**
+ * @brief Шаблонная структура async_reader определяет реализацию
+ *        опрератора operator() для получения данных из датаграммного
+ *        локального сокета.
+ */
+template < typename SocketSession >
+struct async_reader< SocketSession, spo::asio::local_datagram_t >
+{
+  std::size_t operator()
+  (
+      SocketSession                               & session,
+      boost::asio::streambuf::mutable_buffers_type& bufs,
+      boost::system::error_code                   & ec,
+      boost::asio::yield_context                    yield
+  ) const
+  {
+    return session.SocketRef().async_receive_from( bufs, session.EndpointRef(), yield[ ec ] );
+  }
+};
+
 //------------------------------------------------------------------------------
 /**
  * @brief Шаблонная структура async_writer определяет специализацию
@@ -163,6 +277,10 @@ template
       std::is_same< Prot_, boost::asio::ip::tcp >::value
       or
       std::is_same< Prot_, boost::asio::ip::udp >::value
+      or
+      std::is_same< Prot_, spo::asio::local_stream_t >::value
+      or
+      std::is_same< Prot_, spo::asio::local_datagram_t >::value
 //      or
 //      std::is_same< Prot_, boost::asio::ip::icmp >::value
     >::type
@@ -185,6 +303,9 @@ struct async_writer
 /**
  * @brief Шаблонная структура async_writer определяет реализацию
  *        опрератора operator() для отправки данных в сокет TCP-протокола.
+ *
+ * Данные передаются полностью (@a boost::asio::async_write ): обмен сессии
+ * завершается только после передачи всего буфера.
  */
 template < typename SocketSession >
 struct async_writer< SocketSession, boost::asio::ip::tcp >
@@ -197,7 +318,11 @@ struct async_writer< SocketSession, boost::asio::ip::tcp >
       boost::asio::yield_context  yield
   ) const
   {
-    return session.SocketRef().async_write_some( bufs.data(), yield[ ec ] );
+#if defined( SPO_ASIO_TLS )
+    if( session.IsTls() )
+      return boost::asio::async_write( * session.TlsStreamPtr(), bufs.data(), yield[ ec ] );
+#endif
+    return boost::asio::async_write( session.SocketRef(), bufs.data(), yield[ ec ] );
   }
 };
 
@@ -220,6 +345,46 @@ struct async_writer< SocketSession, boost::asio::ip::udp >
   }
 };
 
+/**
+ * @brief Шаблонная структура async_writer определяет реализацию
+ *        опрератора operator() для отправки данных в потоковый локальный
+ *        сокет (данные передаются полностью).
+ */
+template < typename SocketSession >
+struct async_writer< SocketSession, spo::asio::local_stream_t >
+{
+  std::size_t  operator()
+  (
+      SocketSession             & session,
+      boost::asio::streambuf    & bufs,
+      boost::system::error_code & ec,
+      boost::asio::yield_context  yield
+  ) const
+  {
+    return boost::asio::async_write( session.SocketRef(), bufs.data(), yield[ ec ] );
+  }
+};
+
+/**
+ * @brief Шаблонная структура async_writer определяет реализацию
+ *        опрератора operator() для отправки данных в датаграммный локальный
+ *        сокет.
+ */
+template < typename SocketSession >
+struct async_writer< SocketSession, spo::asio::local_datagram_t >
+{
+  std::size_t  operator()
+  (
+      SocketSession & session,
+      boost::asio::streambuf & bufs,
+      boost::system::error_code & ec,
+      boost::asio::yield_context yield
+  ) const
+  {
+    return session.SocketRef().async_send_to( boost::asio::buffer( bufs.data() ), session.EndpointRef(), yield[ ec ] );
+  }
+};
+
 //------------------------------------------------------------------------------
 
 /**
@@ -266,6 +431,10 @@ template
       std::is_same< ProtocolT_, boost::asio::ip::udp >::value
       or
       std::is_same< ProtocolT_, boost::asio::ip::icmp >::value
+      or
+      std::is_same< ProtocolT_, spo::asio::local_stream_t >::value
+      or
+      std::is_same< ProtocolT_, spo::asio::local_datagram_t >::value
     >::type
 >
 class SPO_CORE_EXPORT             AsioSocketSession :
@@ -278,7 +447,26 @@ public:
   using self_t                  = spo::asio::AsioSocketSession< ProtocolT_, ByteT_ >;
   using shared_t                = std::enable_shared_from_this< self_t >;
   using buffer_container_t      = io_buffers_t< ProtocolT_, ByteT_ >;
+  using channel_t               = typename buffer_container_t::value_type;
   using timer_ptr               = std::shared_ptr< SteadyTimer >;
+  using batcher_t               = spo::asio::AsioSendBatcher< ProtocolT_, ByteT_ >;
+  using batcher_ptr_t           = std::shared_ptr< batcher_t >;
+  /**
+   * @brief Тип stream_receive_t определяет обработчик данных, принятых
+   *        сессией @a StartPush (данные, размер в байтах). Закрытие
+   *        подключения передается вызовом с нулевым размером; false
+   *        останавливает сессию.
+   */
+  using stream_receive_t        = spo::simple_fnc_t< bool, const unsigned char *, std::size_t >;
+
+  /**
+   * @brief Константа IS_STREAM сообщает о потоковом протоколе сессии (TCP,
+   *        потоковые локальные сокеты).
+   */
+  static constexpr bool           IS_STREAM         =
+      std::is_same< ProtocolT_, tcp_t >::value
+      or
+      std::is_same< ProtocolT_, local_stream_t >::value;
 
 private:
   /**
@@ -322,6 +510,12 @@ private:
    * Значение "завернуто" в "уный" указатель общего доступа @a std::shared_ptr
    */
   timer_ptr                       m_TimerPtr;
+  /**
+   * @brief Атрибут m_Strand содержит поток выполнения сопрограмм сессии
+   *        Boost.Coroutine: в нем же возобновляется сопрограмма после
+   *        действия, выполненного в пуле вычислений.
+   */
+  io_strand_t                     m_Strand;
   std::atomic<std::size_t>        m_Transfered    { 0 };
   spo::simple_fnc_t<void>         m_AfterTransfer;
 
@@ -330,6 +524,93 @@ private:
    */
   io_service_callback_t           m_AfterStop;
   void                          * m_StopParamPtr = nullptr;
+  /**
+   * @brief Атрибут m_Stopped содержит признак выполненного останова сессии:
+   *        обработчик @a m_AfterStop вызывается однократно.
+   */
+  std::atomic_bool                m_Stopped       { false };
+  /**
+   * @brief Атрибут m_Exchanging содержит признак начатого обмена данными:
+   *        сессия получила данные или начала передачу. Сессия без начатого
+   *        обмена закрывается сразу при плавном завершении работы сервиса.
+   */
+  std::atomic_bool                m_Exchanging    { false };
+  /**
+   * @brief Атрибут m_SocketProfile содержит профиль опций сокета, уже
+   *        назначенный сокету сессии (унаследованный от прослушивающего сокета
+   *        или назначенный до подключения).
+   */
+  socket_profile_ptr_t            m_SocketProfile;
+  /**
+   * @brief Атрибут m_FileTransfer содержит передачу файла сессии (пустой
+   *        указатель - обмен обработчиками каналов).
+   */
+  file_transfer_ptr_t             m_FileTransfer;
+  /**
+   * @brief Атрибут m_BatchPolicy содержит параметры объединения сообщений,
+   *        передаваемых методом @a Post (пустой указатель - передача без
+   *        удержания).
+   */
+  batch_policy_ptr_t              m_BatchPolicy;
+  /**
+   * @brief Атрибут m_Batcher содержит очередь сообщений метода @a Post
+   *        (создается при первом вызове).
+   */
+  batcher_ptr_t                   m_Batcher;
+  /**
+   * @brief Атрибут m_StreamReceive содержит обработчик данных, принятых
+   *        сессией @a StartPush (пустой - данные отбрасываются).
+   */
+  stream_receive_t                m_StreamReceive;
+  /**
+   * @brief Атрибут m_Inbound содержит объем принятых данных сессии,
+   *        ожидающих обработки, байт.
+   */
+  std::atomic< std::size_t >      m_Inbound       { 0 };
+  std::atomic< std::size_t >      m_InboundHigh   { 0 };
+  std::atomic< std::size_t >      m_InboundLow    { 0 };
+  /**
+   * @brief Атрибут m_ReceiveSize содержит текущий размер буфера канала
+   *        приема ( @a ReceiveBufferSize ).
+   */
+  std::atomic< std::size_t >      m_ReceiveSize   { 512 };
+  /**
+   * @brief Атрибут m_InboundPaused сообщает, что объем данных сессии достиг
+   *        верхней границы и еще не снизился до нижней.
+   */
+  std::atomic_bool                m_InboundPaused { false };
+  /**
+   * @brief Атрибут m_InboundResume содержит обработчик возобновления
+   *        приостановленного чтения.
+   */
+  spo::simple_fnc_t< void >       m_InboundResume;
+  /**
+   * @brief Атрибут m_InboundMutex защищает обработчик @a m_InboundResume и
+   *        совместное изменение @a m_Inbound и @a m_InboundPaused.
+   */
+  std::mutex                      m_InboundMutex;
+  /**
+   * @brief Атрибут m_Priorities содержит приоритеты дополнительных каналов
+   *        передачи сессии (каналов @a m_Channels начиная с
+   *        @a DataType::DataSize ).
+   */
+  std::vector< ChannelPriority >  m_Priorities;
+#if defined( SPO_ASIO_TLS )
+  /**
+   * @brief Атрибут m_TlsContext содержит контекст TLS сессии (пустой
+   *        указатель - обмен без шифрования).
+   */
+  tls_context_ptr_t               m_TlsContext;
+  /**
+   * @brief Атрибут m_TlsPeer содержит идентификатор сервера в кэше сессий
+   *        TLS клиента.
+   */
+  std::string                     m_TlsPeer;
+  /**
+   * @brief Атрибут m_TlsStream содержит поток TLS поверх сокета @a m_Socket.
+   */
+  std::unique_ptr< tls_stream_t > m_TlsStream;
+#endif
 
   void SetTransfered( const std::size_t value, bool onTransferedExec = false )
   {
@@ -341,114 +622,767 @@ private:
     }
   }
 
-public:
   /**
-   * @brief Конструктор AsioSocketSession принимает ссылку на сервис boost::asio::io_service
-   *        и определяет режимы и время ожидания ответа приема и передачи данных.
-   * @param type тип передачи данных
-   * @param socket r-value ссылка на сокет
-   * @param deadLine время ожидания завершкения приема/передачи данныхчерез сетевой
-   *        сокет @a m_Socket;
-   *
-   * Конструктор закрепляет за сессией владение сокетом ( @a std::move )
-   *
-   * @see spo::asio::TransferType
+   * @brief Метод IsReadable сообщает о наличии в сокете данных для приема.
    */
-  /* конструктор */               AsioSocketSession
-  (
-      const spo::asio::TransferType & type,
-      typename ProtocolT_::socket  && socket,
-      const boost::int64_t            deadLine  = boost::int64_t( ASIO_DEADLINE_DEFAULT * 10 )
-  )
-    : m_Socket    ( std::move( socket ) )
-    , m_TimerPtr  ( std::make_shared< timer_ptr::element_type>(
-                                          m_Socket.get_io_service(),
-                                          deadLine ) )
+  bool IsReadable ()
   {
-    assert( m_TimerPtr );
-    SetTransferType( type );
-    SetDefaultErrorCallbacks();
+#if defined( SPO_ASIO_TLS )
+    // расшифрованные данные могут быть уже приняты потоком TLS (вместе с
+    // завершением рукопожатия): готовность определяет чтение из потока
+    if( IsTls() )
+      return IsOpen();
+#endif
+    error_t ec;
+    return IsOpen() and ( SocketRef().available( ec ) > 0 );
   }
 
-  /* конструктор */               AsioSocketSession
-  (
-      const spo::asio::TransferType & type,
-      typename ProtocolT_::socket  && socket,
-      typename ProtocolT_::endpoint   ep,
-      boost::int64_t                  deadLine  = ASIO_DEADLINE_DEFAULT * 10
-  )
-    : AsioSocketSession( type, std::move( socket ), deadLine )
+  /**
+   * @brief Метод BeginReceive подготавливает промежуточный буфер приема
+   *        размером буфера канала приема и запускает таймер ожидания приема.
+   * @param buffer промежуточный буфер.
+   * @return область буфера для приема данных.
+   */
+  boost::asio::streambuf::mutable_buffers_type BeginReceive ( boost::asio::streambuf & buffer )
   {
-    m_Endpoint = ep;
+    m_Exchanging = true;
+    auto bufs( buffer.prepare( ChannelsRef().at( 0 ).BufferSize() ) );
+    StartTimer();
+    return bufs;
   }
 
-  virtual ~AsioSocketSession()
+  /**
+   * @brief Метод EndReceive переносит принятые данные в буфер канала приема.
+   * @param buffer промежуточный буфер;
+   * @param t      количество принятых данных.
+   * @return Признак необходимости выполнения действия канала приема
+   *         ( @a RunAction ) с последующим вызовом @a CompleteReceive.
+   */
+  bool EndReceive ( boost::asio::streambuf & buffer, std::size_t t )
   {
-    Stop();
+    auto & ch_ref = ChannelsRef().at( 0 );
+    SetTransfered( t );
+    SPO_ASIO_TRACE( Resume, this, "read", 0 );
+    SPO_ASIO_TRACE( IoComplete, this, "read", t );
+    buffer.commit( t );
+    if( t > 0 )
+    {
+      // таймер остановлен, т.к. данные получены
+      StopTimer();
+
+      // размер следующего чтения
+      if( ch_ref.Adapt( t ) )
+        m_ReceiveSize = ch_ref.BufferSize();
+
+      if( ch_ref.ActionExists() )
+      { // данные приняты и действие над данными в буфере опаределено
+        // перенос данных из временного буфера в m_Buffer
+        ch_ref.BufferRef().FromStream( buffer );
+
+        // данные учитываются до завершения обработки
+        HoldInbound( t );
+        return true;
+      }
+    }
+    SetTransfered( t, true );
+    return false;
   }
 
-  endpoint_t & EndpointRef()
+  /**
+   * @brief Метод CompleteReceive завершает прием после выполнения действия
+   *        канала приема.
+   * @param t количество принятых данных.
+   */
+  void CompleteReceive ( std::size_t t )
   {
-    return std::ref( m_Endpoint );
+    ReleaseInbound( t );
+
+    // очистка данных (данные больше не нужны, т.к. ими управляет
+    // обработчик @a m_Action); память, превышающая уменьшенный размер
+    // буфера, освобождается
+    auto & ch_ref = ChannelsRef().at( 0 );
+    ch_ref.Clear();
+    if( ch_ref.BufferRef().ContentRef().capacity() > ch_ref.BufferSize() )
+      ch_ref.BufferRef().ContentRef().shrink_to_fit();
+    SetTransfered( t, true );
   }
 
   /**
-   * @brief Метод TransferType возвращает тип (режим) работы сессии:
-   * @return значение типа работы сессии типа @a spo::asio::TransferType :
-   * @value SimplexIn     одностороний прием данных (без ожидания и обработки ответа)
-   * @value SimplexOut    односторонняя передача данных (без ожидания и обработки према данных )
-   * @value HalfDuplexIn  двусторонний последовательный обмен данными ( прием затем передача )
-   * @value HalfDuplexOut двусторонний последовательный обмен данными ( передача затем приём )
-   *
-   * @warning FullDuplex НЕ ИСПОЛЬЗУЕТСЯ ЯВНО!
+   * @brief Метод PrepareSend подготавливает канал передачи к выполнению
+   *        действия ( @a RunAction ).
+   * @return Признак наличия действия канала передачи.
    */
-  spo::asio::TransferType TransferType () const BOOST_NOEXCEPT
+  bool PrepareSend ()
   {
-    return m_TransferType;
+    auto & ch_ref = ChannelsRef().at( 1 );
+    if( not ( IsOpen() and ch_ref.ActionExists() ) )
+      return false;
+
+    m_Exchanging = true;
+
+    // очиска буфера
+    ch_ref.Clear();
+    return true;
   }
 
   /**
-   * @brief Метод SetTransferType назначает тип (режим) работы текущей сессии
-   * @param type значение типа работы ntreotq сессии:
-   * @value SimplexIn     одностороний прием данных (без ожидания и обработки ответа)
-   * @value SimplexOut    односторонняя передача данных (без ожидания и обработки према данных )
-   * @value HalfDuplexIn  двусторонний последовательный обмен данными ( прием затем передача )
-   * @value HalfDuplexOut двусторонний последовательный обмен данными ( передача затем приём )
-   *
-   * @warning FuulDuplex НЕ ИСПОЛЬЗУЕТСЯ ЯВНО: будет задано исключение.
+   * @brief Метод BeginSend переносит подготовленные действием канала
+   *        передачи данные во временный буфер к отправке на сокет.
+   * @param buffer промежуточный буфер.
+   * @return Признак наличия данных к отправке (таймер ожидания передачи
+   *         запущен).
    */
-  void SetTransferType ( const spo::asio::TransferType & type ) BOOST_NOEXCEPT
+  bool BeginSend ( boost::asio::streambuf & buffer )
   {
-    // полный дуплекс реализуется двумя сессиями для двух однонаправленных сокетов!
-    assert( type !=  spo::asio::TransferType::FullDuplex );
-    m_TransferType.store( type );
+    auto & ch_ref = ChannelsRef().at( 1 );
+    if( not IsOpen() or ch_ref.BufferRef().IsEmpty() )
+      return false;
+
+    ch_ref.BufferRef().ToStream( buffer, ch_ref.BufferRef().Size() );
+
+    // запуск таймера ожидания передачи данных
+    StartTimer();
+    return true;
   }
 
   /**
-   * @brief Метод StopTimer останавливает таймер @a m_TimerPtr задержки приема
-   *        или передачи данных через сокет.
+   * @brief Структура AsyncWait содержит состояние операции, завершаемой вне
+   *        сопрограммы сессии (действия канала в пуле вычислений или записи
+   *        очереди исходящих сообщений): таймер ожидания (срок переводится в
+   *        прошлое по завершении операции) и результат операции.
    */
-  void                            StopTimer   ()
-    { if( m_TimerPtr ) m_TimerPtr->Stop(); }
+  struct                          AsyncWait
+  {
+    explicit                      AsyncWait           ( io_service_t & service )
+      : m_Timer( service )
+    {
+      m_Timer.expires_at( asio_steady_timer_t::time_point::max() );
+    }
+
+    /**
+     * @brief Метод Complete отмечает завершение операции в исполнителе
+     *        сопрограммы @a executor (результат операции записывается до
+     *        вызова).
+     */
+    template< typename            ExecutorT_ >
+    static void Complete ( const std::shared_ptr< AsyncWait > & wait, ExecutorT_ executor )
+    {
+      boost::asio::post(
+            executor,
+            [ wait ]()
+            {
+              wait->m_Timer.expires_at( asio_steady_timer_t::time_point::min() );
+            } );
+    }
+
+    asio_steady_timer_t           m_Timer;
+    std::exception_ptr            m_Error;                        ///< исключение действия
+    error_t                       m_Code;                         ///< код завершения записи
+    std::size_t                   m_Transfered        { 0 };      ///< размер записанных данных
+  };
+  using async_wait_ptr_t        = std::shared_ptr< AsyncWait >;
 
   /**
-   * @brief Метод StartTimer pfgrcrftn таймер @a m_TimerPtr задержки приема
-   *        или передачи данных через сокет.
-   * По истечению времени задержки прием или передача прекращаются.
+   * @brief Метод OffloadAction передает действие канала в пул вычислений
+   *        @a AsioComputePool.
+   * @param ch_ref   канал сессии;
+   * @param name     имя действия трассировки;
+   * @param executor исполнитель сопрограммы сессии, в котором отмечается
+   *        завершение действия.
+   * @return состояние ожидания действия или пустой указатель: признак
+   *         канала не назначен или пул не запущен.
+   *
+   * Завершение отмечается и при исключении действия: исключение передается
+   * сопрограмме ( @a WaitAction ).
    */
-  void                            StartTimer   ()
-    { if( m_TimerPtr ) m_TimerPtr->Start(); }
+  template< typename              ExecutorT_ >
+  async_wait_ptr_t OffloadAction ( channel_t & ch_ref, const char * name, ExecutorT_ executor )
+  {
+    if( not ch_ref.IsOffload() )
+      return async_wait_ptr_t();
+
+    auto retval( std::make_shared< AsyncWait >( ServiceRef() ) );
+    auto self( this->shared_from_this() );
+    const bool submitted(
+          AsioComputePool::Instance().Submit(
+            [ self, & ch_ref, retval, name, executor ]()
+            {
+              try
+              {
+                SPO_ASIO_TRACE_SCOPE( self.get(), name );
+                ch_ref.Execute();
+              }
+              catch( ... )
+              {
+                retval->m_Error = std::current_exception();
+              }
+              AsyncWait::Complete( retval, executor );
+            } ) );
+    return submitted ? retval : async_wait_ptr_t();
+  }
 
   /**
-   * @brief Метод TimerRef возвращает ссылку на общий указатель, содержащий
-   *        переменную со значением времени ожидания приема или передачи данных.
-   * @return ссылку на общий указатель.
+   * @brief Метод WaitAction передает сопрограмме исключение действия канала,
+   *        выполненного в пуле вычислений, как при выполнении действия в
+   *        потоке сервиса.
    */
-  timer_ptr                     & TimerRef      ()
-    { return std::ref( m_TimerPtr ); }
+  static void WaitAction ( const async_wait_ptr_t & wait )
+  {
+    if( wait->m_Error )
+      std::rethrow_exception( wait->m_Error );
+  }
 
   /**
-   * @brief Метод IsTimerActive возвращает пнризнак раброты таймера (запущен
+   * @brief Метод RunAction выполняет действие канала в потоке сервиса или,
+   *        для канала с признаком @a IOChannel::IsOffload, в пуле
+   *        вычислений. Сопрограмма ожидает завершения действия, поэтому
+   *        действия сессии выполняются по очереди.
+   * @param ch_ref канал сессии;
+   * @param name   имя действия трассировки;
+   * @param yield  контекст передачи управления сопрограмме.
+   */
+  void RunAction ( channel_t & ch_ref, const char * name, boost::asio::yield_context yield )
+  {
+    auto wait( OffloadAction( ch_ref, name, m_Strand ) );
+    if( not wait )
+    {
+      AsioStallScope stall_scope_( this, name );
+      SPO_ASIO_TRACE_SCOPE( this, name );
+      ch_ref.Execute();
+      return;
+    }
+
+    error_t ec;
+    SPO_ASIO_TRACE( Yield, this, name, 0 );
+    wait->m_Timer.async_wait( yield[ ec ] );
+    SPO_ASIO_TRACE( Resume, this, name, 0 );
+    WaitAction( wait );
+  }
+
+#if defined( SPO_ASIO_STACKLESS )
+  /**
+   * @brief Метод RunActionAsync выполняет действие канала сопрограммой C++20
+   *        (аналог метода @a RunAction ).
+   */
+  boost::asio::awaitable< void > RunActionAsync ( channel_t & ch_ref, const char * name )
+  {
+    auto wait( OffloadAction( ch_ref, name, co_await boost::asio::this_coro::executor ) );
+    if( not wait )
+    {
+      AsioStallScope stall_scope_( this, name );
+      SPO_ASIO_TRACE_SCOPE( this, name );
+      ch_ref.Execute();
+      co_return;
+    }
+
+    error_t ec;
+    co_await wait->m_Timer.async_wait( boost::asio::redirect_error( boost::asio::use_awaitable, ec ) );
+    WaitAction( wait );
+  }
+#endif
+
+  /**
+   * @brief Метод IsQueuedSend сообщает, что данные канала передачи
+   *        записываются в сокет очередью исходящих сообщений сессии
+   *        ( @a AsioSendBatcher ) кадрами канала @a DataType::Output:
+   *        потоковая сессия без TLS с дополнительными каналами
+   *        ( @a AddChannel ). Иначе данные записываются в сокет напрямую,
+   *        без копирования в очередь.
+   */
+  bool IsQueuedSend () const
+  {
+#if defined( SPO_ASIO_TLS )
+    if( IsTls() )
+      return false;
+#endif
+    return IS_STREAM and ( not m_Priorities.empty() );
+  }
+
+  /**
+   * @brief Метод QueueSend передает подготовленные действием канала
+   *        передачи данные в очередь исходящих сообщений сессии с
+   *        приоритетом @a ChannelPriority::Interactive кадрами канала
+   *        @a DataType::Output ( @a IsQueuedSend ).
+   * @param executor исполнитель сопрограммы сессии, в котором отмечается
+   *        завершение записи.
+   * @return состояние ожидания записи или пустой указатель: данных к
+   *         отправке нет (таймер ожидания передачи не запущен).
+   */
+  template< typename              ExecutorT_ >
+  async_wait_ptr_t QueueSend ( ExecutorT_ executor )
+  {
+    return QueueSend( executor, std::integral_constant< bool, IS_STREAM >() );
+  }
+
+  template< typename              ExecutorT_ >
+  async_wait_ptr_t QueueSend ( ExecutorT_, std::false_type )
+  {
+    return async_wait_ptr_t();
+  }
+
+  template< typename              ExecutorT_ >
+  async_wait_ptr_t QueueSend ( ExecutorT_ executor, std::true_type )
+  {
+    auto & ch_ref = ChannelsRef().at( DataType::Output );
+    if( not IsOpen() or ch_ref.BufferRef().IsEmpty() )
+      return async_wait_ptr_t();
+
+    auto retval( std::make_shared< AsyncWait >( ServiceRef() ) );
+    StartTimer();
+    Batcher()->Post( this->shared_from_this(),
+                     Copy( ch_ref.BufferRef() ),
+                     ChannelPriority::Interactive,
+                     static_cast< int >( DataType::Output ),
+                     [ retval, executor ]( const error_t & ec, std::size_t t )
+                     {
+                       retval->m_Code       = ec;
+                       retval->m_Transfered = t;
+                       AsyncWait::Complete( retval, executor );
+                     } );
+    return retval;
+  }
+
+  /**
+   * @brief Метод EndSend завершает передачу данных.
+   * @param t  количество переданных данных;
+   * @param ec код завершения передачи.
+   */
+  void EndSend ( std::size_t t, const error_t & ec )
+  {
+    SetTransfered( t, true );
+    SPO_ASIO_TRACE( Resume, this, "write", 0 );
+    SPO_ASIO_TRACE( IoComplete, this, "write", Transfered() );
+
+    if( not spo::asio::AsioService::Instance().IsError( ec ) )
+    { // передача выполнена: останов таймера
+      StopTimer();
+    }
+  }
+
+  /**
+   * @brief Метод Batcher возвращает очередь исходящих сообщений сессии,
+   *        создавая ее при первом вызове (вызов допускается из любого
+   *        потока).
+   */
+  batcher_ptr_t Batcher ()
+  {
+    auto retval( std::atomic_load( & m_Batcher ) );
+    if( retval )
+      return retval;
+
+    auto policy( std::atomic_load( & m_BatchPolicy ) );
+    BatchPolicy immediate;
+    immediate.m_BudgetUs = 0;
+    auto created( std::make_shared< batcher_t >( SocketRef(), policy ? * policy : immediate ) );
+    std::weak_ptr< self_t > weak( this->shared_from_this() );
+    created->SetErrorHandler(
+          [ weak ]()
+          { // подключение недоступно: сессия закрывается
+            auto session_ptr( weak.lock() );
+            if( session_ptr )
+              session_ptr->Stop();
+          } );
+    // очередь, созданная одновременным вызовом, используется вместо новой
+    if( std::atomic_compare_exchange_strong( & m_Batcher, & retval, created ) )
+      retval = created;
+    return retval;
+  }
+
+  /**
+   * @brief Метод Enqueue передает данные сообщения в очередь исходящих
+   *        сообщений сессии.
+   * @param content  данные сообщения;
+   * @param priority приоритет сообщения;
+   * @param channel  номер канала кадров или @a batcher_t::UNFRAMED.
+   */
+  bool Enqueue
+  (
+      const typename batcher_t::content_ptr_t & content,
+      ChannelPriority                           priority,
+      int                                       channel
+  )
+  {
+    if( not ( IS_STREAM and IsOpen() and content ) )
+      return false;
+#if defined( SPO_ASIO_TLS )
+    if( IsTls() )
+      return false;
+#endif
+
+    Batcher()->Post( this->shared_from_this(), content, priority, channel );
+    return true;
+  }
+
+  /**
+   * @brief Метод Copy возвращает копию содержимого документа для очереди
+   *        исходящих сообщений.
+   */
+  static typename batcher_t::content_ptr_t Copy ( const spo::core::docs::BytesDocument< ByteT_ > & document )
+  {
+    return std::make_shared< typename batcher_t::content_t >(
+          const_cast< spo::core::docs::BytesDocument< ByteT_ > & >( document ).ContentRef() );
+  }
+
+  /**
+   * @brief Метод WhenInboundAllowed приостанавливает чтение сессии до
+   *        снижения объема принятых данных (сессии и общего,
+   *        @a InboundBudget ) до нижней границы.
+   * @param resume обработчик возобновления чтения (вызывается в потоке
+   *        сервиса сессии однократно, в т.ч. при останове сессии).
+   */
+  void WhenInboundAllowed ( const spo::simple_fnc_t< void > & resume )
+  {
+    {
+      std::lock_guard< std::mutex > l( m_InboundMutex );
+      m_InboundResume = resume;
+    }
+    // приостановка по общей границе учитывается, только если она
+    // действительно достигнута, а граница сессии - нет
+    InboundBudget::Instance().CountPause(
+          ( not m_InboundPaused ) and InboundBudget::Instance().IsPaused() );
+    ScheduleResume();
+  }
+
+  /**
+   * @brief Метод ScheduleResume ожидает снятия общего ограничения приема;
+   *        ограничение сессии снимается методом @a ReleaseInbound.
+   */
+  void ScheduleResume ()
+  {
+    if( m_InboundPaused )
+      return;
+
+    std::weak_ptr< self_t > weak_self( this->shared_from_this() );
+    io_service_t * session_service( & ServiceRef() );
+    InboundBudget::Instance().Wait(
+          [ weak_self, session_service ]()
+          {
+            session_service->post(
+                  [ weak_self ]()
+                  {
+                    auto session_ptr( weak_self.lock() );
+                    if( session_ptr )
+                      session_ptr->TryResume();
+                  } );
+          } );
+  }
+
+  /**
+   * @brief Метод TryResume возобновляет приостановленное чтение, если
+   *        ограничения сняты или сессия остановлена.
+   */
+  void TryResume ()
+  {
+    if( ( not IsOpen() ) or IsInboundAllowed() )
+      FireResume( false );
+    else
+      ScheduleResume();
+  }
+
+  /**
+   * @brief Метод FireResume вызывает обработчик возобновления чтения.
+   * @param post вызов в потоке сервиса сессии (при останове).
+   */
+  void FireResume ( bool post )
+  {
+    spo::simple_fnc_t< void > resume;
+    {
+      std::lock_guard< std::mutex > l( m_InboundMutex );
+      resume.swap( m_InboundResume );
+    }
+    if( not resume )
+      return;
+
+    InboundBudget::Instance().CountResume();
+    if( post )
+      ServiceRef().post( resume );
+    else
+      resume();
+  }
+
+#if defined( SPO_ASIO_STACKLESS )
+  /**
+   * @brief Метод WaitInboundAsync ожидает возобновления чтения сопрограммой
+   *        C++20 (аналог метода @a WaitInbound ).
+   */
+  boost::asio::awaitable< void > WaitInboundAsync ()
+  {
+    if( IsInboundAllowed() )
+      co_return;
+
+    error_t ec;
+    auto wake( InboundWake() );
+    co_await wake->async_wait( boost::asio::redirect_error( boost::asio::use_awaitable, ec ) );
+  }
+#endif
+
+  /**
+   * @brief Метод WaitInbound ожидает возобновления приостановленного
+   *        чтения сопрограммой.
+   * @param yield контекст передачи управления сопрограмме.
+   */
+  void WaitInbound ( boost::asio::yield_context yield )
+  {
+    if( IsInboundAllowed() )
+      return;
+
+    error_t ec;
+    auto wake( InboundWake() );
+    SPO_ASIO_TRACE( Yield, this, "inbound", 0 );
+    wake->async_wait( yield[ ec ] );
+    SPO_ASIO_TRACE( Resume, this, "inbound", 0 );
+  }
+
+  /**
+   * @brief Метод InboundWake возвращает таймер ожидания возобновления
+   *        чтения: обработчик возобновления переводит срок таймера в
+   *        прошлое, и ожидание завершается независимо от того, начато ли
+   *        оно.
+   */
+  std::shared_ptr< asio_steady_timer_t > InboundWake ()
+  {
+    auto retval( std::make_shared< asio_steady_timer_t >( ServiceRef() ) );
+    retval->expires_at( asio_steady_timer_t::time_point::max() );
+    WhenInboundAllowed(
+          [ retval ]()
+          {
+            retval->expires_at( asio_steady_timer_t::time_point::min() );
+          } );
+    return retval;
+  }
+
+  /**
+   * @brief Метод StreamBuffer возвращает буфер очередного чтения сессии
+   *        @a StartPush.
+   * @param sized буфер чтения при изменении размера буфера канала приема
+   *        ( @a SetReceiveSizing ): размер буфера канала, но не более
+   *        объема данных, готовых к чтению;
+   * @param size  размер буфера.
+   * @return Указатель на буфер: @a sized или, без изменения размера, общий
+   *         буфер 16 КБ потока сервиса. Память не закрепляется за сессией
+   *         между чтениями.
+   */
+  unsigned char * StreamBuffer ( std::vector< unsigned char > & sized, std::size_t & size )
+  {
+    auto & ch_ref( m_Channels.at( DataType::Input ) );
+    if( not ch_ref.SizingRef().IsAdaptive() )
+    {
+      static thread_local std::vector< unsigned char > scratch( 16384 );
+      size = scratch.size();
+      return scratch.data();
+    }
+
+    error_t ec;
+    const std::size_t available( SocketRef().available( ec ) );
+    size = ch_ref.BufferSize();
+    if( ( available > 0 ) and IsNoErr( ec ) )
+      size = std::min( size, available );
+    sized.resize( size );
+    return sized.data();
+  }
+
+  /**
+   * @brief Метод AdaptStreamBuffer изменяет размер буфера канала приема
+   *        сессии @a StartPush по количеству принятых данных.
+   */
+  void AdaptStreamBuffer ( std::size_t t )
+  {
+    auto & ch_ref( m_Channels.at( DataType::Input ) );
+    if( ( t > 0 ) and ch_ref.Adapt( t ) )
+      m_ReceiveSize = ch_ref.BufferSize();
+  }
+
+  /**
+   * @brief Метод FileTransferFor возвращает передачу файла сессии в
+   *        направлении @a direction.
+   * @return передача файла или пустой указатель: передача не назначена,
+   *         назначена в другом направлении или сессия использует TLS.
+   */
+  file_transfer_ptr_t FileTransferFor ( FileDirection direction )
+  {
+    auto retval( std::atomic_load( & m_FileTransfer ) );
+#if defined( SPO_ASIO_TLS )
+    // данные TLS шифруются в памяти процесса: sendfile/splice неприменимы
+    if( IsTls() )
+      return file_transfer_ptr_t();
+#endif
+    return ( retval and ( retval->Direction() == direction ) )
+        ? retval
+        : file_transfer_ptr_t();
+  }
+
+  /**
+   * @brief Метод BeginFileTransfer подготавливает сокет к передаче файла и
+   *        запускает таймер ожидания.
+   */
+  void BeginFileTransfer ()
+  {
+    error_t ec;
+    m_Exchanging = true;
+    SocketRef().non_blocking( true, ec );
+    StartTimer();
+  }
+
+  /**
+   * @brief Метод StepFileTransfer выполняет шаг передачи файла.
+   * @param transfer передача файла;
+   * @param ec       код ошибки.
+   * @return true - требуется ожидание готовности сокета, false - шаг
+   *         выполнен (или передача завершена, или произошла ошибка).
+   */
+  bool StepFileTransfer ( const file_transfer_ptr_t & transfer, error_t & ec )
+  {
+    auto t( transfer->Transfer( SocketRef().native_handle(), ec ) );
+    if( ec == boost::asio::error::would_block )
+    {
+      ec = error_t();
+      return true;
+    }
+    if( t > 0 )
+    { // время ожидания отсчитывается от последнего шага передачи
+      StopTimer();
+      StartTimer();
+    }
+    else if( IsNoErr( ec ) and ( not transfer->IsComplete() ) )
+      ec = boost::asio::error::eof;
+    return false;
+  }
+
+  /**
+   * @brief Метод EndFileTransfer завершает передачу файла: при ошибке
+   *        сессия останавливается.
+   */
+  void EndFileTransfer ( const file_transfer_ptr_t & transfer, const error_t & ec )
+  {
+    StopTimer();
+    SetTransfered( static_cast< std::size_t >( transfer->Done() ), true );
+    if( not ( IsNoErr( ec ) and transfer->IsComplete() ) )
+    {
+      DUMP_BOOST_ERROR( ec );
+      Stop();
+    }
+  }
+
+  /**
+   * @brief Метод FileWaitType возвращает вид ожидания готовности сокета для
+   *        направления передачи файла.
+   */
+  static boost::asio::socket_base::wait_type FileWaitType ( const file_transfer_ptr_t & transfer )
+  {
+    return transfer->Direction() == FileDirection::Send
+        ? boost::asio::socket_base::wait_write
+        : boost::asio::socket_base::wait_read;
+  }
+
+public:
+  /**
+   * @brief Конструктор AsioSocketSession принимает ссылку на сервис boost::asio::io_service
+   *        и определяет режимы и время ожидания ответа приема и передачи данных.
+   * @param type тип передачи данных
+   * @param socket r-value ссылка на сокет
+   * @param deadLine время ожидания завершкения приема/передачи данныхчерез сетевой
+   *        сокет @a m_Socket;
+   *
+   * Конструктор закрепляет за сессией владение сокетом ( @a std::move )
+   *
+   * @see spo::asio::TransferType
+   */
+  /* конструктор */               AsioSocketSession
+  (
+      const spo::asio::TransferType & type,
+      typename ProtocolT_::socket  && socket,
+      const boost::int64_t            deadLine  = boost::int64_t( ASIO_DEADLINE_DEFAULT * 10 )
+  )
+    : m_Socket    ( std::move( socket ) )
+    , m_TimerPtr  ( std::make_shared< timer_ptr::element_type>(
+                                          ServiceOf( m_Socket ),
+                                          deadLine ) )
+    , m_Strand    ( ServiceOf( m_Socket ) )
+  {
+    assert( m_TimerPtr );
+    SetTransferType( type );
+    SetDefaultErrorCallbacks();
+  }
+
+  /* конструктор */               AsioSocketSession
+  (
+      const spo::asio::TransferType & type,
+      typename ProtocolT_::socket  && socket,
+      typename ProtocolT_::endpoint   ep,
+      boost::int64_t                  deadLine  = ASIO_DEADLINE_DEFAULT * 10
+  )
+    : AsioSocketSession( type, std::move( socket ), deadLine )
+  {
+    m_Endpoint = ep;
+  }
+
+  virtual ~AsioSocketSession()
+  {
+    Stop();
+  }
+
+  endpoint_t & EndpointRef()
+  {
+    return std::ref( m_Endpoint );
+  }
+
+  /**
+   * @brief Метод TransferType возвращает тип (режим) работы сессии:
+   * @return значение типа работы сессии типа @a spo::asio::TransferType :
+   * @value SimplexIn     одностороний прием данных (без ожидания и обработки ответа)
+   * @value SimplexOut    односторонняя передача данных (без ожидания и обработки према данных )
+   * @value HalfDuplexIn  двусторонний последовательный обмен данными ( прием затем передача )
+   * @value HalfDuplexOut двусторонний последовательный обмен данными ( передача затем приём )
+   *
+   * @warning FullDuplex НЕ ИСПОЛЬЗУЕТСЯ ЯВНО!
+   */
+  spo::asio::TransferType TransferType () const BOOST_NOEXCEPT
+  {
+    return m_TransferType;
+  }
+
+  /**
+   * @brief Метод SetTransferType назначает тип (режим) работы текущей сессии
+   * @param type значение типа работы ntreotq сессии:
+   * @value SimplexIn     одностороний прием данных (без ожидания и обработки ответа)
+   * @value SimplexOut    односторонняя передача данных (без ожидания и обработки према данных )
+   * @value HalfDuplexIn  двусторонний последовательный обмен данными ( прием затем передача )
+   * @value HalfDuplexOut двусторонний последовательный обмен данными ( передача затем приём )
+   *
+   * @warning FuulDuplex НЕ ИСПОЛЬЗУЕТСЯ ЯВНО: будет задано исключение.
+   */
+  void SetTransferType ( const spo::asio::TransferType & type ) BOOST_NOEXCEPT
+  {
+    // полный дуплекс реализуется двумя сессиями для двух однонаправленных сокетов!
+    assert( type !=  spo::asio::TransferType::FullDuplex );
+    m_TransferType.store( type );
+  }
+
+  /**
+   * @brief Метод StopTimer останавливает таймер @a m_TimerPtr задержки приема
+   *        или передачи данных через сокет.
+   */
+  void                            StopTimer   ()
+    { if( m_TimerPtr ) m_TimerPtr->Stop(); }
+
+  /**
+   * @brief Метод StartTimer pfgrcrftn таймер @a m_TimerPtr задержки приема
+   *        или передачи данных через сокет.
+   * По истечению времени задержки прием или передача прекращаются.
+   */
+  void                            StartTimer   ()
+    { if( m_TimerPtr ) m_TimerPtr->Start(); }
+
+  /**
+   * @brief Метод TimerRef возвращает ссылку на общий указатель, содержащий
+   *        переменную со значением времени ожидания приема или передачи данных.
+   * @return ссылку на общий указатель.
+   */
+  timer_ptr                     & TimerRef      ()
+    { return std::ref( m_TimerPtr ); }
+
+  /**
+   * @brief Метод IsTimerActive возвращает пнризнак раброты таймера (запущен
    * ли таймер ожидания приема или передпачи информации).
    * @return Признак:
    * @value true  таймер запущен;
@@ -546,6 +1480,24 @@ public:
     return m_Socket.is_open();
   }
 
+  /**
+   * @brief Метод IsIdle сообщает, что сессия ожидает начала обмена: данные не
+   *        получены и не передавались, входящих данных в сокете нет, очередь
+   *        сообщений метода @a Post пуста.
+   * @return Булево значение:
+   * @value true  обмен данными не начат;
+   * @value false обмен выполняется или сокет закрыт.
+   */
+  bool IsIdle ()
+  {
+    error_t ec;
+    return
+        ( not m_Exchanging )
+        and IsOpen()
+        and ( SocketRef().available( ec ) == 0 )
+        and IsBatcherEmpty();
+  }
+
   /**
    * @brief Метод ServiceRef возвращает ссылку на сервис воода/вывода
    *        типа @a boost::asio::io_service для сокета @a m_Socket.
@@ -553,7 +1505,7 @@ public:
    */
   io_service_t & ServiceRef ()
   {
-    return m_Socket.get_io_service();
+    return ServiceOf( m_Socket );
   }
 
   /**
@@ -565,6 +1517,264 @@ public:
     return std::ref( m_Channels );
   }
 
+  /**
+   * @brief Метод SetBufferSize задает размер буфера всех каналов сессии.
+   * @param bSize размер буфера в единицах типа ByteT_.
+   */
+  void SetBufferSize ( std::size_t bSize )
+  {
+    for( auto & ch_ref : m_Channels )
+      ch_ref.SetBufferSize( bSize );
+    m_ReceiveSize = m_Channels.at( DataType::Input ).BufferSize();
+  }
+
+  /**
+   * @brief Метод SetReceiveSizing назначает изменение размера буфера канала
+   *        приема по результатам чтения ( @a IOChannel::Adapt ).
+   */
+  void SetReceiveSizing ( const BufferSizing & sizing )
+  {
+    auto & ch_ref( m_Channels.at( DataType::Input ) );
+    ch_ref.SetSizing( sizing );
+    m_ReceiveSize = ch_ref.BufferSize();
+  }
+
+  /**
+   * @brief Метод ReceiveBufferSize возвращает текущий размер буфера канала
+   *        приема (допускает вызов из любого потока).
+   */
+  std::size_t ReceiveBufferSize () const
+  {
+    return m_ReceiveSize;
+  }
+
+  /**
+   * @brief Метод SetSocketProfile назначает сессии профиль опций, уже
+   *        примененный к ее сокету. При запуске сессии TCP-сокету назначаются
+   *        только ненаследуемые опции профиля вместо опций по умолчанию
+   *        @a SetSocketOptions.
+   * @param profile профиль опций сокета (пустой указатель - опции по умолчанию).
+   */
+  void SetSocketProfile ( const socket_profile_ptr_t & profile )
+  {
+    m_SocketProfile = profile;
+  }
+
+  /**
+   * @brief Метод ReadPeerCredentials возвращает учетные данные процесса
+   *        другой стороны потокового локального сокета (SO_PEERCRED):
+   *        данные фиксируются ядром при подключении и не могут быть подделаны.
+   * @param credentials учетные данные;
+   * @param ec          код ошибки (для сокетов IP - ошибка ядра).
+   * @return Признак получения учетных данных.
+   */
+  bool ReadPeerCredentials ( spo::asio::PeerCredentials & credentials, error_t & ec )
+  {
+    return spo::asio::ReadPeerCredentials( SocketRef().native_handle(), credentials, ec );
+  }
+
+  /**
+   * @brief Метод SetFileTransfer назначает сессии передачу файла: файл
+   *        передается вместо данных канала передачи (FileDirection::Send)
+   *        или принятые данные записываются в файл вместо обработки каналом
+   *        приема (FileDirection::Receive). Назначается до запуска сессии.
+   * @param transfer передача файла (пустой указатель - обмен обработчиками
+   *        каналов).
+   * @return false для датаграммных протоколов (передача не назначена).
+   *
+   * Сессии TLS передают данные обработчиками каналов.
+   */
+  bool SetFileTransfer ( const file_transfer_ptr_t & transfer )
+  {
+    if( not IS_STREAM )
+      return false;
+    std::atomic_store( & m_FileTransfer, transfer );
+    return true;
+  }
+
+  file_transfer_ptr_t FileTransferPtr () const
+  {
+    return std::atomic_load( & m_FileTransfer );
+  }
+
+  /**
+   * @brief Метод SetBatchPolicy назначает параметры объединения сообщений,
+   *        передаваемых методом @a Post. Назначается до первого вызова
+   *        @a Post.
+   * @return false для датаграммных протоколов.
+   */
+  bool SetBatchPolicy ( const batch_policy_ptr_t & policy )
+  {
+    if( not IS_STREAM )
+      return false;
+    std::atomic_store( & m_BatchPolicy, policy );
+    return true;
+  }
+
+  /**
+   * @brief Метод Post передает копию документа @a document через очередь
+   *        исходящих сообщений сессии ( @a AsioSendBatcher ) независимо от
+   *        обмена обработчиками каналов. Метод допускает вызов из любого
+   *        потока; сообщения передаются в порядке вызовов.
+   *
+   * Данные канала Output передаются той же очередью только при наличии
+   * дополнительных каналов ( @a IsQueuedSend ); иначе они записываются в
+   * сокет напрямую, и сообщения метода не должны передаваться одновременно
+   * с обменом каналом Output.
+   *
+   * @return false, если сокет закрыт, протокол датаграммный или сессия
+   *         использует TLS.
+   */
+  bool Post ( const spo::core::docs::BytesDocument< ByteT_ > & document )
+  {
+    return Enqueue( Copy( document ), ChannelPriority::Interactive, batcher_t::UNFRAMED );
+  }
+
+  /**
+   * @brief Метод Post передает данные @a content через очередь исходящих
+   *        сообщений сессии без копирования: неизменяемые данные могут
+   *        одновременно находиться в очередях нескольких сессий
+   *        ( @a AsioTopicHub ).
+   */
+  bool Post ( const typename batcher_t::content_ptr_t & content )
+  {
+    return Enqueue( content, ChannelPriority::Interactive, batcher_t::UNFRAMED );
+  }
+
+  /**
+   * @brief Метод AddChannel добавляет канал передачи с приоритетом
+   *        @a priority. Документы канала передаются кадрами
+   *        ( @a ChannelFrame ) через очередь исходящих сообщений сессии;
+   *        получатель собирает их объектом @a ChannelDemux. Вызывается до
+   *        запуска сессии.
+   * @param priority приоритет канала;
+   * @param action   обработчик подготовки документа канала (метод
+   *                 @a Transmit ).
+   * @return номер канала (не менее @a DataType::DataSize ) или 0, если
+   *         протокол датаграммный или количество каналов исчерпано.
+   */
+  std::size_t AddChannel
+  (
+      ChannelPriority                       priority,
+      const io_channel_action_t< ByteT_ > & action = io_channel_action_t< ByteT_ >()
+  )
+  {
+    if( ( not IS_STREAM ) or ( m_Channels.size() > std::numeric_limits< std::uint8_t >::max() ) )
+      return 0;
+    m_Channels.emplace_back( action, m_Channels.at( DataType::Output ).BufferSize() );
+    m_Priorities.push_back( priority );
+    return m_Channels.size() - 1;
+  }
+
+  /**
+   * @brief Метод ChannelsCount возвращает количество каналов сессии, включая
+   *        каналы приема и передачи.
+   */
+  std::size_t ChannelsCount () const
+  {
+    return m_Channels.size();
+  }
+
+  /**
+   * @brief Метод Post передает копию документа @a document каналом
+   *        @a channel, добавленным методом @a AddChannel.
+   * @return false, если канал не добавлен, сокет закрыт или сессия
+   *         использует TLS.
+   */
+  bool Post ( std::size_t channel, const spo::core::docs::BytesDocument< ByteT_ > & document )
+  {
+    return
+        ( channel >= DataType::DataSize )
+        and ( channel < m_Channels.size() )
+        and Enqueue( Copy( document ), m_Priorities.at( channel - DataType::DataSize ), static_cast< int >( channel ) );
+  }
+
+  /**
+   * @brief Метод Transmit выполняет обработчик канала @a channel,
+   *        добавленного методом @a AddChannel, и передает подготовленный им
+   *        документ. Вызовы для одного канала не выполняются одновременно.
+   * @return false, если обработчик не назначен или вернул false, либо
+   *         документ не передан.
+   */
+  bool Transmit ( std::size_t channel )
+  {
+    if( ( channel < DataType::DataSize ) or ( channel >= m_Channels.size() ) )
+      return false;
+
+    auto & ch_ref( m_Channels[ channel ] );
+    ch_ref.Clear();
+    bool retval;
+    {
+      AsioStallScope stall_scope_( this, "Channel" );
+      SPO_ASIO_TRACE_SCOPE( this, "Channel" );
+      retval = ch_ref.Execute();
+    }
+    retval = retval and Post( channel, ch_ref.BufferRef() );
+    ch_ref.Clear();
+    return retval;
+  }
+
+  /**
+   * @brief Метод BatcherPtr возвращает очередь сообщений метода @a Post
+   *        (пустой указатель - метод не вызывался).
+   */
+  batcher_ptr_t BatcherPtr () const
+  {
+    return std::atomic_load( & m_Batcher );
+  }
+
+  /**
+   * @brief Метод IsBatcherEmpty сообщает, что очередь сообщений метода
+   *        @a Post не создана или пуста.
+   */
+  bool IsBatcherEmpty () const
+  {
+    auto batcher( BatcherPtr() );
+    return ( not batcher ) or batcher->IsEmpty();
+  }
+
+#if defined( SPO_ASIO_TLS )
+  /**
+   * @brief Метод SetTls включает шифрование обмена сессии TCP. Вызывается до
+   *        запуска сессии.
+   * @param context контекст TLS сервера или клиента;
+   * @param peer    идентификатор сервера в кэше сессий TLS клиента (сессия
+   *                сервера возобновляется при повторном подключении).
+   * @return Признак включения TLS (для UDP - false).
+   */
+  bool SetTls ( const tls_context_ptr_t & context, const std::string & peer = std::string() )
+  {
+    m_TlsStream.reset();
+    m_TlsContext = context;
+    m_TlsPeer    = peer;
+    if( m_TlsContext )
+    {
+      m_TlsStream = tls_stream_factory< ProtocolT_ >()( SocketRef(), * m_TlsContext );
+      if( m_TlsStream )
+        m_TlsContext->PrepareSession( m_TlsStream->native_handle(), m_TlsPeer );
+      else
+        m_TlsContext.reset();
+    }
+    return IsTls();
+  }
+
+  /**
+   * @brief Метод IsTls сообщает о шифровании обмена сессии.
+   */
+  bool IsTls () const BOOST_NOEXCEPT
+  {
+    return m_TlsStream.operator bool();
+  }
+
+  /**
+   * @brief Метод TlsStreamPtr возвращает поток TLS сессии.
+   */
+  tls_stream_t * TlsStreamPtr ()
+  {
+    return m_TlsStream.get();
+  }
+#endif
+
   /**
    * @brief Transfered
    * @return
@@ -584,111 +1794,185 @@ public:
   }
 
   /**
-   * @brief SetAfterTransfer
-   * @param f
+   * @brief SetAfterTransfer
+   * @param f
+   */
+  void SetAfterTransfer( const spo::simple_fnc_t<void> & f )
+  {
+    m_AfterTransfer = f;
+  }
+
+  /**
+   * @brief Метод Start запускает обработку приема и отправки данных через сокет.
+   *
+   * Метод реализует методы чередования приема и передачи как набор сопрограмм.
+   * Формируется общий умный указатель @a std::shared_ptr на текущий (this)
+   * экземпляр класса. Необходим для корректного завершения сопрограм без потери
+   * указателя на текущий экземпляр.
+   *
+   * @see boost::asio::spawn, boost::bind, std::enable_shared_from_this
+   * @see Boost.Coroutine
+   */
+  void Start ()
+  {
+    if( m_StreamReceive )
+    { // прием потока данных вместо обмена обработчиками каналов
+      StartPush();
+      return;
+    }
+    if( not Prepare() )
+    {
+      Stop();
+      return;
+    }
+
+    auto self( this->shared_from_this() );
+
+    try
+    {
+#if defined( SPO_ASIO_STACKLESS )
+      if( AsioService::Instance().SessionCoroutines() == CoroutineKind::Stackless )
+        StartStackless( self );
+      else
+#endif
+        StartStackful( self );
+
+      // ожидание окончания таймаута приема/передачи данных по сокету:
+      // выполняется после запуска обмена, запустившего таймер
+      self->ServiceRef().post( boost::bind( & self_t::CheckTimeout, self ) );
+    }
+    catch( const std::exception & e )
+    {
+      UNUSED( AsioService::ExceptionError() );
+      DUMP_EXCEPTION( e );
+    }
+  }
+
+  /**
+   * @brief Метод StartPush запускает сессию передачи сообщений очереди
+   *        ( @a Post ) без обмена обработчиками каналов (например, сессию
+   *        подписчика @a AsioTopicHub ). Сессия остается открытой до
+   *        закрытия подключения другой стороной, ошибки записи или
+   *        освобождения последнего указателя на нее; принятые данные
+   *        передаются обработчику @a SetStreamReceive или отбрасываются.
+   */
+  void StartPush ()
+  {
+    if( not ( IS_STREAM and Prepare() ) )
+    {
+      Stop();
+      return;
+    }
+    WatchPeer();
+  }
+
+  /**
+   * @brief Метод SetStreamReceive назначает обработчик потока принятых
+   *        данных: сессия запускается методом @a Start как сессия
+   *        @a StartPush. Назначается до запуска сессии.
+   * @return false для датаграммных протоколов и сессий TLS.
+   */
+  bool SetStreamReceive ( const stream_receive_t & receive )
+  {
+    if( not IS_STREAM )
+      return false;
+#if defined( SPO_ASIO_TLS )
+    if( IsTls() )
+      return false;
+#endif
+    m_StreamReceive = receive;
+    return true;
+  }
+
+  /**
+   * @brief Метод SetOffload назначает выполнение действия канала
+   *        @a channel ( @a DataType::Input или @a DataType::Output ) в пуле
+   *        вычислений @a AsioComputePool. Вызывается до запуска сессии.
+   * @return false, если канал не участвует в обмене сессии.
+   */
+  bool SetOffload ( std::size_t channel, bool offload = true )
+  {
+    if( channel >= DataType::DataSize )
+      return false;
+    m_Channels.at( channel ).SetOffload( offload );
+    return true;
+  }
+
+  /**
+   * @brief Метод SetInboundLimit назначает границы объема принятых данных
+   *        сессии, ожидающих обработки: при достижении верхней границы
+   *        сессия не читает данные из сокета до снижения объема до нижней.
+   * @param high верхняя граница, байт (0 - без ограничения);
+   * @param low  нижняя граница, байт.
+   *
+   * @see spo::asio::InboundBudget
+   */
+  void SetInboundLimit ( std::size_t high, std::size_t low )
+  {
+    m_InboundHigh = high;
+    m_InboundLow  = std::min( low, high );
+  }
+
+  /**
+   * @brief Метод InboundBytes возвращает объем принятых данных сессии,
+   *        ожидающих обработки, байт.
+   */
+  std::size_t InboundBytes () const
+  {
+    return m_Inbound;
+  }
+
+  /**
+   * @brief Метод IsInboundAllowed сообщает, что ограничения приема сессии и
+   *        общее ( @a InboundBudget ) не достигнуты.
+   */
+  bool IsInboundAllowed () const
+  {
+    return ( not m_InboundPaused ) and ( not InboundBudget::Instance().IsPaused() );
+  }
+
+  /**
+   * @brief Метод HoldInbound учитывает принятые данные, обработка которых
+   *        продолжается после возврата из обработчика (например,
+   *        выполняется в другом потоке). Учет завершается методом
+   *        @a ReleaseInbound.
    */
-  void SetAfterTransfer( const spo::simple_fnc_t<void> & f )
+  void HoldInbound ( std::size_t bytes )
   {
-    m_AfterTransfer = f;
+    InboundBudget::Instance().Acquire( bytes );
+    // объем и признак приостановки изменяются совместно: иначе снижение
+    // объема в другом потоке ( @a ReleaseInbound ) может пройти между
+    // проверкой и установкой признака, и чтение не будет возобновлено
+    std::lock_guard< std::mutex > l( m_InboundMutex );
+    const std::size_t inbound( m_Inbound += bytes );
+    const std::size_t high( m_InboundHigh );
+    if( ( high > 0 ) and ( inbound >= high ) )
+      m_InboundPaused = true;
   }
 
   /**
-   * @brief Метод Start запускает обработку приема и отправки данных через сокет.
-   *
-   * Метод реализует методы чередования приема и передачи как набор сопрограмм.
-   * Формируется общий умный указатель @a std::shared_ptr на текущий (this)
-   * экземпляр класса. Необходим для корректного завершения сопрограм без потери
-   * указателя на текущий экземпляр.
-   *
-   * @see boost::asio::spawn, boost::bind, std::enable_shared_from_this
-   * @see Boost.Coroutine
+   * @brief Метод ReleaseInbound завершает учет обработанных данных.
+   *        Допускает вызов из любого потока.
    */
-  void Start ()
+  void ReleaseInbound ( std::size_t bytes )
   {
-    if( not SetSocketOptions< ProtocolT_ >( SocketRef() ) )
+    InboundBudget::Instance().Release( bytes );
     {
-      Stop();
-      return;
+      std::lock_guard< std::mutex > l( m_InboundMutex );
+      const std::size_t inbound( m_Inbound -= bytes );
+      if( ( not m_InboundPaused ) or ( inbound > m_InboundLow ) )
+        return;
+      m_InboundPaused = false;
     }
 
-    auto self( this->shared_from_this() );
-
-    try
-    {
-      switch( self->TransferType() )
-      {
-        case spo::asio::TransferType::SimplexIn :
-        { // прем данных выполняется первым.
-          boost::asio::spawn(
-                io_strand_t( self->ServiceRef() ),
-                boost::bind( & self_t::Receive, self, _1  ) );
-        }
-        break;
-
-        case spo::asio::TransferType::SimplexOut :
-        { // передача данных выполняется первой
-          boost::asio::spawn(
-                io_strand_t( self->ServiceRef() ),
-                boost::bind( & self_t::Send, self, _1 ) );
-        }
-        break;
-
-        case spo::asio::TransferType::HalfDuplexIn :
-        { // прем данных выполняется первым, затем идет передача
-          boost::asio::spawn(
-                io_strand_t( self->ServiceRef() ),
-                [ this, self ]( boost::asio::yield_context yield )
-                {
-                  spo::asio::error_t  ec;
-
-                  self->Receive ( yield[ ec ] );
-                  if( ( not spo::asio::AsioService::Instance().IsError( ec ) ) and self->IsTransfered() )
-                  {
-                    self->Send( yield[ec] );
-                  }
-                  if( spo::asio::AsioService::Instance().IsError( ec ) )
-                  {
-                    self->Stop();
-                  }
-                } );
-        }
-        break;
-
-        case spo::asio::TransferType::HalfDuplexOut :
-        { // передача данных клиенту выполняется первой, затем следует прием
-          boost::asio::spawn(
-                io_strand_t( self->ServiceRef() ),
-                [ this, self ]( boost::asio::yield_context yield )
-                {
-                  spo::asio::error_t  ec;
-
-                  self->Send ( yield[ ec ] );
-
-                  if( not spo::asio::AsioService::Instance().IsError( ec ) and self->IsTransfered() )
-                  {
-                    self->Receive ( yield );
-                  }
-                  if( spo::asio::AsioService::Instance().IsError( ec ) )
-                  {
-                    self->Stop();
-                  }
-                } );
-        }
-        break;
-        default : throw boost::system::errc::invalid_argument;
-      }
-
-      // запуск алгоритма, выполняемого по окончании таймаута ожидания передачи
-      // данных по сокету.
-      boost::asio::spawn(
-            io_strand_t( self->ServiceRef() ),
-            boost::bind( & self_t::CheckTimeout, self, _1 ) );
-    }
-    catch( const std::exception & e )
-    {
-      UNUSED( AsioService::ExceptionError() );
-      DUMP_EXCEPTION( e );
-    }
+    std::weak_ptr< self_t > weak_self( this->shared_from_this() );
+    ServiceRef().post(
+          [ weak_self ]()
+          {
+            auto session_ptr( weak_self.lock() );
+            if( session_ptr )
+              session_ptr->TryResume();
+          } );
   }
 
   /**
@@ -700,6 +1984,7 @@ public:
   void Stop ()
   {
     spo::asio::error_t ec;
+    AsioService::Instance().UnregisterSession( this );
     try
     {
       StopTimer();
@@ -714,7 +1999,9 @@ public:
     }
 
     m_Socket.close( ec );
-    if( m_AfterStop )
+    // приостановленное чтение завершается
+    FireResume( true );
+    if( m_AfterStop and ( not m_Stopped.exchange( true ) ) )
     {
 //      std::async( std::launch::async, &self_t::m_AfterStop, this, m_StopParamPtr ).
 //          wait_for( std::chrono::milliseconds(0));
@@ -855,50 +2142,37 @@ public:
   void Receive( boost::asio::yield_context yield )
   {
     error_t ec;
+    auto transfer( FileTransferFor( FileDirection::Receive ) );
+    if( transfer )
+    {
+      TransferFile( transfer, yield );
+      return;
+    }
     try
     {
-      auto & ch_ref = ChannelsRef().at(0);
+      // чтение приостанавливается, пока принятые данные не обработаны
+      WaitInbound( yield );
+      if( IsOpen() and ( not IsReadable() ) )
+      { // данные еще не поступили: ожидание готовности сокета к чтению в
+        // пределах времени ожидания таймера сессии
+        StartTimer();
+        SocketRef().async_receive( boost::asio::null_buffers(), yield[ ec ] );
+      }
 
-      if( IsOpen() and ( SocketRef().available( ec ) > 0)/* and IsNoErr( ec )*/ )
+      if( IsReadable() )
       {
-        // сокет располагает данными для приема в буфер
-        // подготовка размера промежуточного буфера
         boost::asio::streambuf buffer;
-        boost::asio::streambuf::mutable_buffers_type bufs(
-              buffer.prepare( ch_ref.BufferSize() ) );
-
-        // запуск таймера ожидания приема данных
-        StartTimer();
+        auto bufs( BeginReceive( buffer ) );
 
         // асинхронный прием данных с получением значения фактически принятых данных
-        SetTransfered(
-            async_reader< AsioSocketSession< ProtocolT_, ByteT_ >, ProtocolT_ >()(
-              *this, bufs, ec, yield ) );
-
-        auto t( Transfered() );
-        buffer.commit( t );
-        if( t > 0 )
+        SPO_ASIO_TRACE( Yield, this, "read", 0 );
+        auto t( async_reader< AsioSocketSession< ProtocolT_, ByteT_ >, ProtocolT_ >()(
+                  *this, bufs, ec, yield ) );
+        if( EndReceive( buffer, t ) )
         {
-          // таймер остановлен, т.к. данные получены
-          StopTimer();
-
-          if( ch_ref.ActionExists() )
-          { // обработчик данных присутствует
-            ec = boost::system::errc::make_error_code( boost::system::errc::success );
-
-            // данные приняты и действие над данными в буфере опаределено
-            // перенос данных из временного буфера в m_Buffer
-            ch_ref.BufferRef().FromStream( buffer );
-
-            // выполнение действия над данными буфера
-            ch_ref.Execute();
-
-            // очистка данных (данные больше не нужны, т.к. ими управляет
-            // обработчик @a m_Action)
-            ch_ref.Clear();
-          }
+          RunAction( ChannelsRef().at( 0 ), "Input", yield );
+          CompleteReceive( t );
         }
-        SetTransfered( t, true );
       }
     }
     catch (std::exception& e)
@@ -915,80 +2189,621 @@ public:
   void Send( boost::asio::yield_context yield )
   {
     error_t ec;
+    auto transfer( FileTransferFor( FileDirection::Send ) );
+    if( transfer )
+    {
+      TransferFile( transfer, yield );
+      return;
+    }
     try
     {
-      auto & ch_ref = ChannelsRef().at( 1 );
-      if( IsOpen() and ch_ref.ActionExists() )
-      {
-        // очиска буфера
-        ch_ref.Clear();
-
-        // подготовка буфера с данными
-        ch_ref.Execute();
-
-        if( not ch_ref.BufferRef().IsEmpty() )
-        { // буфер содержит данных к отправке
-          // перенос данных во временный буфер к оправке на сокет
-          boost::asio::streambuf buffer;
-          ch_ref.BufferRef().ToStream( buffer, ch_ref.BufferRef().Size() );
-
-          // запуск таймера ожидания передачи данных
-          StartTimer();
-
-          // попытка передачи данных в сокет
-          SetTransfered(
-              async_writer< AsioSocketSession<ProtocolT_,ByteT_>, ProtocolT_ >()(
-                *this, buffer, ec, yield ), true );
-
-          if( not spo::asio::AsioService::Instance().IsError( ec ) )
-          { // передача выполнена: останов таймера
-            StopTimer();
-          }
+      boost::asio::streambuf buffer;
+      if( not PrepareSend() )
+        return;
+
+      RunAction( ChannelsRef().at( 1 ), "Output", yield );
+      if( IsQueuedSend() )
+      { // запись выполняется очередью исходящих сообщений
+        auto wait( QueueSend( m_Strand ) );
+        if( wait )
+        {
+          SPO_ASIO_TRACE( Yield, this, "write", 0 );
+          wait->m_Timer.async_wait( yield[ ec ] );
+          EndSend( wait->m_Transfered, wait->m_Code );
         }
       }
+      else if( BeginSend( buffer ) )
+      { // попытка передачи данных в сокет
+        SPO_ASIO_TRACE( Yield, this, "write", 0 );
+        auto t( async_writer< AsioSocketSession<ProtocolT_,ByteT_>, ProtocolT_ >()(
+                  *this, buffer, ec, yield ) );
+        EndSend( t, ec );
+      }
+    }
+    catch( const std::exception & e )
+    {
+      ec = AsioService::ExceptionError();
+      DUMP_EXCEPTION( e );
+    }
+  }
+
+  /**
+   * @brief Метод TransferFile реализует сопрограмму передачи или приема
+   *        файла сессии.
+   * @param transfer передача файла;
+   * @param yield    контент условия передачи управления сопрограме.
+   */
+  void TransferFile( const file_transfer_ptr_t & transfer, boost::asio::yield_context yield )
+  {
+    error_t ec;
+    try
+    {
+      BeginFileTransfer();
+      while( IsNoErr( ec ) and IsOpen() and ( not transfer->IsComplete() ) )
+        if( StepFileTransfer( transfer, ec ) )
+        {
+          SPO_ASIO_TRACE( Yield, this, "file", 0 );
+          SocketRef().async_wait( FileWaitType( transfer ), yield[ ec ] );
+          SPO_ASIO_TRACE( Resume, this, "file", 0 );
+        }
     }
     catch( const std::exception & e )
     {
       ec = AsioService::ExceptionError();
       DUMP_EXCEPTION( e );
     }
+    EndFileTransfer( transfer, ec );
+  }
+
+  /**
+   * @brief Метод Prepare назначает опции сокета перед запуском сессии и
+   *        регистрирует сессию для плавного завершения работы сервиса.
+   * @return false, если опции сокета не назначены.
+   */
+  bool Prepare ()
+  {
+    // опции сокета, унаследованные от прослушивающего сокета или назначенные
+    // до подключения, повторно не назначаются
+    bool options_valid(
+          ( m_SocketProfile and std::is_same< ProtocolT_, tcp_t >::value )
+          ? IsOpen()
+          : SetSocketOptions< ProtocolT_ >( SocketRef() ) );
+    if( not options_valid )
+      return false;
+    if( m_SocketProfile )
+    {
+      error_t ec;
+      if( not m_SocketProfile->template ApplyConnected< ProtocolT_ >( SocketRef(), ec ) )
+        DUMP_BOOST_ERROR( ec );
+    }
+
+    // регистрация сессии для плавного завершения работы сервиса: останов
+    // выполняется в потоке сервиса сессии
+    std::weak_ptr< self_t > weak_self( this->shared_from_this() );
+    io_service_t * session_service( & ServiceRef() );
+    AsioService::Instance().RegisterSession(
+          this,
+          [ weak_self, session_service ]( bool force )
+          {
+            session_service->post(
+                  [ weak_self, force ]()
+                  {
+                    auto session_ptr( weak_self.lock() );
+                    if( session_ptr and ( force or session_ptr->IsIdle() ) )
+                      session_ptr->Stop();
+                  } );
+          } );
+    return true;
+  }
+
+  /**
+   * @brief Метод WatchPeer ожидает готовности сокета сессии @a StartPush к
+   *        чтению и передает принятые данные обработчику
+   *        @a m_StreamReceive (без обработчика данные отбрасываются);
+   *        закрытие подключения другой стороной останавливает сессию.
+   *
+   * Ожидание без обработчика не удерживает сессию; с обработчиком сессия
+   * существует, пока подключение открыто.
+   */
+  void WatchPeer ()
+  {
+    std::weak_ptr< self_t > weak_self( this->shared_from_this() );
+    auto hold( m_StreamReceive ? this->shared_from_this() : std::shared_ptr< self_t >() );
+    if( not IsInboundAllowed() )
+    { // принятые данные не обработаны: чтение возобновляется после их
+      // обработки, данные остаются в буфере сокета
+      WhenInboundAllowed(
+            [ weak_self, hold ]()
+            {
+              auto session_ptr( weak_self.lock() );
+              if( session_ptr )
+                session_ptr->WatchPeer();
+            } );
+      return;
+    }
+
+    SocketRef().async_wait(
+          boost::asio::socket_base::wait_read,
+          [ weak_self, hold ]( const error_t & ec )
+          {
+            auto session_ptr( weak_self.lock() );
+            if( not session_ptr )
+              return;
+
+            error_t rec;
+            std::vector< unsigned char > sized;
+            std::size_t size( 0 );
+            unsigned char * buffer( session_ptr->StreamBuffer( sized, size ) );
+            const std::size_t t( IsNoErr( ec ) and session_ptr->IsOpen()
+                                 ? session_ptr->SocketRef().receive( boost::asio::buffer( buffer, size ), 0, rec )
+                                 : 0 );
+            auto & receive( session_ptr->m_StreamReceive );
+            if( ( t == 0 ) or ( not IsNoErr( rec ) ) )
+            { // подключение закрыто: обработчик уведомляется однократно
+              if( receive )
+                receive( nullptr, 0 );
+              session_ptr->Stop();
+            }
+            else
+            {
+              session_ptr->HoldInbound( t );
+              bool accepted;
+              {
+                AsioStallScope stall_scope_( session_ptr.get(), "Stream" );
+                accepted = ( not receive ) or receive( buffer, t );
+              }
+              session_ptr->ReleaseInbound( t );
+              session_ptr->AdaptStreamBuffer( t );
+              if( accepted )
+                session_ptr->WatchPeer();
+              else
+              {
+                receive( nullptr, 0 );
+                session_ptr->Stop();
+              }
+            }
+          } );
+  }
+
+  /**
+   * @brief Метод StartStackful запускает обмен данными сессии сопрограммами
+   *        Boost.Coroutine ( @a boost::asio::spawn ) с размером стека
+   *        @a AsioService::CoroutineStackSize.
+   * @param self указатель на сессию.
+   */
+  void StartStackful ( const std::shared_ptr< self_t > & self )
+  {
+    auto attributes( AsioService::Instance().CoroutineAttributes() );
+#if defined( SPO_ASIO_TLS )
+    if( IsTls() )
+    { // рукопожатие, обмен и завершение TLS выполняются одной сопрограммой
+      SPO_ASIO_TRACE( SessionSpawn, this, "Tls", 0 );
+      boost::asio::spawn(
+            self->m_Strand,
+            boost::bind( & self_t::ExchangeTls, self, _1 ),
+            attributes );
+      return;
+    }
+#endif
+    switch( self->TransferType() )
+    {
+      case spo::asio::TransferType::SimplexIn :
+      { // прем данных выполняется первым.
+        SPO_ASIO_TRACE( SessionSpawn, this, "SimplexIn", 0 );
+        boost::asio::spawn(
+              self->m_Strand,
+              boost::bind( & self_t::Receive, self, _1  ),
+              attributes );
+      }
+      break;
+
+      case spo::asio::TransferType::SimplexOut :
+      { // передача данных выполняется первой
+        SPO_ASIO_TRACE( SessionSpawn, this, "SimplexOut", 0 );
+        boost::asio::spawn(
+              self->m_Strand,
+              boost::bind( & self_t::Send, self, _1 ),
+              attributes );
+      }
+      break;
+
+      case spo::asio::TransferType::HalfDuplexIn :
+      { // прем данных выполняется первым, затем идет передача
+        SPO_ASIO_TRACE( SessionSpawn, this, "HalfDuplexIn", 0 );
+        boost::asio::spawn(
+              self->m_Strand,
+              [ this, self ]( boost::asio::yield_context yield )
+              {
+                spo::asio::error_t  ec;
+
+                self->Receive ( yield[ ec ] );
+                if( ( not spo::asio::AsioService::Instance().IsError( ec ) ) and self->IsTransfered() )
+                {
+                  self->Send( yield[ec] );
+                }
+                if( spo::asio::AsioService::Instance().IsError( ec ) )
+                {
+                  self->Stop();
+                }
+              },
+              attributes );
+      }
+      break;
+
+      case spo::asio::TransferType::HalfDuplexOut :
+      { // передача данных клиенту выполняется первой, затем следует прием
+        SPO_ASIO_TRACE( SessionSpawn, this, "HalfDuplexOut", 0 );
+        boost::asio::spawn(
+              self->m_Strand,
+              [ this, self ]( boost::asio::yield_context yield )
+              {
+                spo::asio::error_t  ec;
+
+                self->Send ( yield[ ec ] );
+
+                if( not spo::asio::AsioService::Instance().IsError( ec ) and self->IsTransfered() )
+                {
+                  self->Receive ( yield );
+                }
+                if( spo::asio::AsioService::Instance().IsError( ec ) )
+                {
+                  self->Stop();
+                }
+              },
+              attributes );
+      }
+      break;
+      default : throw boost::system::errc::invalid_argument;
+    }
+
+  }
+
+#if defined( SPO_ASIO_TLS )
+  /**
+   * @brief Метод Handshake выполняет рукопожатие TLS в пределах времени
+   *        ожидания сессии.
+   * @param yield контекст передачи управления сопрограмме.
+   * @return Признак успешного рукопожатия.
+   */
+  bool Handshake ( boost::asio::yield_context yield )
+  {
+    error_t ec;
+    StartTimer();
+    SPO_ASIO_TRACE( Yield, this, "handshake", 0 );
+    m_TlsStream->async_handshake( TlsHandshakeType(), yield[ ec ] );
+    SPO_ASIO_TRACE( Resume, this, "handshake", 0 );
+    StopTimer();
+    return m_TlsContext->CompleteHandshake( m_TlsStream->native_handle(), ec );
+  }
+
+  /**
+   * @brief Метод Shutdown завершает сеанс TLS (обмен уведомлениями
+   *        close_notify). Клиент TLS 1.3 при этом принимает билет сессии,
+   *        если обмен сессии не включал прием данных.
+   * @param yield контекст передачи управления сопрограмме.
+   */
+  void Shutdown ( boost::asio::yield_context yield )
+  {
+    if( not IsOpen() )
+      return;
+
+    error_t ec;
+    StartTimer();
+    SPO_ASIO_TRACE( Yield, this, "shutdown", 0 );
+    m_TlsStream->async_shutdown( yield[ ec ] );
+    SPO_ASIO_TRACE( Resume, this, "shutdown", 0 );
+    StopTimer();
+  }
+
+  /**
+   * @brief Метод ExchangeTls реализует сопрограмму обмена данными сессии TLS
+   *        в режиме @a TransferType : рукопожатие, обмен, завершение сеанса.
+   * @param yield контекст передачи управления сопрограмме.
+   */
+  void ExchangeTls ( boost::asio::yield_context yield )
+  {
+    if( not Handshake( yield ) )
+    {
+      Stop();
+      return;
+    }
+
+    switch( TransferType() )
+    {
+      case spo::asio::TransferType::SimplexIn :
+        Receive( yield );
+        break;
+
+      case spo::asio::TransferType::SimplexOut :
+        Send( yield );
+        break;
+
+      case spo::asio::TransferType::HalfDuplexIn :
+        Receive( yield );
+        if( IsTransfered() )
+          Send( yield );
+        break;
+
+      case spo::asio::TransferType::HalfDuplexOut :
+        Send( yield );
+        if( IsTransfered() )
+          Receive( yield );
+        break;
+
+      default :
+        break;
+    }
+    Shutdown( yield );
+  }
+
+  boost::asio::ssl::stream_base::handshake_type TlsHandshakeType () const
+  {
+    return
+        m_TlsContext->Role() == TlsRole::Server
+        ? boost::asio::ssl::stream_base::server
+        : boost::asio::ssl::stream_base::client;
+  }
+#endif
+
+#if defined( SPO_ASIO_STACKLESS )
+  /**
+   * @brief Метод StartStackless запускает обмен данными сессии сопрограммой
+   *        C++20 ( @a boost::asio::co_spawn ): состояние сопрограммы
+   *        размещается в куче и не требует отдельного стека.
+   * @param self указатель на сессию.
+   */
+  void StartStackless ( const std::shared_ptr< self_t > & self )
+  {
+    SPO_ASIO_TRACE( SessionSpawn, this, "Exchange", 0 );
+    boost::asio::co_spawn( boost::asio::make_strand( self->ServiceRef() ),
+                           Exchange( self ), boost::asio::detached );
   }
+#endif
 
+#if defined( SPO_ASIO_STACKLESS )
   /**
-   * @brief Метод CheckTimeout возвращает признак продолжения работы сопрограммы
-   * по таймауту.
-   * @param socket ссылка на сокет, к которому "привязан" таймер
-   * @param yield   метод условия передачи управления сопрограмме или продолжения
-   *                выполнения текущего метода.
-   * @return Признак продолжения работы:
-   * @value true работа (чтение или запись через сокет ) может быть продолжена
-   * @value false работа должна быть прервана по таймауту или по закрытию сокета.
+   * @brief Метод ReceiveAsync реализует прием данных из сокета сопрограммой
+   *        C++20 (аналог метода @a Receive ).
+   * @return код завершения обмена.
    */
-  void CheckTimeout( boost::asio::yield_context yield )
+  boost::asio::awaitable< error_t > ReceiveAsync ()
   {
-    auto self( this/*->shared_from_this()*/ );
-    boost::system::error_code ignored_ec;
+    error_t ec;
+    auto token( boost::asio::redirect_error( boost::asio::use_awaitable, ec ) );
+    auto transfer( FileTransferFor( FileDirection::Receive ) );
+    if( transfer )
+    {
+      co_await TransferFileAsync( transfer );
+      co_return error_t();
+    }
     try
     {
-      if( SocketRef().is_open() )
+      co_await WaitInboundAsync();
+      if( IsOpen() and ( not IsReadable() ) )
+      {
+        StartTimer();
+        co_await SocketRef().async_receive( boost::asio::null_buffers(), token );
+      }
+
+      if( IsReadable() )
       {
-        if( self->IsTimerActive() )
+        boost::asio::streambuf buffer;
+        auto bufs( BeginReceive( buffer ) );
+
+        SPO_ASIO_TRACE( Yield, this, "read", 0 );
+        std::size_t t( 0 );
+#if defined( SPO_ASIO_TLS )
+        if( IsTls() )
+          t = co_await TlsStreamPtr()->async_read_some( bufs, token );
+        else
+#endif
+        if constexpr( IS_STREAM )
+          t = co_await SocketRef().async_read_some( bufs, token );
+        else
+          t = co_await SocketRef().async_receive_from( bufs, EndpointRef(), token );
+        if( EndReceive( buffer, t ) )
+        {
+          co_await RunActionAsync( ChannelsRef().at( 0 ), "Input" );
+          CompleteReceive( t );
+        }
+      }
+    }
+    catch( const std::exception & e )
+    {
+      ec = AsioService::ExceptionError();
+      DUMP_EXCEPTION( e );
+    }
+    co_return ec;
+  }
+
+  /**
+   * @brief Метод SendAsync реализует отправку данных через сокет сопрограммой
+   *        C++20 (аналог метода @a Send ).
+   * @return код завершения обмена.
+   */
+  boost::asio::awaitable< error_t > SendAsync ()
+  {
+    error_t ec;
+    auto token( boost::asio::redirect_error( boost::asio::use_awaitable, ec ) );
+    auto transfer( FileTransferFor( FileDirection::Send ) );
+    if( transfer )
+    {
+      co_await TransferFileAsync( transfer );
+      co_return error_t();
+    }
+    try
+    {
+      boost::asio::streambuf buffer;
+      if( not PrepareSend() )
+        co_return ec;
+
+      co_await RunActionAsync( ChannelsRef().at( 1 ), "Output" );
+      if( IsQueuedSend() )
+      { // запись выполняется очередью исходящих сообщений
+        auto wait( QueueSend( co_await boost::asio::this_coro::executor ) );
+        if( wait )
         {
-          // асинжронно выполнить ожидание в течение заданного времени
-          self->TimerRef()->TimerRef().async_wait( yield[ ignored_ec ] );
-          if( self->TimerRef()->IsExpired( ignored_ec ) )
-          { // время ожидания приема/передачи через сокет истекло
-            self->Stop();
-            yield[ ignored_ec ];
-          }
+          SPO_ASIO_TRACE( Yield, this, "write", 0 );
+          co_await wait->m_Timer.async_wait( token );
+          ec = wait->m_Code;
+          EndSend( wait->m_Transfered, ec );
         }
       }
+      else if( BeginSend( buffer ) )
+      {
+        SPO_ASIO_TRACE( Yield, this, "write", 0 );
+        std::size_t t( 0 );
+#if defined( SPO_ASIO_TLS )
+        if( IsTls() )
+          t = co_await boost::asio::async_write( * TlsStreamPtr(), buffer.data(), token );
+        else
+#endif
+        if constexpr( IS_STREAM )
+          t = co_await boost::asio::async_write( SocketRef(), buffer.data(), token );
+        else
+          t = co_await SocketRef().async_send_to( boost::asio::buffer( buffer.data() ), EndpointRef(), token );
+        EndSend( t, ec );
+      }
+    }
+    catch( const std::exception & e )
+    {
+      ec = AsioService::ExceptionError();
+      DUMP_EXCEPTION( e );
+    }
+    co_return ec;
+  }
+
+  /**
+   * @brief Метод TransferFileAsync реализует передачу или прием файла
+   *        сессии сопрограммой C++20 (аналог метода @a TransferFile ).
+   */
+  boost::asio::awaitable< void > TransferFileAsync ( file_transfer_ptr_t transfer )
+  {
+    error_t ec;
+    auto token( boost::asio::redirect_error( boost::asio::use_awaitable, ec ) );
+    try
+    {
+      BeginFileTransfer();
+      while( IsNoErr( ec ) and IsOpen() and ( not transfer->IsComplete() ) )
+        if( StepFileTransfer( transfer, ec ) )
+          co_await SocketRef().async_wait( FileWaitType( transfer ), token );
     }
     catch( const std::exception & e )
     {
-      ignored_ec = AsioService::ExceptionError();
+      ec = AsioService::ExceptionError();
       DUMP_EXCEPTION( e );
     }
+    EndFileTransfer( transfer, ec );
+  }
+
+  /**
+   * @brief Метод Exchange реализует обмен данными сессии в режиме
+   *        @a TransferType сопрограммой C++20.
+   * @param self указатель на сессию, удерживаемый до завершения обмена.
+   */
+  boost::asio::awaitable< void > Exchange ( std::shared_ptr< self_t > self )
+  {
+    UNUSED( self );
+#if defined( SPO_ASIO_TLS )
+    if( IsTls() )
+    {
+      error_t ec;
+      StartTimer();
+      co_await TlsStreamPtr()->async_handshake(
+            TlsHandshakeType(),
+            boost::asio::redirect_error( boost::asio::use_awaitable, ec ) );
+      StopTimer();
+      if( not m_TlsContext->CompleteHandshake( TlsStreamPtr()->native_handle(), ec ) )
+      {
+        Stop();
+        co_return;
+      }
+    }
+#endif
+    // ошибка приема или передачи, возвращенная сопрограммой, закрывает
+    // сессию; в сопрограммах Boost.Coroutine ( @a StartStackful ) методы
+    // Receive и Send ошибку не возвращают, и обмен продолжается по признаку
+    // @a IsTransfered
+    error_t ec;
+    switch( TransferType() )
+    {
+      case spo::asio::TransferType::SimplexIn :
+        ec = co_await ReceiveAsync();
+        break;
+
+      case spo::asio::TransferType::SimplexOut :
+        ec = co_await SendAsync();
+        break;
+
+      case spo::asio::TransferType::HalfDuplexIn :
+        ec = co_await ReceiveAsync();
+        if( ( not AsioService::Instance().IsError( ec ) ) and IsTransfered() )
+          ec = co_await SendAsync();
+        break;
+
+      case spo::asio::TransferType::HalfDuplexOut :
+        ec = co_await SendAsync();
+        if( ( not AsioService::Instance().IsError( ec ) ) and IsTransfered() )
+          ec = co_await ReceiveAsync();
+        break;
+
+      default :
+        break;
+    }
+    if( AsioService::Instance().IsError( ec ) )
+    {
+      Stop();
+      co_return;
+    }
+#if defined( SPO_ASIO_TLS )
+    if( IsTls() and IsOpen() )
+    {
+      error_t ec;
+      StartTimer();
+      co_await TlsStreamPtr()->async_shutdown(
+            boost::asio::redirect_error( boost::asio::use_awaitable, ec ) );
+      StopTimer();
+    }
+#endif
+  }
+#endif
+
+  /**
+   * @brief Метод CheckTimeout ожидает истечения времени таймера сессии и
+   *        останавливает сессию, если прием или передача не завершились.
+   *
+   * Ожидание выполняется обработчиком таймера (без отдельной сопрограммы и ее
+   * стека) и возобновляется, пока таймер запускается очередным этапом обмена.
+   * Обработчик удерживает сессию до останова таймера.
+   */
+  void CheckTimeout ()
+  {
+    if( not ( IsOpen() and IsTimerActive() ) )
+      return;
+
+    auto self( this->shared_from_this() );
+    SPO_ASIO_TRACE( Yield, this, "timer", 0 );
+    TimerRef()->TimerRef().async_wait(
+          [ self ]( const error_t & ec )
+          {
+            SPO_ASIO_TRACE( Resume, self.get(), "timer", 0 );
+            try
+            {
+              if( self->TimerRef()->IsExpired( ec ) )
+              { // время ожидания приема/передачи через сокет истекло
+                self->Stop();
+              }
+              else
+              { // таймер перезапущен следующим этапом обмена
+                self->CheckTimeout();
+              }
+            }
+            catch( const std::exception & e )
+            {
+              UNUSED( AsioService::ExceptionError() );
+              DUMP_EXCEPTION( e );
+            }
+          } );
   }
 
   /**
@@ -1016,6 +2831,10 @@ template
       std::is_same< ProtocolT_, boost::asio::ip::udp >::value
       or
       std::is_same< ProtocolT_, boost::asio::ip::icmp >::value
+      or
+      std::is_same< ProtocolT_, spo::asio::local_stream_t >::value
+      or
+      std::is_same< ProtocolT_, spo::asio::local_datagram_t >::value
     >::type
 >
 using SocketSessionShared = std::shared_ptr< spo::asio::AsioSocketSession< ProtocolT_, ByteT_ > >;
@@ -1033,6 +2852,10 @@ template
       std::is_same< ProtocolT_, boost::asio::ip::udp >::value
       or
       std::is_same< ProtocolT_, boost::asio::ip::icmp >::value
+      or
+      std::is_same< ProtocolT_, spo::asio::local_stream_t >::value
+      or
+      std::is_same< ProtocolT_, spo::asio::local_datagram_t >::value
     >::type
 >
 SocketSessionShared< ProtocolT_, ByteT_ > MakeSocketSession
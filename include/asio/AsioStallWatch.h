@@ -0,0 +1,232 @@
+/**
+  * @file AsioStallWatch.h
+  * @brief Файл AsioStallWatch.h содержит объявление класса
+  *        @a spo::asio::AsioStallWatch обнаружения длительных обработчиков в
+  *        потоках сервиса.
+  *
+  * Потоки сервиса ( @a AsioService::ServiceRef и потоки ввода/вывода
+  * @a AsioService::SetIoThreads ) регистрируются при запуске. Поток
+  * наблюдения периодически передает каждому сервису пробный обработчик:
+  * если пробный обработчик не выполнен или действие канала сессии
+  * ( @a AsioStallScope ) не завершено за время, превышающее порог, поток
+  * считается занятым одним обработчиком. О задержке сообщается один раз:
+  * указываются поток, сессия и действие (если задержка возникла в действии
+  * канала) и, по запросу, стек вызовов потока.
+  *
+  * @par Пример использования:
+  * @code language="cpp"
+  *  spo::asio::StallPolicy policy;
+  *  policy.m_ThresholdMs  = 200;
+  *  policy.m_CaptureStack = true;
+  *  spo::asio::AsioService::Instance().SetStallWatch( policy );
+  * @endcode
+  */
+
+#ifndef ASIOSTALLWATCH_H
+#define ASIOSTALLWATCH_H
+
+#include "asio/AsioCommon.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+
+namespace                         spo   {
+namespace                         asio  {
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Структура StallPolicy содержит параметры наблюдения за потоками
+ *        сервиса.
+ */
+struct                            StallPolicy
+{
+  /**
+   * @brief Атрибут m_ThresholdMs содержит порог длительности обработчика,
+   *        мс (0 - наблюдение отключено).
+   */
+  std::int64_t                    m_ThresholdMs     { 0 };
+  /**
+   * @brief Атрибут m_CaptureStack указывает получать стек вызовов занятого
+   *        потока (сигналом @a m_StackSignal).
+   */
+  bool                            m_CaptureStack    { false };
+  int                             m_StackSignal     { SIGURG };
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Структура StallMetrics содержит счетчики наблюдения.
+ */
+struct                            StallMetrics
+{
+  std::atomic< std::uint64_t >    m_Stalls          { 0 }; ///< обнаружено задержек
+  std::atomic< std::uint64_t >    m_InAction        { 0 }; ///< из них в действиях каналов
+  std::atomic< std::uint64_t >    m_Captured        { 0 }; ///< получено стеков вызовов
+  std::atomic< std::int64_t >     m_LongestMs       { 0 }; ///< наибольшая длительность, мс
+  std::atomic< std::size_t >      m_Stalled         { 0 }; ///< потоков, занятых сейчас
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Структура StallReport содержит сведения о задержке потока.
+ */
+struct                            StallReport
+{
+  long                            m_ThreadId        { 0 };        ///< идентификатор потока (gettid)
+  const void                    * m_Session         { nullptr };  ///< адрес сессии (nullptr - не известен)
+  const char                    * m_Action          { nullptr };  ///< действие (nullptr - обработчик сервиса)
+  std::int64_t                    m_Ms              { 0 };        ///< длительность на момент обнаружения, мс
+  std::vector< std::string >      m_Stack;                        ///< стек вызовов потока
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Структура StallSlot содержит состояние потока сервиса.
+ */
+struct                            StallSlot
+{
+  std::atomic< std::int64_t >     m_Since           { 0 };        ///< начало действия, нс (0 - нет)
+  std::atomic< const void * >     m_Session         { nullptr };
+  std::atomic< const char * >     m_Name            { nullptr };
+  std::atomic< std::int64_t >     m_ProbeSince      { 0 };        ///< передача пробного обработчика, нс
+  std::atomic_bool                m_ProbePending    { false };
+  io_service_t                  * m_Service         { nullptr };
+  pthread_t                       m_Thread;
+  long                            m_ThreadId        { 0 };
+  std::int64_t                    m_Reported        { 0 };        ///< начало последней задержки, о которой сообщено
+  std::atomic_bool                m_Stalling        { false };    ///< поток учтен в @a StallMetrics::m_Stalled
+  std::atomic_bool                m_Detached        { false };    ///< поток завершил работу с сервисом
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс AsioStallWatch определяет наблюдение за длительностью
+ *        обработчиков потоков сервиса.
+ */
+class SPO_CORE_EXPORT             AsioStallWatch
+{
+public:
+  /**
+   * @brief Тип report_t определяет обработчик сообщения о задержке
+   *        (вызывается потоком наблюдения).
+   */
+  using report_t                = spo::simple_fnc_t< void, const StallReport & >;
+
+  /**/                            AsioStallWatch      ( const AsioStallWatch & ) = delete;
+  /**/                            AsioStallWatch      ( AsioStallWatch && ) = delete;
+  AsioStallWatch &                operator=           ( const AsioStallWatch & ) = delete;
+  AsioStallWatch &                operator=           ( AsioStallWatch && ) = delete;
+
+  static
+  spo::asio::AsioStallWatch &     Instance            ();
+
+  /**
+   * @brief Метод SetPolicy назначает параметры наблюдения: поток наблюдения
+   *        запускается при ненулевом пороге и завершается при нулевом.
+   *        Обработчик сигнала @a StallPolicy::m_StackSignal назначается при
+   *        получении стеков; при их отключении, нулевом пороге или
+   *        уничтожении наблюдения восстанавливается прежнее действие сигнала.
+   */
+  void                            SetPolicy           ( const StallPolicy & policy );
+  StallPolicy                     Policy              () const;
+
+  /**
+   * @brief Метод SetReport назначает обработчик сообщений о задержках
+   *        (пустой - сообщение выводится в журнал).
+   */
+  void                            SetReport           ( const report_t & report );
+
+  const StallMetrics            & MetricsRef          () const BOOST_NOEXCEPT
+    { return m_Metrics; }
+
+  /**
+   * @brief Методы Attach и Detach регистрируют текущий поток как поток
+   *        сервиса @a service и отменяют регистрацию.
+   */
+  void                            Attach              ( io_service_t & service );
+  void                            Detach              ();
+
+  /**
+   * @brief Метод ThreadSlot возвращает состояние текущего потока
+   *        (nullptr - поток не зарегистрирован).
+   */
+  static
+  StallSlot                     * ThreadSlot          () BOOST_NOEXCEPT;
+
+  static
+  std::int64_t                    Now                 () BOOST_NOEXCEPT
+  {
+    return std::chrono::duration_cast< std::chrono::nanoseconds >(
+          std::chrono::steady_clock::now().time_since_epoch() ).count();
+  }
+
+private:
+  /**/                            AsioStallWatch      () = default;
+  /**/                           ~AsioStallWatch      ();
+
+  void                            Run                 ();
+  void                            Check               ( const std::shared_ptr< StallSlot > & slot,
+                                                        std::int64_t now,
+                                                        const StallPolicy & policy );
+  void                            CaptureStack        ( StallSlot & slot, int signal, StallReport & report );
+
+  StallPolicy                     m_Policy;
+  report_t                        m_Report;
+  StallMetrics                    m_Metrics;
+  std::vector< std::shared_ptr< StallSlot > >
+                                  m_Slots;
+  std::thread                     m_Thread;
+  bool                            m_Running           { false };
+  mutable std::mutex              m_Mutex;
+  std::condition_variable         m_Wake;
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс AsioStallScope отмечает выполнение действия сессии в потоке
+ *        сервиса на время своего существования (в потоках вне сервиса не
+ *        действует).
+ */
+class                             AsioStallScope
+{
+public:
+  /**/                            AsioStallScope      ( const void * session, const char * name )
+    : m_Slot ( AsioStallWatch::ThreadSlot() )
+  {
+    if( nullptr == m_Slot )
+      return;
+    m_Since   = m_Slot->m_Since.load();
+    m_Session = m_Slot->m_Session.load();
+    m_Name    = m_Slot->m_Name.load();
+    m_Slot->m_Session = session;
+    m_Slot->m_Name    = name;
+    m_Slot->m_Since   = AsioStallWatch::Now();
+  }
+  /**/                          ~ AsioStallScope      ()
+  {
+    if( nullptr == m_Slot )
+      return;
+    m_Slot->m_Since   = m_Since;
+    m_Slot->m_Session = m_Session;
+    m_Slot->m_Name    = m_Name;
+  }
+
+private:
+  StallSlot                     * m_Slot;
+  std::int64_t                    m_Since         { 0 };
+  const void                    * m_Session       { nullptr };
+  const char                    * m_Name          { nullptr };
+};
+
+//------------------------------------------------------------------------------
+
+}// namespace                   asio
+}// namespace                   spo
+
+#endif // ASIOSTALLWATCH_H
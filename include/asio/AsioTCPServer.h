@@ -51,15 +51,19 @@ namespace                         asio  {
  * основе сопрограмм.
  *
  */
-template< typename                ByteT_ >
+template
+<
+    typename                      ByteT_,
+    typename                      ProtocolT_  = boost::asio::ip::tcp
+>
 class SPO_CORE_EXPORT             AsioTCPServer :
-public                            spo::asio::AsioServer< boost::asio::ip::tcp, ByteT_ >
+public                            spo::asio::AsioServer< ProtocolT_, ByteT_ >
 {
 public:
-  using self_t                  = spo::asio::AsioTCPServer< ByteT_ >;
+  using self_t                  = spo::asio::AsioTCPServer< ByteT_, ProtocolT_ >;
   using tcp_t                   = boost::asio::ip::tcp;
-  using base_class_t            = spo::asio::AsioServer< self_t::tcp_t, ByteT_ >;
-  using self_acceptor_t         = std::shared_ptr< spo::asio::AsioAcceptor< ByteT_> >;
+  using base_class_t            = spo::asio::AsioServer< ProtocolT_, ByteT_ >;
+  using self_acceptor_t         = std::shared_ptr< spo::asio::AsioAcceptor< ByteT_, ProtocolT_ > >;
 
 private:
   mutable self_acceptor_t         m_Acceptor;
@@ -86,6 +90,27 @@ public:
   {
   }
 
+  /**
+   * @brief Конструктор AsioTCPServer формирует экземпляр класса для
+   *        прослушивания подключений на конечной точке @a endpoint (для
+   *        потоковых локальных сокетов - путь сокета).
+   * @param type             тип (режим) работы сервера;
+   * @param endpoint         конечная точка сервера;
+   * @param serviceTimeoutMs время ожидания активации сервиса.
+   */
+  /**/                            AsioTCPServer
+  (
+      const spo::asio::TransferType                   type,
+      const typename base_class_t::endpoint_type    & endpoint,
+      const std::int64_t                            & serviceTimeoutMs = 10000
+  )
+    : self_t::base_class_t( type, endpoint, serviceTimeoutMs )
+    , m_Acceptor          ( std::make_shared< typename self_t::self_acceptor_t::element_type >(
+                              type,
+                              std::ref( * this ) ) )
+  {
+  }
+
   bool IsValid () const BOOST_NOEXCEPT override
   {
     return
@@ -0,0 +1,189 @@
+/**
+  * @file AsioTls.h
+  * @brief Файл AsioTls.h содержит объявление класса @a spo::asio::AsioTls
+  *        контекста TLS (OpenSSL) сессий сервера или клиента с кэшем
+  *        сессий TLS для возобновления подключений без полного рукопожатия.
+  *
+  * Сервер выдает клиентам билеты сессий (session tickets, RFC 5077 / TLS 1.3)
+  * и дополнительно хранит сессии в собственном кэше. Клиент сохраняет
+  * последнюю полученную сессию каждого сервера и предлагает ее при повторном
+  * подключении: рукопожатие возобновления не требует обмена сертификатами и
+  * операций с закрытым ключом.
+  *
+  * Поддержка TLS включается в сборке с qmake CONFIG+=asio_tls (SPO_ASIO_TLS).
+  */
+
+#ifndef ASIOTLS_H
+#define ASIOTLS_H
+
+#include "asio/AsioCommon.h"
+
+#if defined( SPO_ASIO_TLS )
+
+#include <boost/asio/ssl.hpp>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace                         spo   {
+namespace                         asio  {
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс-перечисление TlsRole определяет сторону рукопожатия TLS.
+ */
+enum class                        TlsRole
+{
+  Server        = 0 , ///< сессии принятых подключений
+  Client            , ///< сессии подключений клиента
+};
+
+/**
+ * @brief Структура TlsMetrics содержит счетчики рукопожатий сессий,
+ *        использующих контекст TLS.
+ */
+struct                            TlsMetrics
+{
+  std::atomic< std::uint64_t >    m_Handshakes      { 0 }; ///< успешные рукопожатия
+  std::atomic< std::uint64_t >    m_Resumed         { 0 }; ///< из них с возобновлением сессии
+  std::atomic< std::uint64_t >    m_Failures        { 0 }; ///< неудачные рукопожатия
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс AsioTls содержит контекст TLS сессий сервера или клиента.
+ *
+ * Экземпляр класса назначается серверу или клиенту методом
+ * @a ClientServerBase::SetTlsContext до запуска сервиса и разделяется всеми
+ * его сессиями.
+ *
+ * @par Пример использования:
+ * @code language="cpp"
+ *  auto tls( std::make_shared< spo::asio::AsioTls >( spo::asio::TlsRole::Server ) );
+ *  spo::asio::error_t ec;
+ *  if( tls->SetCertificate( "server.pem", "server.key", ec ) )
+ *    server.SetTlsContext( tls );
+ * @endcode
+ */
+class SPO_CORE_EXPORT             AsioTls
+{
+public:
+  using context_t               = boost::asio::ssl::context;
+  /**
+   * @brief Константа TICKET_KEYS_SIZE содержит размер ключей билетов сессий
+   *        (имя ключа, ключ HMAC, ключ AES).
+   */
+  static const std::size_t        TICKET_KEYS_SIZE  = 80;
+
+  explicit AsioTls ( TlsRole role );
+  ~ AsioTls ();
+
+  AsioTls ( const AsioTls & ) = delete;
+  AsioTls & operator = ( const AsioTls & ) = delete;
+
+  TlsRole                         Role              () const { return m_Role; }
+  context_t                     & ContextRef        ()       { return std::ref( m_Context ); }
+  const TlsMetrics              & MetricsRef        () const { return m_Metrics; }
+
+  /**
+   * @brief Метод SetCertificate загружает цепочку сертификатов и закрытый
+   *        ключ (формат PEM).
+   * @param certFile файл цепочки сертификатов;
+   * @param keyFile  файл закрытого ключа;
+   * @param ec       код ошибки.
+   * @return Признак успешной загрузки.
+   */
+  bool SetCertificate ( const std::string & certFile, const std::string & keyFile, error_t & ec );
+
+  /**
+   * @brief Метод SetVerifyFile включает проверку сертификата другой стороны
+   *        по сертификатам удостоверяющих центров файла @a caFile (формат
+   *        PEM). Без вызова метода клиент проверяет сертификат сервера по
+   *        системным сертификатам, сервер сертификат клиента не запрашивает.
+   */
+  bool SetVerifyFile ( const std::string & caFile, error_t & ec );
+
+  /**
+   * @brief Метод SetVerifyNone отключает проверку сертификата сервера
+   *        клиентом (цепочки и имени узла). Предназначен для отладки.
+   */
+  void SetVerifyNone ();
+
+  /**
+   * @brief Метод SetTicketKeys назначает ключи билетов сессий сервера. Общие
+   *        ключи позволяют возобновлять сессии на нескольких процессах
+   *        сервера и после его перезапуска. Без вызова метода ключи создаются
+   *        случайно при создании контекста.
+   * @param keys ключи размером @a TICKET_KEYS_SIZE байт.
+   */
+  bool SetTicketKeys ( const std::string & keys, error_t & ec );
+
+  /**
+   * @brief Метод SetSessionTimeout задает время жизни сессий и билетов, с.
+   */
+  void SetSessionTimeout ( long seconds );
+
+  /**
+   * @brief Метод SetSessionCacheSize ограничивает количество сессий кэша
+   *        сервера (0 - без ограничения).
+   */
+  void SetSessionCacheSize ( long size );
+
+  /**
+   * @brief Метод PrepareSession подготавливает соединение TLS сессии к
+   *        рукопожатию: клиенту назначаются имя сервера (SNI), проверка
+   *        имени узла или адреса в сертификате сервера и сохраненная сессия
+   *        сервера @a peer (если есть).
+   * @param ssl  соединение TLS сессии;
+   * @param peer идентификатор сервера "узел:служба" в кэше клиента (строка
+   *             должна существовать до закрытия соединения).
+   */
+  void PrepareSession ( SSL * ssl, const std::string & peer );
+
+  /**
+   * @brief Метод CompleteHandshake учитывает результат рукопожатия.
+   * @param ssl соединение TLS сессии;
+   * @param ec  код завершения рукопожатия.
+   * @return Признак успешного рукопожатия.
+   */
+  bool CompleteHandshake ( SSL * ssl, const error_t & ec );
+
+  /**
+   * @brief Метод ForgetSession удаляет сохраненную сессию сервера @a peer
+   *        (следующее подключение выполнит полное рукопожатие).
+   */
+  void ForgetSession ( const std::string & peer );
+
+  /**
+   * @brief Метод CachedSessions возвращает количество сессий, сохраненных
+   *        клиентом.
+   */
+  std::size_t CachedSessions () const;
+
+private:
+  TlsRole                         m_Role;
+  context_t                       m_Context;
+  TlsMetrics                      m_Metrics;
+  /**
+   * @brief Атрибут m_Sessions содержит последнюю полученную сессию каждого
+   *        сервера (кэш клиента). Ссылки на сессии принадлежат кэшу.
+   */
+  std::unordered_map< std::string, SSL_SESSION * > m_Sessions;
+  mutable std::mutex              m_SessionsMutex;
+
+  /**
+   * @brief Метод OnNewSession сохраняет сессию, полученную клиентом после
+   *        рукопожатия (для TLS 1.3 - с билетом сессии).
+   */
+  static int OnNewSession ( SSL * ssl, SSL_SESSION * session );
+};
+
+using tls_context_ptr_t         = std::shared_ptr< AsioTls >;
+
+//------------------------------------------------------------------------------
+}// namespace                   asio
+}// namespace                   spo
+
+#endif // SPO_ASIO_TLS
+
+#endif // ASIOTLS_H
@@ -0,0 +1,287 @@
+/**
+  * @file AsioTopicHub.h
+  * @brief Файл AsioTopicHub.h содержит объявление шаблона класса
+  *        @a spo::asio::AsioTopicHub рассылки сообщений подписчикам тем.
+  *
+  * Сообщение темы формируется один раз (неизменяемые данные со счетчиком
+  * ссылок) и передается в очереди исходящих сообщений
+  * ( @a AsioSendBatcher ) всех сессий-подписчиков без копирования: память
+  * сообщения освобождается после записи в сокет последнего подписчика.
+  *
+  * @code language="cpp"
+  *  spo::asio::AsioTCPServer< char > server( spo::asio::TransferType::SimplexOut, 33445 );
+  *  server.SetSubscribe( []( session_ptr ) { return std::vector< std::string > { "quotes" }; } );
+  *  ...
+  *  auto buffer( server.TopicsRef().MakeBuffer( document ) );
+  *  server.Publish( "quotes", buffer );
+  * @endcode
+  */
+
+#ifndef ASIOTOPICHUB_H
+#define ASIOTOPICHUB_H
+
+#include "asio/AsioSocketSession.h"
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace                         spo   {
+namespace                         asio  {
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс-перечисление SlowSubscriber определяет действие с
+ *        подписчиком, очередь которого превысила ограничение
+ *        @a TopicPolicy.
+ */
+enum class                        SlowSubscriber
+{
+  Drop          = 0 , ///< сообщение подписчику не передается
+  Disconnect        , ///< подписчик отключается
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Структура TopicPolicy содержит ограничения очереди подписчика.
+ */
+struct                            TopicPolicy
+{
+  /**
+   * @brief Атрибут m_MaxPending ограничивает количество сообщений, ожидающих
+   *        записи в сокет подписчика.
+   */
+  std::size_t                     m_MaxPending      { 256 };
+  /**
+   * @brief Атрибут m_MaxPendingBytes ограничивает объем сообщений, ожидающих
+   *        записи в сокет подписчика, байт.
+   */
+  std::size_t                     m_MaxPendingBytes { 4 * 1024 * 1024 };
+  SlowSubscriber                  m_Slow            { SlowSubscriber::Drop };
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Структура TopicMetrics содержит счетчики рассылки.
+ */
+struct                            TopicMetrics
+{
+  std::atomic< std::uint64_t >    m_Published       { 0 }; ///< опубликовано сообщений
+  std::atomic< std::uint64_t >    m_Deliveries      { 0 }; ///< передано в очереди подписчиков
+  std::atomic< std::uint64_t >    m_Dropped         { 0 }; ///< не передано медленным подписчикам
+  std::atomic< std::uint64_t >    m_Disconnected    { 0 }; ///< отключено медленных подписчиков
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс AsioTopicHub определяет реестр подписчиков тем и рассылку
+ *        им сообщений.
+ *
+ * Параметры шаблона:
+ * @value ProtocolT_ потоковый протокол сессий;
+ * @value ByteT_     тип единицы информации сообщений.
+ *
+ * Методы допускают вызов из любого потока. Реестр удерживает сессии
+ * подписчиков: сессия, запущенная методом
+ * @a AsioSocketSession::StartPush, остается открытой до отписки, отключения
+ * или ошибки записи. Сессии подключений сервера удаляются из реестра при
+ * останове ( @a Release ), остальные закрытые сессии - при публикации в их
+ * темы.
+ */
+template< typename ProtocolT_, typename ByteT_ >
+class SPO_CORE_EXPORT             AsioTopicHub
+{
+public:
+  using session_t               = spo::asio::AsioSocketSession< ProtocolT_, ByteT_ >;
+  using session_shr_t           = std::shared_ptr< session_t >;
+  using buffer_t                = typename session_t::batcher_t::content_ptr_t;
+  using document_t              = spo::core::docs::BytesDocument< ByteT_ >;
+
+  const TopicMetrics            & MetricsRef        () const { return m_Metrics; }
+
+  /**
+   * @brief Метод SetPolicy назначает ограничения очереди подписчиков.
+   */
+  void SetPolicy ( const TopicPolicy & policy )
+  {
+    std::lock_guard< std::mutex > l( m_Mutex );
+    m_Policy = policy;
+  }
+
+  /**
+   * @brief Метод MakeBuffer формирует неизменяемые данные сообщения из
+   *        документа (данные копируются один раз для всех подписчиков).
+   */
+  static buffer_t MakeBuffer ( const document_t & document )
+  {
+    return std::make_shared< typename session_t::batcher_t::content_t >(
+          const_cast< document_t & >( document ).ContentRef() );
+  }
+
+  /**
+   * @brief Метод Subscribe добавляет сессию в подписчики темы @a topic.
+   * @return false, если сессия закрыта или уже подписана.
+   */
+  bool Subscribe ( const std::string & topic, const session_shr_t & session )
+  {
+    if( not ( session and session->IsOpen() ) )
+      return false;
+
+    std::lock_guard< std::mutex > l( m_Mutex );
+    auto & subscribers( m_Topics[ topic ] );
+    if( std::find( subscribers.begin(), subscribers.end(), session ) != subscribers.end() )
+      return false;
+    subscribers.push_back( session );
+    return true;
+  }
+
+  /**
+   * @brief Метод Unsubscribe удаляет сессию из подписчиков темы @a topic.
+   */
+  void Unsubscribe ( const std::string & topic, const session_shr_t & session )
+  {
+    std::lock_guard< std::mutex > l( m_Mutex );
+    auto it( m_Topics.find( topic ) );
+    if( it != m_Topics.end() )
+      Remove( it, session );
+  }
+
+  /**
+   * @brief Метод Unsubscribe удаляет сессию из подписчиков всех тем.
+   */
+  void Unsubscribe ( const session_shr_t & session )
+  {
+    std::lock_guard< std::mutex > l( m_Mutex );
+    for( auto it( m_Topics.begin() ); it != m_Topics.end(); )
+      it = Remove( it, session );
+  }
+
+  /**
+   * @brief Метод Release удаляет остановленную сессию из подписчиков всех
+   *        тем (вызывается при останове сессии). Указатели реестра
+   *        освобождаются обработчиком сервиса сессии: останов сессии не
+   *        завершается ее удалением.
+   */
+  void Release ( const session_t * session )
+  {
+    std::vector< session_shr_t > removed;
+    {
+      std::lock_guard< std::mutex > l( m_Mutex );
+      for( auto it( m_Topics.begin() ); it != m_Topics.end(); )
+      {
+        auto & list( it->second );
+        auto found( std::find_if( list.begin(), list.end(),
+                                  [ session ]( const session_shr_t & s ) { return s.get() == session; } ) );
+        if( found != list.end() )
+        {
+          removed.push_back( * found );
+          list.erase( found );
+        }
+        it = list.empty() ? m_Topics.erase( it ) : std::next( it );
+      }
+    }
+    if( not removed.empty() )
+      removed.front()->ServiceRef().post( [ removed ]() {} );
+  }
+
+  /**
+   * @brief Метод Subscribers возвращает количество подписчиков темы.
+   */
+  std::size_t Subscribers ( const std::string & topic ) const
+  {
+    std::lock_guard< std::mutex > l( m_Mutex );
+    auto it( m_Topics.find( topic ) );
+    return it == m_Topics.end() ? 0 : it->second.size();
+  }
+
+  /**
+   * @brief Метод Publish передает сообщение @a buffer подписчикам темы
+   *        @a topic. Подписчик, очередь которого превысила ограничение
+   *        @a TopicPolicy, пропускает сообщение или отключается.
+   * @return количество подписчиков, получивших сообщение в очередь.
+   */
+  std::size_t Publish ( const std::string & topic, const buffer_t & buffer )
+  {
+    if( not buffer )
+      return 0;
+
+    std::vector< session_shr_t > subscribers;
+    std::vector< session_shr_t > slow;
+    TopicPolicy policy;
+    {
+      std::lock_guard< std::mutex > l( m_Mutex );
+      auto it( m_Topics.find( topic ) );
+      if( it != m_Topics.end() )
+      {
+        auto & list( it->second );
+        list.erase( std::remove_if( list.begin(), list.end(),
+                                    []( const session_shr_t & s ) { return not s->IsOpen(); } ),
+                    list.end() );
+        subscribers = list;
+        if( list.empty() )
+          m_Topics.erase( it );
+      }
+      policy = m_Policy;
+    }
+    ++ m_Metrics.m_Published;
+
+    std::size_t retval( 0 );
+    for( auto & session : subscribers )
+    {
+      auto batcher( session->BatcherPtr() );
+      if( batcher
+          and ( ( batcher->PendingMessages() >= policy.m_MaxPending )
+                or ( batcher->PendingBytes() >= policy.m_MaxPendingBytes ) ) )
+      {
+        ++ m_Metrics.m_Dropped;
+        if( policy.m_Slow == SlowSubscriber::Disconnect )
+          slow.push_back( session );
+        continue;
+      }
+
+      if( session->Post( buffer ) )
+      {
+        ++ retval;
+        ++ m_Metrics.m_Deliveries;
+      }
+    }
+
+    for( auto & session : slow )
+    {
+      Unsubscribe( session );
+      ++ m_Metrics.m_Disconnected;
+      session->ServiceRef().post( boost::bind( & session_t::Stop, session ) );
+    }
+    return retval;
+  }
+
+  /**
+   * @brief Метод Publish передает копию документа @a document подписчикам
+   *        темы @a topic.
+   */
+  std::size_t Publish ( const std::string & topic, const document_t & document )
+  {
+    return Publish( topic, MakeBuffer( document ) );
+  }
+
+private:
+  using topics_t                = std::map< std::string, std::vector< session_shr_t > >;
+
+  topics_t                        m_Topics;
+  TopicPolicy                     m_Policy;
+  TopicMetrics                    m_Metrics;
+  mutable std::mutex              m_Mutex;
+
+  typename topics_t::iterator Remove ( typename topics_t::iterator it, const session_shr_t & session )
+  {
+    auto & list( it->second );
+    list.erase( std::remove( list.begin(), list.end(), session ), list.end() );
+    return list.empty() ? m_Topics.erase( it ) : std::next( it );
+  }
+};
+
+//------------------------------------------------------------------------------
+}// namespace                   asio
+}// namespace                   spo
+
+#endif // ASIOTOPICHUB_H
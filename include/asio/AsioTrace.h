@@ -0,0 +1,246 @@
+/**
+  * @file AsioTrace.h
+  * @brief Файл AsioTrace.h содержит объявление класса @a spo::asio::AsioTrace
+  *        трассировки работы сопрограмм и обработчиков сессий Boost.Asio с
+  *        выгрузкой в формате Chrome trace-event JSON.
+  *
+  * Трассировка включается при сборке опцией qmake @a CONFIG+=asio_tracing
+  * (определение @a SPO_ASIO_TRACING) и во время работы методом
+  * @a AsioTrace::SetEnabled. Без определения @a SPO_ASIO_TRACING макросы
+  * @a SPO_ASIO_TRACE и @a SPO_ASIO_TRACE_SCOPE не порождают кода.
+  *
+  * Полученный файл открывается в Perfetto (ui.perfetto.dev) или chrome://tracing.
+  */
+
+#ifndef ASIOTRACE_H
+#define ASIOTRACE_H
+
+#include "asio/AsioCommon.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <ostream>
+
+namespace                         spo   {
+namespace                         asio  {
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс-перечисление TraceEventType определяет тип события трассировки.
+ */
+enum class                        TraceEventType : unsigned char
+{
+  SessionSpawn  = 0 , ///< запуск сопрограммы сессии (boost::asio::spawn)
+  Yield             , ///< сопрограмма передала управление в ожидании операции
+  Resume            , ///< сопрограмма возобновлена по завершении операции
+  HandlerBegin      , ///< начало выполнения обработчика (действия канала)
+  HandlerEnd        , ///< окончание выполнения обработчика
+  IoComplete        , ///< завершение операции ввода/вывода (значение - байты)
+};
+
+/**
+ * @brief Структура TraceEvent определяет запись кольцевого буфера трассировки.
+ *
+ * Атрибут @a m_Name обязан указывать на строку со статическим временем жизни
+ * (строковый литерал): буфер хранит только указатель.
+ */
+struct                            TraceEvent
+{
+  std::uint64_t                   m_TimeNs      { 0 };       ///< время от начала трассировки, нс
+  const void                    * m_Session     { nullptr }; ///< адрес сессии (идентификатор)
+  const char                    * m_Name        { nullptr }; ///< имя операции или обработчика
+  std::uint64_t                   m_Value       { 0 };       ///< количество байт или код ошибки
+  TraceEventType                  m_Type        { TraceEventType::SessionSpawn };
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс AsioTraceRing определяет кольцевой буфер событий трассировки
+ *        одного потока.
+ *
+ * Запись выполняет только поток-владелец, без блокировок. Чтение (снимок)
+ * допускается из любого потока: каждая ячейка защищена счетчиком
+ * последовательности, поэтому перезаписанные во время чтения ячейки
+ * отбрасываются, а не попадают в выгрузку частично.
+ */
+class SPO_CORE_EXPORT             AsioTraceRing
+{
+public:
+  explicit                        AsioTraceRing       ( std::size_t capacity, long threadId );
+
+  /**
+   * @brief Метод Push добавляет событие в буфер, вытесняя самое старое при
+   *        переполнении.
+   * @param event добавляемое событие.
+   */
+  void                            Push                ( const TraceEvent & event ) BOOST_NOEXCEPT;
+
+  /**
+   * @brief Метод Snapshot возвращает согласованную копию событий буфера в
+   *        порядке записи.
+   */
+  std::vector< TraceEvent >       Snapshot            () const;
+
+  /**
+   * @brief Метод Clear отбрасывает накопленные события.
+   */
+  void                            Clear               () BOOST_NOEXCEPT;
+
+  long                            ThreadId            () const BOOST_NOEXCEPT
+    { return m_ThreadId; }
+
+private:
+  /**
+   * @brief Структура Slot содержит ячейку буфера: поля события хранятся
+   *        атомарными словами, читаемыми без упорядочивания, поэтому чтение
+   *        ячейки во время ее записи не является гонкой данных; такое чтение
+   *        обнаруживается по счетчику @a m_Seq и отбрасывается.
+   */
+  struct                          Slot
+  {
+    std::atomic< std::uint64_t >  m_Seq             { 0 };
+    std::atomic< std::uint64_t >  m_TimeNs          { 0 };
+    std::atomic< const void * >   m_Session         { nullptr };
+    std::atomic< const char * >   m_Name            { nullptr };
+    std::atomic< std::uint64_t >  m_Value           { 0 };
+    std::atomic< TraceEventType > m_Type            { TraceEventType::SessionSpawn };
+  };
+
+  std::vector< Slot >             m_Slots;
+  std::atomic< std::uint64_t >    m_Head              { 0 };
+  long                            m_ThreadId          { 0 };
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс AsioTrace реализует сбор событий планирования сопрограмм и
+ *        выполнения обработчиков в потоковые кольцевые буферы и их выгрузку
+ *        по запросу в формате Chrome trace-event JSON.
+ *
+ * @par Пример использования:
+ * @code language="cpp"
+ *  spo::asio::AsioTrace::Instance().SetEnabled( true );
+ *  . . .
+ *  spo::asio::AsioSignals signals( spo::asio::AsioService::Instance() );
+ *  signals.AddSignalHandler( SIGUSR1,
+ *    []( int, spo::asio::error_t & ec )
+ *    {
+ *      spo::asio::AsioTrace::Instance().DumpToFile( "/tmp/asio.trace.json" );
+ *      return ec;
+ *    } );
+ * @endcode
+ */
+class SPO_CORE_EXPORT             AsioTrace
+{
+public:
+  /**/                            AsioTrace           ( const AsioTrace & ) = delete;
+  /**/                            AsioTrace           ( AsioTrace && ) = delete;
+  AsioTrace &                     operator=           ( const AsioTrace & ) = delete;
+  AsioTrace &                     operator=           ( AsioTrace && ) = delete;
+
+  static
+  spo::asio::AsioTrace &          Instance            ();
+
+  bool                            IsEnabled           () const BOOST_NOEXCEPT
+    { return m_Enabled.load( std::memory_order_relaxed ); }
+  void                            SetEnabled          ( bool value ) BOOST_NOEXCEPT
+    { m_Enabled.store( value ); }
+
+  /**
+   * @brief Метод RingSize возвращает емкость (в событиях) кольцевого буфера,
+   *        выделяемого потоку при первой записи.
+   */
+  std::size_t                     RingSize            () const BOOST_NOEXCEPT
+    { return m_RingSize; }
+  /**
+   * @brief Метод SetRingSize задает емкость буферов потоков, регистрируемых
+   *        после вызова.
+   */
+  void                            SetRingSize         ( std::size_t size ) BOOST_NOEXCEPT
+    { m_RingSize = size > 0 ? size : ASIO_TRACE_RING_SIZE_DEFAULT; }
+
+  /**
+   * @brief Метод Record добавляет событие в буфер текущего потока.
+   * @param type    тип события;
+   * @param session адрес сессии;
+   * @param name    имя операции (строковый литерал);
+   * @param value   количество байт или код ошибки.
+   */
+  void                            Record
+  (
+      TraceEventType              type,
+      const void                * session,
+      const char                * name,
+      std::uint64_t               value = 0
+  ) BOOST_NOEXCEPT;
+
+  /**
+   * @brief Метод DumpChromeJson выгружает события всех потоков в поток вывода
+   *        в формате Chrome trace-event JSON.
+   * @return количество выгруженных событий.
+   */
+  std::size_t                     DumpChromeJson      ( std::ostream & os ) const;
+  /**
+   * @brief Метод DumpToFile выгружает события всех потоков в файл.
+   * @return Признак успешной записи файла.
+   */
+  bool                            DumpToFile          ( const std::string & fileName ) const;
+  /**
+   * @brief Метод Clear отбрасывает события всех потоков.
+   */
+  void                            Clear               ();
+
+  static const std::size_t        ASIO_TRACE_RING_SIZE_DEFAULT = 65536;
+
+private:
+  /**/                            AsioTrace           ();
+
+  AsioTraceRing                 * ThreadRing          ();
+
+  std::atomic_bool                m_Enabled           { false };
+  std::size_t                     m_RingSize          { ASIO_TRACE_RING_SIZE_DEFAULT };
+  std::chrono::steady_clock::time_point m_Epoch;
+  mutable std::mutex              m_Mutex;
+  std::vector< std::shared_ptr< AsioTraceRing > > m_Rings;
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс AsioTraceScope регистрирует начало обработчика при создании и
+ *        его окончание при разрушении.
+ */
+class                             AsioTraceScope
+{
+public:
+  /**/                            AsioTraceScope      ( const void * session, const char * name )
+    : m_Session ( session )
+    , m_Name    ( name )
+  {
+    AsioTrace::Instance().Record( TraceEventType::HandlerBegin, m_Session, m_Name );
+  }
+  /**/                          ~ AsioTraceScope      ()
+  {
+    AsioTrace::Instance().Record( TraceEventType::HandlerEnd, m_Session, m_Name );
+  }
+
+private:
+  const void                    * m_Session;
+  const char                    * m_Name;
+};
+
+//------------------------------------------------------------------------------
+
+}// namespace                     asio
+}// namespace                     spo
+
+#ifdef SPO_ASIO_TRACING
+# define SPO_ASIO_TRACE( type, session, name, value ) \
+  do { spo::asio::AsioTrace::Instance().Record( spo::asio::TraceEventType::type, session, name, value ); } while( 0 )
+# define SPO_ASIO_TRACE_SCOPE( session, name ) \
+  spo::asio::AsioTraceScope trace_scope_( session, name )
+#else
+# define SPO_ASIO_TRACE( type, session, name, value ) do { } while( 0 )
+# define SPO_ASIO_TRACE_SCOPE( session, name )
+#endif
+
+#endif // ASIOTRACE_H
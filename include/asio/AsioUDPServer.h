@@ -9,16 +9,25 @@ namespace                         asio  {
 
 //------------------------------------------------------------------------------
 
-template< typename                ByteT_ >
+/**
+ * @brief Класс AsioUDPServer определяет сервер датаграмм: UDP или
+ *        датаграммных локальных сокетов ( @a local_datagram_t ).
+ */
+template
+<
+    typename                      ByteT_,
+    typename                      ProtocolT_  = boost::asio::ip::udp
+>
 class SPO_CORE_EXPORT             AsioUDPServer :
-public                            spo::asio::AsioServer< boost::asio::ip::udp, ByteT_ >
+public                            spo::asio::AsioServer< ProtocolT_, ByteT_ >
 {
 public:
-  using self_t                  = spo::asio::AsioUDPServer< ByteT_ >;
+  using self_t                  = spo::asio::AsioUDPServer< ByteT_, ProtocolT_ >;
   using udp_t                   = boost::asio::ip::udp;
-  using base_class_t            = spo::asio::AsioServer< self_t::udp_t, ByteT_ >;
+  using socket_t                = typename ProtocolT_::socket;
+  using base_class_t            = spo::asio::AsioServer< ProtocolT_, ByteT_ >;
 
-  boost::system::error_code TryOpen( boost::asio::ip::udp::socket & socket )
+  boost::system::error_code TryOpen( socket_t & socket )
   {
     boost::system::error_code ec =
         boost::system::errc::make_error_code( boost::system::errc::success );
@@ -27,12 +36,21 @@ public:
       if( not socket.is_open() )
       {
         socket.open( base_class_t::Protocol(), ec );
-        spo::asio::SetSocketOptions< boost::asio::ip::udp >( socket );
+        spo::asio::SetSocketOptions< ProtocolT_ >( socket );
+
+        auto profile( base_class_t::SocketProfilePtr() );
+        if( profile and IsNoErr( ec ) )
+        {
+          boost::system::error_code profile_ec;
+          if( not profile->template ApplySocket< ProtocolT_ >( socket, profile_ec ) )
+            DUMP_BOOST_ERROR( profile_ec );
+        }
 
         AsioService::Instance().SetError( ec );
         if( IsNoErr( ec ) )
-        {
-          socket.bind( base_class_t::Endpoint(), ec );
+        { // файл локального сокета предыдущей сессии или запуска сервера
+          if( UnlinkLocalEndpoint( base_class_t::Endpoint(), ec ) )
+            socket.bind( base_class_t::Endpoint(), ec );
           AsioService::Instance().SetError( ec );
         }
       }
@@ -69,6 +87,25 @@ public:
     Init();
   }
 
+  /**
+   * @brief Конструктор AsioUDPServer формирует экземпляр класса для приема
+   *        датаграмм на конечной точке @a endpoint (для датаграммных
+   *        локальных сокетов - путь сокета).
+   * @param type             тип (режим) работы сервера;
+   * @param endpoint         конечная точка сервера;
+   * @param serviceTimeoutMs время ожидания активации сервиса.
+   */
+  /**/                            AsioUDPServer
+  (
+      const spo::asio::TransferType                   type,
+      const typename base_class_t::endpoint_type    & endpoint,
+      const std::int64_t                            & serviceTimeoutMs = 10000
+  )
+    : self_t::base_class_t( type, endpoint, serviceTimeoutMs )
+  {
+    Init();
+  }
+
 private:
 
   /**
@@ -86,7 +123,7 @@ private:
     }
 
     // назначение сокета и проверка подключения
-    boost::asio::ip::udp::socket socket( AsioService::Instance().ServiceRef() );
+    socket_t socket( AsioService::Instance().ServiceRef() );
 
     ec = TryOpen( socket );
 
@@ -95,7 +132,7 @@ private:
       base_class_t::IncSocketsCount();
 
       // создание shared-сессии работы с UDP-сокетом
-      auto session_ptr( std::move( MakeSocketSession< boost::asio::ip::udp, ByteT_ >(
+      auto session_ptr( std::move( MakeSocketSession< ProtocolT_, ByteT_ >(
                                     base_class_t::ActionsRef(),
                                     base_class_t::TransferType(),
                                     std::move( socket ),
@@ -103,51 +140,28 @@ private:
                                     base_class_t::SocketDeadline() ) ) );
       if( session_ptr )
       {
-        struct socket_udp
-        {
-          boost::asio::ip::udp::socket && s;
-          spo::asio::AsioUDPServer< ByteT_ > * ptr = this;
-          socket_udp( boost::asio::ip::udp::socket &&sk, spo::asio::AsioUDPServer< ByteT_ > * p )
-            : s( std::move( sk ) )
-            , ptr( p )
-          {}
-        };
-        socket_udp obj( std::move( socket ), this );
-
+        session_ptr->SetBufferSize( base_class_t::BufferSize() );
         session_ptr->SetAfterStop(
-              [ this, yield ]( void * ptr )
+              []( void * ptr )
               {
-                auto s_ptr( reinterpret_cast< socket_udp * >(ptr) );
+                auto s_ptr( reinterpret_cast< self_t * >(ptr) );
                 if( nullptr != s_ptr )
                 {
-                  s_ptr->ptr->DecSocketsCount();
-                  //перезапуск UDP-приема после останова работы сессии
-//                  if( AsioService::Instance().IsActive() and s_ptr->ptr->SocketsValid() )
-//                  {
-//                    try
-//                    {
-//                      std::async( std::launch::async,
-//                                  [ this, yield, s_ptr]
-//                      {
-//                      boost::asio::spawn(
-//                            io_strand_t( AsioService::Instance().ServiceRef() ),
-////                            boost::bind( & self_t::Listen, s_ptr, yield ) );
-//                            boost::bind( & self_t::Listen,
-//                                         s_ptr->ptr,
-//                                         s_ptr->s,
-//                                         yield ) );
-//                      } ).wait_for( std::chrono::milliseconds( 0 ) );
-//                    }
-//                    catch( const std::exception & e )
-//                    {
-//                      DUMP_EXCEPTION( e )
-//                    }
-//                  }
+                  s_ptr->DecSocketsCount();
+                  // перезапуск UDP-приема после останова работы сессии:
+                  // сокет сессии закрыт, порт сервера свободен для привязки
+                  // (при плавном завершении работы прием не возобновляется)
+                  if( AsioService::Instance().IsActive()
+                      and ( not AsioService::Instance().IsDraining() ) )
+                  {
+                    AsioService::Instance().ServiceRef().post(
+                      boost::bind( & self_t::SpawnListen, s_ptr ) );
+                  }
                 }
-              }, &obj );
+              }, this );
         AsioService::Instance().ServiceRef().post(
           boost::bind(
-            & spo::asio::AsioSocketSession< boost::asio::ip::udp, ByteT_ >::Start,
+            & spo::asio::AsioSocketSession< ProtocolT_, ByteT_ >::Start,
             session_ptr ) );
       }
       else
@@ -167,29 +181,35 @@ private:
   {
     AsioService::Instance().AddBeforeStartCallback
         ( {
-            [ this ](void * ptr)
+            []( void * ptr )
             {
               auto self( reinterpret_cast< self_t * >(ptr) );
               if( nullptr != self )
               {
-                try
-                {
-                  boost::asio::spawn(
-                        io_strand_t( AsioService::Instance().ServiceRef() ),
-                        boost::bind(& self_t::Listen,
-                                      self,
-//                                      std::move( boost::asio::ip::udp::socket( AsioService::Instance().ServiceRef() ) ),
-                                      _1 ) );
-                }
-                catch ( const std::exception & e)
-                {
-                  DUMP_EXCEPTION( e );
-                }
+                self->SpawnListen();
               }
             },
             this
           } );
   }
+
+  /**
+   * @brief Метод SpawnListen запускает сопрограмму @a Listen приема
+   *        UDP-датаграмм.
+   */
+  void SpawnListen () BOOST_NOEXCEPT
+  {
+    try
+    {
+      boost::asio::spawn(
+            io_strand_t( AsioService::Instance().ServiceRef() ),
+            boost::bind( & self_t::Listen, this, _1 ) );
+    }
+    catch ( const std::exception & e)
+    {
+      DUMP_EXCEPTION( e );
+    }
+  }
 };
 
 //------------------------------------------------------------------------------
@@ -0,0 +1,229 @@
+/**
+  * @file ChannelFrame.h
+  * @brief Файл ChannelFrame.h содержит объявления приоритетов каналов
+  *        передачи сессии и формата кадра канала, а также шаблон класса
+  *        @a spo::asio::ChannelDemux сборки документов каналов из принятых
+  *        кадров.
+  *
+  * Дополнительные каналы передачи сессии ( @a AsioSocketSession::AddChannel )
+  * передают документы кадрами. Документ, превышающий
+  * @a BatchPolicy::m_ChunkSize, передается несколькими кадрами, между
+  * которыми передаются кадры каналов более высокого приоритета. Документы
+  * канала Output сессии с дополнительными каналами передаются кадрами канала
+  * @a DataType::Output той же очередью.
+  *
+  * Формат кадра:
+  * @code
+  *   [номер канала: 1 байт][признаки: 1 байт][длина данных: 4 байта][данные]
+  * @endcode
+  * Длина передается в сетевом порядке. Признак @a ChannelFrame::FLAG_LAST
+  * отмечает последний кадр документа.
+  */
+
+#ifndef CHANNELFRAME_H
+#define CHANNELFRAME_H
+
+#include "asio/IOChannel.h"
+#include "core/documents/FrameHeader.h"
+#include <array>
+#include <map>
+
+namespace                         spo   {
+namespace                         asio  {
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс-перечисление ChannelPriority определяет приоритет канала
+ *        передачи сессии: очередь канала с более высоким приоритетом
+ *        передается первой.
+ */
+enum class                        ChannelPriority
+{
+  Control       = 0 , ///< управляющие сообщения (передаются без удержания)
+  Interactive       , ///< интерактивный обмен
+  Bulk              , ///< массовая передача данных
+
+  Count             , ///< граница значений приоритета
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Структура ChannelFrame содержит заголовок кадра канала.
+ */
+struct                            ChannelFrame
+{
+  static const std::size_t        HEADER_SIZE       = 6;
+  static const std::uint8_t       FLAG_LAST         = 0x01;
+
+  using header_t                = std::array< unsigned char, HEADER_SIZE >;
+
+  std::uint8_t                    m_Channel         { 0 };
+  std::uint8_t                    m_Flags           { 0 };
+  std::uint32_t                   m_Length          { 0 };
+
+  bool IsLast () const { return ( m_Flags & FLAG_LAST ) != 0; }
+
+  /**
+   * @brief Метод Write формирует заголовок кадра.
+   */
+  header_t Write () const
+  {
+    header_t retval;
+    spo::core::docs::FrameHeaderWriter( retval.data() ).Byte( m_Channel ).Byte( m_Flags ).Fixed32( m_Length );
+    return retval;
+  }
+
+  /**
+   * @brief Метод Read разбирает заголовок кадра (не менее
+   *        @a HEADER_SIZE байт).
+   */
+  void Read ( const unsigned char * data )
+  {
+    spo::core::docs::FrameHeaderReader in( data );
+    m_Channel = in.Byte();
+    m_Flags   = in.Byte();
+    m_Length  = in.Fixed32();
+  }
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс ChannelDemux собирает документы каналов из потока кадров и
+ *        передает их обработчикам каналов.
+ *
+ * Параметры шаблона:
+ * @value ByteT_ тип единицы информации документов.
+ *
+ * Принятые данные передаются методу @a Feed частями произвольного размера.
+ * Объект содержит состояние разбора одного потока: обработчик канала
+ * приема ( @a AsAction ) содержит копию объекта, а каждая сессия - копию
+ * обработчика.
+ *
+ * @par Пример использования:
+ * @code language="cpp"
+ *  spo::asio::ChannelDemux< char > demux;
+ *  demux.SetAction( spo::asio::DataType::Output, on_main );
+ *  demux.SetAction( 2, on_control );
+ *  demux.SetAction( 3, on_bulk );
+ *  server.SetBufferAction( spo::asio::DataType::Input, demux.AsAction() );
+ * @endcode
+ */
+template< typename                ByteT_            = unsigned char >
+class SPO_CORE_EXPORT             ChannelDemux
+{
+public:
+  using document_t              = spo::core::docs::BytesDocument< ByteT_ >;
+  using action_t                = io_channel_action_t< ByteT_ >;
+
+  /**
+   * @brief Константа DOCUMENT_SIZE_MAX ограничивает размер собираемого
+   *        документа по умолчанию, байт.
+   */
+  static const std::size_t        DOCUMENT_SIZE_MAX = 64 * 1024 * 1024;
+
+  explicit ChannelDemux ( std::size_t maxDocument = DOCUMENT_SIZE_MAX )
+    : m_MaxDocument( maxDocument )
+  {}
+
+  void SetAction ( std::uint8_t channel, const action_t & action )
+  {
+    m_Actions[ channel ] = action;
+  }
+
+  /**
+   * @brief Метод IsCorrupted сообщает о нарушении формата потока (размер
+   *        документа превысил ограничение). Прием далее не выполняется.
+   */
+  bool IsCorrupted () const { return m_Corrupted; }
+
+  /**
+   * @brief Метод Feed разбирает очередную часть принятых данных.
+   * @return false при нарушении формата потока или отказе обработчика
+   *         канала.
+   */
+  bool Feed ( const ByteT_ * data, std::size_t size )
+  {
+    auto ptr( reinterpret_cast< const unsigned char * >( data ) );
+    std::size_t bytes( size * sizeof( ByteT_ ) );
+    bool retval( not m_Corrupted );
+    while( retval and ( bytes > 0 ) )
+    {
+      if( m_HeaderFill < ChannelFrame::HEADER_SIZE )
+      { // заголовок кадра может быть разделен между частями данных
+        const std::size_t t( std::min( bytes, ChannelFrame::HEADER_SIZE - m_HeaderFill ) );
+        std::copy( ptr, ptr + t, m_Header.begin() + m_HeaderFill );
+        m_HeaderFill += t;
+        ptr += t;
+        bytes -= t;
+        if( m_HeaderFill < ChannelFrame::HEADER_SIZE )
+          break;
+        m_Frame.Read( m_Header.data() );
+        m_Left = m_Frame.m_Length;
+
+        auto & content( m_Partial[ m_Frame.m_Channel ] );
+        if( ( content.size() * sizeof( ByteT_ ) + m_Left > m_MaxDocument )
+            or ( m_Left % sizeof( ByteT_ ) != 0 ) )
+        {
+          m_Corrupted = true;
+          return false;
+        }
+        content.reserve( content.size() + m_Left / sizeof( ByteT_ ) );
+      }
+
+      const std::size_t t( std::min< std::size_t >( bytes, m_Left ) );
+      auto & content( m_Partial[ m_Frame.m_Channel ] );
+      auto first( reinterpret_cast< const ByteT_ * >( ptr ) );
+      content.insert( content.end(), first, first + t / sizeof( ByteT_ ) );
+      ptr += t;
+      bytes -= t;
+      m_Left -= t;
+      if( m_Left == 0 )
+      {
+        m_HeaderFill = 0;
+        if( m_Frame.IsLast() )
+          retval = Complete( m_Frame.m_Channel );
+      }
+    }
+    return retval;
+  }
+
+  /**
+   * @brief Метод AsAction возвращает обработчик канала приема сессии,
+   *        передающий принятые данные методу @a Feed копии объекта (со
+   *        своим состоянием разбора потока).
+   */
+  action_t AsAction () const
+  {
+    ChannelDemux demux( * this );
+    return
+        [ demux ]( document_t & document ) mutable
+        {
+          auto & content( document.ContentRef() );
+          return demux.Feed( content.data(), content.size() );
+        };
+  }
+
+private:
+  std::size_t                     m_MaxDocument;
+  std::map< std::uint8_t, action_t >                              m_Actions;
+  std::map< std::uint8_t, spo::socket_byffer_t< ByteT_ > >        m_Partial;
+  ChannelFrame::header_t          m_Header;
+  std::size_t                     m_HeaderFill      { 0 };
+  ChannelFrame                    m_Frame;
+  std::size_t                     m_Left            { 0 };
+  bool                            m_Corrupted       { false };
+
+  bool Complete ( std::uint8_t channel )
+  {
+    document_t document;
+    document.ContentRef().swap( m_Partial[ channel ] );
+    auto action( m_Actions.find( channel ) );
+    return ( action == m_Actions.end() ) or ( not action->second ) or action->second( document );
+  }
+};
+
+//------------------------------------------------------------------------------
+}// namespace                   asio
+}// namespace                   spo
+
+#endif // CHANNELFRAME_H
@@ -21,6 +21,10 @@ template
       std::is_same< ProtocolT_, boost::asio::ip::udp >::value
       or
       std::is_same< ProtocolT_, boost::asio::ip::icmp >::value
+      or
+      std::is_same< ProtocolT_, spo::asio::local_stream_t >::value
+      or
+      std::is_same< ProtocolT_, spo::asio::local_datagram_t >::value
     >::type
 >
 class SPO_CORE_EXPORT             ClientServerBase
@@ -65,9 +69,61 @@ private:
    *        открытия/закрытия обработчика подключений.
    */
   std::atomic< std::int64_t >     m_TimeoutMs { 3000 };
+  /**
+   * @brief Атрибут m_BufferSize содержит размер буфера каналов приема и
+   *        передачи, назначаемый вновь создаваемым сессиям.
+   */
+  std::atomic< std::size_t >      m_BufferSize        { 512 };
 
   io_service_callback_t           m_SessionAfterStop;
   void                          * m_SessionAfterStopParamPtr = nullptr;
+  /**
+   * @brief Атрибут m_SocketProfile содержит профиль опций сокетов сервера
+   *        (клиента). Пустой указатель - опции по умолчанию.
+   */
+  socket_profile_ptr_t            m_SocketProfile;
+  /**
+   * @brief Атрибут m_FileTransferFactory содержит фабрику передач файлов
+   *        сессий потоковых протоколов.
+   */
+  file_transfer_factory_t         m_FileTransferFactory;
+  /**
+   * @brief Атрибут m_BatchPolicy содержит параметры объединения сообщений
+   *        сессий потоковых протоколов ( @a AsioSocketSession::Post ).
+   */
+  batch_policy_ptr_t              m_BatchPolicy;
+  /**
+   * @brief Атрибут m_ReceiveSizing содержит параметры изменения размера
+   *        буфера канала приема сессий (пустой указатель - размер
+   *        @a m_BufferSize не изменяется).
+   */
+  std::shared_ptr< const BufferSizing > m_ReceiveSizing;
+  /**
+   * @brief Атрибут m_ExtraChannels содержит дополнительные каналы передачи,
+   *        добавляемые сессиям потоковых протоколов
+   *        ( @a AsioSocketSession::AddChannel ).
+   */
+  std::vector< std::pair< ChannelPriority, io_channel_action_t< ByteT_ > > > m_ExtraChannels;
+  /**
+   * @brief Атрибуты m_InboundHigh и m_InboundLow содержат границы объема
+   *        принятых данных сессии, ожидающих обработки
+   *        ( @a AsioSocketSession::SetInboundLimit ).
+   */
+  std::atomic< std::size_t >      m_InboundHigh       { 0 };
+  std::atomic< std::size_t >      m_InboundLow        { 0 };
+  /**
+   * @brief Атрибут m_Offload содержит признаки выполнения действий каналов
+   *        приема и передачи сессий в пуле вычислений
+   *        ( @a AsioSocketSession::SetOffload ), бит - номер канала.
+   */
+  std::atomic< unsigned >         m_Offload           { 0 };
+#if defined( SPO_ASIO_TLS )
+  /**
+   * @brief Атрибут m_TlsContext содержит контекст TLS сессий TCP (пустой
+   *        указатель - обмен без шифрования).
+   */
+  tls_context_ptr_t               m_TlsContext;
+#endif
 
 public:
   /**
@@ -230,6 +286,216 @@ public:
           0 );
   }
 
+  /**
+   * @brief Метод BufferSize возвращает размер буфера каналов приема и передачи
+   *        данных, назначаемый сессиям при подключении.
+   * @return размер буфера в единицах типа ByteT_.
+   */
+  std::size_t BufferSize () const
+  {
+    return m_BufferSize;
+  }
+
+  /**
+   * @brief Метод SetBufferSize устанавливает размер буфера каналов приема и
+   *        передачи данных для сессий, создаваемых после вызова метода.
+   * @param bufferSize размер буфера в единицах типа ByteT_ (не менее 1).
+   */
+  void SetBufferSize ( std::size_t bufferSize )
+  {
+    m_BufferSize.store( bufferSize > 0 ? bufferSize : 1 );
+  }
+
+  /**
+   * @brief Метод SetReceiveSizing назначает изменение размера буфера канала
+   *        приема сессиям, создаваемым после вызова метода: начальный размер
+   *        @a BufferSize изменяется по результатам чтения в пределах
+   *        параметров @a sizing.
+   */
+  void SetReceiveSizing ( const BufferSizing & sizing )
+  {
+    std::atomic_store( & m_ReceiveSizing,
+                       std::shared_ptr< const BufferSizing >( std::make_shared< BufferSizing >( sizing ) ) );
+  }
+
+  std::shared_ptr< const BufferSizing > ReceiveSizingPtr () const
+  {
+    return std::atomic_load( & m_ReceiveSizing );
+  }
+
+  /**
+   * @brief Метод SetSocketProfile назначает профиль опций сокетов. Профиль
+   *        применяется к прослушивающим сокетам, открываемым после вызова
+   *        метода, и к сокетам новых подключений.
+   * @param profile профиль опций сокетов.
+   */
+  void SetSocketProfile ( const SocketProfile & profile )
+  {
+    std::atomic_store( & m_SocketProfile,
+                       socket_profile_ptr_t( std::make_shared< SocketProfile >( profile ) ) );
+  }
+
+  /**
+   * @brief Метод ClearSocketProfile восстанавливает опции сокетов по умолчанию.
+   */
+  void ClearSocketProfile ()
+  {
+    std::atomic_store( & m_SocketProfile, socket_profile_ptr_t() );
+  }
+
+  /**
+   * @brief Метод SocketProfilePtr возвращает профиль опций сокетов.
+   * @return указатель на профиль или пустой указатель (опции по умолчанию).
+   */
+  socket_profile_ptr_t SocketProfilePtr () const
+  {
+    return std::atomic_load( & m_SocketProfile );
+  }
+
+  /**
+   * @brief Метод SetFileTransferFactory назначает фабрику передач файлов:
+   *        каждая сессия TCP или потокового локального сокета, создаваемая
+   *        после вызова метода, получает передачу файла фабрики
+   *        ( @a AsioSocketSession::SetFileTransfer ).
+   * @param factory фабрика передач (пустая фабрика или пустой указатель
+   *        передачи - обмен обработчиками каналов).
+   */
+  void SetFileTransferFactory ( const file_transfer_factory_t & factory )
+  {
+    m_FileTransferFactory = factory;
+  }
+
+  const file_transfer_factory_t & FileTransferFactory () const
+  {
+    return m_FileTransferFactory;
+  }
+
+  /**
+   * @brief Метод SetBatchPolicy назначает параметры объединения исходящих
+   *        сообщений сессиям TCP и потоковых локальных сокетов, создаваемым
+   *        после вызова метода.
+   */
+  void SetBatchPolicy ( const BatchPolicy & policy )
+  {
+    std::atomic_store( & m_BatchPolicy,
+                       batch_policy_ptr_t( std::make_shared< BatchPolicy >( policy ) ) );
+  }
+
+  /**
+   * @brief Метод ClearBatchPolicy восстанавливает передачу сообщений без
+   *        удержания.
+   */
+  void ClearBatchPolicy ()
+  {
+    std::atomic_store( & m_BatchPolicy, batch_policy_ptr_t() );
+  }
+
+  batch_policy_ptr_t BatchPolicyPtr () const
+  {
+    return std::atomic_load( & m_BatchPolicy );
+  }
+
+  /**
+   * @brief Метод SetInboundLimit назначает границы объема принятых данных,
+   *        ожидающих обработки, сессиям, создаваемым после вызова метода.
+   * @param high верхняя граница, байт (0 - без ограничения);
+   * @param low  нижняя граница возобновления чтения, байт.
+   *
+   * @see spo::asio::InboundBudget
+   */
+  void SetInboundLimit ( std::size_t high, std::size_t low )
+  {
+    m_InboundHigh = high;
+    m_InboundLow  = std::min( low, high );
+  }
+
+  std::size_t InboundHigh () const
+  {
+    return m_InboundHigh;
+  }
+
+  std::size_t InboundLow () const
+  {
+    return m_InboundLow;
+  }
+
+  /**
+   * @brief Метод SetOffload назначает выполнение действия канала
+   *        @a channel ( @a DataType::Input или @a DataType::Output ) в пуле
+   *        вычислений @a AsioComputePool сессиям, создаваемым после вызова
+   *        метода.
+   */
+  void SetOffload ( spo::asio::DataType channel, bool offload = true )
+  {
+    const unsigned bit( 1u << static_cast< unsigned >( channel ) );
+    if( offload )
+      m_Offload |= bit;
+    else
+      m_Offload &= ~bit;
+  }
+
+  /**
+   * @brief Метод OffloadTo назначает сессии выполнение действий каналов в
+   *        пуле вычислений, заданное методом @a SetOffload.
+   */
+  template< typename Session_ >
+  void OffloadTo ( Session_ & session ) const
+  {
+    const unsigned offload( m_Offload );
+    for( std::size_t channel( 0 ); channel < spo::asio::DataType::DataSize; ++channel )
+      if( offload & ( 1u << channel ) )
+        session.SetOffload( channel );
+  }
+
+  /**
+   * @brief Метод AddChannel добавляет канал передачи с приоритетом
+   *        @a priority сессиям, создаваемым после вызова метода. Вызывается
+   *        до запуска сервиса.
+   * @return номер канала в сессиях ( @a AsioSocketSession::Post,
+   *         @a AsioSocketSession::Transmit ).
+   */
+  std::size_t AddChannel
+  (
+      ChannelPriority                                   priority,
+      const spo::asio::io_channel_action_t< ByteT_ >  & action = spo::asio::io_channel_action_t< ByteT_ >()
+  )
+  {
+    m_ExtraChannels.emplace_back( priority, action );
+    return spo::asio::DataType::DataSize + m_ExtraChannels.size() - 1;
+  }
+
+  /**
+   * @brief Метод AddChannelsTo добавляет сессии каналы, заданные методом
+   *        @a AddChannel.
+   */
+  template< typename Session_ >
+  void AddChannelsTo ( Session_ & session ) const
+  {
+    for( auto & channel : m_ExtraChannels )
+      session.AddChannel( channel.first, channel.second );
+  }
+
+#if defined( SPO_ASIO_TLS )
+  /**
+   * @brief Метод SetTlsContext назначает контекст TLS сессиям TCP, создаваемым
+   *        после вызова метода. Роль контекста ( @a TlsRole ) должна
+   *        соответствовать серверу или клиенту.
+   * @param context контекст TLS (пустой указатель - обмен без шифрования).
+   */
+  void SetTlsContext ( const tls_context_ptr_t & context )
+  {
+    std::atomic_store( & m_TlsContext, context );
+  }
+
+  /**
+   * @brief Метод TlsContextPtr возвращает контекст TLS сессий.
+   */
+  tls_context_ptr_t TlsContextPtr () const
+  {
+    return std::atomic_load( & m_TlsContext );
+  }
+#endif
+
   /**
    * @brief Метод SocketsLimit возвращает максимальное допустимое значение
    *        количества одновременно обслуживаемых сокетов.
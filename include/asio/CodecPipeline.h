@@ -0,0 +1,595 @@
+/**
+  * @file CodecPipeline.h
+  * @brief Файл CodecPipeline.h содержит шаблоны конвейера преобразования
+  *        данных канала обмена @a spo::asio::CodecPipeline и его звеньев
+  *        ( @a spo::asio::CodecStage ): выделение кадров, распаковка,
+  *        декодирование и обработка принятых данных, и обратная
+  *        последовательность для передаваемых данных.
+  *
+  * Звенья передают друг другу представления ( @a spo::asio::CodecView ) -
+  * указатель и размер - без копирования данных. Данные, формируемые звеном
+  * (распакованные, закодированные), размещаются в общей для конвейера области
+  * памяти ( @a spo::asio::CodecArena ), которая освобождается после обработки
+  * очередной порции данных канала и не возвращает память системе, поэтому
+  * при установившемся обмене память не выделяется.
+  *
+  * Конвейер подключается к каналу обычным действием @a io_channel_action_t
+  * (методы @a CodecPipeline::InputAction и @a CodecPipeline::OutputAction).
+  * Действие содержит копию конвейера, а каждая сессия - копию действия,
+  * поэтому состояние звеньев (например, незавершенный кадр) не разделяется
+  * сессиями.
+  *
+  * Например:
+  * @code
+  *   spo::asio::CodecPipeline< char > pipeline;
+  *   pipeline.Add( spo::asio::FrameCodec< char >( spo::core::docs::FrameLength::Varint, true ) );
+  *   server.SetBufferAction(
+  *     spo::asio::DataType::Input,
+  *     pipeline.InputAction( []( const spo::asio::CodecView< char > & msg ) { return Process( msg ); } ) );
+  *   server.SetBufferAction( spo::asio::DataType::Output, pipeline.OutputAction( Prepare ) );
+  * @endcode
+  */
+
+#ifndef CODECPIPELINE_H
+#define CODECPIPELINE_H
+
+#include "asio/IOChannel.h"
+#include "core/documents/DocumentFrame.h"
+#include <cstring>
+
+namespace                         spo   {
+namespace                         asio  {
+
+template< typename ByteT_ >       class CodecPipeline;
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Структура CodecView определяет представление непрерывной области
+ *        данных, передаваемое между звеньями конвейера.
+ *
+ * Представление действительно до окончания обработки порции данных канала.
+ */
+template< typename                ByteT_            = unsigned char >
+struct                            CodecView
+{
+  const ByteT_                  * m_Data            { nullptr };
+  std::size_t                     m_Size            { 0 };
+
+  /**/                            CodecView         () = default;
+  /**/                            CodecView         ( const ByteT_ * data, std::size_t size )
+    : m_Data                      ( data )
+    , m_Size                      ( size )
+  {}
+
+  const ByteT_                  * Data              () const { return m_Data; }
+  std::size_t                     Size              () const { return m_Size; }
+  bool                            IsEmpty           () const { return m_Size == 0; }
+  const ByteT_                  * begin             () const { return m_Data; }
+  const ByteT_                  * end               () const { return m_Data + m_Size; }
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс CodecArena реализует общую область памяти звеньев конвейера.
+ *
+ * Память выделяется последовательно из блоков. Метод @a Reset освобождает
+ * всю выделенную память разом; если понадобилось несколько блоков, они
+ * объединяются в один блок суммарного размера, поэтому при повторяющемся
+ * объеме данных выделение выполняется из одного блока без обращения к
+ * системе.
+ */
+template< typename                ByteT_            = unsigned char >
+class                             CodecArena
+{
+public:
+  static const std::size_t        BLOCK_SIZE_MIN    = 4096;
+
+  /**/                            CodecArena        () = default;
+  /**/                            CodecArena        ( const CodecArena & ) {}
+  CodecArena                    & operator =        ( const CodecArena & ) { return * this; }
+
+  /**
+   * @brief Метод Allocate выделяет область памяти.
+   * @param size размер области в единицах @a ByteT_.
+   * @return указатель на область, действительный до вызова @a Reset.
+   */
+  ByteT_ * Allocate ( std::size_t size )
+  {
+    for( ; m_Block < m_Blocks.size(); ++ m_Block, m_Used = 0 )
+    {
+      auto & block( m_Blocks[ m_Block ] );
+      if( block.m_Size - m_Used >= size )
+      {
+        auto retval( block.m_Data.get() + m_Used );
+        m_Used += size;
+        return retval;
+      }
+    }
+
+    Block block;
+    block.m_Size = std::max( { size, BLOCK_SIZE_MIN, Capacity() } );
+    block.m_Data.reset( new ByteT_[ block.m_Size ] );
+    m_Blocks.push_back( std::move( block ) );
+    m_Block = m_Blocks.size() - 1;
+    m_Used  = size;
+    return m_Blocks.back().m_Data.get();
+  }
+
+  /**
+   * @brief Метод Reset освобождает всю выделенную память.
+   */
+  void Reset ()
+  {
+    if( m_Blocks.size() > 1 )
+    {
+      Block block;
+      block.m_Size = Capacity();
+      block.m_Data.reset( new ByteT_[ block.m_Size ] );
+      m_Blocks.clear();
+      m_Blocks.push_back( std::move( block ) );
+    }
+    m_Block = 0;
+    m_Used  = 0;
+  }
+
+  /**
+   * @brief Метод Capacity возвращает суммарный размер блоков.
+   */
+  std::size_t Capacity () const
+  {
+    std::size_t retval( 0 );
+    for( auto & block : m_Blocks )
+      retval += block.m_Size;
+    return retval;
+  }
+
+private:
+  struct                          Block
+  {
+    std::unique_ptr< ByteT_[] >   m_Data;
+    std::size_t                   m_Size            { 0 };
+  };
+
+  std::vector< Block >            m_Blocks;
+  std::size_t                     m_Block           { 0 };
+  std::size_t                     m_Used            { 0 };
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс CodecContext передается звену конвейера и обеспечивает
+ *        передачу результата следующему звену и доступ к общей памяти.
+ */
+template< typename                ByteT_            = unsigned char >
+class                             CodecContext
+{
+public:
+  using view_t                  = CodecView< ByteT_ >;
+
+  /**/                            CodecContext      ( CodecPipeline< ByteT_ > & pipeline, std::size_t stage, bool encode )
+    : m_Pipeline                  ( pipeline )
+    , m_Stage                     ( stage )
+    , m_Encode                    ( encode )
+  {}
+
+  /**
+   * @brief Метод Next передает данные следующему звену конвейера (при
+   *        приеме - в сторону обработчика, при передаче - в сторону сокета).
+   * @return результат обработки данных следующими звеньями.
+   */
+  bool Next ( const view_t & view )
+  {
+    return m_Pipeline.Forward( m_Stage, m_Encode, view );
+  }
+
+  /**
+   * @brief Метод IsLast сообщает, что следующее звено - окончание конвейера
+   *        (обработчик при приеме, буфер канала при передаче). Окончанию
+   *        конвейера при передаче данные сообщения можно передавать
+   *        несколькими частями (вызовами @a Next), остальным звеньям -
+   *        одним представлением.
+   */
+  bool IsLast () const
+  {
+    return m_Pipeline.IsLast( m_Stage, m_Encode );
+  }
+
+  /**
+   * @brief Метод Allocate выделяет память для данных, формируемых звеном, в
+   *        общей области памяти конвейера.
+   */
+  ByteT_ * Allocate ( std::size_t size )
+  {
+    return m_Pipeline.ArenaRef().Allocate( size );
+  }
+
+private:
+  CodecPipeline< ByteT_ >       & m_Pipeline;
+  std::size_t                     m_Stage;
+  bool                            m_Encode;
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс CodecStage определяет интерфейс звена конвейера.
+ *
+ * Звено получает данные методом @a Decode (прием) или @a Encode (передача)
+ * и передает результат следующему звену методом @a CodecContext::Next -
+ * ни одного, один или несколько раз (например, звено выделения кадров
+ * передает каждый полный кадр).
+ */
+template< typename                ByteT_            = unsigned char >
+class                             CodecStage
+{
+public:
+  using view_t                  = CodecView< ByteT_ >;
+  using context_t               = CodecContext< ByteT_ >;
+  using stage_ptr_t             = std::unique_ptr< CodecStage< ByteT_ > >;
+
+  virtual                       ~ CodecStage        () {}
+
+  /**
+   * @brief Метод Clone возвращает копию звена для отдельного канала.
+   */
+  virtual stage_ptr_t             Clone             () const = 0;
+
+  /**
+   * @brief Метод Decode преобразует принятые данные.
+   * @return Признак успешной обработки.
+   */
+  virtual bool                    Decode            ( context_t & ctx, const view_t & in ) = 0;
+
+  /**
+   * @brief Метод Encode преобразует передаваемые данные.
+   * @return Признак успешной обработки.
+   */
+  virtual bool                    Encode            ( context_t & ctx, const view_t & in ) = 0;
+};
+
+/**
+ * @brief Шаблон CodecStageBase реализует копирование звена @a Clone через
+ *        конструктор копирования класса звена @a StageT_.
+ */
+template< typename                StageT_,
+          typename                ByteT_            = unsigned char >
+class                             CodecStageBase :
+public                            CodecStage< ByteT_ >
+{
+public:
+  typename CodecStage< ByteT_ >::stage_ptr_t Clone () const override
+  {
+    return
+        typename CodecStage< ByteT_ >::stage_ptr_t(
+          new StageT_( static_cast< const StageT_ & >( * this ) ) );
+  }
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс FunctionCodec реализует звено конвейера функторами (например,
+ *        декодирование сообщений прикладного протокола).
+ *
+ * Отсутствующий функтор передает данные следующему звену без изменений.
+ */
+template< typename                ByteT_            = unsigned char >
+class                             FunctionCodec :
+public                            CodecStageBase< FunctionCodec< ByteT_ >, ByteT_ >
+{
+public:
+  using view_t                  = CodecView< ByteT_ >;
+  using context_t               = CodecContext< ByteT_ >;
+  using function_t              = std::function< bool( context_t &, const view_t & ) >;
+
+  explicit                        FunctionCodec     ( function_t decode, function_t encode = function_t() )
+    : m_Decode                    ( decode )
+    , m_Encode                    ( encode )
+  {}
+
+  bool Decode ( context_t & ctx, const view_t & in ) override
+  {
+    return m_Decode ? m_Decode( ctx, in ) : ctx.Next( in );
+  }
+
+  bool Encode ( context_t & ctx, const view_t & in ) override
+  {
+    return m_Encode ? m_Encode( ctx, in ) : ctx.Next( in );
+  }
+
+private:
+  function_t                      m_Decode;
+  function_t                      m_Encode;
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс FrameCodec реализует звено выделения и формирования кадров
+ *        с префиксом длины в формате @a spo::core::docs::DocumentFrame.
+ *
+ * При приеме кадры, целиком находящиеся в принятой порции данных, передаются
+ * следующему звену без копирования; копируются только части кадров,
+ * разделенных между порциями. При передаче последним звеном заголовок и CRC
+ * передаются отдельно от данных, без копирования данных.
+ *
+ * После ошибки потока (искаженная длина или CRC) данные канала не
+ * принимаются.
+ */
+template< typename                ByteT_            = unsigned char >
+class                             FrameCodec :
+public                            CodecStageBase< FrameCodec< ByteT_ >, ByteT_ >
+{
+public:
+  using view_t                  = CodecView< ByteT_ >;
+  using context_t               = CodecContext< ByteT_ >;
+  using frame_t                 = spo::core::docs::DocumentFrame< ByteT_ >;
+  using state_t                 = typename frame_t::FrameState;
+
+  explicit                        FrameCodec        ( spo::core::docs::FrameLength length = spo::core::docs::FrameLength::Varint,
+                                                      bool checksum = false,
+                                                      std::size_t maxFrameSize = frame_t::FRAME_SIZE_DEFAULT )
+    : m_Format                    ( length, checksum )
+  {
+    m_Format.SetMaxFrameSize( maxFrameSize );
+  }
+
+  /**/                            FrameCodec        ( const FrameCodec & codec )
+    : m_Format                    ( codec.m_Format.LengthFormat(), codec.m_Format.HasChecksum() )
+  {
+    m_Format.SetMaxFrameSize( codec.m_Format.MaxFrameSize() );
+  }
+
+  bool IsCorrupted () const { return m_Corrupted; }
+
+  bool Decode ( context_t & ctx, const view_t & in ) override
+  {
+    if( m_Corrupted )
+      return false;
+
+    std::size_t used( 0 );
+    if( m_Pending.empty() )
+    { // кадры в принятой порции передаются без копирования
+      auto retval( Frames( ctx, in.Data(), in.Size(), used ) );
+      if( not m_Corrupted )
+        m_Pending.assign( in.Data() + used, in.Data() + in.Size() );
+      return retval;
+    }
+
+    m_Pending.insert( m_Pending.end(), in.begin(), in.end() );
+    auto retval( Frames( ctx, m_Pending.data(), m_Pending.size(), used ) );
+    if( not m_Corrupted )
+      m_Pending.erase( m_Pending.begin(), m_Pending.begin() + static_cast< std::ptrdiff_t >( used ) );
+    return retval;
+  }
+
+  bool Encode ( context_t & ctx, const view_t & in ) override
+  {
+    auto size   ( m_Format.FrameSize( in.Size() ) );
+    auto header ( size - in.Size() - ( m_Format.HasChecksum() ? frame_t::CRC_SIZE : 0 ) );
+    if( ctx.IsLast() )
+    { // заголовок и CRC - отдельными частями, данные - без копирования
+      auto out( ctx.Allocate( header + frame_t::CRC_SIZE ) );
+      m_Format.WriteHeader( out, in.Size() );
+      auto crc( m_Format.WriteChecksum( out + header, in.Data(), in.Size() ) );
+      return
+          ctx.Next( view_t{ out, header } )
+          and
+          ctx.Next( in )
+          and
+          ( ( crc == 0 ) or ctx.Next( view_t{ out + header, crc } ) );
+    }
+
+    auto out( ctx.Allocate( size ) );
+    m_Format.WriteHeader( out, in.Size() );
+    std::memcpy( out + header, in.Data(), in.Size() * sizeof( ByteT_ ) );
+    m_Format.WriteChecksum( out + header + in.Size(), in.Data(), in.Size() );
+    return ctx.Next( view_t{ out, size } );
+  }
+
+private:
+  frame_t                         m_Format;
+  std::vector< ByteT_ >           m_Pending;
+  bool                            m_Corrupted       { false };
+
+  /**
+   * @brief Метод Frames передает следующему звену все полные кадры области.
+   *        Передача прекращается на первом кадре, не принятом следующим
+   *        звеном; непереданные кадры остаются в области.
+   * @param used размер обработанных данных.
+   * @return признак передачи всех полных кадров без ошибок.
+   */
+  bool Frames ( context_t & ctx, const ByteT_ * data, std::size_t available, std::size_t & used )
+  {
+    used = 0;
+    while( used < available )
+    {
+      std::size_t header( 0 ), size( 0 );
+      auto state( m_Format.ParseFrame( data + used, available - used, header, size ) );
+      if( state == state_t::Incomplete )
+        break;
+
+      if( ( state == state_t::Corrupted )
+          or
+          ( not m_Format.IsChecksumValid( data + used + header, size ) ) )
+      {
+        DUMP_CRITICAL( "FrameCodec: stream corrupted" );
+        m_Corrupted = true;
+        m_Pending.clear();
+        return false;
+      }
+
+      const bool next( ctx.Next( view_t{ data + used + header, size } ) );
+      used += m_Format.FrameSize( size );
+      if( not next )
+        return false;
+    }
+    return true;
+  }
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс CodecPipeline реализует конвейер звеньев преобразования данных
+ *        канала обмена.
+ *
+ * Звенья перечисляются от сокета к обработчику: при приеме данные проходят
+ * звенья в порядке добавления, при передаче - в обратном порядке.
+ */
+template< typename                ByteT_            = unsigned char >
+class                             CodecPipeline
+{
+public:
+  using view_t                  = CodecView< ByteT_ >;
+  using stage_t                 = CodecStage< ByteT_ >;
+  using document_t              = spo::core::docs::BytesDocument< ByteT_ >;
+
+  /**
+   * @brief Тип handler_t определяет обработчик принятого сообщения на
+   *        выходе конвейера.
+   */
+  using handler_t               = std::function< bool( const view_t & ) >;
+
+  /**/                            CodecPipeline     () = default;
+  /**/                            CodecPipeline     ( const CodecPipeline & pipeline )
+    : m_Handler                   ( pipeline.m_Handler )
+  {
+    for( auto & stage : pipeline.m_Stages )
+      m_Stages.push_back( stage->Clone() );
+  }
+  /**/                            CodecPipeline     ( CodecPipeline && ) = default;
+
+  CodecPipeline & operator = ( CodecPipeline pipeline )
+  {
+    m_Stages.swap( pipeline.m_Stages );
+    m_Handler.swap( pipeline.m_Handler );
+    return * this;
+  }
+
+  /**
+   * @brief Метод Add добавляет копию звена в конец конвейера (в сторону
+   *        обработчика).
+   * @return ссылка на конвейер.
+   */
+  CodecPipeline & Add ( const stage_t & stage )
+  {
+    m_Stages.push_back( stage.Clone() );
+    return * this;
+  }
+
+  std::size_t StagesCount () const { return m_Stages.size(); }
+
+  /**
+   * @brief Метод SetHandler назначает обработчик принятых сообщений.
+   */
+  void SetHandler ( const handler_t & handler ) { m_Handler = handler; }
+
+  /**
+   * @brief Метод Decode пропускает принятые данные через звенья конвейера до
+   *        обработчика.
+   * @return Признак успешной обработки.
+   */
+  bool Decode ( const view_t & in )
+  {
+    m_Arena.Reset();
+    return Forward( std::size_t( -1 ), false, in );
+  }
+
+  /**
+   * @brief Метод Encode пропускает данные сообщения через звенья конвейера в
+   *        обратном порядке и помещает результат в документ @a out.
+   * @return Признак успешной обработки.
+   */
+  bool Encode ( const view_t & in, document_t & out )
+  {
+    m_Arena.Reset();
+    m_Output.clear();
+    auto retval( Forward( m_Stages.size(), true, in ) );
+    if( retval )
+      out.ContentRef().swap( m_Output );
+    return retval;
+  }
+
+  /**
+   * @brief Метод InputAction возвращает действие канала приема: принятые
+   *        данные канала пропускаются через конвейер до обработчика
+   *        @a handler.
+   */
+  io_channel_action_t< ByteT_ > InputAction ( const handler_t & handler ) const
+  {
+    CodecPipeline pipeline( * this );
+    pipeline.SetHandler( handler );
+    return
+        [ pipeline ]( document_t & data ) mutable
+        {
+          auto & content( data.ContentRef() );
+          return pipeline.Decode( view_t{ content.data(), content.size() } );
+        };
+  }
+
+  /**
+   * @brief Метод OutputAction возвращает действие канала передачи: данные,
+   *        подготовленные действием @a source, пропускаются через конвейер в
+   *        обратном порядке и заменяют данные канала.
+   */
+  io_channel_action_t< ByteT_ > OutputAction ( const io_channel_action_t< ByteT_ > & source ) const
+  {
+    CodecPipeline pipeline( * this );
+    return
+        [ pipeline, source ]( document_t & data ) mutable
+        {
+          if( not ( source and source( data ) ) )
+            return false;
+          auto & content( data.ContentRef() );
+          return pipeline.Encode( view_t{ content.data(), content.size() }, data );
+        };
+  }
+
+  CodecArena< ByteT_ > & ArenaRef () { return std::ref( m_Arena ); }
+
+private:
+  friend class                    CodecContext< ByteT_ >;
+
+  std::vector< typename stage_t::stage_ptr_t > m_Stages;
+  handler_t                       m_Handler;
+  CodecArena< ByteT_ >            m_Arena;
+  /**
+   * @brief Атрибут m_Output содержит результат передачи; после обмена с
+   *        буфером канала содержит прежний буфер канала, память которого
+   *        используется повторно.
+   */
+  socket_byffer_t< ByteT_ >       m_Output;
+
+  /**
+   * @brief Метод Forward передает данные звену, следующему за звеном
+   *        @a stage, или окончанию конвейера.
+   */
+  bool Forward ( std::size_t stage, bool encode, const view_t & view )
+  {
+    if( encode )
+    {
+      if( stage == 0 )
+      {
+        m_Output.insert( m_Output.end(), view.begin(), view.end() );
+        return true;
+      }
+      CodecContext< ByteT_ > ctx( * this, stage - 1, true );
+      return m_Stages[ stage - 1 ]->Encode( ctx, view );
+    }
+
+    auto next( stage + 1 );
+    if( next >= m_Stages.size() )
+      return m_Handler ? m_Handler( view ) : false;
+    CodecContext< ByteT_ > ctx( * this, next, false );
+    return m_Stages[ next ]->Decode( ctx, view );
+  }
+
+  bool IsLast ( std::size_t stage, bool encode ) const
+  {
+    return encode ? stage == 0 : stage + 1 >= m_Stages.size();
+  }
+};
+
+//------------------------------------------------------------------------------
+
+}// namespace                   asio
+}// namespace                   spo
+
+#endif // CODECPIPELINE_H
@@ -0,0 +1,471 @@
+/**
+  * @file CompressionCodec.h
+  * @brief Файл CompressionCodec.h содержит шаблон звена конвейера
+  *        @a spo::asio::CompressionCodec потокового сжатия данных канала
+  *        (zlib deflate/inflate; zstd в сборке с CONFIG+=asio_zstd) и
+  *        структуру @a spo::asio::CompressionMetrics счетчиков сжатия.
+  *
+  * Контекст сжатия сохраняется между сообщениями канала, а каждое сообщение
+  * завершается сбросом (Z_SYNC_FLUSH, ZSTD_e_flush): получатель восстанавливает
+  * сообщение целиком сразу после его приема, что необходимо для
+  * последовательного обмена (HalfDuplexIn, HalfDuplexOut). Общий словарь
+  * отправителя и получателя (например, типовое сообщение протокола) улучшает
+  * сжатие коротких сообщений, для которых собственной истории потока нет.
+  *
+  * Звено размещается в конвейере после звена выделения кадров: сжатые
+  * сообщения передаются кадрами.
+  */
+
+#ifndef COMPRESSIONCODEC_H
+#define COMPRESSIONCODEC_H
+
+#include "asio/CodecPipeline.h"
+#include <cstring>
+#include <zlib.h>
+#if defined( SPO_ASIO_ZSTD )
+# include <zstd.h>
+#endif
+
+namespace                         spo   {
+namespace                         asio  {
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс-перечисление CompressionKind определяет алгоритм сжатия.
+ */
+enum class                        CompressionKind
+{
+  Zlib          = 0 , ///< deflate без заголовков zlib (как permessage-deflate)
+  Zstd              , ///< zstd, только в сборке с SPO_ASIO_ZSTD
+};
+
+/**
+ * @brief Структура CompressionMetrics содержит счетчики звеньев сжатия,
+ *        разделяемые копиями звена (всеми сессиями сервера или клиента).
+ */
+struct                            CompressionMetrics
+{
+  std::atomic< std::uint64_t >    m_RawOut          { 0 }; ///< байт до сжатия (передача)
+  std::atomic< std::uint64_t >    m_CompressedOut   { 0 }; ///< байт после сжатия (передача)
+  std::atomic< std::uint64_t >    m_CompressedIn    { 0 }; ///< сжатых байт принято
+  std::atomic< std::uint64_t >    m_RawIn           { 0 }; ///< байт после распаковки (прием)
+  std::atomic< std::uint64_t >    m_MessagesOut     { 0 };
+  std::atomic< std::uint64_t >    m_MessagesIn      { 0 };
+  std::atomic< std::uint64_t >    m_Errors          { 0 };
+
+  /**
+   * @brief Метод Ratio возвращает отношение объема сжатых данных к исходным
+   *        (передача и прием вместе): значение меньше 1 - сжатие выгодно.
+   */
+  double Ratio () const
+  {
+    auto raw( m_RawOut + m_RawIn );
+    return raw > 0 ? double( m_CompressedOut + m_CompressedIn ) / double( raw ) : 1.0;
+  }
+};
+
+using compression_metrics_ptr_t = std::shared_ptr< CompressionMetrics >;
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс CompressionCodec реализует звено потокового сжатия.
+ *
+ * Контексты сжатия создаются при первом сообщении, поэтому прототип звена в
+ * действии канала память под контексты не занимает. Копия звена (для новой
+ * сессии) получает новый контекст и общие счетчики.
+ *
+ * Размер распакованного сообщения ограничен ( @a SetMaxMessage ): короткое
+ * сжатое сообщение не может занять память сверх предела.
+ */
+template< typename                ByteT_            = unsigned char >
+class                             CompressionCodec :
+public                            CodecStageBase< CompressionCodec< ByteT_ >, ByteT_ >
+{
+public:
+  using view_t                  = CodecView< ByteT_ >;
+  using context_t               = CodecContext< ByteT_ >;
+
+  static const int                LEVEL_DEFAULT     = -1;
+  /**
+   * @brief Константа MAX_MESSAGE_DEFAULT содержит наибольший размер
+   *        распакованного сообщения по умолчанию, байт.
+   */
+  static const std::size_t        MAX_MESSAGE_DEFAULT = 16 * 1024 * 1024;
+
+  /**
+   * @brief Конструктор CompressionCodec
+   * @param kind       алгоритм сжатия;
+   * @param level      уровень сжатия ( @a LEVEL_DEFAULT - по умолчанию
+   *                   алгоритма);
+   * @param dictionary общий словарь отправителя и получателя;
+   * @param metrics    счетчики (создаются, если не заданы).
+   */
+  explicit
+  CompressionCodec ( CompressionKind              kind        = CompressionKind::Zlib,
+                     int                          level       = LEVEL_DEFAULT,
+                     const std::string          & dictionary  = std::string(),
+                     compression_metrics_ptr_t    metrics     = compression_metrics_ptr_t() )
+    : m_Kind                      ( kind )
+    , m_Level                     ( level )
+    , m_Dictionary                ( dictionary )
+    , m_Metrics                   ( metrics ? metrics : std::make_shared< CompressionMetrics >() )
+  {}
+
+  CompressionCodec ( const CompressionCodec & codec )
+    : CompressionCodec( codec.m_Kind, codec.m_Level, codec.m_Dictionary, codec.m_Metrics )
+  {
+    m_MaxMessage = codec.m_MaxMessage;
+  }
+
+  CompressionCodec & operator = ( const CompressionCodec & ) = delete;
+
+  ~ CompressionCodec ()
+  {
+    if( m_Deflate )
+      ::deflateEnd( & m_DeflateStream );
+    if( m_Inflate )
+      ::inflateEnd( & m_InflateStream );
+#if defined( SPO_ASIO_ZSTD )
+    ::ZSTD_freeCCtx( m_CCtx );
+    ::ZSTD_freeDCtx( m_DCtx );
+#endif
+  }
+
+  /**
+   * @brief Метод IsAvailable сообщает о доступности алгоритма в сборке.
+   */
+  static bool IsAvailable ( CompressionKind kind )
+  {
+#if defined( SPO_ASIO_ZSTD )
+    UNUSED( kind );
+    return true;
+#else
+    return kind == CompressionKind::Zlib;
+#endif
+  }
+
+  compression_metrics_ptr_t MetricsPtr () const { return m_Metrics; }
+
+  /**
+   * @brief Метод SetMaxMessage ограничивает размер распакованного сообщения:
+   *        сообщение, распаковка которого превышает предел, отклоняется без
+   *        выделения памяти сверх предела.
+   * @param size наибольший размер сообщения, байт (не менее 1).
+   */
+  void SetMaxMessage ( std::size_t size ) { m_MaxMessage = std::max< std::size_t >( size, 1 ); }
+  std::size_t MaxMessage () const { return m_MaxMessage; }
+
+  bool Decode ( context_t & ctx, const view_t & in ) override
+  {
+    m_Buffer.clear();
+    bool retval(
+          m_Kind == CompressionKind::Zlib
+          ? Inflate( in )
+          : DecompressZstd( in ) );
+    if( not retval )
+    {
+      ++ m_Metrics->m_Errors;
+      return false;
+    }
+
+    m_Metrics->m_CompressedIn += in.Size();
+    m_Metrics->m_RawIn        += m_Buffer.size();
+    ++ m_Metrics->m_MessagesIn;
+    return ctx.Next( view_t( m_Buffer.data(), m_Buffer.size() ) );
+  }
+
+  bool Encode ( context_t & ctx, const view_t & in ) override
+  {
+    m_Buffer.clear();
+    bool retval(
+          m_Kind == CompressionKind::Zlib
+          ? Deflate( in )
+          : CompressZstd( in ) );
+    if( not retval )
+    {
+      ++ m_Metrics->m_Errors;
+      return false;
+    }
+
+    m_Metrics->m_RawOut         += in.Size();
+    m_Metrics->m_CompressedOut  += m_Buffer.size();
+    ++ m_Metrics->m_MessagesOut;
+    return ctx.Next( view_t( m_Buffer.data(), m_Buffer.size() ) );
+  }
+
+private:
+  /**
+   * @brief Атрибут DEFLATE_TAIL_SIZE - размер окончания каждого сообщения после
+   *        Z_SYNC_FLUSH: не передается и восстанавливается получателем.
+   *        Пустое сообщение передается без данных и не распаковывается
+   *        (повторный Z_SYNC_FLUSH без входа не формирует окончание).
+   */
+  static const std::size_t        DEFLATE_TAIL_SIZE = 4;
+
+  static const unsigned char    * DeflateTail ()
+  {
+    static const unsigned char tail[ DEFLATE_TAIL_SIZE ] = { 0x00, 0x00, 0xFF, 0xFF };
+    return tail;
+  }
+  static const int                WINDOW_BITS       = 15;
+
+  CompressionKind                 m_Kind;
+  int                             m_Level;
+  std::string                     m_Dictionary;
+  compression_metrics_ptr_t       m_Metrics;
+  std::size_t                     m_MaxMessage      { MAX_MESSAGE_DEFAULT };
+  /**
+   * @brief Атрибут m_Buffer содержит результат звена; память буфера
+   *        используется повторно для следующих сообщений.
+   */
+  std::vector< ByteT_ >           m_Buffer;
+
+  z_stream                        m_DeflateStream;
+  z_stream                        m_InflateStream;
+  bool                            m_Deflate         { false };
+  bool                            m_Inflate         { false };
+#if defined( SPO_ASIO_ZSTD )
+  ZSTD_CCtx                     * m_CCtx            { nullptr };
+  ZSTD_DCtx                     * m_DCtx            { nullptr };
+#endif
+
+  static Bytef * ZData ( const ByteT_ * data )
+  {
+    return reinterpret_cast< Bytef * >( const_cast< ByteT_ * >( data ) );
+  }
+
+  /**
+   * @brief Метод Grow увеличивает буфер результата, заполненный на @a used.
+   */
+  void Grow ( std::size_t used )
+  {
+    m_Buffer.resize( std::max< std::size_t >( 2 * m_Buffer.size(), used + 1024 ) );
+  }
+
+  /**
+   * @brief Метод GrowDecoded увеличивает буфер распаковки, заполненный на
+   *        @a used, не более чем до @a m_MaxMessage + 1 байт.
+   * @return false, если сообщение превышает @a m_MaxMessage.
+   */
+  bool GrowDecoded ( std::size_t used )
+  {
+    if( used > m_MaxMessage )
+    {
+      DUMP_CRITICAL( "CompressionCodec: decompressed message exceeds " << m_MaxMessage << " bytes" );
+      return false;
+    }
+    m_Buffer.resize( std::min< std::size_t >(
+                       std::max< std::size_t >( 2 * m_Buffer.size(), used + 1024 ),
+                       m_MaxMessage + 1 ) );
+    return true;
+  }
+
+  /**
+   * @brief Метод DecodedSize возвращает начальный размер буфера распаковки
+   *        сообщения размером @a size.
+   */
+  std::size_t DecodedSize ( std::size_t size ) const
+  {
+    return std::min< std::size_t >( std::max< std::size_t >( 4 * size, 1024 ), m_MaxMessage + 1 );
+  }
+
+  bool Deflate ( const view_t & in )
+  {
+    if( in.Size() == 0 )
+      return true;
+
+    if( not m_Deflate )
+    {
+      std::memset( & m_DeflateStream, 0, sizeof( m_DeflateStream ) );
+      if( ::deflateInit2( & m_DeflateStream,
+                          m_Level == LEVEL_DEFAULT ? Z_DEFAULT_COMPRESSION : m_Level,
+                          Z_DEFLATED, - WINDOW_BITS, 8, Z_DEFAULT_STRATEGY ) != Z_OK )
+        return false;
+      m_Deflate = true;
+      if( ( not m_Dictionary.empty() )
+          and
+          ( ::deflateSetDictionary( & m_DeflateStream,
+                                    ZData( reinterpret_cast< const ByteT_ * >( m_Dictionary.data() ) ),
+                                    static_cast< uInt >( m_Dictionary.size() ) ) != Z_OK ) )
+        return false;
+    }
+
+    m_Buffer.resize( ::deflateBound( & m_DeflateStream, static_cast< uLong >( in.Size() ) ) + 16 );
+    m_DeflateStream.next_in   = ZData( in.Data() );
+    m_DeflateStream.avail_in  = static_cast< uInt >( in.Size() );
+    std::size_t used( 0 );
+    for( ;; )
+    {
+      m_DeflateStream.next_out  = ZData( m_Buffer.data() + used );
+      m_DeflateStream.avail_out = static_cast< uInt >( m_Buffer.size() - used );
+      auto ret( ::deflate( & m_DeflateStream, Z_SYNC_FLUSH ) );
+      if( ( ret != Z_OK ) and ( ret != Z_BUF_ERROR ) )
+      {
+        DUMP_CRITICAL( "CompressionCodec: deflate failed" );
+        return false;
+      }
+      used = m_Buffer.size() - m_DeflateStream.avail_out;
+      if( m_DeflateStream.avail_out > 0 )
+        break;
+      Grow( used );
+    }
+
+    // окончание 00 00 FF FF восстанавливается получателем: сообщение без
+    // окончания получатель распаковать не сможет
+    if( ( used < DEFLATE_TAIL_SIZE )
+        or ( std::memcmp( m_Buffer.data() + used - DEFLATE_TAIL_SIZE, DeflateTail(), DEFLATE_TAIL_SIZE ) != 0 ) )
+    {
+      DUMP_CRITICAL( "CompressionCodec: deflate output has no sync flush tail" );
+      return false;
+    }
+    m_Buffer.resize( used - DEFLATE_TAIL_SIZE );
+    return true;
+  }
+
+  bool Inflate ( const view_t & in )
+  {
+    // пустое сообщение передается без данных и окончания
+    if( in.Size() == 0 )
+      return true;
+
+    if( not m_Inflate )
+    {
+      std::memset( & m_InflateStream, 0, sizeof( m_InflateStream ) );
+      if( ::inflateInit2( & m_InflateStream, - WINDOW_BITS ) != Z_OK )
+        return false;
+      m_Inflate = true;
+      if( ( not m_Dictionary.empty() )
+          and
+          ( ::inflateSetDictionary( & m_InflateStream,
+                                    ZData( reinterpret_cast< const ByteT_ * >( m_Dictionary.data() ) ),
+                                    static_cast< uInt >( m_Dictionary.size() ) ) != Z_OK ) )
+        return false;
+    }
+
+    m_Buffer.resize( DecodedSize( in.Size() ) );
+    std::size_t used( 0 );
+    for( int part( 0 ); part < 2; ++part )
+    {
+      m_InflateStream.next_in   = part == 0 ? ZData( in.Data() ) : const_cast< Bytef * >( DeflateTail() );
+      m_InflateStream.avail_in  = static_cast< uInt >( part == 0 ? in.Size() : DEFLATE_TAIL_SIZE );
+      // распаковка продолжается, пока есть вход или выход заполнен
+      // полностью (часть результата может ожидать вывода)
+      do
+      {
+        if( ( used == m_Buffer.size() ) and ( not GrowDecoded( used ) ) )
+          return false;
+        m_InflateStream.next_out  = ZData( m_Buffer.data() + used );
+        m_InflateStream.avail_out = static_cast< uInt >( m_Buffer.size() - used );
+        auto ret( ::inflate( & m_InflateStream, Z_SYNC_FLUSH ) );
+        if( ( ret != Z_OK ) and ( ret != Z_BUF_ERROR ) )
+        {
+          DUMP_CRITICAL( "CompressionCodec: inflate failed" );
+          return false;
+        }
+        used = m_Buffer.size() - m_InflateStream.avail_out;
+        if( ret == Z_BUF_ERROR )
+          break; // продолжение невозможно: вход исчерпан
+      }
+      while( ( m_InflateStream.avail_in > 0 ) or ( m_InflateStream.avail_out == 0 ) );
+    }
+    if( used > m_MaxMessage )
+      return GrowDecoded( used );
+    m_Buffer.resize( used );
+    return true;
+  }
+
+#if defined( SPO_ASIO_ZSTD )
+  bool CompressZstd ( const view_t & in )
+  {
+    if( m_CCtx == nullptr )
+    {
+      m_CCtx = ::ZSTD_createCCtx();
+      if( m_CCtx == nullptr )
+        return false;
+      if( m_Level != LEVEL_DEFAULT )
+        ::ZSTD_CCtx_setParameter( m_CCtx, ZSTD_c_compressionLevel, m_Level );
+      if( ( not m_Dictionary.empty() )
+          and
+          ::ZSTD_isError( ::ZSTD_CCtx_loadDictionary( m_CCtx, m_Dictionary.data(), m_Dictionary.size() ) ) )
+        return false;
+    }
+
+    m_Buffer.resize( ::ZSTD_compressBound( in.Size() ) + 16 );
+    ZSTD_inBuffer input{ in.Data(), in.Size(), 0 };
+    std::size_t used( 0 );
+    for( ;; )
+    {
+      ZSTD_outBuffer output{ m_Buffer.data() + used, m_Buffer.size() - used, 0 };
+      auto ret( ::ZSTD_compressStream2( m_CCtx, & output, & input, ZSTD_e_flush ) );
+      if( ::ZSTD_isError( ret ) )
+      {
+        DUMP_CRITICAL( "CompressionCodec: ZSTD_compressStream2 failed" );
+        return false;
+      }
+      used += output.pos;
+      if( ret == 0 )
+        break;
+      Grow( used );
+    }
+    m_Buffer.resize( used );
+    return true;
+  }
+
+  bool DecompressZstd ( const view_t & in )
+  {
+    if( m_DCtx == nullptr )
+    {
+      m_DCtx = ::ZSTD_createDCtx();
+      if( m_DCtx == nullptr )
+        return false;
+      if( ( not m_Dictionary.empty() )
+          and
+          ::ZSTD_isError( ::ZSTD_DCtx_loadDictionary( m_DCtx, m_Dictionary.data(), m_Dictionary.size() ) ) )
+        return false;
+    }
+
+    m_Buffer.resize( DecodedSize( in.Size() ) );
+    ZSTD_inBuffer input{ in.Data(), in.Size(), 0 };
+    std::size_t used( 0 );
+    for( ;; )
+    {
+      ZSTD_outBuffer output{ m_Buffer.data() + used, m_Buffer.size() - used, 0 };
+      auto ret( ::ZSTD_decompressStream( m_DCtx, & output, & input ) );
+      if( ::ZSTD_isError( ret ) )
+      {
+        DUMP_CRITICAL( "CompressionCodec: ZSTD_decompressStream failed" );
+        return false;
+      }
+      used += output.pos;
+      // сообщение восстановлено, если вход исчерпан, а выход заполнен не
+      // полностью (данных, ожидающих вывода, нет)
+      if( ( input.pos == input.size ) and ( output.pos < output.size ) )
+        break;
+      if( ( output.pos == output.size ) and ( not GrowDecoded( used ) ) )
+        return false;
+    }
+    if( used > m_MaxMessage )
+      return GrowDecoded( used );
+    m_Buffer.resize( used );
+    return true;
+  }
+#else
+  bool CompressZstd ( const view_t & )
+  {
+    DUMP_CRITICAL( "CompressionCodec: built without zstd (CONFIG+=asio_zstd)" );
+    return false;
+  }
+
+  bool DecompressZstd ( const view_t & in )
+  {
+    return CompressZstd( in );
+  }
+#endif
+};
+
+//------------------------------------------------------------------------------
+
+}// namespace                   asio
+}// namespace                   spo
+
+#endif // COMPRESSIONCODEC_H
@@ -3,6 +3,7 @@
 
 #include "core/documents/DocumentPkg.h"
 #include "asio/SteadyTimer.h"
+#include <algorithm>
 
 namespace                         spo   {
 namespace                         asio  {
@@ -31,6 +32,26 @@ using io_channel_action_t       = spo::simple_fnc_t< bool, spo::core::docs::Byte
 template< typename                ByteT_            = unsigned char >
 using buffer_actions_map        = std::map< short, io_channel_action_t< ByteT_ > >;
 
+//------------------------------------------------------------------------------
+/**
+ * @brief Структура BufferSizing содержит параметры изменения размера буфера
+ *        канала приема по результатам чтения.
+ *
+ * Размер удваивается после @a m_GrowAfter чтений подряд, заполнивших буфер,
+ * и уменьшается вдвое после @a m_ShrinkAfter чтений подряд, занявших не
+ * более четверти буфера, в пределах [ @a m_Min, @a m_Max ].
+ */
+struct                            BufferSizing
+{
+  std::size_t                     m_Min             { 512 };
+  std::size_t                     m_Max             { 0 };  ///< 0 - размер не изменяется
+  unsigned                        m_GrowAfter       { 2 };
+  unsigned                        m_ShrinkAfter     { 16 };
+
+  bool                            IsAdaptive        () const BOOST_NOEXCEPT
+    { return m_Max > 0; }
+};
+
 //------------------------------------------------------------------------------
 /**
  * @brief Шаблонная структура IOChannel определяет канал передачи данных при
@@ -56,6 +77,19 @@ struct                            IOChannel
    */
   action_t                        m_Action;
   std::size_t                     m_BufferSize  { 512 };
+  /**
+   * @brief Атрибут m_Offload указывает выполнять действие @a m_Action сессии
+   *        в пуле вычислений @a AsioComputePool, а не в потоке сервиса.
+   */
+  bool                            m_Offload     { false };
+  /**
+   * @brief Атрибуты m_Sizing, m_FullReads и m_SmallReads содержат параметры
+   *        изменения размера буфера и количество чтений подряд, заполнивших
+   *        буфер или занявших не более его четверти.
+   */
+  BufferSizing                    m_Sizing;
+  unsigned                        m_FullReads   { 0 };
+  unsigned                        m_SmallReads  { 0 };
 
   /**
     * @brief Конструктор IOChannel без параметров запрещен.
@@ -114,6 +148,20 @@ struct                            IOChannel
     return m_Action.operator bool();
   }
 
+  /**
+   * @brief Метод SetOffload назначает выполнение действия канала в пуле
+   *        вычислений @a AsioComputePool (действует, пока пул запущен).
+   */
+  void SetOffload ( bool offload = true ) BOOST_NOEXCEPT
+  {
+    m_Offload = offload;
+  }
+
+  bool IsOffload () const BOOST_NOEXCEPT
+  {
+    return m_Offload;
+  }
+
   /**
    * @brief Метод BufferRef возвращает ссылку на буфер с данными.
    * @return ссылка на буфер данных
@@ -145,10 +193,73 @@ struct                            IOChannel
   void SetBufferSize( std::size_t bSize )
   {
     BEGIN_LOCK_SECTION_( m_Buffer.MutexRef() );
-    m_BufferSize = bSize;
+    m_BufferSize = Bounded( bSize );
     END_LOCK_SECTION_;
   }
 
+  /**
+   * @brief Метод SetSizing назначает параметры изменения размера буфера;
+   *        текущий размер приводится к их пределам.
+   */
+  void SetSizing( const BufferSizing & sizing )
+  {
+    BEGIN_LOCK_SECTION_( m_Buffer.MutexRef() );
+    m_Sizing          = sizing;
+    m_Sizing.m_Min    = std::max< std::size_t >( sizing.m_Min, 1 );
+    if( m_Sizing.IsAdaptive() )
+      m_Sizing.m_Max  = std::max( m_Sizing.m_Max, m_Sizing.m_Min );
+    m_FullReads       = 0;
+    m_SmallReads      = 0;
+    m_BufferSize      = Bounded( m_BufferSize );
+    END_LOCK_SECTION_;
+  }
+
+  const BufferSizing & SizingRef() const
+  {
+    return m_Sizing;
+  }
+
+  /**
+   * @brief Метод Adapt изменяет размер буфера по количеству данных,
+   *        принятых очередным чтением.
+   * @param t количество принятых данных.
+   * @return Признак изменения размера.
+   */
+  bool Adapt( std::size_t t )
+  {
+    bool retval( false );
+    BEGIN_LOCK_SECTION_( m_Buffer.MutexRef() );
+    const std::size_t size( m_BufferSize );
+    const bool adaptive( m_Sizing.IsAdaptive() );
+    if( adaptive and ( t >= size ) )
+    {
+      m_SmallReads = 0;
+      if( ( ++ m_FullReads >= m_Sizing.m_GrowAfter ) and ( size < m_Sizing.m_Max ) )
+      {
+        m_FullReads  = 0;
+        m_BufferSize = std::min( size * 2, m_Sizing.m_Max );
+        retval       = true;
+      }
+    }
+    else if( adaptive and ( t <= size / 4 ) )
+    {
+      m_FullReads = 0;
+      if( ( ++ m_SmallReads >= m_Sizing.m_ShrinkAfter ) and ( size > m_Sizing.m_Min ) )
+      {
+        m_SmallReads = 0;
+        m_BufferSize = std::max( size / 2, m_Sizing.m_Min );
+        retval       = true;
+      }
+    }
+    else
+    {
+      m_FullReads  = 0;
+      m_SmallReads = 0;
+    }
+    END_LOCK_SECTION_;
+    return retval;
+  }
+
   /**
    * @brief Метод Clear очищаетданные в буфере.
    * Размер буфера устанавливается равным нулю.
@@ -159,6 +270,15 @@ struct                            IOChannel
     m_Buffer.ContentRef().clear();
     END_LOCK_SECTION_;
   }
+
+private:
+  std::size_t Bounded ( std::size_t size ) const
+  {
+    return
+        m_Sizing.IsAdaptive()
+        ? std::min( std::max( size, m_Sizing.m_Min ), m_Sizing.m_Max )
+        : size;
+  }
 };
 
 //------------------------------------------------------------------------------
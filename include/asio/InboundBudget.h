@@ -0,0 +1,130 @@
+/**
+  * @file InboundBudget.h
+  * @brief Файл InboundBudget.h содержит объявление класса
+  *        @a spo::asio::InboundBudget учета принятых данных, ожидающих
+  *        обработки, всех сессий процесса.
+  *
+  * Принятые данные учитываются от приема до завершения их обработки
+  * (обработчиком канала приема или отложенной обработкой,
+  * @a AsioSocketSession::HoldInbound ). При превышении верхней границы
+  * сессии не выполняют чтение из сокетов: данные остаются в буферах ядра, и
+  * управление потоком TCP приостанавливает передачу отправителей. Чтение
+  * возобновляется, когда объем данных становится не выше нижней границы.
+  */
+
+#ifndef INBOUNDBUDGET_H
+#define INBOUNDBUDGET_H
+
+#include "asio/AsioCommon.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace                         spo   {
+namespace                         asio  {
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Структура InboundMetrics содержит счетчики ограничения приема.
+ */
+struct                            InboundMetrics
+{
+  std::atomic< std::size_t >      m_Buffered        { 0 }; ///< данные, ожидающие обработки, байт
+  std::atomic< std::size_t >      m_Peak            { 0 }; ///< наибольший объем данных, байт
+  std::atomic< std::uint64_t >    m_GlobalPauses    { 0 }; ///< приостановок по общей границе
+  std::atomic< std::uint64_t >    m_SessionPauses   { 0 }; ///< приостановок по границе сессии
+  std::atomic< std::uint64_t >    m_Resumes         { 0 }; ///< возобновлений чтения сессий
+  std::atomic< std::size_t >      m_Paused          { 0 }; ///< сессий, ожидающих возобновления
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс InboundBudget определяет общую для сессий процесса границу
+ *        объема принятых данных, ожидающих обработки.
+ *
+ * @par Пример использования:
+ * @code language="cpp"
+ *  // чтение приостанавливается при 64 МБ и возобновляется при 32 МБ
+ *  spo::asio::InboundBudget::Instance().SetLimit( 64 << 20, 32 << 20 );
+ * @endcode
+ */
+class SPO_CORE_EXPORT             InboundBudget
+{
+public:
+  /**
+   * @brief Тип resume_t определяет обработчик возобновления чтения.
+   */
+  using resume_t                = spo::simple_fnc_t< void >;
+
+  /**/                            InboundBudget       ( const InboundBudget & ) = delete;
+  /**/                            InboundBudget       ( InboundBudget && ) = delete;
+  InboundBudget &                 operator=           ( const InboundBudget & ) = delete;
+  InboundBudget &                 operator=           ( InboundBudget && ) = delete;
+
+  static
+  spo::asio::InboundBudget &      Instance            ();
+
+  /**
+   * @brief Метод SetLimit назначает границы объема данных.
+   * @param high верхняя граница, байт (0 - без ограничения);
+   * @param low  нижняя граница возобновления чтения, байт (не более
+   *             @a high ).
+   */
+  void                            SetLimit            ( std::size_t high, std::size_t low );
+
+  std::size_t                     High                () const BOOST_NOEXCEPT
+    { return m_High; }
+  std::size_t                     Low                 () const BOOST_NOEXCEPT
+    { return m_Low; }
+  const InboundMetrics          & MetricsRef          () const BOOST_NOEXCEPT
+    { return m_Metrics; }
+
+  /**
+   * @brief Метод IsPaused сообщает, что объем данных достиг верхней границы
+   *        и еще не снизился до нижней.
+   */
+  bool                            IsPaused            () const BOOST_NOEXCEPT
+    { return m_Paused.load(); }
+
+  /**
+   * @brief Метод Acquire учитывает принятые данные.
+   */
+  void                            Acquire             ( std::size_t bytes );
+  /**
+   * @brief Метод Release исключает обработанные данные из учета.
+   */
+  void                            Release             ( std::size_t bytes );
+
+  /**
+   * @brief Метод Wait назначает обработчик, однократно вызываемый при
+   *        снижении объема данных до нижней границы (немедленно, если чтение
+   *        не приостановлено).
+   */
+  void                            Wait                ( const resume_t & resume );
+
+  /**
+   * @brief Методы CountPause и CountResume учитывают приостановку чтения
+   *        сессии и его возобновление.
+   * @param global приостановка по общей границе.
+   */
+  void                            CountPause          ( bool global ) BOOST_NOEXCEPT;
+  void                            CountResume         () BOOST_NOEXCEPT;
+
+private:
+  /**/                            InboundBudget       () = default;
+
+  void                            Update              ();
+
+  std::atomic< std::size_t >      m_High              { 0 };
+  std::atomic< std::size_t >      m_Low               { 0 };
+  std::atomic_bool                m_Paused            { false };
+  InboundMetrics                  m_Metrics;
+  std::mutex                      m_Mutex;
+  std::vector< resume_t >         m_Waiters;
+};
+
+//------------------------------------------------------------------------------
+}// namespace                   asio
+}// namespace                   spo
+
+#endif // INBOUNDBUDGET_H
@@ -0,0 +1,237 @@
+/**
+  * @file ShmRing.h
+  * @brief Файл ShmRing.h содержит объявления кольцевого буфера сообщений в
+  *        разделяемой памяти @a spo::asio::ShmRing (один писатель, один
+  *        читатель) и области разделяемой памяти канала обмена
+  *        @a spo::asio::ShmRegion с двумя кольцами (по одному на направление).
+  *
+  * Область создается в анонимном файле памяти (memfd) сервером разделяемой
+  * памяти и передается клиенту вместе с дескрипторами eventfd пробуждения по
+  * локальному сокету (SCM_RIGHTS). Размер файла запечатывается до передачи
+  * (F_SEAL_SHRINK, F_SEAL_GROW): ни одна из сторон не может уменьшить
+  * область, отображенную другой. Сообщения записываются в кольцо и читаются
+  * из него без системных вызовов; eventfd используется только для пробуждения
+  * читателя, ожидающего данные в цикле сервиса @a spo::asio::AsioService.
+  */
+
+#ifndef SHMRING_H
+#define SHMRING_H
+
+#include "asio/AsioCommon.h"
+#include <atomic>
+#include <cstdint>
+
+namespace                         spo   {
+namespace                         asio  {
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Структура ShmRingHeader содержит заголовок кольца в разделяемой
+ *        памяти. Позиции записи и чтения возрастают монотонно и размещаются в
+ *        разных строках кэша.
+ */
+struct                            ShmRingHeader
+{
+  alignas( 64 ) std::atomic< std::uint64_t > m_Head     { 0 }; ///< позиция записи
+  alignas( 64 ) std::atomic< std::uint64_t > m_Tail     { 0 }; ///< позиция чтения
+  alignas( 64 ) std::atomic< std::uint32_t > m_Waiting  { 0 }; ///< читатель ожидает данные
+  alignas( 64 ) std::atomic< std::uint32_t > m_Writing  { 0 }; ///< писатель ожидает место
+  std::uint64_t                   m_Capacity        { 0 };     ///< размер области данных, байт
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс ShmRing реализует кольцевой буфер сообщений переменной длины
+ *        в разделяемой памяти для одного писателя и одного читателя.
+ *
+ * Сообщение хранится с заголовком длины (4 байта) и выравниванием 8 байт.
+ * Сообщение, не помещающееся до конца области данных, записывается с ее
+ * начала. Максимальный размер сообщения - @a MaxMessage.
+ *
+ * Размер области данных и собственная позиция (записи у писателя, чтения у
+ * читателя) хранятся в объекте, а не в разделяемой памяти: значения другой
+ * стороны (позиция, длина сообщения, признак переноса) проверяются перед
+ * использованием. При недопустимом значении кольцо отключается
+ * ( @a IsCorrupted ), и канал должен быть закрыт.
+ *
+ * Пробуждение читателя: читатель перед ожиданием вызывает @a PrepareWait,
+ * писатель после записи получает от @a TryPush признак необходимости
+ * пробуждения и сигнализирует eventfd только в этом случае. Писатель, не
+ * нашедший места, вызывает @a PrepareWaitSpace, читатель после извлечения
+ * сообщений получает признак его пробуждения от @a ReleaseWriter.
+ */
+class SPO_CORE_EXPORT             ShmRing
+{
+public:
+  /**
+   * @brief Метод RegionSize возвращает размер памяти кольца с областью
+   *        данных @a capacity байт (с учетом заголовка).
+   */
+  static std::size_t RegionSize ( std::size_t capacity );
+
+  /**
+   * @brief Метод Init размещает заголовок кольца в памяти @a memory.
+   * @param memory   память размером не менее @a RegionSize( capacity );
+   * @param capacity размер области данных (кратен 8).
+   */
+  static void Init ( void * memory, std::size_t capacity );
+
+  /**/                            ShmRing           () = default;
+
+  /**
+   * @brief Метод Attach подключает объект к кольцу, размещенному методом
+   *        @a Init (в том числе другим процессом).
+   * @param memory   память кольца;
+   * @param capacity размер области данных, известный подключающейся стороне
+   *                 (размер в заголовке кольца только проверяется).
+   */
+  void Attach ( void * memory, std::size_t capacity );
+
+  bool IsAttached () const { return nullptr != m_Header; }
+
+  /**
+   * @brief Метод IsCorrupted сообщает об отключении кольца из-за
+   *        недопустимого значения в разделяемой памяти.
+   */
+  bool IsCorrupted () const { return m_Corrupted; }
+
+  std::size_t Capacity () const;
+  std::size_t MaxMessage () const;
+
+  /**
+   * @brief Метод TryPush записывает сообщение (писатель).
+   * @param data данные сообщения;
+   * @param size размер данных, байт;
+   * @param wake признак ожидания читателя: писатель должен его пробудить.
+   * @return false, если в кольце нет места или сообщение больше
+   *         @a MaxMessage (сообщение не записано).
+   */
+  bool TryPush ( const void * data, std::size_t size, bool & wake );
+
+  /**
+   * @brief Метод Front возвращает очередное сообщение (читатель) без
+   *        извлечения.
+   * @param size размер сообщения, байт.
+   * @return указатель на данные или nullptr, если кольцо пусто или
+   *         отключено ( @a IsCorrupted ).
+   */
+  const void * Front ( std::size_t & size );
+
+  /**
+   * @brief Метод Pop извлекает сообщение, полученное методом @a Front.
+   */
+  void Pop ();
+
+  /**
+   * @brief Метод ReleaseWriter вызывается читателем после извлечения
+   *        сообщений.
+   * @return true, если писатель ожидает место и его необходимо пробудить.
+   */
+  bool ReleaseWriter ();
+
+  bool IsEmpty () const;
+
+  /**
+   * @brief Метод PrepareWait сообщает писателю об ожидании читателя.
+   * @return true, если кольцо пусто и читатель может ожидать пробуждения;
+   *         false, если данные уже есть (признак ожидания снят).
+   */
+  bool PrepareWait ();
+
+  /**
+   * @brief Метод PrepareWaitSpace сообщает читателю об ожидании писателем
+   *        места для сообщения размером @a size байт.
+   * @return true, если места нет и писатель может ожидать пробуждения;
+   *         false, если место уже освободилось (признак ожидания снят).
+   */
+  bool PrepareWaitSpace ( std::size_t size );
+
+private:
+  ShmRingHeader                 * m_Header          = nullptr;
+  unsigned char                 * m_Data            = nullptr;
+  std::uint64_t                   m_Capacity        { 0 };
+  std::uint64_t                   m_Head            { 0 };  ///< позиция записи (писатель)
+  std::uint64_t                   m_Tail            { 0 };  ///< позиция чтения (читатель)
+  /**
+   * @brief Атрибут m_FrontSize содержит размер записи, полученной методом
+   *        @a Front (с заголовком и выравниванием).
+   */
+  std::uint64_t                   m_FrontSize       { 0 };
+  bool                            m_Corrupted       { false };
+
+  /**
+   * @brief Метод Corrupt отключает кольцо при недопустимом значении в
+   *        разделяемой памяти.
+   */
+  void Corrupt ();
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс ShmRegion содержит область разделяемой памяти канала обмена
+ *        (два кольца) и дескрипторы eventfd пробуждения читателей колец.
+ *
+ * Создатель области (сервер) пишет в кольцо 0 и читает кольцо 1, подключившаяся
+ * сторона (клиент) - наоборот.
+ */
+class SPO_CORE_EXPORT             ShmRegion
+{
+public:
+  /**/                            ShmRegion         () = default;
+  ~ ShmRegion ();
+
+  ShmRegion ( const ShmRegion & ) = delete;
+  ShmRegion & operator = ( const ShmRegion & ) = delete;
+
+  /**
+   * @brief Метод Create создает область с кольцами @a capacity байт.
+   */
+  bool Create ( std::size_t capacity, error_t & ec );
+
+  /**
+   * @brief Метод Send передает дескрипторы области другой стороне по
+   *        подключенному локальному сокету @a socketHandle.
+   */
+  bool Send ( int socketHandle, error_t & ec ) const;
+
+  /**
+   * @brief Метод Receive получает дескрипторы области от создателя по
+   *        подключенному локальному сокету @a socketHandle и подключается к
+   *        кольцам.
+   * @param timeoutMs время ожидания дескрипторов, мс.
+   */
+  bool Receive ( int socketHandle, int timeoutMs, error_t & ec );
+
+  bool IsValid () const { return nullptr != m_Memory; }
+
+  ShmRing                       & TxRef             () { return std::ref( m_Rings[ m_Creator ? 0 : 1 ] ); }
+  ShmRing                       & RxRef             () { return std::ref( m_Rings[ m_Creator ? 1 : 0 ] ); }
+  int                             TxEventHandle     () const { return m_Events[ m_Creator ? 0 : 1 ]; }
+  int                             RxEventHandle     () const { return m_Events[ m_Creator ? 1 : 0 ]; }
+
+  /**
+   * @brief Метод Wake пробуждает другую сторону: читателя кольца передачи
+   *        или писателя кольца приема, ожидающего место.
+   */
+  void Wake () const;
+
+  void Close ();
+
+private:
+  bool Map ( std::size_t size, error_t & ec );
+
+  int                             m_MemoryHandle    { -1 };
+  int                             m_Events[ 2 ]     { -1, -1 };
+  void                          * m_Memory          = nullptr;
+  std::size_t                     m_Size            { 0 };
+  bool                            m_Creator         { false };
+  ShmRing                         m_Rings[ 2 ];
+};
+
+using shm_region_ptr_t          = std::unique_ptr< ShmRegion >;
+
+//------------------------------------------------------------------------------
+}// namespace                   asio
+}// namespace                   spo
+
+#endif // SHMRING_H
@@ -0,0 +1,212 @@
+/**
+  * @file SocketProfile.h
+  * @brief Файл SocketProfile.h содержит объявление структуры
+  *        @a spo::asio::SocketProfile набора опций сокетов сервера или
+  *        клиента (размеры буферов ядра, параметры TCP, keepalive, busy poll).
+  *
+  * Большую часть опций TCP ядро Linux переносит с прослушивающего сокета на
+  * принятые им сокеты, поэтому для сервера профиль назначается один раз
+  * прослушивающему сокету ( @a ApplyListener ), а принятым сокетам назначаются
+  * только опции, которые не наследуются ( @a ApplyConnected ). Сокетам клиента
+  * и UDP-сервера профиль назначается до подключения или привязки
+  * ( @a ApplySocket ).
+  *
+  * Опции, отсутствующие в заголовках системы, пропускаются.
+  */
+
+#ifndef SOCKETPROFILE_H
+#define SOCKETPROFILE_H
+
+#include "asio/AsioCommon.h"
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+namespace                         spo   {
+namespace                         asio  {
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс IntSocketOption определяет целочисленную опцию сокета с
+ *        произвольными уровнем и именем для методов @a set_option сокетов и
+ *        акцепторов Boost.Asio.
+ */
+class                             IntSocketOption
+{
+public:
+  /**/                            IntSocketOption     ( int level, int name, int value )
+    : m_Level ( level )
+    , m_Name  ( name  )
+    , m_Value ( value )
+  {}
+
+  template< typename P_ > int           level ( const P_ & ) const { return m_Level; }
+  template< typename P_ > int           name  ( const P_ & ) const { return m_Name; }
+  template< typename P_ > const int   * data  ( const P_ & ) const { return & m_Value; }
+  template< typename P_ > std::size_t   size  ( const P_ & ) const { return sizeof( m_Value ); }
+
+private:
+  int                             m_Level;
+  int                             m_Name;
+  int                             m_Value;
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Структура SocketProfile определяет набор опций сокетов.
+ *
+ * Значение @a SocketProfile::NOT_SET оставляет опцию без изменений (значение
+ * ядра по умолчанию). Опции протокола TCP для UDP-сокетов не назначаются.
+ *
+ * Например:
+ * @code
+ *   spo::asio::SocketProfile profile;
+ *   profile.m_ReceiveBuffer   = 4 << 20;
+ *   profile.m_DeferAcceptSec  = 5;
+ *   profile.m_NotSentLowat    = 16384;
+ *   profile.m_KeepAlive       = 1;
+ *   profile.m_KeepIdleSec     = 30;
+ *   server.SetSocketProfile( profile );
+ * @endcode
+ */
+struct                            SocketProfile
+{
+  static const int                NOT_SET           = -1;
+
+  int                             m_ReceiveBuffer   { NOT_SET }; ///< SO_RCVBUF, байт (наследуется)
+  int                             m_SendBuffer      { NOT_SET }; ///< SO_SNDBUF, байт (наследуется)
+  int                             m_NoDelay         { 1 };       ///< TCP_NODELAY (наследуется)
+  int                             m_QuickAck        { NOT_SET }; ///< TCP_QUICKACK (не наследуется)
+  int                             m_DeferAcceptSec  { NOT_SET }; ///< TCP_DEFER_ACCEPT, с (только прослушивающий сокет)
+  int                             m_NotSentLowat    { NOT_SET }; ///< TCP_NOTSENT_LOWAT, байт (наследуется)
+  int                             m_BusyPollUs      { NOT_SET }; ///< SO_BUSY_POLL, мкс (наследуется)
+  int                             m_IncomingCpu     { NOT_SET }; ///< SO_INCOMING_CPU, номер процессора
+  int                             m_UserTimeoutMs   { NOT_SET }; ///< TCP_USER_TIMEOUT, мс (наследуется)
+  int                             m_KeepAlive       { NOT_SET }; ///< SO_KEEPALIVE (наследуется)
+  int                             m_KeepIdleSec     { NOT_SET }; ///< TCP_KEEPIDLE, с (наследуется)
+  int                             m_KeepIntervalSec { NOT_SET }; ///< TCP_KEEPINTVL, с (наследуется)
+  int                             m_KeepCount       { NOT_SET }; ///< TCP_KEEPCNT (наследуется)
+
+  /**
+   * @brief Метод ApplyListener назначает опции прослушивающему TCP-сокету:
+   *        наследуемые принятыми сокетами и опции только прослушивающего
+   *        сокета. Вызывается до привязки сокета (размер окна приема
+   *        определяется при установлении соединения).
+   * @param acceptor акцептор Boost.Asio;
+   * @param ec       код первой ошибки назначения.
+   * @return Булево значение:
+   * @value true  все опции назначены;
+   * @value false назначение одной или нескольких опций завершилось ошибкой.
+   */
+  template< typename              AcceptorT_ >
+  bool ApplyListener ( AcceptorT_ & acceptor, error_t & ec ) const
+  {
+    ec = error_t();
+    ApplyCommon( acceptor, ec );
+    ApplyTcp( acceptor, ec );
+#if defined( TCP_DEFER_ACCEPT )
+    Set( acceptor, IPPROTO_TCP, TCP_DEFER_ACCEPT, m_DeferAcceptSec, ec );
+#endif
+    return IsNoErr( ec );
+  }
+
+  /**
+   * @brief Метод ApplySocket назначает все опции профиля, кроме опций
+   *        прослушивающего сокета, открытому сокету клиента или UDP-сервера.
+   * @param socket сокет Boost.Asio протокола @a ProtocolT_;
+   * @param ec     код первой ошибки назначения.
+   * @return Признак назначения всех опций.
+   */
+  template< typename              ProtocolT_ >
+  bool ApplySocket ( typename ProtocolT_::socket & socket, error_t & ec ) const
+  {
+    ec = error_t();
+    ApplyCommon( socket, ec );
+    if( std::is_same< ProtocolT_, tcp_t >::value )
+    {
+      ApplyTcp( socket, ec );
+      ApplyConnected< ProtocolT_ >( socket, ec );
+    }
+    return IsNoErr( ec );
+  }
+
+  /**
+   * @brief Метод ApplyConnected назначает подключенному сокету опции, которые
+   *        не наследуются от прослушивающего сокета.
+   * @param socket сокет Boost.Asio протокола @a ProtocolT_;
+   * @param ec     код первой ошибки назначения (не сбрасывается).
+   * @return Признак отсутствия ошибки в @a ec.
+   */
+  template< typename              ProtocolT_ >
+  bool ApplyConnected ( typename ProtocolT_::socket & socket, error_t & ec ) const
+  {
+#if defined( TCP_QUICKACK )
+    if( std::is_same< ProtocolT_, tcp_t >::value )
+      Set( socket, IPPROTO_TCP, TCP_QUICKACK, m_QuickAck, ec );
+#else
+    UNUSED( socket );
+#endif
+    return IsNoErr( ec );
+  }
+
+private:
+  /**
+   * @brief Метод Set назначает опцию, если ее значение задано. Ошибка
+   *        сохраняется в @a ec, только если ошибок до этого не было.
+   */
+  template< typename              SocketT_ >
+  static void Set ( SocketT_ & socket, int level, int name, int value, error_t & ec )
+  {
+    if( value == NOT_SET )
+      return;
+
+    error_t opt_ec;
+    socket.set_option( IntSocketOption( level, name, value ), opt_ec );
+    if( IsNoErr( ec ) and ( not IsNoErr( opt_ec ) ) )
+      ec = opt_ec;
+  }
+
+  template< typename              SocketT_ >
+  void ApplyCommon ( SocketT_ & socket, error_t & ec ) const
+  {
+    Set( socket, SOL_SOCKET, SO_RCVBUF, m_ReceiveBuffer, ec );
+    Set( socket, SOL_SOCKET, SO_SNDBUF, m_SendBuffer, ec );
+#if defined( SO_BUSY_POLL )
+    Set( socket, SOL_SOCKET, SO_BUSY_POLL, m_BusyPollUs, ec );
+#endif
+#if defined( SO_INCOMING_CPU )
+    Set( socket, SOL_SOCKET, SO_INCOMING_CPU, m_IncomingCpu, ec );
+#endif
+  }
+
+  template< typename              SocketT_ >
+  void ApplyTcp ( SocketT_ & socket, error_t & ec ) const
+  {
+    Set( socket, IPPROTO_TCP, TCP_NODELAY, m_NoDelay, ec );
+#if defined( TCP_NOTSENT_LOWAT )
+    Set( socket, IPPROTO_TCP, TCP_NOTSENT_LOWAT, m_NotSentLowat, ec );
+#endif
+#if defined( TCP_USER_TIMEOUT )
+    Set( socket, IPPROTO_TCP, TCP_USER_TIMEOUT, m_UserTimeoutMs, ec );
+#endif
+    Set( socket, SOL_SOCKET, SO_KEEPALIVE, m_KeepAlive, ec );
+#if defined( TCP_KEEPIDLE )
+    Set( socket, IPPROTO_TCP, TCP_KEEPIDLE, m_KeepIdleSec, ec );
+    Set( socket, IPPROTO_TCP, TCP_KEEPINTVL, m_KeepIntervalSec, ec );
+    Set( socket, IPPROTO_TCP, TCP_KEEPCNT, m_KeepCount, ec );
+#endif
+  }
+};
+
+/**
+ * @brief Тип socket_profile_ptr_t общего указателя на неизменяемый профиль
+ *        опций сокетов (разделяется сервером и его сессиями).
+ */
+using socket_profile_ptr_t      = std::shared_ptr< const SocketProfile >;
+
+//------------------------------------------------------------------------------
+
+}// namespace                     asio
+}// namespace                     spo
+
+#endif // SOCKETPROFILE_H
@@ -365,14 +365,11 @@ public:
       {
         std::istream is( & buff );
         decltype( doc_class_t::mContent ) content( buff.size() );
-// 1-й вариант:
-//        std::skipws( is );
-//        content.assign(
-//              std::istreambuf_iterator< ByteT_ >( is ),
-//              std::istreambuf_iterator< ByteT_ >() );
-//
-// 2-й вариант:
-        is >> std::skipws >> content.data();
+        // побайтовое чтение: форматный ввод (operator>>) останавливается на
+        // пробельных символах и дописывает завершающий ноль за пределы буфера
+        is.read( reinterpret_cast< char * >( content.data() ),
+                 static_cast< std::streamsize >( content.size() ) );
+        content.resize( static_cast< std::size_t >( is.gcount() ) );
 
         Add( content);
 //        retval = FromByteArray( doc_class_t::mContent.data() );
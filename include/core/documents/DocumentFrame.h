@@ -0,0 +1,534 @@
+/**
+  * @file DocumentFrame.h
+  * @brief Файл DocumentFrame.h содержит шаблон класса
+  *        @a spo::core::docs::DocumentFrame пакета с префиксом длины - замены
+  *        пакета с байт-стаффингом @a spo::core::docs::DocumentPkg.
+  *
+  * Формат кадра:
+  * @code
+  *   [длина данных][данные][CRC-32 данных (необязательно)]
+  * @endcode
+  * Длина данных кодируется переменным числом байт (varint LEB128, 1-5 байт)
+  * или фиксированными 4 байтами в сетевом порядке. CRC-32 передается 4
+  * байтами в сетевом порядке. Данные передаются без экранирования, поэтому
+  * формирование кадра не изменяет данные, а выделение кадра из принятых
+  * данных не требует поиска маркеров: размер кадра определяется по его
+  * заголовку.
+  *
+  * Формат кадра (кодирование длины, наличие CRC) не передается и должен
+  * совпадать у отправителя и получателя.
+  */
+
+#ifndef DOCUMENTFRAME_H
+#define DOCUMENTFRAME_H
+
+#include "core/documents/BytesDocument.h"
+#include "core/documents/FrameHeader.h"
+#include <array>
+#include <string>
+
+namespace                       spo   {
+namespace                       core  {
+namespace                       docs  {
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Функция Crc32 вычисляет CRC-32 (IEEE 802.3, как zlib и
+ *        boost::crc_32_type) по 8 байт за шаг (slicing-by-8): побайтовый
+ *        табличный алгоритм ограничивает скорость приема кадров с CRC.
+ * @param data данные;
+ * @param size размер данных.
+ * @return значение CRC-32.
+ */
+inline std::uint32_t Crc32 ( const void * data, std::size_t size )
+{
+  using table_t = std::array< std::array< std::uint32_t, 256 >, 8 >;
+  static const table_t tables(
+        []()
+        {
+          table_t retval;
+          for( std::uint32_t idx( 0 ); idx < 256; ++idx )
+          {
+            std::uint32_t crc( idx );
+            for( int bit( 0 ); bit < 8; ++bit )
+              crc = ( crc >> 1 ) ^ ( ( crc & 1 ) ? 0xEDB88320u : 0 );
+            retval[ 0 ][ idx ] = crc;
+          }
+          for( std::uint32_t idx( 0 ); idx < 256; ++idx )
+            for( std::size_t t( 1 ); t < 8; ++t )
+              retval[ t ][ idx ] =
+                  ( retval[ t - 1 ][ idx ] >> 8 ) ^ retval[ 0 ][ retval[ t - 1 ][ idx ] & 0xFF ];
+          return retval;
+        }() );
+
+  auto ptr( static_cast< const unsigned char * >( data ) );
+  std::uint32_t crc( 0xFFFFFFFFu );
+  for( ; size >= 8; size -= 8, ptr += 8 )
+  {
+    std::uint32_t lo( crc ^ ( std::uint32_t( ptr[ 0 ] )         | std::uint32_t( ptr[ 1 ] ) << 8
+                            | std::uint32_t( ptr[ 2 ] ) << 16   | std::uint32_t( ptr[ 3 ] ) << 24 ) );
+    std::uint32_t hi(         std::uint32_t( ptr[ 4 ] )         | std::uint32_t( ptr[ 5 ] ) << 8
+                            | std::uint32_t( ptr[ 6 ] ) << 16   | std::uint32_t( ptr[ 7 ] ) << 24 );
+    crc = tables[ 7 ][ lo & 0xFF ]          ^ tables[ 6 ][ ( lo >> 8 ) & 0xFF ]
+        ^ tables[ 5 ][ ( lo >> 16 ) & 0xFF ] ^ tables[ 4 ][ lo >> 24 ]
+        ^ tables[ 3 ][ hi & 0xFF ]          ^ tables[ 2 ][ ( hi >> 8 ) & 0xFF ]
+        ^ tables[ 1 ][ ( hi >> 16 ) & 0xFF ] ^ tables[ 0 ][ hi >> 24 ];
+  }
+  for( ; size > 0; --size, ++ptr )
+    crc = ( crc >> 8 ) ^ tables[ 0 ][ ( crc ^ *ptr ) & 0xFF ];
+  return crc ^ 0xFFFFFFFFu;
+}
+
+/**
+ * @brief Класс-перечисление FrameLength определяет кодирование длины данных
+ *        кадра.
+ */
+enum class                      FrameLength
+{
+  Varint        = 0 , ///< переменное число байт (LEB128), 1-5 байт
+  Fixed32           , ///< 4 байта в сетевом порядке
+};
+
+/**
+ * @brief Шаблон DocumentFrame определяет пакет с префиксом длины.
+ * @typedef ByteT_ тип представления байта.
+ *
+ * Содержимое документа - данные кадра. @a ToByteArray формирует кадр,
+ * @a FromByteArray извлекает данные из одного кадра. При приеме документ
+ * накапливает принятые данные ( @a Add ), а @a GetPackage извлекает из их
+ * начала очередной полный кадр.
+ *
+ * Поток кадров с нарушенной длиной или CRC не может быть синхронизирован
+ * повторно (маркеров нет), поэтому при такой ошибке накопленные данные
+ * удаляются и документ помечается признаком @a IsCorrupted.
+ *
+ * Например:
+ * @code
+ *   spo::core::docs::DocumentFrame< char > frame( FrameLength::Varint, true );
+ *   frame.Add( received.ContentRef(), received.Size() );
+ *   for( auto & pkg : frame.GetPackages() )
+ *     Process( pkg.ContentRef() );
+ * @endcode
+ */
+template
+<
+    typename ByteT_,
+    typename                    = typename std::enable_if
+                                  <
+                                    std::is_same< ByteT_, unsigned char >::value
+                                    or
+                                    std::is_same< ByteT_, char >::value
+                                    or
+                                    std::is_same< ByteT_, signed char >::value
+                                  >::type
+>
+class SPO_CORE_EXPORT           DocumentFrame :
+public                          spo::core::docs::BytesDocument< ByteT_ >
+{
+public:
+  using base_class_t          = spo::core::docs::BytesDocument< ByteT_ >;
+
+  static const std::size_t      FIXED_HEADER_SIZE   = 4;
+  static const std::size_t      VARINT_HEADER_MAX   = 5;
+  static const std::size_t      CRC_SIZE            = 4;
+  static const std::size_t      FRAME_SIZE_DEFAULT  = 64 * 1024 * 1024;
+
+  /**
+   * @brief Конструктор DocumentFrame
+   * @param length   кодирование длины данных;
+   * @param checksum признак передачи CRC-32 данных.
+   */
+  explicit
+  DocumentFrame ( FrameLength length = FrameLength::Varint, bool checksum = false )
+    : DocumentFrame::base_class_t()
+    , m_Length  ( length )
+    , m_Checksum( checksum )
+  {
+    base_class_t::GetIDRef() = spo::core::docs::DOC_DOCFRAME_ID;
+  }
+
+  DocumentFrame ( const DocumentFrame & frame )
+    : DocumentFrame::DocumentFrame()
+  {
+    *this = frame;
+  }
+
+  DocumentFrame ( DocumentFrame && frame )
+    : DocumentFrame::DocumentFrame()
+  {
+    *this = std::move( frame );
+  }
+
+  virtual DocumentFrame & operator()()
+  {
+    return std::ref( * this );
+  }
+
+  virtual DocumentFrame & operator= ( const DocumentFrame & frame )
+  {
+    DocumentFrame::base_class_t::operator =( frame );
+    CopyFormat( frame );
+    m_Corrupted = frame.m_Corrupted;
+    return std::ref( *this );
+  }
+
+  virtual DocumentFrame & operator= ( DocumentFrame && frame )
+  {
+    DocumentFrame::base_class_t::operator =( std::move( frame ) );
+    CopyFormat( frame );
+    m_Corrupted = frame.m_Corrupted;
+    return std::ref( *this );
+  }
+
+  /**
+   * @brief Методы LengthFormat, SetLengthFormat, HasChecksum, SetChecksum
+   *        возвращают и задают формат кадра.
+   */
+  FrameLength LengthFormat () const { return m_Length; }
+  void SetLengthFormat ( FrameLength length ) { m_Length = length; }
+  bool HasChecksum () const { return m_Checksum; }
+  void SetChecksum ( bool checksum ) { m_Checksum = checksum; }
+
+  /**
+   * @brief Методы MaxFrameSize, SetMaxFrameSize возвращают и задают
+   *        максимальный размер данных кадра: кадр с большей длиной считается
+   *        ошибкой потока (защита от выделения памяти по искаженной длине).
+   */
+  std::size_t MaxFrameSize () const { return m_MaxFrameSize; }
+  void SetMaxFrameSize ( std::size_t size ) { m_MaxFrameSize = size; }
+
+  /**
+   * @brief Метод IsCorrupted сообщает об ошибке длины или CRC в принятых
+   *        данных. Признак сбрасывается методом @a ClearContent.
+   */
+  bool IsCorrupted () const { return m_Corrupted; }
+
+  void ClearContent () override
+  {
+    BEGIN_LOCK_SECTION_SELF_;
+    base_class_t::ClearContent();
+    m_Corrupted = false;
+    END_LOCK_SECTION_
+  }
+
+  /**
+   * @brief Метод HeaderSize возвращает размер заголовка кадра с данными
+   *        размера @a size.
+   */
+  std::size_t HeaderSize ( std::size_t size ) const
+  {
+    std::size_t retval( 1 );
+    if( m_Length == FrameLength::Fixed32 )
+      retval = FIXED_HEADER_SIZE;
+    else
+      for( ; size >= 0x80; size >>= 7 )
+        ++ retval;
+    return retval;
+  }
+
+  /**
+   * @brief Класс-перечисление FrameState определяет состояние кадра в
+   *        разбираемых данных.
+   */
+  enum class                    FrameState
+  {
+    Incomplete    , ///< данных недостаточно для кадра
+    Complete      , ///< кадр получен полностью
+    Corrupted     , ///< длина кадра искажена или превышает @a MaxFrameSize
+  };
+
+  /**
+   * @brief Метод FrameSize возвращает размер кадра (заголовок, данные, CRC)
+   *        с данными размера @a size.
+   */
+  std::size_t FrameSize ( std::size_t size ) const
+  {
+    return HeaderSize( size ) + size + ( m_Checksum ? CRC_SIZE : 0 );
+  }
+
+  /**
+   * @brief Метод ParseFrame разбирает заголовок кадра в произвольной области
+   *        памяти (без копирования в документ).
+   * @param data      начало кадра;
+   * @param available размер доступных данных;
+   * @param header    размер заголовка;
+   * @param size      размер данных кадра.
+   * @return состояние кадра.
+   */
+  FrameState ParseFrame ( const ByteT_ * data, std::size_t available,
+                          std::size_t & header, std::size_t & size ) const
+  {
+    size = 0;
+    if( m_Length == FrameLength::Fixed32 )
+    {
+      if( available < FIXED_HEADER_SIZE )
+        return FrameState::Incomplete;
+      header  = FIXED_HEADER_SIZE;
+      size    = ReadFixed32( data );
+    }
+    else
+    {
+      header = 0;
+      for( ;; )
+      {
+        if( header >= VARINT_HEADER_MAX )
+          return FrameState::Corrupted;
+        if( header >= available )
+          return FrameState::Incomplete;
+        auto b( static_cast< unsigned char >( data[ header ] ) );
+        size |= std::size_t( b & 0x7F ) << ( 7 * header );
+        ++ header;
+        if( ( b & 0x80 ) == 0 )
+          break;
+      }
+    }
+
+    if( size > m_MaxFrameSize )
+      return FrameState::Corrupted;
+
+    return
+        available >= header + size + ( m_Checksum ? CRC_SIZE : 0 )
+        ? FrameState::Complete
+        : FrameState::Incomplete;
+  }
+
+  /**
+   * @brief Метод IsChecksumValid проверяет CRC-32, следующий за данными кадра
+   *        (всегда true для кадров без CRC).
+   */
+  bool IsChecksumValid ( const ByteT_ * payload, std::size_t size ) const
+  {
+    return
+        ( not m_Checksum )
+        or
+        ( Crc32( payload, size ) == ReadFixed32( payload + size ) );
+  }
+
+  /**
+   * @brief Метод WriteHeader записывает заголовок кадра с данными размера
+   *        @a size.
+   * @param out область не менее @a HeaderSize( size ) байт.
+   * @return размер заголовка.
+   */
+  std::size_t WriteHeader ( ByteT_ * out, std::size_t size ) const
+  {
+    std::size_t retval( 0 );
+    if( m_Length == FrameLength::Fixed32 )
+    {
+      WriteFixed32( out, static_cast< std::uint32_t >( size ) );
+      retval = FIXED_HEADER_SIZE;
+    }
+    else
+    {
+      for( ; size >= 0x80; size >>= 7 )
+        out[ retval ++ ] = static_cast< ByteT_ >( ( size & 0x7F ) | 0x80 );
+      out[ retval ++ ] = static_cast< ByteT_ >( size );
+    }
+    return retval;
+  }
+
+  /**
+   * @brief Метод WriteChecksum записывает CRC-32 данных кадра (4 байта), если
+   *        формат кадра предусматривает CRC.
+   * @return размер записанного CRC (0 или 4).
+   */
+  std::size_t WriteChecksum ( ByteT_ * out, const ByteT_ * payload, std::size_t size ) const
+  {
+    if( not m_Checksum )
+      return 0;
+    WriteFixed32( out, Crc32( payload, size ) );
+    return CRC_SIZE;
+  }
+
+  /**
+   * @brief Метод HasFrame проверяет наличие полного кадра в начале
+   *        накопленных данных.
+   * @param startIndex смещение начала кадра.
+   * @return пара значений: признак наличия полного кадра и его размер
+   *         (заголовок, данные и CRC).
+   */
+  std::pair< bool, std::size_t > HasFrame ( std::size_t startIndex = 0 ) const
+  {
+    BEGIN_LOCK_SECTION_SELF_;
+    std::size_t header( 0 ), size( 0 );
+    auto state( ParseHeader( startIndex, header, size ) );
+    return
+        state == FrameState::Complete
+        ? std::make_pair( true, header + size + ( m_Checksum ? CRC_SIZE : 0 ) )
+        : std::make_pair( false, std::string::npos );
+    END_LOCK_SECTION_
+  }
+
+  /**
+   * @brief Метод GetPackage извлекает первый полный кадр из накопленных
+   *        данных. Размер кадра определяется по заголовку, данные копируются
+   *        однократно.
+   * @return пара значений: признак извлечения кадра и документ с данными
+   *         кадра (без заголовка и CRC).
+   */
+  std::pair< bool, DocumentFrame< ByteT_ > > GetPackage ()
+  {
+    BEGIN_LOCK_SECTION_SELF_;
+    std::pair< bool, DocumentFrame< ByteT_ > > retval{ false, Derived() };
+    auto used( Extract( 0, retval.second ) );
+    retval.first = used > 0;
+    Consume( used );
+    return retval;
+    END_LOCK_SECTION_;
+  }
+
+  /**
+   * @brief Метод GetPackages извлекает все полные кадры из накопленных данных.
+   *        Обработанные данные удаляются однократно (время извлечения не
+   *        зависит квадратично от числа кадров).
+   * @return список документов с данными кадров.
+   */
+  std::vector< DocumentFrame< ByteT_ > > GetPackages ()
+  {
+    BEGIN_LOCK_SECTION_SELF_;
+    std::vector< DocumentFrame< ByteT_ > > retval;
+    std::size_t offset( 0 );
+    for( ;; )
+    {
+      auto frame( Derived() );
+      auto used( Extract( offset, frame ) );
+      if( used == 0 )
+        break;
+      offset += used;
+      retval.push_back( std::move( frame ) );
+    }
+    Consume( offset );
+    return retval;
+    END_LOCK_SECTION_;
+  }
+
+  /**
+   * @brief Метод FromByteArray извлекает данные из одного полного кадра.
+   * @param array кадр.
+   * @return Признак успешного извлечения (кадр полный, CRC совпадает).
+   */
+  bool FromByteArray ( const std::string & array ) override
+  {
+    BEGIN_LOCK_SECTION_SELF_;
+    DocumentFrame< ByteT_ > frame( Derived() );
+    frame.mContent.assign( array.cbegin(), array.cend() );
+    ClearContent();
+    auto package( frame.GetPackage() );
+    if( package.first )
+      base_class_t::mContent.swap( package.second.mContent );
+    return package.first and ( not base_class_t::IsEmpty() );
+    END_LOCK_SECTION_
+  }
+
+  /**
+   * @brief Метод ToByteArray формирует кадр из данных документа. Заголовок,
+   *        данные и CRC записываются в строку с заранее выделенной памятью
+   *        (данные копируются однократно).
+   * @return кадр.
+   */
+  std::string ToByteArray () const override
+  {
+    BEGIN_LOCK_SECTION_SELF_;
+    auto & content( base_class_t::mContent );
+    std::string retval;
+    retval.reserve( FrameSize( content.size() ) );
+
+    ByteT_ header[ VARINT_HEADER_MAX ];
+    retval.append( reinterpret_cast< const char * >( header ),
+                   WriteHeader( header, content.size() ) );
+    retval.append( reinterpret_cast< const char * >( content.data() ), content.size() );
+    ByteT_ crc[ CRC_SIZE ];
+    retval.append( reinterpret_cast< const char * >( crc ),
+                   WriteChecksum( crc, content.data(), content.size() ) );
+    return retval;
+    END_LOCK_SECTION_
+  }
+
+private:
+  FrameLength                   m_Length        { FrameLength::Varint };
+  bool                          m_Checksum      { false };
+  std::size_t                   m_MaxFrameSize  { FRAME_SIZE_DEFAULT };
+  bool                          m_Corrupted     { false };
+
+  void CopyFormat ( const DocumentFrame & frame )
+  {
+    m_Length        = frame.m_Length;
+    m_Checksum      = frame.m_Checksum;
+    m_MaxFrameSize  = frame.m_MaxFrameSize;
+  }
+
+  /**
+   * @brief Метод Derived возвращает пустой документ того же формата кадра.
+   */
+  DocumentFrame< ByteT_ > Derived () const
+  {
+    DocumentFrame< ByteT_ > retval( m_Length, m_Checksum );
+    retval.m_MaxFrameSize = m_MaxFrameSize;
+    return retval;
+  }
+
+  /**
+   * @brief Метод Consume удаляет из начала накопленных данных извлеченные
+   *        кадры, а при ошибке потока - все накопленные данные.
+   */
+  void Consume ( std::size_t used )
+  {
+    auto & content( base_class_t::mContent );
+    if( m_Corrupted )
+      content.clear();
+    else if( used > 0 )
+      content.erase( content.begin(), content.begin() + static_cast< std::ptrdiff_t >( used ) );
+  }
+
+  /**
+   * @brief Метод ParseHeader разбирает заголовок кадра.
+   * @param startIndex смещение начала кадра;
+   * @param header     размер заголовка;
+   * @param size       размер данных кадра.
+   * @return состояние кадра: полный, неполный или ошибочный.
+   */
+  FrameState ParseHeader ( std::size_t startIndex, std::size_t & header, std::size_t & size ) const
+  {
+    auto & content( base_class_t::mContent );
+    return
+        startIndex < content.size()
+        ? ParseFrame( content.data() + startIndex, content.size() - startIndex, header, size )
+        : FrameState::Incomplete;
+  }
+
+  /**
+   * @brief Метод Extract копирует данные кадра, начинающегося со смещения
+   *        @a startIndex, в документ @a frame.
+   * @return размер извлеченного кадра или 0, если полного кадра нет.
+   */
+  std::size_t Extract ( std::size_t startIndex, DocumentFrame< ByteT_ > & frame )
+  {
+    std::size_t header( 0 ), size( 0 );
+    auto state( ParseHeader( startIndex, header, size ) );
+    if( state == FrameState::Corrupted )
+      m_Corrupted = true;
+    if( state != FrameState::Complete )
+      return 0;
+
+    // пустые данные последнего кадра без CRC заканчиваются в конце буфера:
+    // указатель вычисляется без разыменования итератора
+    auto first( base_class_t::mContent.cbegin() + startIndex + header );
+    if( not IsChecksumValid( base_class_t::mContent.data() + startIndex + header, size ) )
+    {
+      DUMP_CRITICAL( "DocumentFrame: CRC mismatch" );
+      m_Corrupted = true;
+      return 0;
+    }
+
+    frame.mContent.assign( first, first + size );
+    return header + size + ( m_Checksum ? CRC_SIZE : 0 );
+  }
+};
+
+//------------------------------------------------------------------------------
+
+}// namespace                   docs
+}// namespace                   core
+}// namespace                   spo
+
+#endif // DOCUMENTFRAME_H
@@ -21,6 +21,7 @@ const int DOC_GROUP_ID          = DOC_USERS_ID + 1;
 const int DOC_GROUPS_ID         = DOC_GROUP_ID + 1;
 
 const int DOC_DOCPKG_ID          = 30;
+const int DOC_DOCFRAME_ID        = DOC_DOCPKG_ID + 1;
 
 const int DOC_BYTEARRAY_ID      = 40;
 const int DOC_BYTESTUFFING_ID   = 50;
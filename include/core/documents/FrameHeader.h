@@ -0,0 +1,111 @@
+/**
+  * @file FrameHeader.h
+  * @brief Файл FrameHeader.h содержит функции записи и чтения полей
+  *        заголовков кадров в сетевом порядке байт.
+  *
+  * Заголовки кадров ( @a spo::core::docs::DocumentFrame,
+  * @a spo::asio::ChannelFrame, @a spo::asio::RpcFrame,
+  * @a spo::asio::MuxFrame ) состоят из однобайтовых полей (тип, признаки,
+  * номер канала) и 4-байтовых полей (длина, номер запроса или потока),
+  * записываемых от старшего байта к младшему.
+  */
+
+#ifndef FRAMEHEADER_H
+#define FRAMEHEADER_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace                       spo   {
+namespace                       core  {
+namespace                       docs  {
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Функция WriteFixed32 записывает значение 4 байтами в сетевом
+ *        порядке.
+ */
+template< typename ByteT_ >
+inline void WriteFixed32 ( ByteT_ * out, std::uint32_t value )
+{
+  for( std::size_t idx( 0 ); idx < 4; ++idx )
+    out[ idx ] = static_cast< ByteT_ >( ( value >> ( 24 - 8 * idx ) ) & 0xFF );
+}
+
+/**
+ * @brief Функция ReadFixed32 читает значение, записанное 4 байтами в
+ *        сетевом порядке.
+ */
+template< typename ByteT_ >
+inline std::uint32_t ReadFixed32 ( const ByteT_ * data )
+{
+  std::uint32_t retval( 0 );
+  for( std::size_t idx( 0 ); idx < 4; ++idx )
+    retval = ( retval << 8 ) | static_cast< unsigned char >( data[ idx ] );
+  return retval;
+}
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Класс FrameHeaderWriter последовательно записывает поля заголовка
+ *        кадра.
+ *
+ * @par Пример использования:
+ * @code language="cpp"
+ *  header_t retval;
+ *  spo::core::docs::FrameHeaderWriter( retval.data() ).Byte( m_Type ).Fixed32( m_Length );
+ * @endcode
+ */
+class                           FrameHeaderWriter
+{
+public:
+  explicit FrameHeaderWriter ( unsigned char * out ) : m_Out( out ) {}
+
+  FrameHeaderWriter & Byte ( std::uint8_t value )
+  {
+    * m_Out ++ = value;
+    return * this;
+  }
+
+  FrameHeaderWriter & Fixed32 ( std::uint32_t value )
+  {
+    WriteFixed32( m_Out, value );
+    m_Out += 4;
+    return * this;
+  }
+
+private:
+  unsigned char               * m_Out;
+};
+
+/**
+ * @brief Класс FrameHeaderReader последовательно читает поля заголовка
+ *        кадра (не менее размера заголовка байт).
+ */
+class                           FrameHeaderReader
+{
+public:
+  explicit FrameHeaderReader ( const unsigned char * data ) : m_Data( data ) {}
+
+  std::uint8_t Byte ()
+  {
+    return * m_Data ++;
+  }
+
+  std::uint32_t Fixed32 ()
+  {
+    const std::uint32_t retval( ReadFixed32( m_Data ) );
+    m_Data += 4;
+    return retval;
+  }
+
+private:
+  const unsigned char         * m_Data;
+};
+
+//------------------------------------------------------------------------------
+}// namespace                   docs
+}// namespace                   core
+}// namespace                   spo
+
+#endif // FRAMEHEADER_H
@@ -12,6 +12,7 @@
 #include <map>
 #include <functional>
 #include <fstream>
+#include <iterator>
 #include <boost/filesystem.hpp>
 
 namespace                       spo   {
@@ -345,12 +346,13 @@ public:
 
   bool FromFile( const std::string & fileName )
   {
-    std::ifstream read_stream( fileName.c_str() );
+    std::ifstream read_stream( fileName.c_str(), std::ios::binary );
     bool retval( read_stream );
     if( retval  )
-    {
-      std::string data;
-      std::getline( read_stream, data );
+    { // содержимое файла полностью (большие файлы передаются сессиями без
+      // чтения в память - см. asio/AsioFileTransfer.h)
+      std::string data( ( std::istreambuf_iterator< char >( read_stream ) ),
+                        std::istreambuf_iterator< char >() );
       retval = FromByteArray( data );
     }
     return retval;
@@ -358,7 +360,7 @@ public:
 
   bool ToFile( const std::string & fileName ) const
   {
-    std::ofstream write_stream( fileName.c_str() );
+    std::ofstream write_stream( fileName.c_str(), std::ios::binary );
     bool retval( write_stream );
     if( retval )
     {
@@ -8,6 +8,45 @@ include($$PWD/../core/documents/documents.pri)
 
 DEFINES+=BOOST_COROUTINE_NO_DEPRECATION_WARNING
 
+# трассировка сопрограмм и обработчиков сессий (см. include/asio/AsioTrace.h):
+# qmake CONFIG+=asio_tracing
+asio_tracing : DEFINES += SPO_ASIO_TRACING
+
+# реактор io_uring вместо epoll (Linux 5.10+, Boost 1.78+, liburing):
+# qmake CONFIG+=asio_io_uring
+# Только переключение реактора Boost.Asio: сессии выполняют те же операции,
+# собственных запросов io_uring (multishot прием, регистрация буферов) нет.
+asio_io_uring : {
+  DEFINES += SPO_ASIO_IO_URING BOOST_ASIO_HAS_IO_URING BOOST_ASIO_DISABLE_EPOLL
+  LIBS    += -luring
+}
+
+# сессии на сопрограммах C++20 без стека (Boost 1.70+, GCC 10+/Clang 14+):
+# qmake CONFIG+=asio_stackless; выбор вида сопрограмм - во время выполнения
+# методом spo::asio::AsioService::SetSessionCoroutines
+asio_stackless : {
+  CONFIG         -= c++11
+  CONFIG         += c++2a
+  QMAKE_CXXFLAGS -= -std=c++11
+  QMAKE_CXXFLAGS += -std=c++20 -fcoroutines
+  DEFINES        += SPO_ASIO_STACKLESS
+}
+
+# звено сжатия каналов (include/asio/CompressionCodec.h): zlib всегда,
+# zstd - qmake CONFIG+=asio_zstd (libzstd-dev)
+LIBS += -lz
+asio_zstd : {
+  DEFINES += SPO_ASIO_ZSTD
+  LIBS    += -lzstd
+}
+
+# шифрование сессий TCP (include/asio/AsioTls.h, OpenSSL 1.1.1+):
+# qmake CONFIG+=asio_tls
+asio_tls : {
+  DEFINES += SPO_ASIO_TLS
+  LIBS    += -lssl -lcrypto
+}
+
 isEmpty(ICM_COMPLETE) : {
   ICM_COMPLETE = $$system('sudo iptables -p icmp -h')
   ICM_COMPLETE = $$system('sudo sysctl -w net.ipv4.ping_group_range="0 1010"')
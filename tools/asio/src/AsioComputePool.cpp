@@ -0,0 +1,170 @@
+#include "asio/AsioComputePool.h"
+#include <algorithm>
+
+namespace                       spo   {
+namespace                       asio  {
+
+//------------------------------------------------------------------------------
+
+namespace {
+
+/**
+ * @brief Переменная t_WorkerIndex содержит номер потока пула, выполняющего
+ *        код (для потоков вне пула - значение по умолчанию).
+ */
+thread_local std::size_t t_WorkerIndex( static_cast< std::size_t >( -1 ) );
+
+}
+
+//------------------------------------------------------------------------------
+
+AsioComputePool &
+AsioComputePool::Instance()
+{
+  static spo::asio::AsioComputePool pool;
+  return std::ref( pool );
+}
+
+AsioComputePool::~AsioComputePool()
+{
+  Stop();
+}
+
+bool
+AsioComputePool::Start( std::size_t threads )
+{
+  std::lock_guard< std::mutex > l( m_Mutex );
+  if( m_Running )
+    return false;
+
+  if( threads == 0 )
+    threads = std::max( 1u, std::thread::hardware_concurrency() );
+
+  m_Workers.clear();
+  for( std::size_t i( 0 ); i < threads; ++i )
+    m_Workers.emplace_back( new Worker );
+  m_Threads = threads;
+  m_Running = true;
+  for( std::size_t i( 0 ); i < threads; ++i )
+    m_Workers[ i ]->m_Thread = std::thread( & AsioComputePool::Run, this, i );
+  return true;
+}
+
+void
+AsioComputePool::Stop()
+{
+  {
+    std::lock_guard< std::mutex > l( m_Mutex );
+    if( not m_Running )
+      return;
+    m_Running = false;
+  }
+  m_Ready.notify_all();
+
+  // потоки завершаются после выполнения всех задач очередей
+  for( auto & worker : m_Workers )
+    if( worker->m_Thread.joinable() )
+      worker->m_Thread.join();
+
+  std::lock_guard< std::mutex > l( m_Mutex );
+  m_Workers.clear();
+  m_Threads = 0;
+}
+
+bool
+AsioComputePool::Submit( const task_t & task )
+{
+  if( not task )
+    return false;
+
+  {
+    std::lock_guard< std::mutex > l( m_Mutex );
+    if( not m_Running )
+      return false;
+
+    const std::size_t index(
+          t_WorkerIndex < m_Workers.size()
+          ? t_WorkerIndex
+          : m_Next++ % m_Workers.size() );
+    auto & worker( * m_Workers[ index ] );
+    std::lock_guard< std::mutex > wl( worker.m_Mutex );
+    worker.m_Tasks.push_back( task );
+    ++ m_Metrics.m_Queued;
+  }
+  ++ m_Metrics.m_Submitted;
+  m_Ready.notify_one();
+  return true;
+}
+
+void
+AsioComputePool::Run( std::size_t index )
+{
+  t_WorkerIndex = index;
+  task_t task;
+  while( true )
+  {
+    if( not Take( index, task ) )
+    {
+      std::unique_lock< std::mutex > l( m_Mutex );
+      if( ( not m_Running ) and ( m_Metrics.m_Queued == 0 ) )
+        break;
+      m_Ready.wait( l, [ this ]() { return ( m_Metrics.m_Queued > 0 ) or ( not m_Running ); } );
+      continue;
+    }
+
+    try
+    {
+      task();
+    }
+    catch( const std::exception & e )
+    {
+      DUMP_EXCEPTION( e );
+    }
+    catch( ... )
+    {
+      DUMP_CRITICAL( " compute pool: task raised a non-standard exception" );
+    }
+    task = task_t();
+    ++ m_Metrics.m_Executed;
+  }
+  t_WorkerIndex = static_cast< std::size_t >( -1 );
+}
+
+bool
+AsioComputePool::Take( std::size_t index, task_t & task )
+{
+  // задачи своей очереди выполняются в порядке передачи
+  {
+    auto & own( * m_Workers[ index ] );
+    std::lock_guard< std::mutex > l( own.m_Mutex );
+    if( not own.m_Tasks.empty() )
+    {
+      task = std::move( own.m_Tasks.front() );
+      own.m_Tasks.pop_front();
+      -- m_Metrics.m_Queued;
+      return true;
+    }
+  }
+
+  // чужая очередь: задача берется с конца, чтобы не конкурировать с
+  // владельцем очереди
+  const std::size_t count( m_Workers.size() );
+  for( std::size_t i( 1 ); i < count; ++i )
+  {
+    auto & other( * m_Workers[ ( index + i ) % count ] );
+    std::lock_guard< std::mutex > l( other.m_Mutex );
+    if( not other.m_Tasks.empty() )
+    {
+      task = std::move( other.m_Tasks.back() );
+      other.m_Tasks.pop_back();
+      -- m_Metrics.m_Queued;
+      ++ m_Metrics.m_Stolen;
+      return true;
+    }
+  }
+  return false;
+}
+
+//------------------------------------------------------------------------------
+}// namespace                   asio
+}// namespace                   spo
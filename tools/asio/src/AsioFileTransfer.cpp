@@ -0,0 +1,281 @@
+#include "asio/AsioFileTransfer.h"
+#include <algorithm>
+#include <csignal>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace                       spo   {
+namespace                       asio  {
+
+//------------------------------------------------------------------------------
+
+namespace {
+
+error_t SystemError ()
+{
+  return errno == EAGAIN || errno == EWOULDBLOCK
+      ? error_t( boost::asio::error::would_block )
+      : error_t( errno, boost::system::system_category() );
+}
+
+void CloseHandle ( int & handle )
+{
+  if( handle >= 0 )
+    ::close( handle );
+  handle = -1;
+}
+
+/**
+ * @brief Класс SigPipeGuard блокирует сигнал SIGPIPE потока на время вызова
+ *        sendfile (у вызова нет флага MSG_NOSIGNAL) и удаляет сигнал,
+ *        сформированный при записи в закрытый сокет.
+ */
+class SigPipeGuard
+{
+public:
+  SigPipeGuard ()
+  {
+    sigemptyset( & m_Set );
+    sigaddset( & m_Set, SIGPIPE );
+    sigset_t pending;
+    sigpending( & pending );
+    m_Pending = sigismember( & pending, SIGPIPE ) == 1;
+    if( not m_Pending )
+      pthread_sigmask( SIG_BLOCK, & m_Set, & m_Old );
+  }
+
+  ~ SigPipeGuard ()
+  {
+    if( m_Pending )
+      return;
+    sigset_t pending;
+    sigpending( & pending );
+    if( sigismember( & pending, SIGPIPE ) == 1 )
+    {
+      const timespec zero { 0, 0 };
+      sigtimedwait( & m_Set, nullptr, & zero );
+    }
+    pthread_sigmask( SIG_SETMASK, & m_Old, nullptr );
+  }
+
+private:
+  sigset_t                      m_Set;
+  sigset_t                      m_Old;
+  bool                          m_Pending;
+};
+
+}
+
+//------------------------------------------------------------------------------
+
+const std::size_t               AsioFileTransfer::CHUNK_SIZE;
+
+AsioFileTransfer::~AsioFileTransfer()
+{
+  Close();
+}
+
+bool
+AsioFileTransfer::OpenSend( const std::string & path, error_t & ec, std::uint64_t offset )
+{
+  ec = error_t();
+  Close();
+  m_Direction = FileDirection::Send;
+
+  struct stat st;
+  m_File = ::open( path.c_str(), O_RDONLY | O_CLOEXEC );
+  if( ( m_File < 0 ) or ( ::fstat( m_File, & st ) != 0 ) )
+  {
+    ec = SystemError();
+    Close();
+    return false;
+  }
+  ::posix_fadvise( m_File, 0, 0, POSIX_FADV_SEQUENTIAL );
+
+  m_Total     = static_cast< std::uint64_t >( st.st_size );
+  m_Offset    = std::min( offset, m_Total );
+  m_Done      = m_Offset;
+  m_Complete  = m_Offset == m_Total;
+  return true;
+}
+
+bool
+AsioFileTransfer::OpenReceive( const std::string & path, error_t & ec, std::uint64_t total )
+{
+  ec = error_t();
+  Close();
+  m_Direction = FileDirection::Receive;
+
+  m_File = ::open( path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644 );
+  if( ( m_File < 0 ) or ( ::pipe2( m_Pipe, O_NONBLOCK | O_CLOEXEC ) != 0 ) )
+  {
+    ec = SystemError();
+    Close();
+    return false;
+  }
+  // канал размером с шаг приема (ограничение /proc/sys/fs/pipe-max-size
+  // допускается: канал остается прежнего размера)
+  ::fcntl( m_Pipe[ 1 ], F_SETPIPE_SZ, static_cast< int >( CHUNK_SIZE ) );
+
+  m_Total     = total;
+  m_Offset    = 0;
+  m_Done      = 0;
+  m_Complete  = false;
+  return true;
+}
+
+std::size_t
+AsioFileTransfer::Transfer( int socketHandle, error_t & ec )
+{
+  ec = error_t();
+  if( not IsOpen() )
+  {
+    ec = boost::asio::error::bad_descriptor;
+    return 0;
+  }
+  if( IsComplete() )
+    return 0;
+
+  return m_Direction == FileDirection::Send
+      ? Send( socketHandle, ec )
+      : Receive( socketHandle, ec );
+}
+
+std::size_t
+AsioFileTransfer::Send( int socketHandle, error_t & ec )
+{
+  const std::size_t size( static_cast< std::size_t >(
+                            std::min< std::uint64_t >( CHUNK_SIZE, m_Total - m_Offset ) ) );
+  ssize_t sent( -1 );
+  if( m_ZeroCopy )
+  {
+    SigPipeGuard guard;
+    off_t offset( static_cast< off_t >( m_Offset ) );
+    sent = ::sendfile( socketHandle, m_File, & offset, size );
+    if( ( sent < 0 ) and ( ( errno == EINVAL ) or ( errno == ENOSYS ) ) )
+      m_ZeroCopy = false;
+  }
+
+  if( not m_ZeroCopy )
+  { // перенос через буфер: передается прочитанная часть, непереданный
+    // остаток читается повторно на следующем шаге
+    m_Buffer.resize( CHUNK_SIZE );
+    const ssize_t read( ::pread( m_File, m_Buffer.data(), size, static_cast< off_t >( m_Offset ) ) );
+    if( read < 0 )
+    {
+      ec = SystemError();
+      return 0;
+    }
+    if( read == 0 )
+    { // файл сокращен во время передачи
+      ec = boost::asio::error::eof;
+      return 0;
+    }
+    sent = ::send( socketHandle, m_Buffer.data(), static_cast< std::size_t >( read ), MSG_NOSIGNAL );
+  }
+
+  if( sent < 0 )
+  {
+    ec = SystemError();
+    return 0;
+  }
+  Advance( static_cast< std::size_t >( sent ) );
+  return static_cast< std::size_t >( sent );
+}
+
+std::size_t
+AsioFileTransfer::Receive( int socketHandle, error_t & ec )
+{
+  const std::size_t size( m_Total > 0
+                          ? static_cast< std::size_t >( std::min< std::uint64_t >( CHUNK_SIZE, m_Total - m_Offset ) )
+                          : CHUNK_SIZE );
+  ssize_t received( -1 );
+  if( m_ZeroCopy )
+  {
+    received = ::splice( socketHandle, nullptr, m_Pipe[ 1 ], nullptr, size,
+                         SPLICE_F_MOVE | SPLICE_F_NONBLOCK );
+    if( ( received < 0 ) and ( ( errno == EINVAL ) or ( errno == ENOSYS ) ) )
+      m_ZeroCopy = false;
+    else if( received > 0 )
+    { // данные канала полностью переносятся в файл до следующего приема
+      ssize_t left( received );
+      while( left > 0 )
+      {
+        const ssize_t moved( ::splice( m_Pipe[ 0 ], nullptr, m_File, nullptr,
+                                       static_cast< std::size_t >( left ), SPLICE_F_MOVE ) );
+        if( moved <= 0 )
+        {
+          ec = moved < 0
+              ? error_t( errno, boost::system::system_category() )
+              : error_t( boost::asio::error::broken_pipe );
+          return 0;
+        }
+        left -= moved;
+      }
+    }
+  }
+
+  if( not m_ZeroCopy )
+  {
+    m_Buffer.resize( CHUNK_SIZE );
+    received = ::recv( socketHandle, m_Buffer.data(), size, 0 );
+    for( ssize_t written( 0 ); written < received; )
+    {
+      const ssize_t t( ::write( m_File, m_Buffer.data() + written, static_cast< std::size_t >( received - written ) ) );
+      if( t < 0 )
+      {
+        ec = error_t( errno, boost::system::system_category() );
+        return 0;
+      }
+      written += t;
+    }
+  }
+
+  if( received < 0 )
+  {
+    ec = SystemError();
+    return 0;
+  }
+  if( received == 0 )
+  { // подключение закрыто другой стороной: прием без размера завершен
+    if( m_Total == 0 )
+    {
+      m_Complete = true;
+      if( m_Progress )
+        m_Progress( m_Done, m_Done );
+    }
+    else
+      ec = boost::asio::error::eof;
+    return 0;
+  }
+  Advance( static_cast< std::size_t >( received ) );
+  return static_cast< std::size_t >( received );
+}
+
+void
+AsioFileTransfer::Advance( std::size_t size )
+{
+  m_Offset += size;
+  m_Done    = m_Offset;
+  if( ( m_Total > 0 ) and ( m_Offset >= m_Total ) )
+    m_Complete = true;
+  if( m_Progress )
+    m_Progress( m_Done, m_Total );
+}
+
+void
+AsioFileTransfer::Close()
+{
+  CloseHandle( m_File );
+  CloseHandle( m_Pipe[ 0 ] );
+  CloseHandle( m_Pipe[ 1 ] );
+  std::vector< char >().swap( m_Buffer );
+}
+
+//------------------------------------------------------------------------------
+}// namespace                   asio
+}// namespace                   spo
@@ -0,0 +1,178 @@
+#include "asio/AsioPlacement.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#if defined( __linux__ )
+# include <linux/mempolicy.h>
+#endif
+
+namespace                       spo   {
+namespace                       asio  {
+
+//------------------------------------------------------------------------------
+
+namespace {
+
+const std::string               NODE_SYSFS_PATH   ( "/sys/devices/system/node/node" );
+const int                       NODE_MAX_COUNT    ( 1024 );
+
+std::string ReadFirstLine( const std::string & path )
+{
+  std::ifstream is( path );
+  std::string retval;
+  std::getline( is, retval );
+  return retval;
+}
+
+}
+
+//------------------------------------------------------------------------------
+
+cpu_list_t
+AsioPlacement::ParseCpuList( const std::string & str )
+{
+  cpu_list_t retval;
+  std::stringstream ss( str );
+  std::string item;
+  while( std::getline( ss, item, ',' ) )
+  {
+    if( item.empty() )
+      continue;
+
+    auto dash( item.find( '-' ) );
+    try
+    {
+      int first( std::stoi( item.substr( 0, dash ) ) );
+      int last ( dash == std::string::npos ? first : std::stoi( item.substr( dash + 1 ) ) );
+      for( int cpu( first ); cpu <= last; ++cpu )
+        retval.push_back( cpu );
+    }
+    catch( const std::exception & e )
+    {
+      DUMP_EXCEPTION( e );
+    }
+  }
+  return retval;
+}
+
+cpu_list_t
+AsioPlacement::NodeCpus( int node )
+{
+  return
+      node < 0
+      ? cpu_list_t()
+      : ParseCpuList( ReadFirstLine( NODE_SYSFS_PATH + std::to_string( node ) + "/cpulist" ) );
+}
+
+int
+AsioPlacement::CpuNode( int cpu )
+{
+  if( cpu < 0 )
+    return -1;
+
+  // таблица соответствия процессоров узлам строится однократно
+  static const std::vector< int > cpu_nodes(
+        []()
+        {
+          std::vector< int > retval;
+          for( int node( 0 ); node < NODE_MAX_COUNT; ++node )
+          {
+            std::ifstream is( NODE_SYSFS_PATH + std::to_string( node ) + "/cpulist" );
+            if( not is.is_open() )
+            {
+              if( node > 0 )
+                break;
+              continue;
+            }
+            for( auto c : NodeCpus( node ) )
+            {
+              if( retval.size() <= std::size_t( c ) )
+                retval.resize( std::size_t( c ) + 1, -1 );
+              retval[ std::size_t( c ) ] = node;
+            }
+          }
+          return retval;
+        }() );
+
+  return
+      std::size_t( cpu ) < cpu_nodes.size()
+      ? cpu_nodes[ std::size_t( cpu ) ]
+      : -1;
+}
+
+cpu_list_t
+AsioPlacement::Cpus( const ThreadPlacement & placement )
+{
+  return
+      placement.m_Cpu >= 0
+      ? cpu_list_t{ placement.m_Cpu }
+      : NodeCpus( placement.m_NumaNode );
+}
+
+int
+AsioPlacement::Node( const ThreadPlacement & placement )
+{
+  return
+      placement.m_NumaNode >= 0
+      ? placement.m_NumaNode
+      : CpuNode( placement.m_Cpu );
+}
+
+bool
+AsioPlacement::PinCurrentThread( const ThreadPlacement & placement, error_t & ec )
+{
+  ec = error_t();
+#if defined( __linux__ )
+  auto cpus( Cpus( placement ) );
+  if( not cpus.empty() )
+  {
+    cpu_set_t set;
+    CPU_ZERO( & set );
+    for( auto cpu : cpus )
+      if( cpu < CPU_SETSIZE )
+        CPU_SET( cpu, & set );
+
+    int err( ::pthread_setaffinity_np( ::pthread_self(), sizeof( set ), & set ) );
+    if( err != 0 )
+      ec = error_t( err, boost::system::system_category() );
+  }
+
+  auto node( Node( placement ) );
+  if( node >= 0 )
+  { // предпочтительное (не строгое) выделение памяти на узле: при нехватке
+    // памяти узла используются другие узлы
+    const std::size_t bits( 8 * sizeof( unsigned long ) );
+    std::vector< unsigned long > mask( std::size_t( node ) / bits + 1, 0 );
+    mask[ std::size_t( node ) / bits ] |= 1UL << ( std::size_t( node ) % bits );
+    if( ( ::syscall( SYS_set_mempolicy, MPOL_PREFERRED, mask.data(), mask.size() * bits + 1 ) != 0 )
+        and IsNoErr( ec ) )
+      ec = error_t( errno, boost::system::system_category() );
+  }
+#else
+  UNUSED( placement );
+  ec = boost::asio::error::operation_not_supported;
+#endif
+  return IsNoErr( ec );
+}
+
+int
+AsioPlacement::IncomingCpu( int nativeHandle )
+{
+  int retval( -1 );
+#if defined( SO_INCOMING_CPU )
+  socklen_t len( sizeof( retval ) );
+  if( ::getsockopt( nativeHandle, SOL_SOCKET, SO_INCOMING_CPU, & retval, & len ) != 0 )
+    retval = -1;
+#else
+  UNUSED( nativeHandle );
+#endif
+  return retval;
+}
+
+}// namespace                   asio
+}// namespace                   spo
@@ -2,6 +2,8 @@
 #include <boost/thread.hpp>
 #include <boost/system/error_code.hpp>
 #include <boost/utility/in_place_factory.hpp>
+#include <algorithm>
+#include <thread>
 
 namespace                       spo   {
 namespace                       asio  {
@@ -64,6 +66,8 @@ bool
 AsioService::Start()
 {
   bool retval( IsActive() );
+  if( not retval )
+    m_Draining = false;
   RunServiceCallbacks( IoServiceActionType::BeforeStart );
   if( not retval )
   {
@@ -106,19 +110,195 @@ void
 AsioService::Stop()
 BOOST_NOEXCEPT
 {
+  RunServiceCallbacks( IoServiceActionType::BeforeStop );
+  StopService();
+}
+
+std::size_t
+AsioService::Drain( const std::int64_t & deadlineMs )
+BOOST_NOEXCEPT
+{
+  std::size_t retval( 0 );
   try
   {
+    if( IsServiceThread() )
+    { // ожидание в потоке сервиса остановило бы обработчики завершения сессий
+      std::make_shared<threadptr_t::element_type>(
+              boost::bind( & AsioService::Drain,
+                           this,
+                           deadlineMs ) )->detach();
+      return retval;
+    }
+
+    m_Draining = true;
     RunServiceCallbacks( IoServiceActionType::BeforeStop );
+
+    auto deadline( std::chrono::steady_clock::now()
+                   + std::chrono::milliseconds( deadlineMs > 0 ? deadlineMs : 0 ) );
+    while( IsActive()
+           and ( SessionsCount() > 0 )
+           and ( std::chrono::steady_clock::now() < deadline ) )
+    {
+      DrainSessions( false );
+      std::this_thread::sleep_for( std::chrono::milliseconds( ASIO_DRAIN_POLL_MS ) );
+    }
+
+    retval = SessionsCount();
+    if( retval > 0 )
+    {
+      DrainSessions( true );
+
+      // ожидание закрытия сокетов принудительно остановленных сессий
+      auto close_deadline( std::chrono::steady_clock::now()
+                           + std::chrono::milliseconds( m_TimeoutMs ) );
+      while( IsActive()
+             and ( SessionsCount() > 0 )
+             and ( std::chrono::steady_clock::now() < close_deadline ) )
+        std::this_thread::sleep_for( std::chrono::milliseconds( ASIO_DRAIN_POLL_MS ) );
+    }
+  }
+  catch( const std::exception & e )
+  {
+    DUMP_EXCEPTION( e );
+  }
+
+  StopService();
+  return retval;
+}
+
+bool
+AsioService::IsServiceThread()
+BOOST_NOEXCEPT
+{
+  if( m_Service.get_executor().running_in_this_thread() )
+    return true;
+  for( auto & t_ref : m_IoThreads )
+    if( t_ref->m_Service.get_executor().running_in_this_thread() )
+      return true;
+  return false;
+}
+
+bool
+AsioService::SetIoThreads( const thread_placements_t & placements )
+{
+  if( IsActive() )
+    return false;
+
+  // потоки предыдущего запуска могут еще завершать run() своих сервисов
+  JoinIoThreads();
+  m_IoThreads.clear();
+  for( auto & p_ref : placements )
+  {
+    std::unique_ptr< IoThread > io_thread( new IoThread );
+    io_thread->m_Placement  = p_ref;
+    io_thread->m_Cpus       = AsioPlacement::Cpus( p_ref );
+    io_thread->m_Node       = AsioPlacement::Node( p_ref );
+    m_IoThreads.push_back( std::move( io_thread ) );
+  }
+  return true;
+}
+
+io_service_t &
+AsioService::SessionServiceRef( int incomingCpu )
+BOOST_NOEXCEPT
+{
+  auto count( m_IoThreads.size() );
+  if( count == 0 )
+    return std::ref( m_Service );
+
+  auto start( m_NextIoThread++ );
+  if( m_IncomingCpuMatching and ( incomingCpu >= 0 ) )
+  { // поток на процессоре входящих пакетов, иначе первый поток на его узле
+    auto node( AsioPlacement::CpuNode( incomingCpu ) );
+    IoThread * same_node( nullptr );
+    for( std::size_t idx( 0 ); idx < count; ++idx )
+    {
+      auto & t_ref( * m_IoThreads[ ( start + idx ) % count ] );
+      if( std::find( t_ref.m_Cpus.cbegin(), t_ref.m_Cpus.cend(), incomingCpu ) != t_ref.m_Cpus.cend() )
+        return std::ref( t_ref.m_Service );
+      if( ( nullptr == same_node ) and ( node >= 0 ) and ( t_ref.m_Node == node ) )
+        same_node = & t_ref;
+    }
+    if( nullptr != same_node )
+      return std::ref( same_node->m_Service );
+  }
+  return std::ref( m_IoThreads[ start % count ]->m_Service );
+}
+
+void
+AsioService::RegisterSession( const void * key, const io_session_drain_t & drain )
+{
+  std::lock_guard< std::mutex > l( m_SessionsMutex );
+  m_Sessions[ key ] = drain;
+}
+
+void
+AsioService::UnregisterSession( const void * key )
+BOOST_NOEXCEPT
+{
+  try
+  {
+    std::lock_guard< std::mutex > l( m_SessionsMutex );
+    m_Sessions.erase( key );
+  }
+  catch( const std::exception & e )
+  {
+    DUMP_EXCEPTION( e );
+  }
+}
+
+std::size_t
+AsioService::SessionsCount()
+const
+{
+  std::lock_guard< std::mutex > l( m_SessionsMutex );
+  return m_Sessions.size();
+}
+
+void
+AsioService::DrainSessions( bool force )
+BOOST_NOEXCEPT
+{
+  try
+  {
+    std::vector< io_session_drain_t > sessions;
+    {
+      std::lock_guard< std::mutex > l( m_SessionsMutex );
+      sessions.reserve( m_Sessions.size() );
+      for( auto & s_ref : m_Sessions )
+        sessions.push_back( s_ref.second );
+    }
+    // функторы вызываются вне блокировки: останов сессии удаляет ее из реестра
+    for( auto & drain : sessions )
+      if( drain )
+        drain( force );
+  }
+  catch( const std::exception & e )
+  {
+    DUMP_EXCEPTION( e );
+  }
+}
+
+void
+AsioService::StopService()
+BOOST_NOEXCEPT
+{
+  try
+  {
     if( not IsActive() )
       return;
 
     m_WorkPtr.reset();
+    for( auto & t_ref : m_IoThreads )
+      t_ref->m_WorkPtr.reset();
 
     auto stop_future = std::async
     (
       std::launch::async,
       [ this ]()
       {
+        for( auto & t_ref : this->m_IoThreads )
+          t_ref->m_Service.stop();
         this->m_Service.stop();
         this->m_Service.reset();
       }
@@ -183,7 +363,9 @@ BOOST_NOEXCEPT
     error_t ec;
     m_Active = true;
     m_WorkPtr = std::make_shared< asio_workuptr_t::element_type >( ServiceRef() );
+    AsioStallWatch::Instance().Attach( m_Service );
     m_Service.run( ec );
+    AsioStallWatch::Instance().Detach();
     m_Service.reset();
     m_Active = false;
 
@@ -201,6 +383,7 @@ BOOST_NOEXCEPT
   {
     DUMP_EXCEPTION( e );
   }
+  AsioStallWatch::Instance().Detach();
   m_WorkPtr.reset();
   m_Active = false;
 }
@@ -211,6 +394,15 @@ BOOST_NOEXCEPT
 {
   if( not IsActive() )
   {
+    JoinIoThreads();
+    for( auto & t_ref : m_IoThreads )
+    {
+      t_ref->m_WorkPtr = std::make_shared< asio_workptr_t::element_type >( t_ref->m_Service );
+      t_ref->m_Thread  = std::make_shared<threadptr_t::element_type>(
+              boost::bind( & AsioService::RunIoThread,
+                           this,
+                           t_ref.get() ) );
+    }
     std::make_shared<threadptr_t::element_type>(
             boost::bind( & AsioService::RunService,
                          this ) )->detach();
@@ -218,5 +410,60 @@ BOOST_NOEXCEPT
   }
 }
 
+void
+AsioService::RunIoThread( IoThread * ioThread )
+BOOST_NOEXCEPT
+{
+  try
+  {
+    error_t ec;
+    if( ( ( ioThread->m_Placement.m_Cpu >= 0 ) or ( ioThread->m_Placement.m_NumaNode >= 0 ) )
+        and ( not AsioPlacement::PinCurrentThread( ioThread->m_Placement, ec ) ) )
+      DUMP_BOOST_ERROR( ec );
+
+    AsioStallWatch::Instance().Attach( ioThread->m_Service );
+    ioThread->m_Service.run( ec );
+    AsioStallWatch::Instance().Detach();
+    ioThread->m_Service.reset();
+  }
+  catch( const std::exception & e )
+  {
+    DUMP_EXCEPTION( e );
+    AsioStallWatch::Instance().Detach();
+  }
+}
+
+void
+AsioService::JoinIoThreads()
+BOOST_NOEXCEPT
+{
+  try
+  {
+    for( auto & t_ref : m_IoThreads )
+    {
+      if( not t_ref->m_Thread )
+        continue;
+
+      // сервис потока остановлен вместе с основным, кроме случая истечения
+      // времени ожидания останова ( @a StopService )
+      t_ref->m_WorkPtr.reset();
+      t_ref->m_Service.stop();
+      if( t_ref->m_Thread->get_id() == boost::this_thread::get_id() )
+        t_ref->m_Thread->detach();
+      else
+      {
+        if( t_ref->m_Thread->joinable() )
+          t_ref->m_Thread->join();
+        t_ref->m_Service.reset();
+      }
+      t_ref->m_Thread.reset();
+    }
+  }
+  catch( const std::exception & e )
+  {
+    DUMP_EXCEPTION( e );
+  }
+}
+
 }// namespace                   asio
 }// namespace                   spo
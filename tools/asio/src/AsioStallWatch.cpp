@@ -0,0 +1,345 @@
+#include "asio/AsioStallWatch.h"
+#include <algorithm>
+#include <cstdlib>
+#include <execinfo.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+namespace                       spo   {
+namespace                       asio  {
+
+//------------------------------------------------------------------------------
+
+namespace {
+
+thread_local StallSlot        * t_Slot( nullptr );
+
+/**
+ * @brief Буфер стека вызовов, заполняемый обработчиком сигнала в занятом
+ *        потоке (стек запрашивается только потоком наблюдения, по одному).
+ *
+ * Сигнал передает номер запроса ( @a g_StackRequest ): сигнал, доставленный
+ * после истечения времени ожидания своего запроса, не изменяет буфер.
+ */
+const int                       STALL_STACK_DEPTH = 64;
+void                          * g_StackFrames[ STALL_STACK_DEPTH ];
+std::atomic< int >              g_StackDepth( 0 );
+std::atomic< std::uint64_t >    g_StackRequest( 0 );
+std::atomic< std::uint64_t >    g_StackDone( 0 );
+
+void OnStackSignal( int, siginfo_t * info, void * )
+{
+  const std::uint64_t request(
+        reinterpret_cast< std::uintptr_t >( info->si_value.sival_ptr ) );
+  if( request != g_StackRequest )
+    return;
+  const int depth( ::backtrace( g_StackFrames, STALL_STACK_DEPTH ) );
+  if( request != g_StackRequest )
+    return;
+  g_StackDepth  = depth;
+  g_StackDone   = request;
+}
+
+/**
+ * @brief Номер сигнала с назначенным обработчиком получения стека (0 - не
+ *        назначен) и предыдущее действие сигнала (изменяются под
+ *        @a AsioStallWatch::m_Mutex ).
+ */
+int                             g_StackSignal( 0 );
+struct sigaction                g_PrevAction;
+
+/**
+ * @brief Метод InstallStackSignal назначает обработчик сигнала получения
+ *        стека вызовов, сохраняя предыдущее действие сигнала.
+ */
+bool InstallStackSignal( int signal )
+{
+  // первый вызов backtrace загружает библиотеку раскрутки стека: вызов в
+  // обработчике сигнала должен выполняться без выделения памяти
+  void * frame;
+  ::backtrace( & frame, 1 );
+
+  struct sigaction action {};
+  action.sa_sigaction = & OnStackSignal;
+  action.sa_flags     = SA_RESTART | SA_SIGINFO;
+  sigemptyset( & action.sa_mask );
+  if( ::sigaction( signal, & action, & g_PrevAction ) != 0 )
+    return false;
+  g_StackSignal = signal;
+  return true;
+}
+
+/**
+ * @brief Метод RestoreStackSignal восстанавливает действие сигнала,
+ *        назначенное до @a InstallStackSignal.
+ */
+void RestoreStackSignal()
+{
+  if( 0 == g_StackSignal )
+    return;
+  if( ::sigaction( g_StackSignal, & g_PrevAction, nullptr ) != 0 )
+    DUMP_ERRNO;
+  g_StackSignal = 0;
+}
+
+}
+
+//------------------------------------------------------------------------------
+
+AsioStallWatch &
+AsioStallWatch::Instance()
+{
+  static spo::asio::AsioStallWatch watch;
+  return std::ref( watch );
+}
+
+AsioStallWatch::~AsioStallWatch()
+{
+  SetPolicy( StallPolicy() );
+}
+
+void
+AsioStallWatch::SetPolicy( const StallPolicy & policy )
+{
+  std::thread stopped;
+  {
+    std::lock_guard< std::mutex > l( m_Mutex );
+    // обработчик сигнала назначается только на время получения стеков
+    const int signal( ( policy.m_CaptureStack and ( policy.m_ThresholdMs > 0 ) )
+                      ? policy.m_StackSignal
+                      : 0 );
+    if( signal != g_StackSignal )
+    {
+      RestoreStackSignal();
+      if( ( 0 != signal ) and ( not InstallStackSignal( signal ) ) )
+        DUMP_ERRNO;
+    }
+
+    m_Policy = policy;
+    if( ( policy.m_ThresholdMs > 0 ) and ( not m_Running ) )
+    {
+      m_Running = true;
+      m_Thread  = std::thread( & AsioStallWatch::Run, this );
+    }
+    else if( ( policy.m_ThresholdMs <= 0 ) and m_Running )
+    {
+      m_Running = false;
+      stopped.swap( m_Thread );
+    }
+  }
+  m_Wake.notify_all();
+  if( stopped.joinable() )
+    stopped.join();
+}
+
+StallPolicy
+AsioStallWatch::Policy() const
+{
+  std::lock_guard< std::mutex > l( m_Mutex );
+  return m_Policy;
+}
+
+void
+AsioStallWatch::SetReport( const report_t & report )
+{
+  std::lock_guard< std::mutex > l( m_Mutex );
+  m_Report = report;
+}
+
+void
+AsioStallWatch::Attach( io_service_t & service )
+{
+  if( nullptr != t_Slot )
+    return;
+
+  auto slot( std::make_shared< StallSlot >() );
+  slot->m_Service   = & service;
+  slot->m_Thread    = ::pthread_self();
+  slot->m_ThreadId  = static_cast< long >( ::syscall( SYS_gettid ) );
+
+  std::lock_guard< std::mutex > l( m_Mutex );
+  m_Slots.push_back( slot );
+  t_Slot = slot.get();
+}
+
+void
+AsioStallWatch::Detach()
+{
+  if( nullptr == t_Slot )
+    return;
+
+  std::lock_guard< std::mutex > l( m_Mutex );
+  auto it( std::find_if( m_Slots.begin(), m_Slots.end(),
+                         []( const std::shared_ptr< StallSlot > & s ) { return s.get() == t_Slot; } ) );
+  if( it != m_Slots.end() )
+  {
+    // поток наблюдения может проверять копию слота: признак запрещает
+    // обращение к сервису, который может быть уже удален
+    ( * it )->m_Detached = true;
+    if( ( * it )->m_Stalling.exchange( false ) )
+      -- m_Metrics.m_Stalled;
+    m_Slots.erase( it );
+  }
+  t_Slot = nullptr;
+}
+
+StallSlot *
+AsioStallWatch::ThreadSlot()
+BOOST_NOEXCEPT
+{
+  return t_Slot;
+}
+
+void
+AsioStallWatch::Run()
+{
+  std::unique_lock< std::mutex > l( m_Mutex );
+  while( m_Running )
+  {
+    // проверка выполняется 4 раза за время порога
+    const StallPolicy policy( m_Policy );
+    m_Wake.wait_for( l, std::chrono::milliseconds( std::max< std::int64_t >( policy.m_ThresholdMs / 4, 1 ) ) );
+    if( not m_Running )
+      break;
+
+    auto slots( m_Slots );
+    l.unlock();
+    const std::int64_t now( Now() );
+    for( auto & slot : slots )
+      Check( slot, now, policy );
+    l.lock();
+  }
+}
+
+void
+AsioStallWatch::Check
+(
+    const std::shared_ptr< StallSlot >  & slot,
+    std::int64_t                          now,
+    const StallPolicy                   & policy
+)
+{
+  {
+    // регистрация потока отменяется под m_Mutex: сервис отмененного слота
+    // не используется
+    std::lock_guard< std::mutex > l( m_Mutex );
+    if( slot->m_Detached )
+      return;
+    // пробный обработчик: пока он не выполнен, поток занят
+    if( not slot->m_ProbePending.exchange( true ) )
+    {
+      slot->m_ProbeSince = now;
+      std::weak_ptr< StallSlot > weak( slot );
+      slot->m_Service->post(
+            [ weak ]()
+            {
+              auto s( weak.lock() );
+              if( s )
+                s->m_ProbePending = false;
+            } );
+    }
+  }
+
+  const std::int64_t  action_since( slot->m_Since );
+  const void        * session( slot->m_Session );
+  const char        * name( slot->m_Name );
+  if( action_since != slot->m_Since )
+    return;
+
+  const std::int64_t since(
+        action_since > 0
+        ? action_since
+        : ( slot->m_ProbePending ? slot->m_ProbeSince.load() : 0 ) );
+  const std::int64_t ms( since > 0 ? ( now - since ) / 1000000 : 0 );
+  if( ( since == 0 ) or ( ms < policy.m_ThresholdMs ) )
+  {
+    if( slot->m_Stalling.exchange( false ) )
+      -- m_Metrics.m_Stalled;
+    return;
+  }
+
+  std::int64_t longest( m_Metrics.m_LongestMs );
+  while( ( ms > longest ) and ( not m_Metrics.m_LongestMs.compare_exchange_weak( longest, ms ) ) )
+    ;
+
+  {
+    std::lock_guard< std::mutex > l( m_Mutex );
+    if( ( not slot->m_Detached ) and ( not slot->m_Stalling.exchange( true ) ) )
+      ++ m_Metrics.m_Stalled;
+  }
+  if( slot->m_Reported == since )
+    return;
+
+  // о задержке сообщается один раз
+  slot->m_Reported = since;
+  ++ m_Metrics.m_Stalls;
+  if( action_since > 0 )
+    ++ m_Metrics.m_InAction;
+
+  StallReport report;
+  report.m_ThreadId = slot->m_ThreadId;
+  report.m_Session  = action_since > 0 ? session : nullptr;
+  report.m_Action   = action_since > 0 ? name : nullptr;
+  report.m_Ms       = ms;
+  if( policy.m_CaptureStack )
+    CaptureStack( * slot, policy.m_StackSignal, report );
+
+  report_t handler;
+  {
+    std::lock_guard< std::mutex > l( m_Mutex );
+    handler = m_Report;
+  }
+  if( handler )
+  {
+    handler( report );
+    return;
+  }
+
+  DUMP_CRITICAL( " stall: thread " << report.m_ThreadId
+                 << " session " << report.m_Session
+                 << " action " << ( report.m_Action ? report.m_Action : "handler" )
+                 << " " << report.m_Ms << " ms" );
+  for( auto & frame : report.m_Stack )
+    DUMP_CRITICAL( "\t" << frame );
+}
+
+void
+AsioStallWatch::CaptureStack( StallSlot & slot, int signal, StallReport & report )
+{
+  std::uint64_t request( 0 );
+  {
+    // сигнал передается только потоку, зарегистрированному в сервисе
+    std::lock_guard< std::mutex > l( m_Mutex );
+    if( slot.m_Detached or ( signal != g_StackSignal ) )
+      return;
+    request = ++ g_StackRequest;
+    sigval value;
+    value.sival_ptr = reinterpret_cast< void * >( static_cast< std::uintptr_t >( request ) );
+    if( ::pthread_sigqueue( slot.m_Thread, signal, value ) != 0 )
+      return;
+  }
+
+  const std::int64_t deadline( Now() + 100 * 1000000 );
+  while( ( g_StackDone != request ) and ( Now() < deadline ) )
+    std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+
+  // запрос закрывается: опоздавший сигнал не изменяет буфер
+  std::uint64_t current( request );
+  g_StackRequest.compare_exchange_strong( current, request + 1 );
+  const int depth( g_StackDone == request ? g_StackDepth.load() : 0 );
+  if( depth <= 0 )
+    return;
+
+  char ** symbols( ::backtrace_symbols( g_StackFrames, depth ) );
+  if( nullptr == symbols )
+    return;
+  // первые кадры принадлежат обработчику сигнала
+  for( int i( 2 ); i < depth; ++i )
+    report.m_Stack.emplace_back( symbols[ i ] );
+  ::free( symbols );
+  ++ m_Metrics.m_Captured;
+}
+
+//------------------------------------------------------------------------------
+}// namespace                   asio
+}// namespace                   spo
@@ -0,0 +1,240 @@
+#include "asio/AsioTls.h"
+
+#if defined( SPO_ASIO_TLS )
+
+namespace                       spo   {
+namespace                       asio  {
+
+//------------------------------------------------------------------------------
+
+namespace {
+
+const std::string               SESSION_ID_CONTEXT( "spo.asio" );
+
+/**
+ * @brief Индекс данных контекста OpenSSL с указателем на @a AsioTls
+ *        (данные приложения контекста и соединения заняты Boost.Asio).
+ */
+int ContextIndex()
+{
+  static const int retval( ::SSL_CTX_get_ex_new_index( 0, nullptr, nullptr, nullptr, nullptr ) );
+  return retval;
+}
+
+/**
+ * @brief Индекс данных соединения OpenSSL с идентификатором сервера.
+ */
+int PeerIndex()
+{
+  static const int retval( ::SSL_get_ex_new_index( 0, nullptr, nullptr, nullptr, nullptr ) );
+  return retval;
+}
+
+/**
+ * @brief Метод PeerHost возвращает узел идентификатора сервера "узел:служба"
+ *        (адрес IPv6 допускается в квадратных скобках).
+ */
+std::string PeerHost( const std::string & peer )
+{
+  const auto pos( peer.rfind( ':' ) );
+  std::string retval( pos == std::string::npos ? peer : peer.substr( 0, pos ) );
+  if( ( retval.size() > 1 ) and ( retval.front() == '[' ) and ( retval.back() == ']' ) )
+    retval = retval.substr( 1, retval.size() - 2 );
+  return retval;
+}
+
+error_t SslError()
+{
+  return error_t( static_cast< int >( ::ERR_get_error() ), boost::asio::error::get_ssl_category() );
+}
+
+}
+
+//------------------------------------------------------------------------------
+
+AsioTls::AsioTls( TlsRole role )
+  : m_Role    ( role )
+  , m_Context ( role == TlsRole::Server
+                ? context_t::tls_server
+                : context_t::tls_client )
+{
+  auto ctx( m_Context.native_handle() );
+  m_Context.set_options( context_t::default_workarounds
+                         | context_t::no_sslv2
+                         | context_t::no_sslv3
+                         | context_t::no_tlsv1
+                         | context_t::no_tlsv1_1 );
+  ::SSL_CTX_set_ex_data( ctx, ContextIndex(), this );
+
+  if( role == TlsRole::Server )
+  { // билеты сессий выдаются по умолчанию; сессии также хранятся в кэше
+    // сервера (возобновление по идентификатору сессии TLS 1.2)
+    ::SSL_CTX_set_session_cache_mode( ctx, SSL_SESS_CACHE_SERVER );
+    ::SSL_CTX_set_session_id_context(
+          ctx,
+          reinterpret_cast< const unsigned char * >( SESSION_ID_CONTEXT.data() ),
+          static_cast< unsigned int >( SESSION_ID_CONTEXT.size() ) );
+    // одного билета TLS 1.3 достаточно: клиент хранит последнюю сессию
+    ::SSL_CTX_set_num_tickets( ctx, 1 );
+  }
+  else
+  { // сессии клиента хранятся в кэше AsioTls по идентификаторам серверов
+    ::SSL_CTX_set_session_cache_mode( ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE );
+    ::SSL_CTX_sess_set_new_cb( ctx, & AsioTls::OnNewSession );
+    // сертификат сервера проверяется по умолчанию (системные сертификаты
+    // удостоверяющих центров)
+    error_t ec;
+    m_Context.set_default_verify_paths( ec );
+    if( not IsNoErr( ec ) )
+      DUMP_BOOST_ERROR( ec );
+    m_Context.set_verify_mode( boost::asio::ssl::verify_peer, ec );
+  }
+}
+
+AsioTls::~AsioTls()
+{
+  std::lock_guard< std::mutex > lock( m_SessionsMutex );
+  for( auto & item : m_Sessions )
+    ::SSL_SESSION_free( item.second );
+  m_Sessions.clear();
+}
+
+bool
+AsioTls::SetCertificate( const std::string & certFile, const std::string & keyFile, error_t & ec )
+{
+  ec = error_t();
+  m_Context.use_certificate_chain_file( certFile, ec );
+  if( IsNoErr( ec ) )
+    m_Context.use_private_key_file( keyFile, context_t::pem, ec );
+  return IsNoErr( ec );
+}
+
+bool
+AsioTls::SetVerifyFile( const std::string & caFile, error_t & ec )
+{
+  ec = error_t();
+  m_Context.load_verify_file( caFile, ec );
+  if( IsNoErr( ec ) )
+    m_Context.set_verify_mode( boost::asio::ssl::verify_peer
+                               | boost::asio::ssl::verify_fail_if_no_peer_cert,
+                               ec );
+  return IsNoErr( ec );
+}
+
+bool
+AsioTls::SetTicketKeys( const std::string & keys, error_t & ec )
+{
+  ec = error_t();
+  if( keys.size() != TICKET_KEYS_SIZE )
+    ec = boost::asio::error::invalid_argument;
+  else if( ::SSL_CTX_set_tlsext_ticket_keys(
+             m_Context.native_handle(),
+             const_cast< char * >( keys.data() ),
+             static_cast< long >( keys.size() ) ) != 1 )
+    ec = SslError();
+  return IsNoErr( ec );
+}
+
+void
+AsioTls::SetVerifyNone()
+{
+  error_t ec;
+  m_Context.set_verify_mode( boost::asio::ssl::verify_none, ec );
+}
+
+void
+AsioTls::SetSessionTimeout( long seconds )
+{
+  ::SSL_CTX_set_timeout( m_Context.native_handle(), seconds );
+}
+
+void
+AsioTls::SetSessionCacheSize( long size )
+{
+  ::SSL_CTX_sess_set_cache_size( m_Context.native_handle(), size );
+}
+
+void
+AsioTls::PrepareSession( SSL * ssl, const std::string & peer )
+{
+  if( ( m_Role != TlsRole::Client ) or peer.empty() )
+    return;
+
+  // адрес IP проверяется по полю iPAddress сертификата, имя узла - по
+  // dNSName и передается серверу (SNI, RFC 6066 не допускает адресов)
+  const std::string host( PeerHost( peer ) );
+  if( ( not host.empty() )
+      and ( ::X509_VERIFY_PARAM_set1_ip_asc( ::SSL_get0_param( ssl ), host.c_str() ) != 1 ) )
+  {
+    ::SSL_set_tlsext_host_name( ssl, host.c_str() );
+    ::SSL_set1_host( ssl, host.c_str() );
+  }
+
+  ::SSL_set_ex_data( ssl, PeerIndex(), const_cast< std::string * >( & peer ) );
+
+  std::lock_guard< std::mutex > lock( m_SessionsMutex );
+  auto it( m_Sessions.find( peer ) );
+  if( it != m_Sessions.end() )
+    ::SSL_set_session( ssl, it->second );
+}
+
+bool
+AsioTls::CompleteHandshake( SSL * ssl, const error_t & ec )
+{
+  if( not IsNoErr( ec ) )
+  { // сессия, на которой рукопожатие не удалось, повторно не предлагается
+    ++ m_Metrics.m_Failures;
+    auto peer( static_cast< const std::string * >( ::SSL_get_ex_data( ssl, PeerIndex() ) ) );
+    if( nullptr != peer )
+      ForgetSession( * peer );
+    return false;
+  }
+
+  ++ m_Metrics.m_Handshakes;
+  if( ::SSL_session_reused( ssl ) == 1 )
+    ++ m_Metrics.m_Resumed;
+  return true;
+}
+
+void
+AsioTls::ForgetSession( const std::string & peer )
+{
+  std::lock_guard< std::mutex > lock( m_SessionsMutex );
+  auto it( m_Sessions.find( peer ) );
+  if( it != m_Sessions.end() )
+  {
+    ::SSL_SESSION_free( it->second );
+    m_Sessions.erase( it );
+  }
+}
+
+std::size_t
+AsioTls::CachedSessions() const
+{
+  std::lock_guard< std::mutex > lock( m_SessionsMutex );
+  return m_Sessions.size();
+}
+
+int
+AsioTls::OnNewSession( SSL * ssl, SSL_SESSION * session )
+{
+  auto self( static_cast< AsioTls * >(
+               ::SSL_CTX_get_ex_data( ::SSL_get_SSL_CTX( ssl ), ContextIndex() ) ) );
+  auto peer( static_cast< const std::string * >( ::SSL_get_ex_data( ssl, PeerIndex() ) ) );
+  if( ( nullptr == self ) or ( nullptr == peer ) )
+    return 0;
+
+  // ссылка на сессию переходит кэшу (возвращаемое значение 1)
+  std::lock_guard< std::mutex > lock( self->m_SessionsMutex );
+  auto & cached( self->m_Sessions[ * peer ] );
+  if( nullptr != cached )
+    ::SSL_SESSION_free( cached );
+  cached = session;
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+}// namespace                   asio
+}// namespace                   spo
+
+#endif // SPO_ASIO_TLS
@@ -0,0 +1,262 @@
+#include "asio/AsioTrace.h"
+#include <fstream>
+#include <iomanip>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+namespace                       spo   {
+namespace                       asio  {
+
+//------------------------------------------------------------------------------
+
+namespace {
+
+/**
+ * @brief Метод EventPhase возвращает значение поля "ph" Chrome trace-event для
+ *        типа события.
+ *
+ * Ожидание операции (Yield -> Resume) выгружается асинхронным интервалом
+ * ("b"/"e"), т.к. сопрограмма может быть возобновлена другим потоком сервиса.
+ */
+const char * EventPhase( TraceEventType type )
+{
+  switch( type )
+  {
+    case TraceEventType::HandlerBegin : return "B";
+    case TraceEventType::HandlerEnd   : return "E";
+    case TraceEventType::Yield        : return "b";
+    case TraceEventType::Resume       : return "e";
+    default                           : break;
+  }
+  return "i";
+}
+
+const char * EventCategory( TraceEventType type )
+{
+  switch( type )
+  {
+    case TraceEventType::SessionSpawn : return "spawn";
+    case TraceEventType::Yield        :
+    case TraceEventType::Resume       : return "wait";
+    case TraceEventType::HandlerBegin :
+    case TraceEventType::HandlerEnd   : return "handler";
+    case TraceEventType::IoComplete   : return "io";
+  }
+  return "asio";
+}
+
+void WriteJsonString( std::ostream & os, const char * str )
+{
+  os << '"';
+  for( const char * c( str ); ( nullptr != c ) and ( *c != '\0' ); ++c )
+  {
+    if( ( *c == '"' ) or ( *c == '\\' ) )
+      os << '\\';
+    os << *c;
+  }
+  os << '"';
+}
+
+}
+
+//------------------------------------------------------------------------------
+
+AsioTraceRing::AsioTraceRing    ( std::size_t capacity, long threadId )
+  : m_Slots                     ( capacity )
+  , m_ThreadId                  ( threadId )
+{
+}
+
+void
+AsioTraceRing::Push( const TraceEvent & event )
+BOOST_NOEXCEPT
+{
+  auto head ( m_Head.load( std::memory_order_relaxed ) );
+  auto & slot( m_Slots[ head % m_Slots.size() ] );
+
+  // нулевое значение последовательности помечает ячейку как изменяемую
+  slot.m_Seq.store( 0, std::memory_order_relaxed );
+  std::atomic_thread_fence( std::memory_order_release );
+  slot.m_TimeNs .store( event.m_TimeNs,  std::memory_order_relaxed );
+  slot.m_Session.store( event.m_Session, std::memory_order_relaxed );
+  slot.m_Name   .store( event.m_Name,    std::memory_order_relaxed );
+  slot.m_Value  .store( event.m_Value,   std::memory_order_relaxed );
+  slot.m_Type   .store( event.m_Type,    std::memory_order_relaxed );
+  slot.m_Seq.store( head + 1, std::memory_order_release );
+  m_Head.store( head + 1, std::memory_order_release );
+}
+
+std::vector< TraceEvent >
+AsioTraceRing::Snapshot()
+const
+{
+  std::vector< TraceEvent > retval;
+  auto head ( m_Head.load( std::memory_order_acquire ) );
+  auto size ( static_cast< std::uint64_t >( m_Slots.size() ) );
+  auto first( head > size ? head - size : 0 );
+
+  retval.reserve( static_cast< std::size_t >( head - first ) );
+  for( auto idx( first ); idx < head; ++idx )
+  {
+    auto & slot( m_Slots[ idx % size ] );
+    if( slot.m_Seq.load( std::memory_order_acquire ) != idx + 1 )
+      continue;
+
+    TraceEvent event;
+    event.m_TimeNs  = slot.m_TimeNs .load( std::memory_order_relaxed );
+    event.m_Session = slot.m_Session.load( std::memory_order_relaxed );
+    event.m_Name    = slot.m_Name   .load( std::memory_order_relaxed );
+    event.m_Value   = slot.m_Value  .load( std::memory_order_relaxed );
+    event.m_Type    = slot.m_Type   .load( std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_acquire );
+    if( slot.m_Seq.load( std::memory_order_relaxed ) == idx + 1 )
+      retval.push_back( event );
+  }
+  return retval;
+}
+
+void
+AsioTraceRing::Clear()
+BOOST_NOEXCEPT
+{
+  for( auto & slot : m_Slots )
+    slot.m_Seq.store( 0, std::memory_order_relaxed );
+}
+
+//------------------------------------------------------------------------------
+
+AsioTrace::AsioTrace            ()
+  : m_Epoch                     ( std::chrono::steady_clock::now() )
+{
+}
+
+AsioTrace &
+AsioTrace::Instance()
+{
+  static spo::asio::AsioTrace trace;
+  return std::ref( trace );
+}
+
+AsioTraceRing *
+AsioTrace::ThreadRing()
+{
+  thread_local AsioTraceRing * ring_ptr { nullptr };
+  if( nullptr == ring_ptr )
+  {
+    auto ring( std::make_shared< AsioTraceRing >(
+                 RingSize(),
+                 static_cast< long >( ::syscall( SYS_gettid ) ) ) );
+    std::lock_guard< std::mutex > l( m_Mutex );
+    m_Rings.push_back( ring );
+    ring_ptr = ring.get();
+  }
+  return ring_ptr;
+}
+
+void
+AsioTrace::Record
+(
+    TraceEventType              type,
+    const void                * session,
+    const char                * name,
+    std::uint64_t               value
+)
+BOOST_NOEXCEPT
+{
+  if( not IsEnabled() )
+    return;
+
+  try
+  {
+    TraceEvent event;
+    event.m_TimeNs  = static_cast< std::uint64_t >(
+                        std::chrono::duration_cast< std::chrono::nanoseconds >(
+                          std::chrono::steady_clock::now() - m_Epoch ).count() );
+    event.m_Session = session;
+    event.m_Name    = name;
+    event.m_Value   = value;
+    event.m_Type    = type;
+    ThreadRing()->Push( event );
+  }
+  catch( const std::exception & e )
+  {
+    DUMP_EXCEPTION( e );
+  }
+}
+
+std::size_t
+AsioTrace::DumpChromeJson( std::ostream & os )
+const
+{
+  std::vector< std::shared_ptr< AsioTraceRing > > rings;
+  {
+    std::lock_guard< std::mutex > l( m_Mutex );
+    rings = m_Rings;
+  }
+
+  std::size_t retval( 0 );
+  auto pid( ::getpid() );
+
+  os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  for( auto & ring : rings )
+  {
+    for( auto & event : ring->Snapshot() )
+    {
+      os << ( retval++ > 0 ? ",\n" : "\n" )
+         << "{\"name\":";
+      WriteJsonString( os, event.m_Name );
+      os << ",\"cat\":\"" << EventCategory( event.m_Type ) << "\""
+         << ",\"ph\":\"" << EventPhase( event.m_Type ) << "\""
+         << ",\"ts\":" << ( event.m_TimeNs / 1000 ) << "."
+                       << std::setw( 3 ) << std::setfill( '0' ) << ( event.m_TimeNs % 1000 )
+         << ",\"pid\":" << pid
+         << ",\"tid\":" << ring->ThreadId();
+
+      switch( event.m_Type )
+      {
+        case TraceEventType::Yield  :
+        case TraceEventType::Resume :
+          os << ",\"id\":\"" << event.m_Session << "\"";
+          break;
+        case TraceEventType::SessionSpawn :
+        case TraceEventType::IoComplete   :
+          os << ",\"s\":\"t\"";
+          break;
+        default :
+          break;
+      }
+      os << ",\"args\":{\"session\":\"" << event.m_Session << "\"";
+      if( event.m_Type == TraceEventType::IoComplete )
+        os << ",\"bytes\":" << event.m_Value;
+      os << "}}";
+    }
+  }
+  os << "\n]}\n";
+  return retval;
+}
+
+bool
+AsioTrace::DumpToFile( const std::string & fileName )
+const
+{
+  std::ofstream write_stream( fileName.c_str(), std::ios::out | std::ios::trunc );
+  bool retval( write_stream );
+  if( retval )
+  {
+    UNUSED( DumpChromeJson( write_stream ) );
+    write_stream.flush();
+    retval = bool( write_stream );
+  }
+  return retval;
+}
+
+void
+AsioTrace::Clear()
+{
+  std::lock_guard< std::mutex > l( m_Mutex );
+  for( auto & ring : m_Rings )
+    ring->Clear();
+}
+
+}// namespace                   asio
+}// namespace                   spo
@@ -0,0 +1,100 @@
+#include "asio/InboundBudget.h"
+#include <algorithm>
+
+namespace                       spo   {
+namespace                       asio  {
+
+//------------------------------------------------------------------------------
+
+InboundBudget &
+InboundBudget::Instance()
+{
+  static spo::asio::InboundBudget budget;
+  return std::ref( budget );
+}
+
+void
+InboundBudget::SetLimit( std::size_t high, std::size_t low )
+{
+  m_High  = high;
+  m_Low   = std::min( low, high );
+  Update();
+}
+
+void
+InboundBudget::Acquire( std::size_t bytes )
+{
+  const std::size_t buffered( m_Metrics.m_Buffered += bytes );
+  std::size_t peak( m_Metrics.m_Peak );
+  while( ( buffered > peak ) and ( not m_Metrics.m_Peak.compare_exchange_weak( peak, buffered ) ) )
+    ;
+  const std::size_t high( m_High );
+  if( ( high > 0 ) and ( buffered >= high ) )
+    m_Paused = true;
+}
+
+void
+InboundBudget::Release( std::size_t bytes )
+{
+  m_Metrics.m_Buffered -= bytes;
+  if( m_Paused )
+    Update();
+}
+
+void
+InboundBudget::Wait( const resume_t & resume )
+{
+  {
+    std::lock_guard< std::mutex > l( m_Mutex );
+    if( m_Paused )
+    {
+      m_Waiters.push_back( resume );
+      return;
+    }
+  }
+  resume();
+}
+
+void
+InboundBudget::CountPause( bool global )
+BOOST_NOEXCEPT
+{
+  ++ ( global ? m_Metrics.m_GlobalPauses : m_Metrics.m_SessionPauses );
+  ++ m_Metrics.m_Paused;
+}
+
+void
+InboundBudget::CountResume()
+BOOST_NOEXCEPT
+{
+  ++ m_Metrics.m_Resumes;
+  -- m_Metrics.m_Paused;
+}
+
+void
+InboundBudget::Update()
+{
+  std::vector< resume_t > waiters;
+  {
+    std::lock_guard< std::mutex > l( m_Mutex );
+    const std::size_t high( m_High );
+    const std::size_t buffered( m_Metrics.m_Buffered );
+    if( ( high > 0 ) and ( buffered > m_Low ) and ( m_Paused or ( buffered >= high ) ) )
+    {
+      m_Paused = true;
+      return;
+    }
+    m_Paused = false;
+    waiters.swap( m_Waiters );
+  }
+
+  // обработчики вызываются без блокировки: возобновленная сессия может
+  // снова приостановить чтение
+  for( auto & resume : waiters )
+    if( resume )
+      resume();
+}
+
+//------------------------------------------------------------------------------
+}// namespace                   asio
+}// namespace                   spo
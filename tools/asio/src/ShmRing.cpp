@@ -0,0 +1,456 @@
+#include "asio/ShmRing.h"
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <new>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace                       spo   {
+namespace                       asio  {
+
+//------------------------------------------------------------------------------
+
+namespace {
+
+/**
+ * @brief Признак продолжения записей с начала области данных.
+ */
+const std::uint32_t             SHM_WRAP          = 0xFFFFFFFF;
+const std::size_t               SHM_LENGTH_SIZE   = sizeof( std::uint32_t );
+const std::size_t               SHM_HEADER_SIZE   = ( sizeof( ShmRingHeader ) + 63 ) & ~ std::size_t( 63 );
+const int                       SHM_HANDLES       = 3;
+const int                       SHM_SEALS         = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL;
+
+std::uint64_t RecordSize ( std::size_t size )
+{
+  return ( SHM_LENGTH_SIZE + size + 7 ) & ~ std::uint64_t( 7 );
+}
+
+/**
+ * @brief Функция Fits проверяет наличие места для записи размером @a record
+ *        байт в позиции записи кольца.
+ * @param used занятая часть области данных;
+ * @param skip размер пропуска до начала области данных (перенос записи).
+ */
+bool Fits ( std::uint64_t capacity, std::uint64_t head, std::uint64_t used,
+            std::uint64_t record, std::uint64_t & skip )
+{
+  const std::uint64_t pos( head % capacity );
+  skip = ( capacity - pos ) < record ? capacity - pos : 0;
+  return used + skip + record <= capacity;
+}
+
+error_t SystemError ()
+{
+  return error_t( errno, boost::system::system_category() );
+}
+
+void CloseHandle ( int & handle )
+{
+  if( handle >= 0 )
+    ::close( handle );
+  handle = -1;
+}
+
+}
+
+//------------------------------------------------------------------------------
+
+std::size_t
+ShmRing::RegionSize( std::size_t capacity )
+{
+  return SHM_HEADER_SIZE + capacity;
+}
+
+void
+ShmRing::Init( void * memory, std::size_t capacity )
+{
+  auto header( new ( memory ) ShmRingHeader );
+  header->m_Capacity = capacity;
+}
+
+void
+ShmRing::Attach( void * memory, std::size_t capacity )
+{
+  m_Header    = static_cast< ShmRingHeader * >( memory );
+  m_Data      = static_cast< unsigned char * >( memory ) + SHM_HEADER_SIZE;
+  m_Capacity  = capacity;
+  m_FrontSize = 0;
+  m_Corrupted = false;
+  m_Head      = m_Header->m_Head.load( std::memory_order_acquire );
+  m_Tail      = m_Header->m_Tail.load( std::memory_order_acquire );
+
+  // записи выровнены на 8 байт: иные значения заданы не кольцом
+  if( ( capacity < 2 * ( SHM_LENGTH_SIZE + 8 ) )
+      or ( capacity % 8 != 0 )
+      or ( m_Header->m_Capacity != capacity )
+      or ( m_Head % 8 != 0 )
+      or ( m_Tail % 8 != 0 )
+      or ( m_Head - m_Tail > capacity ) )
+    Corrupt();
+}
+
+std::size_t
+ShmRing::Capacity() const
+{
+  return IsAttached() ? static_cast< std::size_t >( m_Capacity ) : 0;
+}
+
+std::size_t
+ShmRing::MaxMessage() const
+{
+  // запись не длиннее половины области всегда помещается в пустое кольцо
+  // (с переносом на начало или без него)
+  return IsAttached() ? Capacity() / 2 - SHM_LENGTH_SIZE : 0;
+}
+
+void
+ShmRing::Corrupt()
+{
+  DUMP_CRITICAL( "ShmRing: invalid ring state in shared memory" );
+  m_Corrupted = true;
+  m_Header    = nullptr;
+  m_Data      = nullptr;
+  m_FrontSize = 0;
+}
+
+bool
+ShmRing::TryPush( const void * data, std::size_t size, bool & wake )
+{
+  wake = false;
+  if( ( not IsAttached() ) or ( size > MaxMessage() ) )
+    return false;
+
+  // позицию чтения изменяет другая сторона
+  const std::uint64_t used( m_Head - m_Header->m_Tail.load( std::memory_order_acquire ) );
+  if( used > m_Capacity )
+  {
+    Corrupt();
+    return false;
+  }
+
+  const std::uint64_t record( RecordSize( size ) );
+  std::uint64_t skip( 0 );
+  if( not Fits( m_Capacity, m_Head, used, record, skip ) )
+    return false;
+
+  std::uint64_t pos( m_Head % m_Capacity );
+  if( skip > 0 )
+  {
+    std::memcpy( m_Data + pos, & SHM_WRAP, SHM_LENGTH_SIZE );
+    pos = 0;
+  }
+  const std::uint32_t length( static_cast< std::uint32_t >( size ) );
+  std::memcpy( m_Data + pos, & length, SHM_LENGTH_SIZE );
+  std::memcpy( m_Data + pos + SHM_LENGTH_SIZE, data, size );
+  m_Head += skip + record;
+  m_Header->m_Head.store( m_Head, std::memory_order_release );
+
+  // пара барьеров с PrepareWait: либо читатель увидит запись, либо писатель
+  // увидит признак ожидания
+  std::atomic_thread_fence( std::memory_order_seq_cst );
+  if( m_Header->m_Waiting.load( std::memory_order_relaxed ) != 0 )
+    wake = m_Header->m_Waiting.exchange( 0, std::memory_order_acq_rel ) != 0;
+  return true;
+}
+
+const void *
+ShmRing::Front( std::size_t & size )
+{
+  size = 0;
+  if( not IsAttached() )
+    return nullptr;
+
+  // позицию записи, длину и признак переноса записывает другая сторона:
+  // запись должна находиться в пределах записанной части кольца
+  const std::uint64_t available( m_Header->m_Head.load( std::memory_order_acquire ) - m_Tail );
+  if( available == 0 )
+    return nullptr;
+  if( available > m_Capacity )
+  {
+    Corrupt();
+    return nullptr;
+  }
+
+  std::uint64_t pos( m_Tail % m_Capacity );
+  std::uint64_t skip( 0 );
+  std::uint32_t length;
+  std::memcpy( & length, m_Data + pos, SHM_LENGTH_SIZE );
+  if( length == SHM_WRAP )
+  {
+    skip = m_Capacity - pos;
+    pos  = 0;
+    std::memcpy( & length, m_Data, SHM_LENGTH_SIZE );
+  }
+  if( ( length > MaxMessage() ) or ( skip + RecordSize( length ) > available ) )
+  {
+    Corrupt();
+    return nullptr;
+  }
+
+  m_FrontSize = skip + RecordSize( length );
+  size = length;
+  return m_Data + pos + SHM_LENGTH_SIZE;
+}
+
+void
+ShmRing::Pop()
+{
+  if( IsAttached() and ( m_FrontSize > 0 ) )
+  {
+    // позицию чтения изменяет только читатель
+    m_Tail += m_FrontSize;
+    m_Header->m_Tail.store( m_Tail, std::memory_order_release );
+    m_FrontSize = 0;
+  }
+}
+
+bool
+ShmRing::ReleaseWriter()
+{
+  if( not IsAttached() )
+    return false;
+
+  std::atomic_thread_fence( std::memory_order_seq_cst );
+  return ( m_Header->m_Writing.load( std::memory_order_relaxed ) != 0 )
+      and ( m_Header->m_Writing.exchange( 0, std::memory_order_acq_rel ) != 0 );
+}
+
+bool
+ShmRing::IsEmpty() const
+{
+  return ( not IsAttached() )
+      or ( m_Header->m_Head.load( std::memory_order_acquire ) == m_Tail );
+}
+
+bool
+ShmRing::PrepareWait()
+{
+  if( not IsAttached() )
+    return false;
+
+  m_Header->m_Waiting.store( 1, std::memory_order_relaxed );
+  std::atomic_thread_fence( std::memory_order_seq_cst );
+  if( IsEmpty() )
+    return true;
+
+  m_Header->m_Waiting.store( 0, std::memory_order_relaxed );
+  return false;
+}
+
+bool
+ShmRing::PrepareWaitSpace( std::size_t size )
+{
+  if( not IsAttached() )
+    return false;
+
+  m_Header->m_Writing.store( 1, std::memory_order_relaxed );
+  std::atomic_thread_fence( std::memory_order_seq_cst );
+
+  std::uint64_t skip( 0 );
+  const std::uint64_t used( m_Head - m_Header->m_Tail.load( std::memory_order_acquire ) );
+  if( ( used > m_Capacity ) or ( not Fits( m_Capacity, m_Head, used, RecordSize( size ), skip ) ) )
+    return true;
+
+  m_Header->m_Writing.store( 0, std::memory_order_relaxed );
+  return false;
+}
+
+//------------------------------------------------------------------------------
+
+ShmRegion::~ShmRegion()
+{
+  Close();
+}
+
+bool
+ShmRegion::Create( std::size_t capacity, error_t & ec )
+{
+  ec = error_t();
+  Close();
+  m_Creator = true;
+  capacity  = ( capacity + 7 ) & ~ std::size_t( 7 );
+
+  // размер запечатывается до передачи области: другая сторона не может
+  // уменьшить файл под отображением (SIGBUS) или снять печати
+  const std::size_t size( 2 * ShmRing::RegionSize( capacity ) );
+  m_MemoryHandle = ::memfd_create( "spo.asio.shm", MFD_CLOEXEC | MFD_ALLOW_SEALING );
+  if( ( m_MemoryHandle < 0 )
+      or ( ::ftruncate( m_MemoryHandle, static_cast< off_t >( size ) ) != 0 )
+      or ( ::fcntl( m_MemoryHandle, F_ADD_SEALS, SHM_SEALS ) != 0 ) )
+    ec = SystemError();
+
+  for( auto & event : m_Events )
+    if( IsNoErr( ec ) and ( ( event = ::eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC ) ) < 0 ) )
+      ec = SystemError();
+
+  if( IsNoErr( ec ) and Map( size, ec ) )
+  {
+    auto memory( static_cast< unsigned char * >( m_Memory ) );
+    ShmRing::Init( memory, capacity );
+    ShmRing::Init( memory + ShmRing::RegionSize( capacity ), capacity );
+    m_Rings[ 0 ].Attach( memory, capacity );
+    m_Rings[ 1 ].Attach( memory + ShmRing::RegionSize( capacity ), capacity );
+  }
+
+  if( not IsNoErr( ec ) )
+    Close();
+  return IsNoErr( ec );
+}
+
+bool
+ShmRegion::Send( int socketHandle, error_t & ec ) const
+{
+  ec = error_t();
+  if( not IsValid() )
+  {
+    ec = boost::asio::error::bad_descriptor;
+    return false;
+  }
+
+  std::uint64_t capacity( m_Rings[ 0 ].Capacity() );
+  iovec io { & capacity, sizeof( capacity ) };
+  const int handles[ SHM_HANDLES ] { m_MemoryHandle, m_Events[ 0 ], m_Events[ 1 ] };
+  alignas( cmsghdr ) char control[ CMSG_SPACE( sizeof( handles ) ) ] {};
+
+  msghdr msg {};
+  msg.msg_iov         = & io;
+  msg.msg_iovlen      = 1;
+  msg.msg_control     = control;
+  msg.msg_controllen  = sizeof( control );
+  auto cmsg( CMSG_FIRSTHDR( & msg ) );
+  cmsg->cmsg_level    = SOL_SOCKET;
+  cmsg->cmsg_type     = SCM_RIGHTS;
+  cmsg->cmsg_len      = CMSG_LEN( sizeof( handles ) );
+  std::memcpy( CMSG_DATA( cmsg ), handles, sizeof( handles ) );
+
+  if( ::sendmsg( socketHandle, & msg, MSG_NOSIGNAL ) != static_cast< ssize_t >( sizeof( capacity ) ) )
+    ec = SystemError();
+  return IsNoErr( ec );
+}
+
+bool
+ShmRegion::Receive( int socketHandle, int timeoutMs, error_t & ec )
+{
+  ec = error_t();
+  Close();
+  m_Creator = false;
+
+  std::uint64_t capacity( 0 );
+  iovec io { & capacity, sizeof( capacity ) };
+  alignas( cmsghdr ) char control[ CMSG_SPACE( SHM_HANDLES * sizeof( int ) ) ] {};
+  msghdr msg {};
+  msg.msg_iov         = & io;
+  msg.msg_iovlen      = 1;
+  msg.msg_control     = control;
+  msg.msg_controllen  = sizeof( control );
+
+  pollfd pfd { socketHandle, POLLIN, 0 };
+  ssize_t received( -1 );
+  if( ::poll( & pfd, 1, timeoutMs ) == 1 )
+    received = ::recvmsg( socketHandle, & msg, MSG_CMSG_CLOEXEC );
+  else
+    errno = ETIMEDOUT;
+  if( received < 0 )
+  {
+    ec = SystemError();
+    return false;
+  }
+
+  auto cmsg( CMSG_FIRSTHDR( & msg ) );
+  if( ( received != static_cast< ssize_t >( sizeof( capacity ) ) )
+      or ( nullptr == cmsg )
+      or ( cmsg->cmsg_type != SCM_RIGHTS )
+      or ( cmsg->cmsg_len != CMSG_LEN( SHM_HANDLES * sizeof( int ) ) ) )
+  { // полученные дескрипторы не соответствуют области
+    if( ( nullptr != cmsg ) and ( cmsg->cmsg_type == SCM_RIGHTS ) )
+    {
+      const std::size_t count( ( cmsg->cmsg_len - CMSG_LEN( 0 ) ) / sizeof( int ) );
+      for( std::size_t i( 0 ); i < count; ++i )
+      {
+        int handle;
+        std::memcpy( & handle, CMSG_DATA( cmsg ) + i * sizeof( int ), sizeof( int ) );
+        ::close( handle );
+      }
+    }
+    ec = boost::asio::error::invalid_argument;
+    return false;
+  }
+
+  int handles[ SHM_HANDLES ];
+  std::memcpy( handles, CMSG_DATA( cmsg ), sizeof( handles ) );
+  m_MemoryHandle  = handles[ 0 ];
+  m_Events[ 0 ]   = handles[ 1 ];
+  m_Events[ 1 ]   = handles[ 2 ];
+
+  // область принимается только с запечатанным размером
+  struct stat st;
+  const std::size_t size( 2 * ShmRing::RegionSize( capacity ) );
+  const int seals( ::fcntl( m_MemoryHandle, F_GET_SEALS ) );
+  if( ( ::fstat( m_MemoryHandle, & st ) != 0 ) or ( seals < 0 ) )
+    ec = SystemError();
+  else if( ( capacity == 0 )
+           or ( capacity % 8 != 0 )
+           or ( capacity > std::numeric_limits< std::uint32_t >::max() )
+           or ( static_cast< std::size_t >( st.st_size ) != size )
+           or ( ( seals & SHM_SEALS ) != SHM_SEALS ) )
+    ec = boost::asio::error::invalid_argument;
+
+  if( IsNoErr( ec ) and Map( size, ec ) )
+  {
+    auto memory( static_cast< unsigned char * >( m_Memory ) );
+    m_Rings[ 0 ].Attach( memory, capacity );
+    m_Rings[ 1 ].Attach( memory + ShmRing::RegionSize( capacity ), capacity );
+    if( m_Rings[ 0 ].IsCorrupted() or m_Rings[ 1 ].IsCorrupted() )
+      ec = boost::asio::error::invalid_argument;
+  }
+
+  if( not IsNoErr( ec ) )
+    Close();
+  return IsNoErr( ec );
+}
+
+void
+ShmRegion::Wake() const
+{
+  const std::uint64_t one( 1 );
+  if( ::write( TxEventHandle(), & one, sizeof( one ) ) < 0 )
+    UNUSED( errno );
+}
+
+void
+ShmRegion::Close()
+{
+  if( nullptr != m_Memory )
+    ::munmap( m_Memory, m_Size );
+  m_Memory  = nullptr;
+  m_Size    = 0;
+  m_Rings[ 0 ] = ShmRing();
+  m_Rings[ 1 ] = ShmRing();
+  CloseHandle( m_MemoryHandle );
+  CloseHandle( m_Events[ 0 ] );
+  CloseHandle( m_Events[ 1 ] );
+}
+
+bool
+ShmRegion::Map( std::size_t size, error_t & ec )
+{
+  auto memory( ::mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_MemoryHandle, 0 ) );
+  if( memory == MAP_FAILED )
+  {
+    ec = SystemError();
+    return false;
+  }
+  m_Memory  = memory;
+  m_Size    = size;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+}// namespace                   asio
+}// namespace                   spo